@@ -5,16 +5,29 @@
 #include <future>
 #include <thread>
 #include <algorithm>
+#include <optional>
 
 #include "Shader.hpp"
 #include "Camera.hpp"
 #include "Objects/Object.hpp"
+#include "Objects/Scene.hpp"
+#include "Objects/PrimitiveRegistry.hpp"
+#include "Shading/MaterialLibrary.hpp"
 #include "LightSource/LightSource.hpp"
 #include "Renderers/RendererManager.hpp"
 #include "Renderers/Renderer.hpp"
+#include "Renderers/GPUTimer.hpp"
+#include "Renderers/ObjectPicker.hpp"
+#include "Renderers/Passes/LightPass.hpp"
 #include "Utils/DebugOutput.hpp"
 #include "ModelLoader.hpp"
+#include "Objects/WorldPartition.hpp"
+#include "Shading/ClusterPagePool.hpp"
+#include "Shading/SkinningSystem.hpp"
+#include "Objects/SkinnedModel.hpp"
+#include "Objects/Terrain.hpp"
 #include "FileBrowser.hpp"
+#include "SceneHierarchyIndex.hpp"
 
 #include "imgui/imgui.h"
 #include "imgui/backends/imgui_impl_glfw.h"
@@ -49,6 +62,7 @@ namespace GUI
         if (ImGui::Button("Reload Current Shaders"))
         {
             renderManager.reloadCurrentShaders();
+            SkinningSystem::Get().reloadShaders();
             DebugOutput::AddLog("Execute Current Shaders Reload\n");
         }
     }
@@ -337,14 +351,14 @@ namespace GUI
         }
     }
 
-    static void ObjectHandle(Object &object)
+    static void ObjectHandle(glm::mat4 &modelMatrix)
     {
         auto &camera = ptrRenderParameters->cam;
         auto view = camera.getViewMatrix();
         auto projection = camera.getPerspectiveMatrix();
         float *cameraView = glm::value_ptr(view);
         float *cameraProjection = glm::value_ptr(projection);
-        float *matrix = glm::value_ptr(object.modelMatrix);
+        float *matrix = glm::value_ptr(modelMatrix);
 
         ImVec2 size;
         ImVec2 pos;
@@ -381,79 +395,346 @@ namespace GUI
         if (ImGui::IsKeyPressed(ImGuiKey_R)) // r Key
             mCurrentGizmoOperation = ImGuizmo::SCALE;
     }
-    inline int selectedIndex = -1;
+    inline SceneHandle selectedHandle;
+    // 层次面板的排序与过滤索引, 随场景增删增量更新
+    inline SceneHierarchyIndex sceneHierarchyIndex;
+
     static void displaySceneHierarchy(Scene &scene)
     {
-
-        /*                 // 列表显示所有对象
-                for (int i = 0; i < scene.size(); ++i)
+        static char filter[128] = "";
+        static SceneHandle lastSelected;
+        ImGui::InputTextWithHint("##HierarchyFilter", "Filter", filter, sizeof(filter));
+        sceneHierarchyIndex.setFilter(filter);
+        sceneHierarchyIndex.update(scene);
+
+        const std::vector<SceneHierarchyIndex::Entry> &rows = sceneHierarchyIndex.rows();
+        ImGui::Text("%zu / %zu objects%s, index %.3f ms", rows.size(), sceneHierarchyIndex.objectCount(),
+                    sceneHierarchyIndex.scanning() ? " (filtering...)" : "", sceneHierarchyIndex.lastUpdateMs());
+
+        // 在场景中拾取等方式改变选择时滚动到对应行
+        size_t scrollRow = rows.size();
+        if (selectedHandle != lastSelected && selectedHandle.isValid())
+            scrollRow = sceneHierarchyIndex.rowOf(selectedHandle);
+        lastSelected = selectedHandle;
+
+        ImGui::BeginChild("SceneHierarchyRows", ImVec2(0.0f, 320.0f), true);
+        {
+            const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+            if (scrollRow < rows.size())
+                ImGui::SetScrollY(rowHeight * static_cast<float>(scrollRow) - 0.5f * ImGui::GetWindowHeight());
+
+            // 只为可见行调用 ImGui
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(rows.size()), rowHeight);
+            while (clipper.Step())
+            {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
                 {
-                    bool isSelected = (selectedIndex == i);
-                    if (ImGui::Selectable(scene[i]->name.c_str(), isSelected))
+                    const SceneHierarchyIndex::Entry &entry = rows[row];
+                    const SceneHandle handle = entry.handle;
+                    bool isSelected = (selectedHandle == handle);
+                    ImGui::PushID(row);
+                    if (ImGui::Selectable(entry.name.c_str(), isSelected))
                     {
-                        if (selectedIndex != i)
+                        if (selectedHandle != handle)
                         {
                             handleControl = HandleControl::ModelControl;
-                            selectedIndex = i;
+                            selectedHandle = handle;
                         }
                         else
                         {
-                            selectedIndex = -1;
+                            selectedHandle = SceneHandle{};
                         }
+                        lastSelected = selectedHandle;
                     }
 
-                    // 右键菜单
-                    if (ImGui::BeginPopupContextItem())
+                    // 右键菜单. 已标记删除的对象在 Scene::update 之前仍在场景中
+                    if (scene.contains(handle) && ImGui::BeginPopupContextItem())
                     {
                         if (ImGui::MenuItem("Delete"))
                         {
-                            if (selectedIndex == i)
-                                selectedIndex = -1;
-                            scene.erase(scene.begin() + i);
-                            ImGui::EndPopup();
-                            break;
+                            if (selectedHandle == handle)
+                                selectedHandle = SceneHandle{};
+                            scene.removeObject(handle);
+                        }
+                        bool occluder = scene.isOccluderAt(scene.denseIndexOf(handle));
+                        if (ImGui::MenuItem("Occluder", nullptr, &occluder))
+                        {
+                            scene.setOccluder(handle, occluder);
                         }
                         ImGui::EndPopup();
                     }
-                    if (selectedIndex >= 0 && handleControl == ModelControl)
-                    {
-                        ObjectHandle(*scene[selectedIndex].get());
-                    }
-                } */
-        // 将selectedIndex 遍历方法修改为ID方法
-        for (auto &&[id, obj] : scene)
+                    ImGui::PopID();
+                }
+            }
+        }
+        ImGui::EndChild();
+
+        // 选中对象的操纵器与其行是否可见无关
+        if (handleControl == ModelControl && scene.contains(selectedHandle))
         {
-            bool isSelected = (selectedIndex == id);
-            if (ImGui::Selectable(obj->name.c_str(), isSelected))
+            // 操纵器使用相机的视图与投影, 在世界空间中编辑; 写回时换算到父节点空间
+            const size_t denseIndex = scene.denseIndexOf(selectedHandle);
+            const glm::mat4 &worldTransform = scene.worldTransformAt(denseIndex);
+            glm::mat4 newWorld = worldTransform;
+            ObjectHandle(newWorld);
+            if (newWorld != worldTransform)
             {
-                if (selectedIndex != id)
+                const SceneHandle parent = scene.parentAt(denseIndex);
+                const glm::mat4 &parentWorld = parent.isValid() ? scene.worldTransformAt(scene.denseIndexOf(parent))
+                                                                : scene.getRootTransform();
+                scene.setLocalTransform(selectedHandle, glm::inverse(parentWorld) * newWorld);
+            }
+        }
+    }
+
+    inline bool drawWireframe = false;
+    inline bool enableObjectIdPicking = true;
+    // 等待GBufferPass回读的点击位置, Scene窗口内的归一化坐标(原点左下)
+    inline std::optional<glm::vec2> pickRequest;
+
+    /// @brief GBufferPass 绘制完成后取走本帧的拾取请求
+    static bool TakePickRequest(glm::vec2 &uv)
+    {
+        if (!pickRequest)
+            return false;
+        uv = *pickRequest;
+        pickRequest.reset();
+        return true;
+    }
+    /// @brief 对象ID回读完成时调用. 点中空白时保持当前选择, 与射线拾取一致
+    static void SelectPickedObject(SceneHandle handle)
+    {
+        if (!handle.isValid())
+            return;
+        handleControl = HandleControl::ModelControl;
+        selectedHandle = handle;
+    }
+
+    // Scene窗口中左键点击拾取对象
+    //     开启对象ID拾取时回读GBuffer中鼠标下的对象ID, 像素精确, 结果晚一到两帧
+    //     否则(或线框模式下GBuffer中没有对象时)由鼠标位置反投影出射线, 在场景BVH中求最近命中
+    static void ScenePicking(Scene &scene)
+    {
+        auto &camera = ptrRenderParameters->cam;
+        ImGui::Begin("Scene", 0); // 窗口,子窗口名称必须和RendererOutuputManager中一致
+        {
+            ImGui::BeginChild("Output");
+            if (ImGui::IsWindowHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left) &&
+                !ImGuizmo::IsOver() && !ImGuizmo::IsUsing())
+            {
+                ImVec2 pos = ImGui::GetWindowPos();
+                ImVec2 size = ImGui::GetWindowSize();
+                ImVec2 mouse = ImGui::GetMousePos();
+                float ndcX = (mouse.x - pos.x) / size.x * 2.0f - 1.0f;
+                float ndcY = 1.0f - (mouse.y - pos.y) / size.y * 2.0f;
+                if (enableObjectIdPicking && !drawWireframe)
                 {
-                    handleControl = HandleControl::ModelControl;
-                    selectedIndex = id;
+                    pickRequest = glm::vec2(ndcX, ndcY) * 0.5f + 0.5f;
                 }
                 else
                 {
-                    selectedIndex = -1;
+                    glm::mat4 invProjView = glm::inverse(camera.getPerspectiveMatrix() * camera.getViewMatrix());
+                    glm::vec4 nearPoint = invProjView * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+                    glm::vec4 farPoint = invProjView * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+                    nearPoint /= nearPoint.w;
+                    farPoint /= farPoint.w;
+
+                    SceneHandle hit = scene.raycast(glm::vec3(nearPoint), glm::vec3(farPoint - nearPoint));
+                    if (hit.isValid())
+                    {
+                        handleControl = HandleControl::ModelControl;
+                        selectedHandle = hit;
+                    }
                 }
             }
+            ImGui::EndChild();
+        }
+        ImGui::End();
+    }
+
+    static void DebugBVH(const Scene &scene)
+    {
+        static int benchmarkCount = 100000;
+        static BVH4::BenchmarkResult benchmark;
+        static Scene::BenchmarkResult sceneBenchmark;
+        ImGui::Begin("DebugBVH");
+        {
+            const BVH4 &bvh = scene.bvh();
+            ImGui::Text("Primitives: %zu  Nodes: %zu", bvh.primitiveCount(), bvh.nodeCount());
+            ImGui::Text("Build: %.3f ms  Refit: %.3f ms", bvh.lastBuildMs(), bvh.lastRefitMs());
+            ImGui::Separator();
+            ImGui::RadioButton("10k", &benchmarkCount, 10000);
+            ImGui::SameLine();
+            ImGui::RadioButton("100k", &benchmarkCount, 100000);
+            ImGui::SameLine();
+            ImGui::RadioButton("1M", &benchmarkCount, 1000000);
+            if (ImGui::Button("Run Benchmark"))
+            {
+                benchmark = BVH4::Benchmark(static_cast<size_t>(benchmarkCount));
+                DebugOutput::AddLog("BVH4 benchmark {} prims: nodes {}, build {:.3f} ms, refit {:.3f} ms, frustum query {:.4f} ms, ray query {:.4f} ms\n",
+                                    benchmark.primitiveCount, benchmark.nodeCount, benchmark.buildMs, benchmark.refitMs,
+                                    benchmark.frustumQueryMs, benchmark.rayQueryMs);
+            }
+            if (benchmark.primitiveCount > 0)
+            {
+                ImGui::Text("%zu prims, %zu nodes", benchmark.primitiveCount, benchmark.nodeCount);
+                ImGui::Text("Build %.3f ms  Refit %.3f ms", benchmark.buildMs, benchmark.refitMs);
+                ImGui::Text("Frustum query %.4f ms  Ray query %.4f ms", benchmark.frustumQueryMs, benchmark.rayQueryMs);
+            }
+            ImGui::Separator();
+            if (ImGui::Button("Run Scene Storage Benchmark"))
+            {
+                sceneBenchmark = Scene::Benchmark(static_cast<size_t>(benchmarkCount));
+                DebugOutput::AddLog("Scene storage benchmark {} objects: walk hash map {:.3f} ms, dense {:.3f} ms; lookup by id {:.3f} ms, by handle {:.3f} ms\n",
+                                    sceneBenchmark.objectCount, sceneBenchmark.mapWalkMs, sceneBenchmark.denseWalkMs,
+                                    sceneBenchmark.mapLookupMs, sceneBenchmark.handleLookupMs);
+            }
+            if (sceneBenchmark.objectCount > 0)
+            {
+                ImGui::Text("%zu objects", sceneBenchmark.objectCount);
+                ImGui::Text("Walk: hash map %.3f ms  dense %.3f ms", sceneBenchmark.mapWalkMs, sceneBenchmark.denseWalkMs);
+                ImGui::Text("Lookup: id %.3f ms  handle %.3f ms", sceneBenchmark.mapLookupMs, sceneBenchmark.handleLookupMs);
+            }
+            ImGui::End();
+        }
+    }
+
+    static void DebugWorldPartition(WorldPartition &partition)
+    {
+        ImGui::Begin("DebugWorldPartition");
+        {
+            const WorldPartition::Stats &stats = partition.getStats();
+            WorldPartition::Settings &settings = partition.getSettings();
+            ImGui::Text("Cells %zu (size %.0f), instances %zu", stats.cells, partition.getCellSize(), stats.instances);
+            ImGui::Text("Resident cells %zu, loading %zu, objects %zu", stats.residentCells, stats.loadingCells, stats.residentObjects);
+            ImGui::Text("Resident memory %.1f / %.1f MB", stats.residentBytes / (1024.0 * 1024.0), settings.memoryBudget / (1024.0 * 1024.0));
+            ImGui::Text("Loads %zu, evictions %zu, cancelled %zu, over budget %zu",
+                        stats.loadsCompleted, stats.evictions, stats.cancelledLoads, stats.budgetRejections);
+            ImGui::Text("Upload %.3f ms this frame, slowest instance %.3f ms", stats.lastUploadMs, stats.maxInstanceUploadMs);
+            ImGui::Separator();
+            ImGui::DragFloat("Load radius", &settings.loadRadius, 1.0f, 0.0f, 100000.0f);
+            ImGui::DragFloat("Hysteresis", &settings.hysteresis, 1.0f, 0.0f, 10000.0f);
+            ImGui::DragFloat("Look ahead (s)", &settings.lookAheadSeconds, 0.01f, 0.0f, 5.0f);
+            int budgetMB = static_cast<int>(settings.memoryBudget >> 20);
+            if (ImGui::DragInt("Memory budget (MB)", &budgetMB, 8.0f, 16, 65536))
+                settings.memoryBudget = size_t(std::max(budgetMB, 16)) << 20;
+            int concurrentLoads = static_cast<int>(settings.maxConcurrentLoads);
+            if (ImGui::SliderInt("Concurrent loads", &concurrentLoads, 1, 16))
+                settings.maxConcurrentLoads = static_cast<size_t>(concurrentLoads);
+            float uploadBudget = static_cast<float>(settings.uploadBudgetMs);
+            if (ImGui::SliderFloat("Upload budget (ms)", &uploadBudget, 0.5f, 16.0f))
+                settings.uploadBudgetMs = uploadBudget;
+            ImGui::End();
+        }
+    }
+
+    static void DebugClusterStreaming(ClusterPagePool &pool)
+    {
+        ImGui::Begin("DebugClusterStreaming");
+        {
+            const ClusterPagePool::Stats &stats = pool.getStats();
+            ClusterPagePool::Settings &settings = pool.getSettings();
+            ImGui::Text("Page pool: %zu/%zu slots (%zu pinned), %.1f MB", stats.usedSlots, stats.slots, stats.pinnedSlots,
+                        stats.poolBytes / (1024.0 * 1024.0));
+            ImGui::Text("Reads in flight %zu, waiting for slot %zu, requests %zu", stats.inFlightReads, stats.readyPages, stats.requests);
+            ImGui::Text("Uploads %zu this frame, evictions %zu, read %.1f MB total", stats.uploads, stats.evictions,
+                        stats.bytesRead / (1024.0 * 1024.0));
+            ImGui::Text("Cut: %zu clusters, %zu triangles, %zu refined groups, select %.3f ms",
+                        stats.drawnClusters, stats.drawnTriangles, stats.refinedGroups, stats.selectMs);
+            ImGui::Separator();
+            ImGui::SliderFloat("Pixel error", &settings.pixelError, 0.25f, 16.0f);
+            int inFlight = static_cast<int>(settings.maxInFlightReads);
+            if (ImGui::SliderInt("Reads in flight", &inFlight, 1, 64))
+                settings.maxInFlightReads = static_cast<size_t>(inFlight);
+            int uploads = static_cast<int>(settings.maxUploadsPerFrame);
+            if (ImGui::SliderInt("Uploads per frame", &uploads, 1, 256))
+                settings.maxUploadsPerFrame = static_cast<size_t>(uploads);
+            ImGui::End();
+        }
+    }
 
-            // 右键菜单
-            if (ImGui::BeginPopupContextItem())
+    static void DebugSkinning(SkinningSystem &skinning, Scene &scene)
+    {
+        ImGui::Begin("DebugSkinning");
+        {
+            const SkinningSystem::Stats &stats = skinning.getStats();
+            SkinningSystem::Settings &settings = skinning.getSettings();
+            ImGui::Text("Instances %zu, skinned this frame %zu (%zu dispatches)", stats.instances, stats.skinnedInstances, stats.dispatches);
+            ImGui::Text("Bones %zu, vertices %zu, palette %.1f KB", stats.bones, stats.vertices, stats.paletteBytes / 1024.0);
+            ImGui::Text("Pose %.3f ms on %zu workers, upload+dispatch %.3f ms, GPU %.3f ms", stats.poseMs, stats.workers, stats.uploadMs, stats.gpuMs);
+            ImGui::Separator();
+            ImGui::Checkbox("Pause", &settings.paused);
+            ImGui::SliderFloat("Time scale", &settings.timeScale, 0.0f, 4.0f);
+            int workers = static_cast<int>(settings.workerCount);
+            if (ImGui::SliderInt("Workers (0 = auto)", &workers, 0, 32))
+                settings.workerCount = static_cast<unsigned>(workers);
+
+            // 选中对象为骨骼动画模型时可切换动画
+            SkinnedModel *model = scene.contains(selectedHandle) ? dynamic_cast<SkinnedModel *>(&scene.getObject(selectedHandle)) : nullptr;
+            if (model)
             {
-                if (ImGui::MenuItem("Delete"))
+                ImGui::Separator();
+                const SkinnedAsset &asset = model->getAsset();
+                ImGui::Text("%s: %zu joints, %zu bones", model->name.c_str(), asset.skeleton.jointCount(), asset.skeleton.boneCount());
+                const int clip = model->getClip();
+                if (ImGui::BeginCombo("Clip", clip >= 0 ? asset.clips[clip].name.c_str() : "Rest pose"))
+                {
+                    if (ImGui::Selectable("Rest pose", clip < 0))
+                        model->setClip(-1);
+                    for (int i = 0; i < static_cast<int>(asset.clips.size()); ++i)
+                    {
+                        if (ImGui::Selectable(asset.clips[i].name.c_str(), i == clip))
+                            model->setClip(i);
+                    }
+                    ImGui::EndCombo();
+                }
+                if (const AnimationClip *current = model->currentClip())
                 {
-                    if (selectedIndex == id)
-                        selectedIndex = -1;
-                    scene.removeObject(id);
-                    ImGui::EndPopup();
-                    break;
+                    float time = model->getTime();
+                    if (ImGui::SliderFloat("Time", &time, 0.0f, current->duration))
+                        model->setTime(time);
                 }
-                ImGui::EndPopup();
+                ImGui::Checkbox("Playing", &model->playing);
+                ImGui::SameLine();
+                ImGui::Checkbox("Loop", &model->loop);
+                ImGui::SliderFloat("Speed", &model->speed, -2.0f, 2.0f);
             }
-            if (selectedIndex == id && handleControl == ModelControl)
+            ImGui::End();
+        }
+    }
+
+    static void DebugTerrain(Terrain &terrain)
+    {
+        ImGui::Begin("DebugTerrain");
+        {
+            if (!terrain.isEnabled())
             {
-                ObjectHandle(*obj.get());
+                ImGui::Text("No terrain (--stress-terrain procedural|<file.r16>)");
+                ImGui::End();
+                return;
             }
+            const Terrain::Stats &stats = terrain.getStats();
+            Terrain::Settings &settings = terrain.getSettings();
+            ImGui::Text("%u levels, tiles %zu/%zu resident, %.1f MB textures", stats.levels, stats.residentTiles, stats.tiles,
+                        stats.cacheBytes / (1024.0 * 1024.0));
+            ImGui::Text("Reads in flight %zu, uploads %zu this frame, loaded %zu, evictions %zu", stats.inFlightReads, stats.uploads,
+                        stats.tilesLoaded, stats.evictions);
+            ImGui::Text("%zu passes: %zu nodes (%zu culled), %zu triangles, select %.3f ms", stats.passes, stats.nodes, stats.culledNodes,
+                        stats.triangles, stats.selectMs);
+            ImGui::Separator();
+            ImGui::Checkbox("Visible", &settings.visible);
+            ImGui::SameLine();
+            ImGui::Checkbox("Show levels", &settings.showLevels);
+            ImGui::SliderFloat("LOD range scale", &settings.lodRangeScale, 3.0f, 16.0f);
+            ImGui::SliderFloat("Morph start", &settings.morphStart, 0.5f, 0.95f);
+            int inFlight = static_cast<int>(settings.maxInFlightReads);
+            if (ImGui::SliderInt("Reads in flight", &inFlight, 1, 32))
+                settings.maxInFlightReads = static_cast<size_t>(inFlight);
+            int uploads = static_cast<int>(settings.maxUploadsPerFrame);
+            if (ImGui::SliderInt("Uploads per frame", &uploads, 1, 32))
+                settings.maxUploadsPerFrame = static_cast<size_t>(uploads);
+            ImGui::End();
         }
     }
 
@@ -468,7 +749,31 @@ namespace GUI
                 // 加载所有选中路径
                 for (auto &path : fileSelector.GetAllPaths())
                 {
-                    ModelLoader::loadFile(std::string(path)); // UI只负责触发信号
+                    const std::string file(path);
+                    if (std::filesystem::path(file).extension() == ".world")
+                    {
+                        // 世界描述文件交给世界分区, 按相机位置流式加载
+                        try
+                        {
+                            WorldPartition::Get().loadWorld(file);
+                        }
+                        catch (const std::exception &e)
+                        {
+                            DebugOutput::AddLog("{}\n", e.what());
+                        }
+                        continue;
+                    }
+                    ModelLoader::loadFile(file); // UI只负责触发信号
+                }
+                fileSelector.ClearPaths();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Build Cluster Files"))
+            {
+                // 离线构建 .clusters 文件, 之后可作为流式网格导入
+                for (auto &path : fileSelector.GetAllPaths())
+                {
+                    ModelLoader::buildClusterFile(std::string(path));
                 }
                 fileSelector.ClearPaths();
             }
@@ -485,8 +790,6 @@ namespace GUI
         // 1. 灯光控制部分
         if (ImGui::CollapsingHeader("Light Settings", ImGuiTreeNodeFlags_DefaultOpen))
         {
-            auto &light = lights.pointLights[0];
-            // GUI::LightHandle(light);
             GUI::LightSourceManage(lights);
         }
 
@@ -503,10 +806,16 @@ namespace GUI
         }
 
         // 4. 场景层次结构
+        GUI::ScenePicking(scene);
         if (ImGui::CollapsingHeader("Scene Hierarchy", ImGuiTreeNodeFlags_DefaultOpen))
         {
             GUI::displaySceneHierarchy(scene);
         }
+        GUI::DebugBVH(scene);
+        GUI::DebugWorldPartition(WorldPartition::Get());
+        GUI::DebugClusterStreaming(ClusterPagePool::Get());
+        GUI::DebugSkinning(SkinningSystem::Get(), scene);
+        GUI::DebugTerrain(Terrain::Get());
 
         // 5. 着色器管理
         if (ImGui::CollapsingHeader("Shader Settings"))
@@ -660,7 +969,44 @@ namespace GUI
         return usePCSS;
     }
 
-    inline bool drawWireframe = false;
+    // 返回本帧要运行的基准次数, 0 表示不运行
+    static int DebugUniformUpload(const LightPass::UniformStats &stats)
+    {
+        static int iterations = 1000;
+        int run = 0;
+        ImGui::Begin("DebugShadow");
+        {
+            ImGui::Text("Light uniform upload: %.3f ms", stats.uploadMs);
+            ImGui::DragInt("Benchmark iterations", &iterations, 10, 1, 100000);
+            if (ImGui::Button("Benchmark uniform upload"))
+            {
+                run = iterations;
+            }
+            if (stats.benchmarkIterations > 0)
+            {
+                ImGui::Text("x%d: UniformId %.2f us, std::format names %.2f us per upload",
+                            stats.benchmarkIterations, stats.idUs, stats.stringUs);
+            }
+
+            ImGui::End();
+        }
+        return run;
+    }
+    static void DebugLightBuffer(const LightBuffer::Stats &stats)
+    {
+        ImGui::Begin("DebugShadow");
+        {
+            ImGui::Text("Light table: %zu point, %zu dir lights, %zu bytes uploaded this frame, %.1f KB buffers",
+                        stats.pointLights, stats.dirLights, stats.uploadBytes, stats.bufferBytes / 1024.0);
+            ImGui::Text("Shadow map arrays %zu (%zu layers), %.1f MB, views created %zu",
+                        stats.shadowArrays, stats.shadowLayers, stats.shadowBytes / (1024.0 * 1024.0), stats.viewsCreated);
+            ImGui::Text("Lights at another shadow resolution %zu, without shadow (array layer limit %d) %zu",
+                        stats.resolutionOverrides, stats.maxArrayLayers, stats.shadowlessLights);
+
+            ImGui::End();
+        }
+    }
+
     static bool DebugToggleDrawWireframe()
     {
         ImGui::Begin("DebugWireframe");
@@ -671,6 +1017,17 @@ namespace GUI
         }
         return drawWireframe;
     }
+    static bool DebugToggleObjectIdPicking(const ObjectPicker &picker)
+    {
+        ImGui::Begin("DebugWireframe");
+        {
+            ImGui::Checkbox("Object ID picking", &enableObjectIdPicking);
+            ImGui::Text("Last pick resolved after %u frame(s)%s", picker.getLastLatencyFrames(), picker.isPending() ? ", pending" : "");
+
+            ImGui::End();
+        }
+        return enableObjectIdPicking;
+    }
     inline bool drawCameraFrustumWireframe = false;
     static bool DebugToggleDrawFrustum()
     {
@@ -682,4 +1039,251 @@ namespace GUI
         }
         return drawCameraFrustumWireframe;
     }
+
+    static bool DebugToggleCulling()
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Checkbox("EnableCulling", &Renderer::enableCulling);
+
+            ImGui::End();
+        }
+        return Renderer::enableCulling;
+    }
+    static void DebugCullingStats(const char *passName, const CullingStats &stats)
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Text("%s: visible %zu, culled %zu, occluded %zu", passName, stats.visible, stats.culled, stats.occluded);
+
+            ImGui::End();
+        }
+    }
+    inline bool enableOcclusionCulling = true;
+    static bool DebugToggleOcclusionCulling()
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Checkbox("OcclusionCulling", &enableOcclusionCulling);
+
+            ImGui::End();
+        }
+        return Renderer::enableCulling && enableOcclusionCulling;
+    }
+    inline bool enableHiZCulling = true;
+    static bool DebugToggleHiZCulling()
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Checkbox("HiZCulling", &enableHiZCulling);
+
+            ImGui::End();
+        }
+        return Renderer::enableCulling && enableHiZCulling;
+    }
+    inline bool enableShadowCasterCulling = true;
+    static bool DebugToggleShadowCasterCulling()
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Checkbox("ShadowCasterCulling", &enableShadowCasterCulling);
+
+            ImGui::End();
+        }
+        return Renderer::enableCulling && enableShadowCasterCulling;
+    }
+    inline bool enableGPUDrivenCulling = false;
+    static bool DebugToggleGPUDrivenCulling()
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Checkbox("GPUDrivenCulling", &enableGPUDrivenCulling);
+
+            ImGui::End();
+        }
+        return Renderer::enableCulling && enableGPUDrivenCulling;
+    }
+    inline bool enableSmallClusterCulling = true;
+    static bool DebugToggleSmallClusterCulling()
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Checkbox("SmallClusterCulling", &enableSmallClusterCulling);
+
+            ImGui::End();
+        }
+        return Renderer::enableCulling && enableSmallClusterCulling;
+    }
+    // 面剔除关闭, 双面使用的网格(植被, 布料)背面会被误剔, 默认关闭
+    inline bool enableClusterConeCulling = false;
+    static bool DebugToggleClusterConeCulling()
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Checkbox("ClusterConeCulling", &enableClusterConeCulling);
+
+            ImGui::End();
+        }
+        return Renderer::enableCulling && enableClusterConeCulling;
+    }
+    static void DebugGPUDrivenStats(const GPUDrivenCulling::Stats &stats)
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Text("GPUDriven: items %zu (clusters %zu), batches %zu, fallback %zu, views %d",
+                        stats.items, stats.clusters, stats.batches, stats.fallback, stats.views);
+            ImGui::Text("GPUDriven submit: %zu multi-draw calls, %zu VAO binds (%zu VAOs)", stats.drawCalls, stats.vaoBinds, stats.vaos);
+
+            ImGui::End();
+        }
+    }
+    inline bool enableInstancing = true;
+    static bool DebugToggleInstancing()
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Checkbox("Instancing", &enableInstancing);
+
+            ImGui::End();
+        }
+        return enableInstancing;
+    }
+    static void DebugInstancingStats(const char *passName, const InstanceBatcher::Stats &stats)
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Text("%s instancing: %zu objects in %zu groups (%zu draw calls), %zu single",
+                        passName, stats.instancedObjects, stats.groups, stats.drawCalls, stats.singleObjects);
+
+            ImGui::End();
+        }
+    }
+    inline bool enableRenderQueueSorting = true;
+    static bool DebugToggleRenderQueue()
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Checkbox("Sorted render queue", &enableRenderQueueSorting);
+
+            ImGui::End();
+        }
+        return enableRenderQueueSorting;
+    }
+    inline bool enableLodSelection = true;
+    inline float lodPixelError = 1.0f;
+    /// @return 相机视图允许的LOD屏幕误差(像素), 关闭时为0
+    static float DebugLodPixelError()
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Checkbox("LOD selection", &enableLodSelection);
+            ImGui::SliderFloat("LOD pixel error", &lodPixelError, 0.25f, 8.0f);
+
+            ImGui::End();
+        }
+        return enableLodSelection ? lodPixelError : 0.0f;
+    }
+    inline bool enablePositionOnlyShadows = true;
+    static bool DebugTogglePositionOnlyShadows()
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Checkbox("Position-only shadow stream", &enablePositionOnlyShadows);
+
+            ImGui::End();
+        }
+        return enablePositionOnlyShadows;
+    }
+    /// @brief 阴影贴图的GPU耗时(含VSM预处理), 用于对比仅位置流的效果
+    static void DebugShadowTiming(const GPUTimer &pointShadow, const GPUTimer &dirShadow)
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Text("Shadow GPU time: point %.3f ms (avg %.3f), dir %.3f ms (avg %.3f)",
+                        pointShadow.getLastMs(), pointShadow.getAverageMs(), dirShadow.getLastMs(), dirShadow.getAverageMs());
+
+            ImGui::End();
+        }
+    }
+    static void DebugRenderQueueStats(const char *passName, const RenderQueue::Stats &stats)
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Text("%s queue: %zu packets, %zu draw calls, %zu fallback, sort %.3f ms",
+                        passName, stats.packets, stats.drawCalls, stats.fallbackObjects, stats.sortMs);
+            ImGui::Text("%s state changes: program %zu, material %zu, VAO %zu, model %zu",
+                        passName, stats.programChanges, stats.materialChanges, stats.vaoChanges, stats.transformChanges);
+            ImGui::Text("%s triangles %zu, LOD draws %zu (%zu triangles saved)",
+                        passName, stats.triangles, stats.lodDrawCalls, stats.lodTrianglesSaved);
+
+            ImGui::End();
+        }
+    }
+    static void DebugGeometryStats(const GeometryBuffer::Stats &stats)
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Text("GeometryBuffer: %zu allocations (%zu shared), vertices %zu/%zu, indices %zu/%zu",
+                        stats.allocations, stats.sharedAllocations, stats.vertexCount, stats.vertexCapacity, stats.indexCount, stats.indexCapacity);
+            ImGui::Text("Per-object submit: %zu draw calls, %zu VAO binds", stats.drawCalls, stats.vaoBinds);
+            ImGui::Text("Geometry memory: vertices %.1f KB, indices %.1f KB, position stream %.1f KB, shared content copies %.1f KB",
+                        stats.vertexBytes / 1024.0, stats.indexBytes / 1024.0, stats.positionBytes / 1024.0, stats.contentBytes / 1024.0);
+
+            ImGui::End();
+        }
+    }
+    static void DebugMeshOptimizeStats(const MeshOptimizer::Stats &stats)
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            const double triangles = double(std::max<size_t>(stats.triangles, 1));
+            const double vertices = double(std::max<size_t>(stats.vertices, 1));
+            ImGui::Text("Imported meshes %zu (%zu triangles), optimized in %.2f ms", stats.meshes, stats.triangles, stats.optimizeMs);
+            ImGui::Text("ACMR %.3f -> %.3f, overdraw reordered %zu meshes",
+                        stats.transformsBefore / triangles, stats.transformsAfter / triangles, stats.overdrawReordered);
+            ImGui::Text("Vertex memory %.1f -> %.1f KB (%.1f bytes/vertex, %zu compact meshes)",
+                        stats.vertexBytesBefore / 1024.0, stats.vertexBytesAfter / 1024.0, stats.vertexBytesAfter / vertices, stats.compactMeshes);
+            ImGui::Text("Index memory %.1f -> %.1f KB (%zu meshes with 16-bit indices)",
+                        stats.indexBytesBefore / 1024.0, stats.indexBytesAfter / 1024.0, stats.shortIndexMeshes);
+
+            ImGui::End();
+        }
+    }
+    static void DebugPrimitiveStats(const PrimitiveRegistry::Stats &stats)
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Text("Primitives: %zu meshes shared by %zu objects, %zu/%zu requests generated",
+                        stats.primitives, stats.users, stats.generated, stats.requests);
+            ImGui::Text("Primitive memory %.1f KB (unshared soup %.1f KB, saved %.1f KB)",
+                        stats.residentBytes / 1024.0, stats.unsharedBytes / 1024.0,
+                        (double(stats.unsharedBytes) - double(stats.residentBytes)) / 1024.0);
+            ImGui::Text("Primitive generate+upload %.3f ms total, last %.3f ms", stats.uploadMs, stats.lastUploadMs);
+
+            ImGui::End();
+        }
+    }
+    static void DebugMaterialStats(const MaterialLibrary::Stats &stats)
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            ImGui::Text("Materials: %zu, textures %zu packed into %zu/%d arrays (%zu layers allocated, %zu free)",
+                        stats.materials, stats.textures, stats.arrays, MaterialLibrary::MaxTextureArrays, stats.layerCapacity, stats.freeLayers);
+            ImGui::Text("Material texture memory %.1f MB (level 0), rejected textures %zu",
+                        stats.textureBytes / (1024.0 * 1024.0), stats.rejected);
+
+            ImGui::End();
+        }
+    }
+    static void DebugOcclusionStats(const MaskedOcclusionCulling &occlusion)
+    {
+        ImGui::Begin("DebugCulling");
+        {
+            const auto &stats = occlusion.getStats();
+            ImGui::Text("Occlusion %dx%d: occluder triangles %zu", occlusion.getWidth(), occlusion.getHeight(), stats.occluderTriangles);
+            ImGui::Text("Rasterize %.3f ms, test %.3f ms (%zu/%zu occluded)", stats.rasterizeMs, stats.testMs, stats.occluded, stats.tested);
+
+            ImGui::End();
+        }
+    }
 }
\ No newline at end of file
@@ -34,31 +34,10 @@ void DirectionLight::setSunlightToShader(Shader &shaders)
     shaders.setUniform3fv("dirLightPos", position);
     shaders.setUniform3fv("dirLightIntensity", combIntensity);
 }
-void DirectionLight::setToShaderLightArray(Shader &shaders, size_t index)
+void DirectionLight::SetDefaultSunlightToShader(Shader &shaders)
 {
-    combIntensity = ColorIntensity::Combine(colorIntensity);
-
-    // shaders.setTextureAuto(depthTexture->ID, GL_TEXTURE_2D, 0, std::format("dirLightArray[{}].depthMap", index));
-    shaders.setTextureAuto(shadowUnit.depthTexture->ID, GL_TEXTURE_2D, 0, std::format("dirLightArray[{}].depthMap", index));
-    if (useVSM)
-    {
-        // shaders.setTextureAuto(VSMTexture->ID, GL_TEXTURE_2D, 0, std::format("dirLightArray[{}].VSMTexture", index));
-        // shaders.setTextureAuto(SATTexture->ID, GL_TEXTURE_2D, 0, std::format("dirLightArray[{}].SATTexture", index));
-        shaders.setTextureAuto(shadowUnit.VSMTexture->ID, GL_TEXTURE_2D, 0, std::format("dirLightArray[{}].VSMTexture", index));
-        shaders.setTextureAuto(shadowUnit.SATTexture->ID, GL_TEXTURE_2D, 0, std::format("dirLightArray[{}].SATTexture", index));
-    }
-    else
-    {
-        shaders.setTextureAuto(0, GL_TEXTURE_2D, 0, std::format("dirLightArray[{}].VSMTexture", index));
-        shaders.setTextureAuto(0, GL_TEXTURE_2D, 0, std::format("dirLightArray[{}].SATTexture", index));
-    }
-    shaders.setUniform(std::format("dirLightArray[{}].useVSM", index), useVSM);
-    shaders.setUniform3fv(std::format("dirLightArray[{}].pos", index), shadowUnit.frustum.getPosition());
-    shaders.setUniform3fv(std::format("dirLightArray[{}].intensity", index), combIntensity);
-    shaders.setMat4(std::format("dirLightArray[{}].spaceMatrix", index), shadowUnit.frustum.getProjViewMatrix());
-    shaders.setUniform(std::format("dirLightArray[{}].farPlane", index), shadowUnit.frustum.getFarPlane());
-    shaders.setUniform(std::format("dirLightArray[{}].orthoScale", index), orthoScale);
-    CSMComponent->setToShader(shaders);
+    shaders.setUniform3fv("dirLightPos", glm::vec3(50.f, 20.f, 60.f));
+    shaders.setUniform3fv("dirLightIntensity", glm::vec3(0.1f));
 }
 void DirectionLight::setPosition(glm::vec3 &_position)
 {
@@ -0,0 +1,372 @@
+#include "LightBuffer.hpp"
+#include "LightSource.hpp"
+#include "Cubemap.hpp"
+#include "../Shading/Texture.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    // 表容量的下限, 保证没有光源时SSBO也不为空
+    constexpr size_t MinTableBytes = 256;
+
+    struct MapFormat
+    {
+        GLenum internalFormat;
+        GLenum filter;
+        size_t texelBytes;
+    };
+
+    constexpr MapFormat MapFormats[] = {
+        {GL_DEPTH_COMPONENT32F, GL_NEAREST, 4},
+        {GL_RGBA32F, GL_LINEAR, 16},
+        {GL_RGBA32F, GL_LINEAR, 16},
+    };
+
+    // 立方体贴图的VSM与原来一样逐texel读取
+    GLenum MapFilter(int kind, bool cube)
+    {
+        return cube ? GL_NEAREST : MapFormats[kind].filter;
+    }
+}
+
+LightBuffer::LightBuffer()
+{
+    glGenBuffers(1, &m_pointTable.buffer);
+    glGenBuffers(1, &m_dirTable.buffer);
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &m_maxArrayLayers);
+    m_stats.maxArrayLayers = m_maxArrayLayers;
+}
+
+LightBuffer::~LightBuffer()
+{
+    glDeleteBuffers(1, &m_pointTable.buffer);
+    glDeleteBuffers(1, &m_dirTable.buffer);
+    for (auto &array : m_pointArrays)
+        ReleaseMaps(array);
+    for (auto &array : m_dirArrays)
+        ReleaseMaps(array);
+}
+
+void LightBuffer::ReleaseMaps(ShadowArray &array)
+{
+    for (GLuint &map : array.maps)
+    {
+        if (map != 0)
+            glDeleteTextures(1, &map);
+        map = 0;
+    }
+    array.capacity = 0;
+}
+
+void LightBuffer::ReleaseUnused(std::vector<ShadowArray> &arrays, const std::vector<GLsizei> &resolutions)
+{
+    for (auto it = arrays.begin(); it != arrays.end();)
+    {
+        if (std::find(resolutions.begin(), resolutions.end(), it->resolution) == resolutions.end())
+        {
+            ReleaseMaps(*it);
+            it = arrays.erase(it);
+        }
+        else
+        {
+            it->used = 0;
+            it->needVSM = false;
+            ++it;
+        }
+    }
+}
+
+// 依次尝试: 分辨率相同且未满的数组, 新建数组(可与已满的数组同分辨率), 分辨率最接近且未满的数组
+LightBuffer::ShadowSlot LightBuffer::AcquireSlot(std::vector<ShadowArray> &arrays, GLsizei resolution, bool useVSM, GLsizei maxLayers)
+{
+    auto found = std::find_if(arrays.begin(), arrays.end(),
+                              [resolution, maxLayers](const ShadowArray &array)
+                              { return array.resolution == resolution && array.used < maxLayers; });
+    if (found == arrays.end())
+    {
+        if (arrays.size() < MaxShadowArrays)
+        {
+            arrays.emplace_back().resolution = resolution;
+            found = arrays.end() - 1;
+        }
+        else
+        {
+            found = arrays.end();
+            for (auto it = arrays.begin(); it != arrays.end(); ++it)
+            {
+                if (it->used < maxLayers &&
+                    (found == arrays.end() || std::abs(it->resolution - resolution) < std::abs(found->resolution - resolution)))
+                {
+                    found = it;
+                }
+            }
+            if (found == arrays.end())
+            {
+                return ShadowSlot{};
+            }
+        }
+    }
+    found->needVSM |= useVSM;
+    return ShadowSlot{static_cast<GLint>(found - arrays.begin()), found->used++};
+}
+
+void LightBuffer::reserve(ShadowArray &array, bool cube)
+{
+    const int kinds = cube ? SATMap : MapKindCount;
+    bool missing = false;
+    for (int kind = 0; kind < kinds; ++kind)
+        missing |= array.maps[kind] == 0 && (kind == DepthMap || array.needVSM);
+    if (array.used <= array.capacity && !missing)
+        return;
+
+    // 扩容时按倍数增长(不超过层数上限), 已有的阴影贴图在本帧的阴影pass中重新渲染, 不复制旧内容
+    const GLsizei capacity = array.used > array.capacity ? std::min(std::max(array.used, array.capacity * 2), maxLayers(cube)) : array.capacity;
+    const bool needVSM = array.needVSM || array.maps[VSMMap] != 0;
+    ReleaseMaps(array);
+    array.capacity = capacity;
+    array.generation = ++m_generation;
+
+    const GLenum target = cube ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_2D_ARRAY;
+    for (int kind = 0; kind < kinds; ++kind)
+    {
+        if (kind != DepthMap && !needVSM)
+            continue;
+        glGenTextures(1, &array.maps[kind]);
+        glBindTexture(target, array.maps[kind]);
+        // 视图要求不可变存储
+        glTexStorage3D(target, 1, MapFormats[kind].internalFormat, array.resolution, array.resolution, cube ? capacity * 6 : capacity);
+        const GLenum filter = MapFilter(kind, cube);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, filter);
+        const GLenum wrap = kind == SATMap ? GL_CLAMP_TO_BORDER : GL_CLAMP_TO_EDGE;
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(target, GL_TEXTURE_WRAP_R, wrap);
+        if (kind == SATMap)
+        {
+            const float borderColor[] = {0.0f, 0.0f, 0.0f, 0.0f};
+            glTexParameterfv(target, GL_TEXTURE_BORDER_COLOR, borderColor);
+        }
+    }
+    glBindTexture(target, 0);
+}
+
+bool LightBuffer::needView(const ShadowArray &array, GLint layer, const void *texture, GLuint id)
+{
+    auto it = m_views.find(texture);
+    if (it == m_views.end())
+        return true;
+    it->second.frame = m_frame;
+    return id == 0 || it->second.id != id || it->second.generation != array.generation || it->second.layer != layer;
+}
+
+void LightBuffer::recordView(const ShadowArray &array, GLint layer, const void *texture, GLuint id)
+{
+    m_views[texture] = ViewRecord{array.generation, layer, id, m_frame};
+    ++m_stats.viewsCreated;
+}
+
+void LightBuffer::allocateShadowMaps(Lights &lights)
+{
+    auto &[pointLights, dirLights] = lights;
+    ++m_frame;
+
+    // 按请求的分辨率分组, 没有光源请求的分辨率的数组被释放
+    std::vector<GLsizei> resolutions;
+    for (const auto &light : pointLights)
+        resolutions.push_back(light.texResolution);
+    ReleaseUnused(m_pointArrays, resolutions);
+    resolutions.clear();
+    for (const auto &light : dirLights)
+        resolutions.push_back(light.texResolution);
+    ReleaseUnused(m_dirArrays, resolutions);
+
+    m_stats.resolutionOverrides = 0;
+    m_stats.shadowlessLights = 0;
+    m_pointSlots.clear();
+    for (const auto &light : pointLights)
+        m_pointSlots.push_back(AcquireSlot(m_pointArrays, light.texResolution, light.useVSM, maxLayers(true)));
+    m_dirSlots.clear();
+    for (const auto &light : dirLights)
+        m_dirSlots.push_back(AcquireSlot(m_dirArrays, light.texResolution, light.useVSM, maxLayers(false)));
+
+    for (auto &array : m_pointArrays)
+        reserve(array, true);
+    for (auto &array : m_dirArrays)
+        reserve(array, false);
+
+    for (size_t i = 0; i < pointLights.size(); ++i)
+    {
+        PointLight &light = pointLights[i];
+        const auto [arrayIndex, layer] = m_pointSlots[i];
+        if (arrayIndex < 0)
+        {
+            ++m_stats.shadowlessLights;
+            continue;
+        }
+        const ShadowArray &array = m_pointArrays[arrayIndex];
+        light.shadowResolution = array.resolution;
+        m_stats.resolutionOverrides += array.resolution != light.texResolution;
+
+        TextureCube *depth = light.depthCubemap.get();
+        if (needView(array, layer, depth, depth->ID))
+        {
+            depth->setWrapMode(GL_CLAMP_TO_EDGE);
+            depth->generateView(array.maps[DepthMap], MapFormats[DepthMap].internalFormat, array.resolution, layer, GL_NEAREST, GL_NEAREST);
+            recordView(array, layer, depth, depth->ID);
+        }
+        TextureCube *vsm = light.VSMCubemap.get();
+        if (light.useVSM && needView(array, layer, vsm, vsm->ID))
+        {
+            vsm->setWrapMode(GL_CLAMP_TO_EDGE);
+            vsm->generateView(array.maps[VSMMap], MapFormats[VSMMap].internalFormat, array.resolution, layer, GL_NEAREST, GL_NEAREST);
+            recordView(array, layer, vsm, vsm->ID);
+        }
+    }
+
+    for (size_t i = 0; i < dirLights.size(); ++i)
+    {
+        DirShadowUnit &shadowUnit = dirLights[i].shadowUnit;
+        const auto [arrayIndex, layer] = m_dirSlots[i];
+        if (arrayIndex < 0)
+        {
+            ++m_stats.shadowlessLights;
+            continue;
+        }
+        const ShadowArray &array = m_dirArrays[arrayIndex];
+        shadowUnit.resolution = array.resolution;
+        m_stats.resolutionOverrides += array.resolution != dirLights[i].texResolution;
+
+        std::shared_ptr<Texture2D> *textures[MapKindCount] = {&shadowUnit.depthTexture, &shadowUnit.VSMTexture, &shadowUnit.SATTexture};
+        for (int kind = 0; kind < MapKindCount; ++kind)
+        {
+            if (kind != DepthMap && !dirLights[i].useVSM)
+                continue;
+            auto &texture = *textures[kind];
+            if (texture == nullptr)
+                texture = std::make_shared<Texture2D>();
+            if (!needView(array, layer, texture.get(), texture->ID))
+                continue;
+            texture->setFilterMax(MapFormats[kind].filter);
+            texture->setFilterMin(MapFormats[kind].filter);
+            texture->setWrapMode(kind == SATMap ? GL_CLAMP_TO_BORDER : GL_CLAMP_TO_EDGE);
+            texture->generateView(array.maps[kind], MapFormats[kind].internalFormat, array.resolution, array.resolution, layer);
+            if (kind == SATMap)
+            {
+                const float borderColor[] = {0.0f, 0.0f, 0.0f, 0.0f};
+                glBindTexture(GL_TEXTURE_2D, texture->ID);
+                glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+                glBindTexture(GL_TEXTURE_2D, 0);
+            }
+            recordView(array, layer, texture.get(), texture->ID);
+        }
+    }
+
+    // 本帧没有用到的记录属于已移除的光源, 其纹理对象的地址可能被复用
+    std::erase_if(m_views, [this](const auto &entry)
+                  { return entry.second.frame != m_frame; });
+    updateStats();
+}
+
+template <typename T>
+size_t LightBuffer::Upload(Table &table, const std::vector<T> &data, std::vector<T> &uploaded)
+{
+    const size_t bytes = data.size() * sizeof(T);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, table.buffer);
+    size_t first = 0;
+    size_t last = data.size();
+    if (bytes > table.capacity || table.capacity == 0)
+    {
+        table.capacity = std::max({bytes, table.capacity * 2, MinTableBytes});
+        glBufferData(GL_SHADER_STORAGE_BUFFER, table.capacity, nullptr, GL_DYNAMIC_DRAW);
+    }
+    else
+    {
+        // 只上传首尾两个变化的光源之间的区间
+        const size_t common = std::min(data.size(), uploaded.size());
+        while (first < common && std::memcmp(&data[first], &uploaded[first], sizeof(T)) == 0)
+            ++first;
+        if (data.size() == uploaded.size())
+        {
+            while (last > first && std::memcmp(&data[last - 1], &uploaded[last - 1], sizeof(T)) == 0)
+                --last;
+        }
+    }
+    if (last > first)
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, first * sizeof(T), (last - first) * sizeof(T), data.data() + first);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    uploaded = data;
+    return (last - first) * sizeof(T);
+}
+
+void LightBuffer::bind(Lights &lights, Shader &shaders)
+{
+    auto &[pointLights, dirLights] = lights;
+
+    m_pointData.resize(pointLights.size());
+    for (size_t i = 0; i < pointLights.size(); ++i)
+    {
+        PointLight &light = pointLights[i];
+        const ShadowSlot slot = i < m_pointSlots.size() ? m_pointSlots[i] : ShadowSlot{};
+        m_pointData[i] = PointLightData{
+            light.getPosition(), light.getFarPlane(),
+            light.combineIntensity(), light.useVSM,
+            slot.array, slot.layer, {0, 0}};
+    }
+    m_dirData.resize(dirLights.size());
+    for (size_t i = 0; i < dirLights.size(); ++i)
+    {
+        DirectionLight &light = dirLights[i];
+        const ShadowSlot slot = i < m_dirSlots.size() ? m_dirSlots[i] : ShadowSlot{};
+        m_dirData[i] = DirLightData{
+            light.shadowUnit.frustum.getProjViewMatrix(),
+            light.shadowUnit.frustum.getPosition(), light.shadowUnit.frustum.getFarPlane(),
+            light.combineIntensity(), light.orthoScale,
+            light.useVSM, slot.array, slot.layer, 0};
+    }
+
+    m_stats.uploadBytes = Upload(m_pointTable, m_pointData, m_pointUploaded) + Upload(m_dirTable, m_dirData, m_dirUploaded);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PointLightBinding, m_pointTable.buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DirLightBinding, m_dirTable.buffer);
+
+    shaders.setUniform("numPointLights"_uniform, static_cast<int>(pointLights.size()));
+    shaders.setUniform("numDirLights"_uniform, static_cast<int>(dirLights.size()));
+
+    // 未分配的数组也绑定到各自的纹理单元, 不同类型的 sampler 不能共用单元
+    for (size_t i = 0; i < MaxShadowArrays; ++i)
+    {
+        const ShadowArray *point = i < m_pointArrays.size() ? &m_pointArrays[i] : nullptr;
+        const ShadowArray *dir = i < m_dirArrays.size() ? &m_dirArrays[i] : nullptr;
+        shaders.setTextureAuto(point ? point->maps[DepthMap] : 0, GL_TEXTURE_CUBE_MAP_ARRAY, 0, "pointShadowMaps[]"_uniform[i]);
+        shaders.setTextureAuto(point ? point->maps[VSMMap] : 0, GL_TEXTURE_CUBE_MAP_ARRAY, 0, "pointVSMMaps[]"_uniform[i]);
+        shaders.setTextureAuto(dir ? dir->maps[DepthMap] : 0, GL_TEXTURE_2D_ARRAY, 0, "dirShadowMaps[]"_uniform[i]);
+        shaders.setTextureAuto(dir ? dir->maps[VSMMap] : 0, GL_TEXTURE_2D_ARRAY, 0, "dirVSMMaps[]"_uniform[i]);
+        shaders.setTextureAuto(dir ? dir->maps[SATMap] : 0, GL_TEXTURE_2D_ARRAY, 0, "dirSATMaps[]"_uniform[i]);
+    }
+    updateStats();
+}
+
+void LightBuffer::updateStats()
+{
+    m_stats.pointLights = m_pointData.size();
+    m_stats.dirLights = m_dirData.size();
+    m_stats.bufferBytes = m_pointTable.capacity + m_dirTable.capacity;
+    m_stats.shadowArrays = m_pointArrays.size() + m_dirArrays.size();
+    m_stats.shadowLayers = 0;
+    m_stats.shadowBytes = 0;
+    for (int cube = 0; cube < 2; ++cube)
+    {
+        for (const auto &array : cube ? m_pointArrays : m_dirArrays)
+        {
+            m_stats.shadowLayers += array.capacity;
+            const size_t layerTexels = size_t(array.resolution) * array.resolution * (cube ? 6 : 1) * array.capacity;
+            for (int kind = 0; kind < MapKindCount; ++kind)
+            {
+                if (array.maps[kind] != 0)
+                    m_stats.shadowBytes += layerTexels * MapFormats[kind].texelBytes;
+            }
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Shader;
+struct Lights;
+
+/*
+光源表: 点光源与平行光的参数存放在两个std430 SSBO中, 光源数目只受显存限制
+    每帧打包后与上次上传的内容比较, 只上传有变化的光源区间, 光源不变时没有上传
+阴影贴图按分辨率分组存放在纹理数组中(点光源为立方体贴图数组), 光源表记录每个光源所在的数组与层
+    光源自身的阴影纹理被替换为该层的纹理视图, 阴影pass照常渲染到光源的纹理, 不需要复制
+    着色器用光源表中的数组下标索引 sampler 数组, 光源循环内该下标对所有片元一致
+*/
+class LightBuffer
+{
+public:
+    // 与 Shaders/lightSource.glsl 一致
+    static constexpr GLuint PointLightBinding = 7;
+    static constexpr GLuint DirLightBinding = 8;
+    // 每类光源的阴影贴图数组(分辨率组)数, 超出时使用分辨率最接近的组
+    // 每个数组的层数受 GL_MAX_ARRAY_TEXTURE_LAYERS 限制(点光源每个占6层), 所有数组都满时其余光源没有阴影
+    static constexpr int MaxShadowArrays = 2;
+
+    struct Stats
+    {
+        size_t pointLights = 0;
+        size_t dirLights = 0;
+        size_t uploadBytes = 0; // 本帧上传的光源数据
+        size_t bufferBytes = 0; // 两个SSBO已分配的容量
+        size_t shadowArrays = 0;
+        size_t shadowLayers = 0; // 所有阴影贴图数组的层容量(光源数)
+        size_t shadowBytes = 0;
+        size_t viewsCreated = 0; // 累计
+        size_t resolutionOverrides = 0; // 没有对应分辨率的数组, 使用其他分辨率的光源数
+        size_t shadowlessLights = 0;    // 阴影贴图数组层数已达上限而没有阴影的光源数
+        GLint maxArrayLayers = 0;
+    };
+
+    LightBuffer();
+    ~LightBuffer();
+    LightBuffer(const LightBuffer &) = delete;
+    LightBuffer &operator=(const LightBuffer &) = delete;
+
+    /// @brief 为每个光源在阴影贴图数组中分配一层, 并把光源的阴影纹理换成该层的视图
+    ///        每帧在阴影pass之前调用, 光源的 useVSM 需已确定
+    ///        请求的分辨率(texResolution)不变, 实际分辨率写入 PointLight::shadowResolution 与 DirShadowUnit::resolution
+    void allocateShadowMaps(Lights &lights);
+
+    /// @brief 上一次 allocateShadowMaps 是否为第 i 个光源分配了阴影贴图
+    bool hasPointShadow(size_t i) const { return i < m_pointSlots.size() && m_pointSlots[i].array >= 0; }
+    bool hasDirShadow(size_t i) const { return i < m_dirSlots.size() && m_dirSlots[i].array >= 0; }
+
+    /// @brief 上传有变化的光源参数, 绑定光源SSBO与阴影贴图数组. 需在 use() 之后调用
+    void bind(Lights &lights, Shader &shaders);
+
+    const Stats &getStats() const { return m_stats; }
+
+private:
+    // 与 lightSource.glsl 中的 PointLight 布局一致
+    struct PointLightData
+    {
+        glm::vec3 pos;
+        float farPlane;
+        glm::vec3 intensity;
+        GLint useVSM;
+        GLint shadowArray;
+        GLint shadowLayer;
+        GLint pad[2];
+    };
+    static_assert(sizeof(PointLightData) == 48, "PointLightData must match std430 layout");
+
+    // 与 lightSource.glsl 中的 DirLight 布局一致
+    struct DirLightData
+    {
+        glm::mat4 spaceMatrix;
+        glm::vec3 pos;
+        float farPlane;
+        glm::vec3 intensity;
+        float orthoScale;
+        GLint useVSM;
+        GLint shadowArray;
+        GLint shadowLayer;
+        GLint pad;
+    };
+    static_assert(sizeof(DirLightData) == 112, "DirLightData must match std430 layout");
+
+    enum MapKind
+    {
+        DepthMap,
+        VSMMap,
+        SATMap, // 只有平行光使用
+        MapKindCount
+    };
+
+    struct ShadowArray
+    {
+        GLsizei resolution = 0;
+        GLsizei capacity = 0; // 层数, 点光源的一层为一个立方体
+        GLsizei used = 0;     // 本帧分配出去的层数
+        bool needVSM = false;
+        uint64_t generation = 0; // 每次重新分配纹理时更新, 之前建立的视图全部失效
+        GLuint maps[MapKindCount] = {}; // 0 表示未分配
+    };
+
+    // 光源纹理对象当前的视图. GL会复用删除的名字, 因此以数组的代数而不是纹理名判断视图是否过期
+    struct ViewRecord
+    {
+        uint64_t generation = 0;
+        GLint layer = -1;
+        GLuint id = 0;
+        uint64_t frame = 0;
+    };
+
+    // array < 0 表示没有阴影贴图
+    struct ShadowSlot
+    {
+        GLint array = -1;
+        GLint layer = -1;
+    };
+
+    struct Table
+    {
+        GLuint buffer = 0;
+        size_t capacity = 0; // 以字节计
+    };
+
+    Table m_pointTable;
+    Table m_dirTable;
+    std::vector<PointLightData> m_pointData;
+    std::vector<PointLightData> m_pointUploaded;
+    std::vector<DirLightData> m_dirData;
+    std::vector<DirLightData> m_dirUploaded;
+
+    std::vector<ShadowArray> m_pointArrays;
+    std::vector<ShadowArray> m_dirArrays;
+    std::vector<ShadowSlot> m_pointSlots;
+    std::vector<ShadowSlot> m_dirSlots;
+
+    std::unordered_map<const void *, ViewRecord> m_views;
+    uint64_t m_generation = 0;
+    uint64_t m_frame = 0;
+    GLint m_maxArrayLayers = 0;
+
+    Stats m_stats;
+
+    template <typename T>
+    static size_t Upload(Table &table, const std::vector<T> &data, std::vector<T> &uploaded);
+
+    static ShadowSlot AcquireSlot(std::vector<ShadowArray> &arrays, GLsizei resolution, bool useVSM, GLsizei maxLayers);
+    GLsizei maxLayers(bool cube) const { return cube ? m_maxArrayLayers / 6 : m_maxArrayLayers; }
+    static void ReleaseUnused(std::vector<ShadowArray> &arrays, const std::vector<GLsizei> &resolutions);
+    static void ReleaseMaps(ShadowArray &array);
+    void reserve(ShadowArray &array, bool cube);
+    // 纹理对象还不是 array 第 layer 层的视图时返回 true
+    bool needView(const ShadowArray &array, GLint layer, const void *texture, GLuint id);
+    void recordView(const ShadowArray &array, GLint layer, const void *texture, GLuint id);
+    void updateStats();
+};
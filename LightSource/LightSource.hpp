@@ -55,18 +55,13 @@ protected:
     glm::vec3 combIntensity;
     glm::vec3 position;
 
-public:
-    static const int MAX_POINT_LIGHTS = 10;
-    static const int MAX_DIR_LIGHTS = 5;
-
-    static void InitialzeShaderLightArray(Shader &shaders);
-
 public:
     ColorIntensity colorIntensity;
 
 public:
     LightSource(const glm::vec3 &_intensity, const glm::vec3 &_position);
-    virtual void setToShaderLightArray(Shader &shaders, size_t index) = 0;
+    /// @brief  colorIntensity ²غϳɵĹǿ
+    const glm::vec3 &combineIntensity();
     virtual void setPosition(glm::vec3 &_position) = 0;
     virtual glm::vec3 getPosition() const = 0;
     virtual void update() = 0;
@@ -77,7 +72,8 @@ class PointLight : public LightSource
 {
 
 public:
-    int texResolution;
+    int texResolution;    // Ӱֱ
+    int shadowResolution; // ʵʹõӰֱ,  LightBuffer Ӱͼ
     std::shared_ptr<CubemapParameters> cubemapParam;
     std::shared_ptr<TextureCube> depthCubemap;
     std::shared_ptr<TextureCube> VSMCubemap;
@@ -85,7 +81,6 @@ public:
 
 public:
     PointLight(const glm::vec3 &_intensity, const glm::vec3 &_position, int _texResolution, float _farPlane);
-    void setToShaderLightArray(Shader &shaders, size_t index) override;
     void setPosition(glm::vec3 &_position) override;
     glm::vec3 getPosition() const override;
     void update() override;
@@ -102,7 +97,7 @@ private:
     glm::mat4 lightView;
 
 public:
-    int texResolution;
+    int texResolution; // Ӱֱ, ʵʹõķֱΪ shadowUnit.resolution
     std::shared_ptr<Texture2D> depthTexture;
     std::shared_ptr<Texture2D> VSMTexture;
     std::shared_ptr<Texture2D> SATTexture;
@@ -119,7 +114,8 @@ public:
     DirectionLight(const glm::vec3 &_intensity = glm::vec3(0.1f), const glm::vec3 &_position = glm::vec3(50.f, 20.f, 60.f), int _texResolution = 2048);
 
     void setSunlightToShader(Shader &shaders);
-    void setToShaderLightArray(Shader &shaders, size_t index) override;
+    /// @brief ûзԴʱ, ĬϲΪ̫д uniform,  light.fs Ļһ
+    static void SetDefaultSunlightToShader(Shader &shaders);
     void setPosition(glm::vec3 &_position) override;
     glm::vec3 getPosition() const override;
     void update() override;
@@ -202,22 +202,22 @@ public:
         shaders.setInt("CSM.useVSSM", 0); // placeholder
         for (int i = 0; i < shadowUnits.size(); ++i)
         {
-            shaders.setMat4(std::format("CSM.units[{}].spaceMatrix", i), shadowUnits[i].frustum.getProjViewMatrix());
-            shaders.setTextureAuto(shadowUnits[i].depthTexture->ID, GL_TEXTURE_2D, 0, std::format("CSM.units[{}].depthMap", i));
+            shaders.setMat4("CSM.units[].spaceMatrix"_uniform[i], shadowUnits[i].frustum.getProjViewMatrix());
+            shaders.setTextureAuto(shadowUnits[i].depthTexture->ID, GL_TEXTURE_2D, 0, "CSM.units[].depthMap"_uniform[i]);
             if (useVSM)
             {
-                shaders.setTextureAuto(shadowUnits[i].VSMTexture->ID, GL_TEXTURE_2D, 0, std::format("CSM.units[{}].VSMTexture", i));
-                shaders.setTextureAuto(shadowUnits[i].SATTexture->ID, GL_TEXTURE_2D, 0, std::format("CSM.units[{}].SATTexture", i));
+                shaders.setTextureAuto(shadowUnits[i].VSMTexture->ID, GL_TEXTURE_2D, 0, "CSM.units[].VSMTexture"_uniform[i]);
+                shaders.setTextureAuto(shadowUnits[i].SATTexture->ID, GL_TEXTURE_2D, 0, "CSM.units[].SATTexture"_uniform[i]);
             }
             else
             {
-                shaders.setTextureAuto(0, GL_TEXTURE_2D, 0, std::format("CSM.units[{}].VSMTexture", i));
-                shaders.setTextureAuto(0, GL_TEXTURE_2D, 0, std::format("CSM.units[{}].SATTexture", i));
+                shaders.setTextureAuto(0, GL_TEXTURE_2D, 0, "CSM.units[].VSMTexture"_uniform[i]);
+                shaders.setTextureAuto(0, GL_TEXTURE_2D, 0, "CSM.units[].SATTexture"_uniform[i]);
             }
-            shaders.setFloat(std::format("CSM.units[{}].nearPlane", i), shadowUnits[i].frustum.getNearPlane());
-            shaders.setFloat(std::format("CSM.units[{}].farPlane", i), shadowUnits[i].frustum.getFarPlane());
-            shaders.setFloat(std::format("CSM.units[{}].orthoScale", i), shadowUnits[i].frustum.getOrthoScaleArea());
-            shaders.setUniform(std::format("CSM.units[{}].pos", i), shadowUnits[i].frustum.getPosition());
+            shaders.setFloat("CSM.units[].nearPlane"_uniform[i], shadowUnits[i].frustum.getNearPlane());
+            shaders.setFloat("CSM.units[].farPlane"_uniform[i], shadowUnits[i].frustum.getFarPlane());
+            shaders.setFloat("CSM.units[].orthoScale"_uniform[i], shadowUnits[i].frustum.getOrthoScaleArea());
+            shaders.setUniform("CSM.units[].pos"_uniform[i], shadowUnits[i].frustum.getPosition());
         }
     }
 
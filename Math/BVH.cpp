@@ -0,0 +1,617 @@
+#include "BVH.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <random>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BVH_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define BVH_USE_SSE 0
+#endif
+
+namespace
+{
+    constexpr uint32_t BinCount = 16;
+    constexpr float TraversalCost = 1.0f;
+
+    using Clock = std::chrono::steady_clock;
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    float SurfaceArea(const AABB &box)
+    {
+        if (!box.isValid())
+            return 0.0f;
+        const glm::vec3 d = box.max - box.min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    // 射线与单个AABB求交, 返回进入距离. 未相交返回 false
+    bool RayBox(const AABB &box, const glm::vec3 &origin, const glm::vec3 &invDir, float maxT, float &tHit)
+    {
+        const glm::vec3 t1 = (box.min - origin) * invDir;
+        const glm::vec3 t2 = (box.max - origin) * invDir;
+        const glm::vec3 tMinV = glm::min(t1, t2);
+        const glm::vec3 tMaxV = glm::max(t1, t2);
+        const float tMin = glm::max(glm::max(tMinV.x, tMinV.y), glm::max(tMinV.z, 0.0f));
+        const float tMax = glm::min(glm::min(tMaxV.x, tMaxV.y), tMaxV.z);
+        if (tMin > tMax || tMin >= maxT)
+            return false;
+        tHit = tMin;
+        return true;
+    }
+
+    // 4个子包围盒与视锥测试, 返回相交槽位掩码
+    int FrustumMask(const BVH4::Node &node, const FrustumPlanes &frustum)
+    {
+#if BVH_USE_SSE
+        const __m128 minX = _mm_load_ps(node.minX), minY = _mm_load_ps(node.minY), minZ = _mm_load_ps(node.minZ);
+        const __m128 maxX = _mm_load_ps(node.maxX), maxY = _mm_load_ps(node.maxY), maxZ = _mm_load_ps(node.maxZ);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const auto &plane : frustum.planes)
+        {
+            // 取法线方向上最远的顶点(p-vertex), 它在平面外侧则整个盒子在外侧
+            const __m128 px = plane.x >= 0.0f ? maxX : minX;
+            const __m128 py = plane.y >= 0.0f ? maxY : minY;
+            const __m128 pz = plane.z >= 0.0f ? maxZ : minZ;
+            const __m128 dist = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), px), _mm_mul_ps(_mm_set1_ps(plane.y), py)),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), pz), _mm_set1_ps(plane.w)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, _mm_setzero_ps()));
+        }
+        return _mm_movemask_ps(inside);
+#else
+        int mask = 0;
+        for (int lane = 0; lane < BVH4::Width; ++lane)
+        {
+            bool inside = true;
+            for (const auto &plane : frustum.planes)
+            {
+                const float px = plane.x >= 0.0f ? node.maxX[lane] : node.minX[lane];
+                const float py = plane.y >= 0.0f ? node.maxY[lane] : node.minY[lane];
+                const float pz = plane.z >= 0.0f ? node.maxZ[lane] : node.minZ[lane];
+                inside = inside && (plane.x * px + plane.y * py + plane.z * pz + plane.w >= 0.0f);
+            }
+            mask |= inside ? (1 << lane) : 0;
+        }
+        return mask;
+#endif
+    }
+
+    int SphereMask(const BVH4::Node &node, const BoundingSphere &sphere)
+    {
+#if BVH_USE_SSE
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 cx = _mm_set1_ps(sphere.center.x), cy = _mm_set1_ps(sphere.center.y), cz = _mm_set1_ps(sphere.center.z);
+        // 球心到盒子的最近距离
+        const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.minX), cx), _mm_sub_ps(cx, _mm_load_ps(node.maxX))), zero);
+        const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.minY), cy), _mm_sub_ps(cy, _mm_load_ps(node.maxY))), zero);
+        const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(node.minZ), cz), _mm_sub_ps(cz, _mm_load_ps(node.maxZ))), zero);
+        const __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        return _mm_movemask_ps(_mm_cmple_ps(d2, _mm_set1_ps(sphere.radius * sphere.radius)));
+#else
+        int mask = 0;
+        for (int lane = 0; lane < BVH4::Width; ++lane)
+        {
+            const float dx = std::max({node.minX[lane] - sphere.center.x, sphere.center.x - node.maxX[lane], 0.0f});
+            const float dy = std::max({node.minY[lane] - sphere.center.y, sphere.center.y - node.maxY[lane], 0.0f});
+            const float dz = std::max({node.minZ[lane] - sphere.center.z, sphere.center.z - node.maxZ[lane], 0.0f});
+            mask |= (dx * dx + dy * dy + dz * dz <= sphere.radius * sphere.radius) ? (1 << lane) : 0;
+        }
+        return mask;
+#endif
+    }
+
+    int RayMask(const BVH4::Node &node, const glm::vec3 &origin, const glm::vec3 &invDir, float maxT, float tNear[BVH4::Width])
+    {
+#if BVH_USE_SSE
+        const __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+        const __m128 ix = _mm_set1_ps(invDir.x), iy = _mm_set1_ps(invDir.y), iz = _mm_set1_ps(invDir.z);
+        const __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), ox), ix);
+        const __m128 tx2 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), ox), ix);
+        const __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), oy), iy);
+        const __m128 ty2 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), oy), iy);
+        const __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), oz), iz);
+        const __m128 tz2 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), oz), iz);
+        __m128 tMin = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx1, tx2), _mm_min_ps(ty1, ty2)), _mm_max_ps(_mm_min_ps(tz1, tz2), _mm_setzero_ps()));
+        const __m128 tMax = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx1, tx2), _mm_max_ps(ty1, ty2)), _mm_max_ps(tz1, tz2));
+        const __m128 hit = _mm_and_ps(_mm_cmple_ps(tMin, tMax), _mm_cmplt_ps(tMin, _mm_set1_ps(maxT)));
+        _mm_storeu_ps(tNear, tMin);
+        return _mm_movemask_ps(hit);
+#else
+        int mask = 0;
+        for (int lane = 0; lane < BVH4::Width; ++lane)
+        {
+            AABB box;
+            box.min = glm::vec3(node.minX[lane], node.minY[lane], node.minZ[lane]);
+            box.max = glm::vec3(node.maxX[lane], node.maxY[lane], node.maxZ[lane]);
+            mask |= RayBox(box, origin, invDir, maxT, tNear[lane]) ? (1 << lane) : 0;
+        }
+        return mask;
+#endif
+    }
+}
+
+void BVH4::build(const std::vector<BoundingVolume> &bounds)
+{
+    const auto start = Clock::now();
+    m_nodes.clear();
+    m_primIndices.clear();
+    m_primLeaf.assign(bounds.size(), InvalidIndex);
+
+    std::vector<BuildPrimitive> primitives;
+    primitives.reserve(bounds.size());
+    for (uint32_t i = 0; i < bounds.size(); ++i)
+    {
+        if (bounds[i].isValid())
+            primitives.push_back({bounds[i].box, bounds[i].box.center(), i});
+    }
+
+    if (!primitives.empty())
+    {
+        std::vector<BuildNode> buildNodes;
+        buildNodes.reserve(2 * primitives.size());
+        const uint32_t root = buildBinary(buildNodes, primitives, 0, static_cast<uint32_t>(primitives.size()));
+        m_primIndices.resize(primitives.size());
+        for (size_t i = 0; i < primitives.size(); ++i)
+            m_primIndices[i] = primitives[i].index;
+        m_nodes.reserve(buildNodes.size() / 2 + 1);
+        collapse(buildNodes, root, InvalidIndex, 0);
+    }
+    m_dirty.assign(m_nodes.size(), 0);
+    m_lastBuildMs = ElapsedMs(start);
+}
+
+uint32_t BVH4::buildBinary(std::vector<BuildNode> &buildNodes, std::vector<BuildPrimitive> &primitives, uint32_t begin, uint32_t end)
+{
+    BuildNode node;
+    AABB centroidBox;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        node.box.expand(primitives[i].box);
+        centroidBox.expand(primitives[i].centroid);
+    }
+    node.begin = begin;
+    node.count = end - begin;
+    const uint32_t index = static_cast<uint32_t>(buildNodes.size());
+    buildNodes.push_back(node);
+    if (node.count <= 1)
+        return index;
+
+    const glm::vec3 extent = centroidBox.max - centroidBox.min;
+    int axis = 0;
+    if (extent.y > extent[axis])
+        axis = 1;
+    if (extent.z > extent[axis])
+        axis = 2;
+
+    uint32_t mid = begin;
+    if (extent[axis] <= 1e-6f)
+    {
+        // 质心重合, SAH 无法区分
+        if (node.count <= MaxLeafSize)
+            return index;
+        mid = begin + node.count / 2;
+    }
+    else
+    {
+        // 分桶SAH
+        struct Bin
+        {
+            AABB box;
+            uint32_t count = 0;
+        };
+        Bin bins[BinCount];
+        const float scale = BinCount / extent[axis];
+        const auto binOf = [&](const BuildPrimitive &primitive)
+        {
+            const int b = static_cast<int>((primitive.centroid[axis] - centroidBox.min[axis]) * scale);
+            return static_cast<uint32_t>(std::clamp(b, 0, static_cast<int>(BinCount) - 1));
+        };
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            Bin &bin = bins[binOf(primitives[i])];
+            bin.box.expand(primitives[i].box);
+            bin.count++;
+        }
+
+        float rightCost[BinCount];
+        AABB rightBox;
+        uint32_t rightCount = 0;
+        for (uint32_t b = BinCount - 1; b > 0; --b)
+        {
+            rightBox.expand(bins[b].box);
+            rightCount += bins[b].count;
+            rightCost[b] = SurfaceArea(rightBox) * rightCount;
+        }
+        AABB leftBox;
+        uint32_t leftCount = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        uint32_t bestSplit = 0;
+        for (uint32_t b = 0; b < BinCount - 1; ++b)
+        {
+            leftBox.expand(bins[b].box);
+            leftCount += bins[b].count;
+            const float cost = SurfaceArea(leftBox) * leftCount + rightCost[b + 1];
+            if (leftCount > 0 && leftCount < node.count && cost < bestCost)
+            {
+                bestCost = cost;
+                bestSplit = b;
+            }
+        }
+        const float parentArea = glm::max(SurfaceArea(node.box), 1e-12f);
+        bestCost = TraversalCost + bestCost / parentArea;
+        if (node.count <= MaxLeafSize && static_cast<float>(node.count) <= bestCost)
+            return index;
+
+        auto it = std::partition(primitives.begin() + begin, primitives.begin() + end,
+                                 [&](const BuildPrimitive &primitive)
+                                 { return binOf(primitive) <= bestSplit; });
+        mid = static_cast<uint32_t>(it - primitives.begin());
+        if (mid == begin || mid == end)
+        {
+            mid = begin + node.count / 2;
+            std::nth_element(primitives.begin() + begin, primitives.begin() + mid, primitives.begin() + end,
+                             [&](const BuildPrimitive &a, const BuildPrimitive &b)
+                             { return a.centroid[axis] < b.centroid[axis]; });
+        }
+    }
+
+    const uint32_t left = buildBinary(buildNodes, primitives, begin, mid);
+    const uint32_t right = buildBinary(buildNodes, primitives, mid, end);
+    buildNodes[index].left = left;
+    buildNodes[index].right = right;
+    return index;
+}
+
+uint32_t BVH4::collapse(const std::vector<BuildNode> &buildNodes, uint32_t buildIndex, uint32_t parent, uint32_t parentLane)
+{
+    // 反复展开表面积最大的内部子节点, 直到凑满4个子节点
+    uint32_t children[Width];
+    int childCount = 0;
+    const BuildNode &source = buildNodes[buildIndex];
+    if (source.isLeaf())
+    {
+        children[childCount++] = buildIndex;
+    }
+    else
+    {
+        children[childCount++] = source.left;
+        children[childCount++] = source.right;
+    }
+    while (childCount < Width)
+    {
+        int best = -1;
+        float bestArea = -1.0f;
+        for (int i = 0; i < childCount; ++i)
+        {
+            const BuildNode &child = buildNodes[children[i]];
+            if (!child.isLeaf() && SurfaceArea(child.box) > bestArea)
+            {
+                bestArea = SurfaceArea(child.box);
+                best = i;
+            }
+        }
+        if (best < 0)
+            break;
+        const BuildNode &expanded = buildNodes[children[best]];
+        children[best] = expanded.left;
+        children[childCount++] = expanded.right;
+    }
+
+    const uint32_t nodeIndex = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+    {
+        Node &node = m_nodes[nodeIndex];
+        for (int lane = 0; lane < Width; ++lane)
+        {
+            setLane(node, lane, AABB());
+            node.child[lane] = InvalidIndex;
+            node.count[lane] = 0;
+        }
+        node.parent = parent;
+        node.parentLane = parentLane;
+        node.laneMask = 0;
+    }
+
+    for (int lane = 0; lane < childCount; ++lane)
+    {
+        const BuildNode &child = buildNodes[children[lane]];
+        uint32_t childIndex;
+        uint32_t count = 0;
+        if (child.isLeaf())
+        {
+            childIndex = child.begin;
+            count = child.count;
+            for (uint32_t i = child.begin; i < child.begin + child.count; ++i)
+                m_primLeaf[m_primIndices[i]] = nodeIndex * Width + lane;
+        }
+        else
+        {
+            childIndex = collapse(buildNodes, children[lane], nodeIndex, lane);
+        }
+        // collapse 可能使 m_nodes 扩容, 重新取引用
+        Node &node = m_nodes[nodeIndex];
+        setLane(node, lane, child.box);
+        node.child[lane] = childIndex;
+        node.count[lane] = count;
+        node.laneMask |= 1u << lane;
+    }
+    return nodeIndex;
+}
+
+void BVH4::setLane(Node &node, int lane, const AABB &box)
+{
+    node.minX[lane] = box.min.x;
+    node.minY[lane] = box.min.y;
+    node.minZ[lane] = box.min.z;
+    node.maxX[lane] = box.max.x;
+    node.maxY[lane] = box.max.y;
+    node.maxZ[lane] = box.max.z;
+}
+
+AABB BVH4::laneBox(const Node &node, int lane) const
+{
+    AABB box;
+    box.min = glm::vec3(node.minX[lane], node.minY[lane], node.minZ[lane]);
+    box.max = glm::vec3(node.maxX[lane], node.maxY[lane], node.maxZ[lane]);
+    return box;
+}
+
+void BVH4::refitLeafLane(uint32_t nodeIndex, int lane, const std::vector<BoundingVolume> &bounds)
+{
+    Node &node = m_nodes[nodeIndex];
+    AABB box;
+    for (uint32_t i = node.child[lane]; i < node.child[lane] + node.count[lane]; ++i)
+        box.expand(bounds[m_primIndices[i]].box);
+    setLane(node, lane, box);
+    m_dirty[nodeIndex] = 1;
+}
+
+void BVH4::propagateDirty()
+{
+    for (size_t n = m_nodes.size(); n-- > 0;)
+    {
+        if (!m_dirty[n])
+            continue;
+        m_dirty[n] = 0;
+        const Node &node = m_nodes[n];
+        if (node.parent == InvalidIndex)
+            continue;
+        AABB box;
+        for (int lane = 0; lane < Width; ++lane)
+        {
+            if (node.laneMask & (1u << lane))
+                box.expand(laneBox(node, lane));
+        }
+        setLane(m_nodes[node.parent], node.parentLane, box);
+        m_dirty[node.parent] = 1;
+    }
+}
+
+bool BVH4::refit(const std::vector<BoundingVolume> &bounds, const std::vector<uint32_t> &changed)
+{
+    const auto start = Clock::now();
+    bool topologyValid = bounds.size() == m_primLeaf.size();
+    for (uint32_t prim : changed)
+    {
+        if (prim >= m_primLeaf.size())
+        {
+            topologyValid = false;
+            continue;
+        }
+        const uint32_t location = m_primLeaf[prim];
+        if ((location != InvalidIndex) != bounds[prim].isValid())
+        {
+            topologyValid = false;
+            continue;
+        }
+        if (location != InvalidIndex)
+            refitLeafLane(location / Width, static_cast<int>(location % Width), bounds);
+    }
+    propagateDirty();
+    m_lastRefitMs = ElapsedMs(start);
+    return topologyValid;
+}
+
+void BVH4::refitAll(const std::vector<BoundingVolume> &bounds)
+{
+    const auto start = Clock::now();
+    for (uint32_t n = 0; n < m_nodes.size(); ++n)
+    {
+        const Node &node = m_nodes[n];
+        for (int lane = 0; lane < Width; ++lane)
+        {
+            if (node.count[lane] > 0)
+                refitLeafLane(n, lane, bounds);
+        }
+    }
+    propagateDirty();
+    m_lastRefitMs = ElapsedMs(start);
+}
+
+void BVH4::queryFrustum(const FrustumPlanes &frustum, const std::vector<BoundingVolume> &bounds, std::vector<uint32_t> &out) const
+{
+    if (m_nodes.empty())
+        return;
+    std::vector<uint32_t> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const Node &node = m_nodes[stack.back()];
+        stack.pop_back();
+        uint32_t mask = static_cast<uint32_t>(FrustumMask(node, frustum)) & node.laneMask;
+        while (mask)
+        {
+            const int lane = std::countr_zero(mask);
+            mask &= mask - 1;
+            const uint32_t count = node.count[lane];
+            if (count == 0)
+            {
+                stack.push_back(node.child[lane]);
+                continue;
+            }
+            // 单图元叶子的槽位包围盒即图元包围盒, 无需再测
+            for (uint32_t i = node.child[lane]; i < node.child[lane] + count; ++i)
+            {
+                const uint32_t prim = m_primIndices[i];
+                if (count == 1 || frustum.intersects(bounds[prim].box))
+                    out.push_back(prim);
+            }
+        }
+    }
+}
+
+void BVH4::querySphere(const BoundingSphere &sphere, const std::vector<BoundingVolume> &bounds, std::vector<uint32_t> &out) const
+{
+    if (m_nodes.empty())
+        return;
+    std::vector<uint32_t> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    while (!stack.empty())
+    {
+        const Node &node = m_nodes[stack.back()];
+        stack.pop_back();
+        uint32_t mask = static_cast<uint32_t>(SphereMask(node, sphere)) & node.laneMask;
+        while (mask)
+        {
+            const int lane = std::countr_zero(mask);
+            mask &= mask - 1;
+            const uint32_t count = node.count[lane];
+            if (count == 0)
+            {
+                stack.push_back(node.child[lane]);
+                continue;
+            }
+            for (uint32_t i = node.child[lane]; i < node.child[lane] + count; ++i)
+            {
+                const uint32_t prim = m_primIndices[i];
+                if (sphere.intersects(bounds[prim].sphere))
+                    out.push_back(prim);
+            }
+        }
+    }
+}
+
+BVH4::RayHit BVH4::raycast(const glm::vec3 &origin, const glm::vec3 &direction, const std::vector<BoundingVolume> &bounds) const
+{
+    RayHit hit;
+    if (m_nodes.empty())
+        return hit;
+    const glm::vec3 invDir = 1.0f / direction;
+
+    struct Entry
+    {
+        uint32_t node;
+        float t;
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({0, 0.0f});
+    while (!stack.empty())
+    {
+        const Entry entry = stack.back();
+        stack.pop_back();
+        if (entry.t >= hit.t)
+            continue;
+        const Node &node = m_nodes[entry.node];
+        float tNear[Width];
+        uint32_t mask = static_cast<uint32_t>(RayMask(node, origin, invDir, hit.t, tNear)) & node.laneMask;
+
+        // 内部子节点按距离由远到近入栈, 近的先出栈
+        Entry children[Width];
+        int childCount = 0;
+        while (mask)
+        {
+            const int lane = std::countr_zero(mask);
+            mask &= mask - 1;
+            const uint32_t count = node.count[lane];
+            if (count == 0)
+            {
+                children[childCount++] = {node.child[lane], tNear[lane]};
+                continue;
+            }
+            for (uint32_t i = node.child[lane]; i < node.child[lane] + count; ++i)
+            {
+                const uint32_t prim = m_primIndices[i];
+                float t;
+                if (RayBox(bounds[prim].box, origin, invDir, hit.t, t))
+                {
+                    hit.t = t;
+                    hit.primitive = prim;
+                }
+            }
+        }
+        std::sort(children, children + childCount, [](const Entry &a, const Entry &b)
+                  { return a.t > b.t; });
+        for (int i = 0; i < childCount; ++i)
+            stack.push_back(children[i]);
+    }
+    return hit;
+}
+
+BVH4::BenchmarkResult BVH4::Benchmark(size_t primitiveCount, uint32_t seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> size(0.5f, 5.0f);
+    std::uniform_real_distribution<float> jitter(-1.0f, 1.0f);
+
+    std::vector<BoundingVolume> bounds(primitiveCount);
+    for (auto &volume : bounds)
+    {
+        const glm::vec3 center(position(generator), position(generator), position(generator));
+        const glm::vec3 half(size(generator), size(generator), size(generator));
+        volume.box.min = center - half;
+        volume.box.max = center + half;
+        volume.sphere = BoundingSphere{center, glm::length(half)};
+    }
+
+    BenchmarkResult result;
+    result.primitiveCount = primitiveCount;
+
+    BVH4 bvh;
+    bvh.build(bounds);
+    result.buildMs = bvh.lastBuildMs();
+    result.nodeCount = bvh.nodeCount();
+
+    for (auto &volume : bounds)
+    {
+        const glm::vec3 offset(jitter(generator), jitter(generator), jitter(generator));
+        volume.box.min += offset;
+        volume.box.max += offset;
+        volume.sphere.center += offset;
+    }
+    bvh.refitAll(bounds);
+    result.refitMs = bvh.lastRefitMs();
+
+    constexpr int FrustumQueries = 16;
+    std::vector<uint32_t> visible;
+    visible.reserve(primitiveCount);
+    auto start = Clock::now();
+    for (int i = 0; i < FrustumQueries; ++i)
+    {
+        const float angle = glm::radians(360.0f * i / FrustumQueries);
+        const glm::vec3 front(glm::cos(angle), 0.0f, glm::sin(angle));
+        const Frustum frustum(glm::vec3(0.0f), front, glm::vec3(0.0f, 1.0f, 0.0f), 0.1f, 1000.0f, 60.0f, 16.0f / 9.0f);
+        visible.clear();
+        bvh.queryFrustum(frustum.getPlanes(), bounds, visible);
+    }
+    result.frustumQueryMs = ElapsedMs(start) / FrustumQueries;
+
+    constexpr int RayQueries = 1000;
+    start = Clock::now();
+    for (int i = 0; i < RayQueries; ++i)
+    {
+        const glm::vec3 direction = glm::normalize(glm::vec3(jitter(generator), jitter(generator), jitter(generator)) + glm::vec3(1e-4f));
+        bvh.raycast(glm::vec3(0.0f), direction, bounds);
+    }
+    result.rayQueryMs = ElapsedMs(start) / RayQueries;
+    return result;
+}
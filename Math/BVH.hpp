@@ -0,0 +1,110 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "Bounds.hpp"
+#include "Frustum.hpp"
+
+/*
+4路层次包围盒 BVH4
+构建: 分桶SAH构建二叉树, 再把二叉树相邻两层合并成4叉节点
+节点以SoA存放4个子包围盒, 遍历时一次测试4个子节点(SSE, 不支持时退化为标量)
+图元为调用方包围体数组的下标, 包围体无效的图元不进入树
+refit: 只更新包围盒不改变拓扑. 节点按先序存放, 父节点下标总小于子节点, 逆序一次扫描即可向上传播
+*/
+class BVH4
+{
+public:
+    static constexpr int Width = 4;
+    static constexpr uint32_t MaxLeafSize = 4;
+    static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    struct alignas(16) Node
+    {
+        float minX[Width], minY[Width], minZ[Width];
+        float maxX[Width], maxY[Width], maxZ[Width];
+        // 内部子节点: child=节点下标, count=0
+        // 叶子: child=m_primIndices 起始位置, count=图元数
+        uint32_t child[Width];
+        uint32_t count[Width];
+        uint32_t parent;
+        uint32_t parentLane;
+        uint32_t laneMask; // 有效子槽位掩码
+    };
+
+    struct RayHit
+    {
+        uint32_t primitive = InvalidIndex;
+        float t = std::numeric_limits<float>::max();
+        bool isValid() const { return primitive != InvalidIndex; }
+    };
+
+    struct BenchmarkResult
+    {
+        size_t primitiveCount = 0;
+        size_t nodeCount = 0;
+        double buildMs = 0.0;
+        double refitMs = 0.0;
+        double frustumQueryMs = 0.0; // 单次查询平均
+        double rayQueryMs = 0.0;     // 单次查询平均
+    };
+
+    /// @brief 以 bounds 中所有有效包围体重建
+    void build(const std::vector<BoundingVolume> &bounds);
+    /// @brief 只更新 changed 中图元所在叶子及其祖先
+    /// @return 有图元的有效性发生变化(需要重建)时返回 false
+    bool refit(const std::vector<BoundingVolume> &bounds, const std::vector<uint32_t> &changed);
+    /// @brief 全部叶子重新计算
+    void refitAll(const std::vector<BoundingVolume> &bounds);
+
+    /// @brief 与视锥相交的图元追加到 out
+    void queryFrustum(const FrustumPlanes &frustum, const std::vector<BoundingVolume> &bounds, std::vector<uint32_t> &out) const;
+    /// @brief 与球相交的图元追加到 out
+    void querySphere(const BoundingSphere &sphere, const std::vector<BoundingVolume> &bounds, std::vector<uint32_t> &out) const;
+    /// @brief 射线与图元包围盒的最近交点. direction 无需归一化, t 以 direction 长度为单位
+    RayHit raycast(const glm::vec3 &origin, const glm::vec3 &direction, const std::vector<BoundingVolume> &bounds) const;
+
+    bool contains(uint32_t primitive) const { return primitive < m_primLeaf.size() && m_primLeaf[primitive] != InvalidIndex; }
+    size_t nodeCount() const { return m_nodes.size(); }
+    size_t primitiveCount() const { return m_primIndices.size(); }
+    double lastBuildMs() const { return m_lastBuildMs; }
+    double lastRefitMs() const { return m_lastRefitMs; }
+
+    /// @brief 随机生成 primitiveCount 个包围盒, 测量构建/refit/查询耗时
+    static BenchmarkResult Benchmark(size_t primitiveCount, uint32_t seed = 1);
+
+private:
+    struct BuildNode
+    {
+        AABB box;
+        uint32_t left = InvalidIndex;
+        uint32_t right = InvalidIndex;
+        uint32_t begin = 0;
+        uint32_t count = 0;
+        bool isLeaf() const { return left == InvalidIndex; }
+    };
+    // 构建期图元, 连续存放以便分区时顺序访问
+    struct BuildPrimitive
+    {
+        AABB box;
+        glm::vec3 centroid;
+        uint32_t index;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_primIndices;
+    // 图元 -> (节点下标 * Width + 槽位), 不在树中为 InvalidIndex
+    std::vector<uint32_t> m_primLeaf;
+    std::vector<uint8_t> m_dirty;
+    double m_lastBuildMs = 0.0;
+    double m_lastRefitMs = 0.0;
+
+    uint32_t buildBinary(std::vector<BuildNode> &buildNodes, std::vector<BuildPrimitive> &primitives, uint32_t begin, uint32_t end);
+    uint32_t collapse(const std::vector<BuildNode> &buildNodes, uint32_t buildIndex, uint32_t parent, uint32_t parentLane);
+    void setLane(Node &node, int lane, const AABB &box);
+    AABB laneBox(const Node &node, int lane) const;
+    void refitLeafLane(uint32_t nodeIndex, int lane, const std::vector<BoundingVolume> &bounds);
+    void propagateDirty();
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/// @brief 轴对齐包围盒. 默认构造为空盒(min > max)
+struct AABB
+{
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extents() const { return (max - min) * 0.5f; }
+
+    void expand(const glm::vec3 &point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    void expand(const AABB &other)
+    {
+        if (!other.isValid())
+            return;
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    /// @brief 变换后的包围盒(Arvo). 只需中心与半长,不展开8个角点
+    AABB transform(const glm::mat4 &matrix) const
+    {
+        if (!isValid())
+            return *this;
+        const glm::vec3 c = glm::vec3(matrix * glm::vec4(center(), 1.0f));
+        const glm::vec3 e = extents();
+        glm::vec3 newExtents(0.0f);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            newExtents += glm::abs(glm::vec3(matrix[axis])) * e[axis];
+        }
+        AABB result;
+        result.min = c - newExtents;
+        result.max = c + newExtents;
+        return result;
+    }
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = -1.0f;
+
+    bool isValid() const { return radius >= 0.0f; }
+
+    /// @brief 变换后的包围球,半径按最大轴缩放放大
+    BoundingSphere transform(const glm::mat4 &matrix) const
+    {
+        if (!isValid())
+            return *this;
+        const float sx = glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0]));
+        const float sy = glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1]));
+        const float sz = glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]));
+        BoundingSphere result;
+        result.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+        result.radius = radius * glm::sqrt(glm::max(sx, glm::max(sy, sz)));
+        return result;
+    }
+
+    bool intersects(const BoundingSphere &other) const
+    {
+        const glm::vec3 d = center - other.center;
+        const float r = radius + other.radius;
+        return glm::dot(d, d) <= r * r;
+    }
+};
+
+/// @brief 对象的包围体: AABB + 包围球. 球心取AABB中心, 半径为到顶点的最大距离
+struct BoundingVolume
+{
+    AABB box;
+    BoundingSphere sphere;
+
+    bool isValid() const { return box.isValid(); }
+
+    /// @param positions 顶点数据首个position地址
+    /// @param count 顶点数
+    /// @param stride 相邻顶点position之间的字节数
+    static BoundingVolume FromPositions(const void *positions, size_t count, size_t stride)
+    {
+        BoundingVolume volume;
+        const auto *bytes = static_cast<const uint8_t *>(positions);
+        for (size_t i = 0; i < count; ++i)
+        {
+            volume.box.expand(*reinterpret_cast<const glm::vec3 *>(bytes + i * stride));
+        }
+        if (!volume.box.isValid())
+            return volume;
+        volume.sphere.center = volume.box.center();
+        float maxDistance2 = 0.0f;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const glm::vec3 d = *reinterpret_cast<const glm::vec3 *>(bytes + i * stride) - volume.sphere.center;
+            maxDistance2 = glm::max(maxDistance2, glm::dot(d, d));
+        }
+        volume.sphere.radius = glm::sqrt(maxDistance2);
+        return volume;
+    }
+
+    /// @brief 合并两个包围体. 包围球取合并后AABB的外接球
+    void merge(const BoundingVolume &other)
+    {
+        if (!other.isValid())
+            return;
+        if (!isValid())
+        {
+            *this = other;
+            return;
+        }
+        box.expand(other.box);
+        const glm::vec3 c = box.center();
+        const float ra = glm::length(sphere.center - c) + sphere.radius;
+        const float rb = glm::length(other.sphere.center - c) + other.sphere.radius;
+        sphere.center = c;
+        sphere.radius = glm::min(glm::max(ra, rb), glm::length(box.extents()));
+    }
+
+    BoundingVolume transform(const glm::mat4 &matrix) const
+    {
+        return BoundingVolume{box.transform(matrix), sphere.transform(matrix)};
+    }
+};
@@ -0,0 +1,466 @@
+#include "ClusterHierarchy.hpp"
+#include "Meshlet.hpp"
+#include "MeshSimplifier.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace
+{
+    using ClusterVertex = ClusterHierarchy::ClusterVertex;
+    constexpr uint32_t None = ClusterHierarchy::None;
+    constexpr size_t MaxLevels = 32;
+
+    struct WorkCluster
+    {
+        std::vector<uint32_t> indices; // 原网格顶点编号
+        glm::vec4 lodBounds = glm::vec4(0.0f);
+        float lodError = 0.0f; // 生成本簇的组的误差与包围球, 原始簇为0与自身包围球
+        uint32_t generatingGroup = None;
+        uint32_t parentGroup = None;
+        uint32_t page = None;
+    };
+
+    struct WorkGroup
+    {
+        ClusterHierarchy::GroupRecord record;
+        std::vector<uint32_t> members;
+        std::vector<uint32_t> outputs;
+    };
+
+    // 包含所有球的球: 球心取各球AABB的中心
+    glm::vec4 MergeSpheres(const std::vector<glm::vec4> &spheres)
+    {
+        glm::vec3 minCorner(std::numeric_limits<float>::max());
+        glm::vec3 maxCorner(-std::numeric_limits<float>::max());
+        for (const glm::vec4 &s : spheres)
+        {
+            minCorner = glm::min(minCorner, glm::vec3(s) - s.w);
+            maxCorner = glm::max(maxCorner, glm::vec3(s) + s.w);
+        }
+        const glm::vec3 center = 0.5f * (minCorner + maxCorner);
+        float radius = 0.0f;
+        for (const glm::vec4 &s : spheres)
+            radius = std::max(radius, glm::length(glm::vec3(s) - center) + s.w);
+        return glm::vec4(center, radius);
+    }
+
+    uint32_t SpreadBits(uint32_t v)
+    {
+        v &= 0x3FF;
+        v = (v | (v << 16)) & 0x030000FF;
+        v = (v | (v << 8)) & 0x0300F00F;
+        v = (v | (v << 4)) & 0x030C30C3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    // 位置相同的顶点(纹理/法线接缝)视为同一拓扑顶点, 分组时按共享的拓扑顶点数衡量相邻程度
+    std::vector<uint32_t> WeldPositions(const std::vector<ClusterVertex> &vertices)
+    {
+        struct Key
+        {
+            glm::vec3 p;
+            bool operator==(const Key &other) const { return p == other.p; }
+        };
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const
+            {
+                uint32_t bits[3];
+                std::memcpy(bits, &key.p, sizeof(bits));
+                return (size_t(bits[0]) * 73856093u) ^ (size_t(bits[1]) * 19349663u) ^ (size_t(bits[2]) * 83492791u);
+            }
+        };
+        std::unordered_map<Key, uint32_t, KeyHash> ids;
+        ids.reserve(vertices.size());
+        std::vector<uint32_t> topology(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+            topology[i] = ids.try_emplace(Key{vertices[i].position}, static_cast<uint32_t>(ids.size())).first->second;
+        return topology;
+    }
+
+    /// 把相邻的簇每 GroupSize 个分为一组. 按簇中心的 Morton 顺序选种子, 每次并入与组共享顶点最多的邻居
+    std::vector<std::vector<uint32_t>> GroupClusters(const std::vector<WorkCluster> &clusters, const std::vector<uint32_t> &level,
+                                                     const std::vector<uint32_t> &topology)
+    {
+        const size_t count = level.size();
+        // (拓扑顶点, 层内簇序号), 排序后同一顶点的簇相邻
+        std::vector<std::pair<uint32_t, uint32_t>> incidence;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            for (uint32_t v : clusters[level[i]].indices)
+                incidence.emplace_back(topology[v], i);
+        }
+        std::sort(incidence.begin(), incidence.end());
+        incidence.erase(std::unique(incidence.begin(), incidence.end()), incidence.end());
+
+        std::vector<std::unordered_map<uint32_t, uint32_t>> shared(count);
+        for (size_t begin = 0; begin < incidence.size();)
+        {
+            size_t end = begin + 1;
+            while (end < incidence.size() && incidence[end].first == incidence[begin].first)
+                ++end;
+            for (size_t a = begin; a < end; ++a)
+            {
+                for (size_t b = a + 1; b < end; ++b)
+                {
+                    shared[incidence[a].second][incidence[b].second]++;
+                    shared[incidence[b].second][incidence[a].second]++;
+                }
+            }
+            begin = end;
+        }
+
+        glm::vec3 minCorner(std::numeric_limits<float>::max());
+        glm::vec3 maxCorner(-std::numeric_limits<float>::max());
+        for (uint32_t id : level)
+        {
+            minCorner = glm::min(minCorner, glm::vec3(clusters[id].lodBounds));
+            maxCorner = glm::max(maxCorner, glm::vec3(clusters[id].lodBounds));
+        }
+        const glm::vec3 extent = glm::max(maxCorner - minCorner, glm::vec3(1e-6f));
+        std::vector<std::pair<uint32_t, uint32_t>> order(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const glm::uvec3 q = glm::uvec3((glm::vec3(clusters[level[i]].lodBounds) - minCorner) / extent * 1023.0f);
+            order[i] = {SpreadBits(q.x) | (SpreadBits(q.y) << 1) | (SpreadBits(q.z) << 2), i};
+        }
+        std::sort(order.begin(), order.end());
+
+        std::vector<uint8_t> grouped(count, 0);
+        std::vector<std::vector<uint32_t>> groups;
+        std::unordered_map<uint32_t, uint32_t> frontier;
+        for (const auto &[code, seed] : order)
+        {
+            if (grouped[seed])
+                continue;
+            std::vector<uint32_t> group{seed};
+            grouped[seed] = 1;
+            frontier.clear();
+            for (const auto &[neighbour, weight] : shared[seed])
+                frontier[neighbour] += weight;
+            while (group.size() < ClusterHierarchy::GroupSize)
+            {
+                uint32_t best = None;
+                uint32_t bestWeight = 0;
+                for (const auto &[neighbour, weight] : frontier)
+                {
+                    if (!grouped[neighbour] && (weight > bestWeight || (weight == bestWeight && neighbour < best)))
+                    {
+                        best = neighbour;
+                        bestWeight = weight;
+                    }
+                }
+                if (best == None)
+                    break;
+                group.push_back(best);
+                grouped[best] = 1;
+                for (const auto &[neighbour, weight] : shared[best])
+                    frontier[neighbour] += weight;
+            }
+            for (uint32_t &member : group)
+                member = level[member];
+            groups.push_back(std::move(group));
+        }
+        return groups;
+    }
+
+    template <typename T>
+    void WriteArray(std::ofstream &file, const std::vector<T> &values)
+    {
+        if (!values.empty())
+            file.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    template <typename T>
+    void ReadArray(std::ifstream &file, std::vector<T> &values, size_t count)
+    {
+        values.resize(count);
+        if (count > 0)
+            file.read(reinterpret_cast<char *>(values.data()), static_cast<std::streamsize>(count * sizeof(T)));
+    }
+}
+
+ClusterHierarchy::BuildStats ClusterHierarchy::Build(const std::vector<ClusterVertex> &vertices, const std::vector<uint32_t> &indices,
+                                                     const std::filesystem::path &path)
+{
+    const auto start = std::chrono::steady_clock::now();
+    BuildStats stats;
+    stats.sourceTriangles = indices.size() / 3;
+    if (vertices.empty() || indices.size() < 3)
+        throw std::runtime_error("ClusterHierarchy: empty mesh");
+
+    const float *positions = &vertices[0].position.x;
+    const std::vector<uint32_t> topology = WeldPositions(vertices);
+
+    std::vector<WorkCluster> clusters;
+    std::vector<WorkGroup> groups;
+    std::vector<std::vector<uint32_t>> pages; // 页 -> 簇
+
+    // 第0层: 原网格直接切簇
+    {
+        std::vector<unsigned int> sourceIndices(indices.begin(), indices.end());
+        const std::vector<Meshlet> meshlets = MeshletBuilder::Build(positions, sizeof(ClusterVertex), vertices.size(), sourceIndices);
+        clusters.reserve(meshlets.size() * 2);
+        for (const Meshlet &meshlet : meshlets)
+        {
+            WorkCluster cluster;
+            cluster.indices.assign(sourceIndices.begin() + meshlet.firstIndex, sourceIndices.begin() + meshlet.firstIndex + meshlet.indexCount);
+            cluster.lodBounds = glm::vec4(meshlet.center, meshlet.radius);
+            clusters.push_back(std::move(cluster));
+        }
+    }
+
+    // 组内顶点编号 -> 局部编号, 每组用完后复位
+    std::vector<uint32_t> localOf(vertices.size(), None);
+    std::vector<uint32_t> level(clusters.size());
+    for (uint32_t i = 0; i < level.size(); ++i)
+        level[i] = i;
+
+    for (size_t depth = 0; depth < MaxLevels && level.size() > 1; ++depth)
+    {
+        const std::vector<std::vector<uint32_t>> levelGroups = GroupClusters(clusters, level, topology);
+        std::vector<uint32_t> next;
+        size_t simplified = 0;
+        for (const std::vector<uint32_t> &members : levelGroups)
+        {
+            if (depth == 0)
+            {
+                // 最底层每组的成员组成一页
+                for (uint32_t member : members)
+                    clusters[member].page = static_cast<uint32_t>(pages.size());
+                pages.push_back(members);
+            }
+
+            std::vector<uint32_t> globalOf;
+            std::vector<ClusterVertex> localVertices;
+            std::vector<unsigned int> localIndices;
+            for (uint32_t member : members)
+            {
+                for (uint32_t v : clusters[member].indices)
+                {
+                    if (localOf[v] == None)
+                    {
+                        localOf[v] = static_cast<uint32_t>(globalOf.size());
+                        globalOf.push_back(v);
+                        localVertices.push_back(vertices[v]);
+                    }
+                    localIndices.push_back(localOf[v]);
+                }
+            }
+            for (uint32_t v : globalOf)
+                localOf[v] = None;
+
+            // 组的外边界是开放边界, 简化时锁定, 与相邻组保持一致
+            float error = 0.0f;
+            const size_t target = localIndices.size() / 6 * 3;
+            std::vector<unsigned int> reduced = MeshSimplifier::Simplify(&localVertices[0].position.x, sizeof(ClusterVertex),
+                                                                         localVertices.size(), localIndices, target, error);
+            size_t reducedVertices = 0;
+            {
+                std::vector<uint8_t> used(localVertices.size(), 0);
+                for (unsigned int v : reduced)
+                {
+                    reducedVertices += used[v] == 0;
+                    used[v] = 1;
+                }
+            }
+            if (reduced.empty() || reduced.size() > size_t(MinReduction * localIndices.size()) ||
+                reduced.size() > PageIndices || reducedVertices > PageVertices)
+            {
+                // 简化失败, 成员原样进入下一层, 与其他簇重新分组
+                stats.failedGroups++;
+                next.insert(next.end(), members.begin(), members.end());
+                continue;
+            }
+            ++simplified;
+
+            const uint32_t groupIndex = static_cast<uint32_t>(groups.size());
+            WorkGroup group;
+            group.members = members;
+            std::vector<glm::vec4> spheres;
+            for (uint32_t member : members)
+            {
+                clusters[member].parentGroup = groupIndex;
+                group.record.error = std::max(group.record.error, clusters[member].lodError);
+                spheres.push_back(clusters[member].lodBounds);
+            }
+            group.record.error += error;
+            group.record.bounds = MergeSpheres(spheres);
+            group.record.outputPage = static_cast<uint32_t>(pages.size());
+
+            const std::vector<Meshlet> meshlets = MeshletBuilder::Build(&localVertices[0].position.x, sizeof(ClusterVertex),
+                                                                        localVertices.size(), reduced);
+            std::vector<uint32_t> page;
+            for (const Meshlet &meshlet : meshlets)
+            {
+                WorkCluster cluster;
+                cluster.indices.reserve(meshlet.indexCount);
+                for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; ++i)
+                    cluster.indices.push_back(globalOf[reduced[i]]);
+                cluster.lodBounds = group.record.bounds;
+                cluster.lodError = group.record.error;
+                cluster.generatingGroup = groupIndex;
+                cluster.page = group.record.outputPage;
+                const uint32_t id = static_cast<uint32_t>(clusters.size());
+                clusters.push_back(std::move(cluster));
+                group.outputs.push_back(id);
+                page.push_back(id);
+                next.push_back(id);
+            }
+            pages.push_back(std::move(page));
+            groups.push_back(std::move(group));
+        }
+        stats.levels = depth + 1;
+        if (simplified == 0)
+            break;
+        level = std::move(next);
+    }
+
+    // 扁平化为文件记录
+    ClusterHierarchy result;
+    result.clusters.resize(clusters.size());
+    for (size_t i = 0; i < clusters.size(); ++i)
+    {
+        result.clusters[i].page = clusters[i].page;
+        result.clusters[i].generatingGroup = clusters[i].generatingGroup;
+        result.clusters[i].parentGroup = clusters[i].parentGroup;
+    }
+    auto appendUnique = [&](std::vector<uint32_t> values, uint32_t &first, uint32_t &count)
+    {
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        values.erase(std::remove(values.begin(), values.end(), None), values.end());
+        first = static_cast<uint32_t>(result.lists.size());
+        count = static_cast<uint32_t>(values.size());
+        result.lists.insert(result.lists.end(), values.begin(), values.end());
+    };
+    result.groups.reserve(groups.size());
+    for (WorkGroup &group : groups)
+    {
+        GroupRecord record = group.record;
+        record.memberFirst = static_cast<uint32_t>(result.lists.size());
+        record.memberCount = static_cast<uint32_t>(group.members.size());
+        result.lists.insert(result.lists.end(), group.members.begin(), group.members.end());
+        std::vector<uint32_t> memberPages, children, parents;
+        for (uint32_t member : group.members)
+        {
+            memberPages.push_back(clusters[member].page);
+            children.push_back(clusters[member].generatingGroup);
+        }
+        for (uint32_t output : group.outputs)
+            parents.push_back(clusters[output].parentGroup);
+        appendUnique(memberPages, record.memberPageFirst, record.memberPageCount);
+        appendUnique(children, record.childFirst, record.childCount);
+        appendUnique(parents, record.parentFirst, record.parentCount);
+        result.groups.push_back(record);
+    }
+    result.pages.resize(pages.size());
+    result.header.rootFirst = static_cast<uint32_t>(result.lists.size());
+    for (uint32_t i = 0; i < clusters.size(); ++i)
+    {
+        if (clusters[i].parentGroup != None)
+            continue;
+        result.lists.push_back(i);
+        result.pages[clusters[i].page].pinned = 1;
+        stats.rootTriangles += clusters[i].indices.size() / 3;
+    }
+    result.header.rootCount = static_cast<uint32_t>(result.lists.size()) - result.header.rootFirst;
+    result.header.clusterCount = static_cast<uint32_t>(result.clusters.size());
+    result.header.groupCount = static_cast<uint32_t>(result.groups.size());
+    result.header.listCount = static_cast<uint32_t>(result.lists.size());
+    result.header.pageCount = static_cast<uint32_t>(result.pages.size());
+    result.header.sourceTriangles = stats.sourceTriangles;
+    glm::vec3 minCorner(std::numeric_limits<float>::max()), maxCorner(-std::numeric_limits<float>::max());
+    for (const ClusterVertex &vertex : vertices)
+    {
+        minCorner = glm::min(minCorner, vertex.position);
+        maxCorner = glm::max(maxCorner, vertex.position);
+    }
+    std::memcpy(result.header.boundsMin, &minCorner, sizeof(result.header.boundsMin));
+    std::memcpy(result.header.boundsMax, &maxCorner, sizeof(result.header.boundsMax));
+
+    // 元数据大小已知, 先跳过元数据写页数据, 得到各页偏移与簇的页内范围后回头写元数据
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("ClusterHierarchy: cannot write " + path.string());
+    const uint64_t metadataBytes = sizeof(FileHeader) + result.clusters.size() * sizeof(ClusterRecord) +
+                                   result.groups.size() * sizeof(GroupRecord) + result.lists.size() * sizeof(uint32_t) +
+                                   result.pages.size() * sizeof(PageRecord);
+    file.seekp(static_cast<std::streamoff>(metadataBytes));
+    uint64_t offset = metadataBytes;
+    std::vector<ClusterVertex> pageVertices;
+    std::vector<uint16_t> pageIndices;
+    for (size_t p = 0; p < pages.size(); ++p)
+    {
+        pageVertices.clear();
+        pageIndices.clear();
+        std::vector<uint32_t> touched;
+        for (uint32_t id : pages[p])
+        {
+            result.clusters[id].firstIndex = static_cast<uint32_t>(pageIndices.size());
+            result.clusters[id].indexCount = static_cast<uint32_t>(clusters[id].indices.size());
+            for (uint32_t v : clusters[id].indices)
+            {
+                if (localOf[v] == None)
+                {
+                    localOf[v] = static_cast<uint32_t>(pageVertices.size());
+                    pageVertices.push_back(vertices[v]);
+                    touched.push_back(v);
+                }
+                pageIndices.push_back(static_cast<uint16_t>(localOf[v]));
+            }
+        }
+        for (uint32_t v : touched)
+            localOf[v] = None;
+        if (pageVertices.size() > PageVertices || pageIndices.size() > PageIndices)
+            throw std::runtime_error("ClusterHierarchy: page exceeds pool slot capacity");
+
+        PageRecord &record = result.pages[p];
+        record.offset = offset;
+        record.vertexCount = static_cast<uint32_t>(pageVertices.size());
+        record.indexCount = static_cast<uint32_t>(pageIndices.size());
+        WriteArray(file, pageVertices);
+        WriteArray(file, pageIndices);
+        offset += record.byteSize();
+    }
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&result.header), sizeof(FileHeader));
+    WriteArray(file, result.clusters);
+    WriteArray(file, result.groups);
+    WriteArray(file, result.lists);
+    WriteArray(file, result.pages);
+    if (!file)
+        throw std::runtime_error("ClusterHierarchy: failed writing " + path.string());
+
+    stats.clusters = clusters.size();
+    stats.groups = groups.size();
+    stats.pages = pages.size();
+    stats.rootClusters = result.header.rootCount;
+    stats.fileBytes = static_cast<size_t>(offset);
+    stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+ClusterHierarchy ClusterHierarchy::Load(const std::filesystem::path &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("ClusterHierarchy: cannot open " + path.string());
+    ClusterHierarchy result;
+    file.read(reinterpret_cast<char *>(&result.header), sizeof(FileHeader));
+    if (!file || std::memcmp(result.header.magic, FileHeader{}.magic, sizeof(result.header.magic)) != 0)
+        throw std::runtime_error("ClusterHierarchy: " + path.string() + " is not a cluster hierarchy file");
+    ReadArray(file, result.clusters, result.header.clusterCount);
+    ReadArray(file, result.groups, result.header.groupCount);
+    ReadArray(file, result.lists, result.header.listCount);
+    ReadArray(file, result.pages, result.header.pageCount);
+    if (!file)
+        throw std::runtime_error("ClusterHierarchy: " + path.string() + " is truncated");
+    return result;
+}
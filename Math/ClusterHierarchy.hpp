@@ -0,0 +1,113 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+/*
+簇层级(cluster DAG), 用于超出内存的单个网格的流式加载
+离线构建: 原网格切成簇(MeshletBuilder), 相邻的簇每 GroupSize 个组成一组, 组内合并后简化一半(MeshSimplifier)再切成新的簇,
+    新簇进入下一层继续分组, 直到无法再简化. 组的外边界在简化中锁定, 因此同一组的成员与它生成的簇可以互相替换而不产生裂缝,
+    各层的分组边界不同, 上一层锁定的边在下一层可以被简化
+运行时: 组 g 的误差投影到屏幕超过阈值且其成员已驻留时"细化", 绘制成员; 否则绘制 g 生成的簇
+    簇 c 绘制当且仅当 c 所在的组已细化(根簇视为已细化) 且 生成 c 的组未细化(原始簇视为未细化), 所有簇恰好覆盖网格一次
+    组的误差与包围球包含其所有子组, 投影误差沿层级单调, 选择结果与遍历顺序无关
+页是流式加载的单位: 最底层一组的成员为一页, 其上每组生成的簇为一页. 页内顶点与16位索引可直接复制到GPU页池的一个槽位
+文件: FileHeader | ClusterRecord[] | GroupRecord[] | uint32 列表(组成员/成员页/子组/父组/根簇) | PageRecord[] | 各页数据
+页数据: ClusterVertex[vertexCount] | uint16[indexCount], 索引相对页内首顶点
+*/
+class ClusterHierarchy
+{
+public:
+    static constexpr size_t GroupSize = 4;
+    // 页池槽位容量, 超出容量的组视为简化失败, 其成员原样进入下一层
+    static constexpr uint32_t PageVertices = 512;
+    static constexpr uint32_t PageIndices = 4096;
+    // 简化后三角形数超过组原三角形数的比例时视为失败
+    static constexpr float MinReduction = 0.85f;
+    static constexpr uint32_t None = ~uint32_t(0);
+
+    // 与 GeometryBuffer::VertexFormat::Standard 的布局一致
+    struct ClusterVertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec2 texCoord;
+    };
+    static_assert(sizeof(ClusterVertex) == 32, "ClusterVertex must match the standard vertex layout");
+
+    struct FileHeader
+    {
+        char magic[8] = {'C', 'L', 'H', 'I', 'E', 'R', '0', '1'};
+        uint32_t clusterCount = 0;
+        uint32_t groupCount = 0;
+        uint32_t listCount = 0; // uint32 列表总长度
+        uint32_t pageCount = 0;
+        uint32_t rootFirst = 0; // 根簇在列表中的位置
+        uint32_t rootCount = 0;
+        uint64_t sourceTriangles = 0;
+        float boundsMin[3] = {};
+        float boundsMax[3] = {};
+    };
+
+    struct ClusterRecord
+    {
+        uint32_t page = 0;
+        uint32_t firstIndex = 0; // 页内
+        uint32_t indexCount = 0;
+        uint32_t generatingGroup = None; // 生成本簇的组, 原始簇为 None
+        uint32_t parentGroup = None;     // 本簇作为成员所在的组, 根簇为 None
+    };
+
+    // 组按构建顺序存放, 父组的编号总是大于子组
+    struct GroupRecord
+    {
+        glm::vec4 bounds = glm::vec4(0.0f); // 包含成员与所有子组的包围球, w 为半径
+        float error = 0.0f;                 // 用生成的簇替换成员时的模型空间误差, 包含子组误差
+        uint32_t memberFirst = 0, memberCount = 0;
+        uint32_t memberPageFirst = 0, memberPageCount = 0;
+        uint32_t childFirst = 0, childCount = 0;   // 生成了成员的组
+        uint32_t parentFirst = 0, parentCount = 0; // 生成的簇所在的组
+        uint32_t outputPage = None;
+    };
+
+    struct PageRecord
+    {
+        uint64_t offset = 0; // 文件中的字节偏移
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint32_t pinned = 0; // 含根簇的页常驻
+
+        size_t byteSize() const { return size_t(vertexCount) * sizeof(ClusterVertex) + size_t(indexCount) * sizeof(uint16_t); }
+    };
+
+    struct BuildStats
+    {
+        size_t sourceTriangles = 0;
+        size_t clusters = 0;
+        size_t groups = 0;
+        size_t pages = 0;
+        size_t levels = 0;
+        size_t rootClusters = 0;
+        size_t rootTriangles = 0;
+        size_t failedGroups = 0;
+        size_t fileBytes = 0;
+        double buildMs = 0.0;
+    };
+
+    /// @brief 构建簇层级并写入文件. 构建期间源网格需完整位于内存中, 运行时只读取元数据与所需的页
+    /// @param indices 三角形列表. 写入失败时抛出 std::runtime_error
+    static BuildStats Build(const std::vector<ClusterVertex> &vertices, const std::vector<uint32_t> &indices,
+                            const std::filesystem::path &path);
+
+    /// @brief 读取文件中除页数据外的全部内容. 格式不符时抛出 std::runtime_error
+    static ClusterHierarchy Load(const std::filesystem::path &path);
+
+    FileHeader header;
+    std::vector<ClusterRecord> clusters;
+    std::vector<GroupRecord> groups;
+    std::vector<uint32_t> lists;
+    std::vector<PageRecord> pages;
+};
@@ -7,6 +7,62 @@
 #include <limits>
 #include "../Renderers/DebugObjectRenderer.hpp"
 
+FrustumPlanes FrustumPlanes::FromMatrix(const glm::mat4 &projView)
+{
+    // glm 列主序, m[col][row]. 取矩阵的行
+    const glm::vec4 row0(projView[0][0], projView[1][0], projView[2][0], projView[3][0]);
+    const glm::vec4 row1(projView[0][1], projView[1][1], projView[2][1], projView[3][1]);
+    const glm::vec4 row2(projView[0][2], projView[1][2], projView[2][2], projView[3][2]);
+    const glm::vec4 row3(projView[0][3], projView[1][3], projView[2][3], projView[3][3]);
+
+    FrustumPlanes result;
+    result.planes[Left] = row3 + row0;
+    result.planes[Right] = row3 - row0;
+    result.planes[Bottom] = row3 + row1;
+    result.planes[Top] = row3 - row1;
+    result.planes[Near] = row3 + row2;
+    result.planes[Far] = row3 - row2;
+    for (auto &plane : result.planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return result;
+}
+
+bool FrustumPlanes::intersects(const BoundingSphere &sphere) const
+{
+    if (!sphere.isValid())
+        return true;
+    for (const auto &plane : planes)
+    {
+        if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+            return false;
+    }
+    return true;
+}
+
+bool FrustumPlanes::intersects(const AABB &box) const
+{
+    if (!box.isValid())
+        return true;
+    const glm::vec3 center = box.center();
+    const glm::vec3 extents = box.extents();
+    for (const auto &plane : planes)
+    {
+        const glm::vec3 normal(plane);
+        // 包围盒在法线方向上的投影半径
+        const float r = glm::dot(extents, glm::abs(normal));
+        if (glm::dot(normal, center) + plane.w < -r)
+            return false;
+    }
+    return true;
+}
+
+bool FrustumPlanes::intersects(const BoundingVolume &volume) const
+{
+    return intersects(volume.sphere) && intersects(volume.box);
+}
+
 Frustum::Frustum()
 {
 }
@@ -59,6 +115,11 @@ glm::mat4 Frustum::getProjViewMatrix() const
     return glm::perspective(glm::radians(m_fov), m_aspect, m_nearPlane, m_farPlane) * glm::lookAt(m_position, m_position + m_front, m_up);
 }
 
+FrustumPlanes Frustum::getPlanes() const
+{
+    return FrustumPlanes::FromMatrix(getProjViewMatrix());
+}
+
 FrustumCorners Frustum::getCorners() const
 {
     // 1. 计算近平面和远平面的宽高
@@ -282,4 +343,8 @@ float OrthoFrustum::getNearPlane() const
 float OrthoFrustum::getFarPlane() const
 {
     return m_farPlane;
-}
\ No newline at end of file
+}
+FrustumPlanes OrthoFrustum::getPlanes() const
+{
+    return FrustumPlanes::FromMatrix(getProjViewMatrix());
+}
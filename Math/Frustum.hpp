@@ -3,6 +3,7 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <string>
+#include "Bounds.hpp"
 
 struct FrustumCorners
 {
@@ -10,6 +11,30 @@ struct FrustumCorners
     glm::vec3 farTopLeft, farTopRight, farBottomRight, farBottomLeft;
 };
 
+/// @brief 视锥的6个平面, 法线朝内. plane = (n, d), 点p在内侧当 dot(n,p)+d >= 0
+struct FrustumPlanes
+{
+    enum Side
+    {
+        Left = 0,
+        Right,
+        Bottom,
+        Top,
+        Near,
+        Far,
+        Count
+    };
+    glm::vec4 planes[Count];
+
+    // 从投影*视图矩阵提取平面(Gribb-Hartmann), 透视与正交通用
+    static FrustumPlanes FromMatrix(const glm::mat4 &projView);
+
+    bool intersects(const BoundingSphere &sphere) const;
+    bool intersects(const AABB &box) const;
+    // 先做包围球测试, 通过后再做AABB测试
+    bool intersects(const BoundingVolume &volume) const;
+};
+
 class FrustumBase
 {
 public:
@@ -22,6 +47,7 @@ public:
     virtual glm::vec3 getUp() const = 0;
     virtual float getNearPlane() const = 0;
     virtual float getFarPlane() const = 0;
+    virtual FrustumPlanes getPlanes() const = 0;
 };
 
 class Frustum : public FrustumBase
@@ -49,6 +75,7 @@ public:
     glm::mat4 getProjectionMatrix() const override;
     glm::mat4 getProjViewMatrix() const override;
     FrustumCorners getCorners() const override;
+    FrustumPlanes getPlanes() const override;
 };
 
 class OrthoFrustum : public FrustumBase
@@ -81,4 +108,5 @@ public:
     glm::vec3 getUp() const override;
     float getNearPlane() const override;
     float getFarPlane() const override;
-};
\ No newline at end of file
+    FrustumPlanes getPlanes() const override;
+};
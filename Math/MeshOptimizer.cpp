@@ -0,0 +1,447 @@
+#include "MeshOptimizer.hpp"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    constexpr uint32_t NoVertex = ~uint32_t(0);
+    constexpr uint32_t NoTriangle = ~uint32_t(0);
+    // 剩余三角形数超过此值的顶点按此值打分
+    constexpr uint32_t MaxValence = 32;
+    // 半精度的最大有限值
+    constexpr float MaxHalf = 65504.0f;
+    // 纹理坐标超出 [0,1] 的容差, 范围内的误差直接截断
+    constexpr float TexCoordTolerance = 1e-4f;
+
+    glm::vec3 PositionAt(const float *positions, size_t stride, uint32_t vertex)
+    {
+        const float *p = reinterpret_cast<const float *>(reinterpret_cast<const char *>(positions) + vertex * stride);
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    const float *AttributeAt(const float *attribute, size_t stride, size_t vertex)
+    {
+        return reinterpret_cast<const float *>(reinterpret_cast<const char *>(attribute) + vertex * stride);
+    }
+
+    // Forsyth 的打分: 刚用过的3个顶点分数固定, 之后随缓存位置衰减; 剩余三角形少的顶点加分, 尽快用完以免留下孤立三角形
+    struct ScoreTable
+    {
+        float cache[MeshOptimizer::CacheSize];
+        float valence[MaxValence + 1];
+
+        ScoreTable()
+        {
+            for (size_t i = 0; i < MeshOptimizer::CacheSize; ++i)
+            {
+                cache[i] = i < 3 ? 0.75f
+                                 : std::pow(1.0f - float(i - 3) / float(MeshOptimizer::CacheSize - 3), 1.5f);
+            }
+            valence[0] = 0.0f;
+            for (uint32_t i = 1; i <= MaxValence; ++i)
+                valence[i] = 2.0f / std::sqrt(float(i));
+        }
+
+        float score(int cachePosition, uint32_t remaining) const
+        {
+            if (remaining == 0)
+                return -1.0f;
+            return (cachePosition >= 0 ? cache[cachePosition] : 0.0f) + valence[std::min(remaining, MaxValence)];
+        }
+    };
+}
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int *indices, size_t indexCount, size_t vertexCount)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2)
+        return;
+    static const ScoreTable table;
+
+    // 每个顶点尚未输出的三角形, 按顶点连续存放
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+        remaining[indices[i]]++;
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v)
+        offsets[v + 1] = offsets[v] + remaining[v];
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (uint32_t t = 0; t < triangleCount; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+                adjacency[fill[indices[t * 3 + k]]++] = t;
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        vertexScore[v] = table.score(-1, remaining[v]);
+    std::vector<float> triangleScore(triangleCount);
+    uint32_t best = 0;
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        if (triangleScore[t] > triangleScore[best])
+            best = t;
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<unsigned int> result;
+    result.reserve(triangleCount * 3);
+    uint32_t cache[CacheSize + 3];
+    uint32_t newCache[CacheSize + 3];
+    size_t cacheCount = 0;
+    size_t scanCursor = 0;
+    while (result.size() < triangleCount * 3)
+    {
+        if (best == NoTriangle)
+        {
+            // 缓存中的顶点都已用完, 从下一个未输出的三角形重新开始
+            while (emitted[scanCursor])
+                ++scanCursor;
+            best = static_cast<uint32_t>(scanCursor);
+        }
+        const unsigned int *triangle = indices + size_t(best) * 3;
+        emitted[best] = 1;
+        result.insert(result.end(), triangle, triangle + 3);
+
+        size_t newCount = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t v = triangle[k];
+            uint32_t *list = adjacency.data() + offsets[v];
+            for (uint32_t i = 0; i < remaining[v]; ++i)
+            {
+                if (list[i] == best)
+                {
+                    std::swap(list[i], list[remaining[v] - 1]);
+                    remaining[v]--;
+                    break;
+                }
+            }
+            if (std::find(newCache, newCache + newCount, v) == newCache + newCount)
+                newCache[newCount++] = v;
+        }
+        for (size_t i = 0; i < cacheCount; ++i)
+        {
+            if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+                newCache[newCount++] = cache[i];
+        }
+
+        // 更新缓存内(含刚被挤出的)顶点的分数, 差值累加到它们剩余的三角形上
+        for (size_t i = 0; i < newCount; ++i)
+        {
+            const uint32_t v = newCache[i];
+            cachePosition[v] = i < CacheSize ? static_cast<int>(i) : -1;
+            const float score = table.score(cachePosition[v], remaining[v]);
+            const float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            for (uint32_t j = 0; j < remaining[v]; ++j)
+                triangleScore[adjacency[offsets[v] + j]] += delta;
+        }
+        cacheCount = std::min(newCount, CacheSize);
+        std::copy(newCache, newCache + cacheCount, cache);
+
+        // 下一个三角形只在缓存顶点的相邻三角形中找
+        best = NoTriangle;
+        float bestScore = -1.0f;
+        for (size_t i = 0; i < cacheCount; ++i)
+        {
+            const uint32_t v = cache[i];
+            for (uint32_t j = 0; j < remaining[v]; ++j)
+            {
+                const uint32_t t = adjacency[offsets[v] + j];
+                if (triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+    }
+    std::copy(result.begin(), result.end(), indices);
+}
+
+void MeshOptimizer::OptimizeMeshletVertexCache(std::vector<unsigned int> &indices, const std::vector<Meshlet> &meshlets, size_t vertexCount)
+{
+    // 簇内顶点重新编号为局部编号, 优化后再映射回去
+    std::vector<uint32_t> localOf(vertexCount, NoVertex);
+    std::vector<uint32_t> globalOf;
+    std::vector<unsigned int> local;
+    for (const Meshlet &meshlet : meshlets)
+    {
+        unsigned int *range = indices.data() + meshlet.firstIndex;
+        globalOf.clear();
+        local.resize(meshlet.indexCount);
+        for (uint32_t i = 0; i < meshlet.indexCount; ++i)
+        {
+            uint32_t &slot = localOf[range[i]];
+            if (slot == NoVertex)
+            {
+                slot = static_cast<uint32_t>(globalOf.size());
+                globalOf.push_back(range[i]);
+            }
+            local[i] = slot;
+        }
+        OptimizeVertexCache(local.data(), local.size(), globalOf.size());
+        for (uint32_t i = 0; i < meshlet.indexCount; ++i)
+            range[i] = globalOf[local[i]];
+        for (uint32_t v : globalOf)
+            localOf[v] = NoVertex;
+    }
+}
+
+bool MeshOptimizer::OptimizeOverdraw(std::vector<unsigned int> &indices, const float *positions, size_t stride, size_t vertexCount,
+                                     float threshold)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2)
+        return false;
+
+    std::vector<size_t> timestamps(vertexCount, 0);
+    size_t time = AnalyzeCacheSize + 1;
+    auto missesOf = [&](size_t t)
+    {
+        size_t misses = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const unsigned int v = indices[t * 3 + k];
+            if (time - timestamps[v] > AnalyzeCacheSize)
+            {
+                timestamps[v] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    };
+    // 时间戳整体前移一个缓存大小, 相当于清空缓存
+    auto flushCache = [&]()
+    { time += AnalyzeCacheSize + 1; };
+
+    // 硬边界: 三个顶点都未命中的三角形处缓存状态与之前无关, 在此切段不会增加变换次数
+    std::vector<uint32_t> hardStarts;
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        if (missesOf(t) == 3 || t == 0)
+            hardStarts.push_back(t);
+    }
+    hardStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+    // 软边界: 从段首起累计的ACMR不超过整段ACMR的 threshold 倍时切开, 重排后每段增加的变换次数有上限
+    std::vector<uint32_t> clusterStarts;
+    for (size_t h = 0; h + 1 < hardStarts.size(); ++h)
+    {
+        const uint32_t start = hardStarts[h];
+        const uint32_t end = hardStarts[h + 1];
+        flushCache();
+        size_t total = 0;
+        for (uint32_t t = start; t < end; ++t)
+            total += missesOf(t);
+        const float limit = threshold * float(total) / float(end - start);
+
+        flushCache();
+        clusterStarts.push_back(start);
+        uint32_t clusterStart = start;
+        size_t misses = 0;
+        for (uint32_t t = start; t + 1 < end; ++t)
+        {
+            misses += missesOf(t);
+            if (float(misses) <= limit * float(t + 1 - clusterStart))
+            {
+                flushCache();
+                clusterStarts.push_back(t + 1);
+                clusterStart = t + 1;
+                misses = 0;
+            }
+        }
+    }
+    if (clusterStarts.size() < 2)
+        return false;
+    clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+    struct Cluster
+    {
+        uint32_t first;
+        uint32_t end;
+        glm::vec3 centroid; // 面积加权
+        glm::vec3 normal;   // 面积加权, 未归一化
+        float area;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters;
+    clusters.reserve(clusterStarts.size() - 1);
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t c = 0; c + 1 < clusterStarts.size(); ++c)
+    {
+        Cluster cluster{clusterStarts[c], clusterStarts[c + 1], glm::vec3(0.0f), glm::vec3(0.0f), 0.0f, 0.0f};
+        for (uint32_t t = cluster.first; t < cluster.end; ++t)
+        {
+            const glm::vec3 a = PositionAt(positions, stride, indices[t * 3]);
+            const glm::vec3 b = PositionAt(positions, stride, indices[t * 3 + 1]);
+            const glm::vec3 p = PositionAt(positions, stride, indices[t * 3 + 2]);
+            const glm::vec3 n = glm::cross(b - a, p - a);
+            const float area = 0.5f * glm::length(n);
+            cluster.centroid += area * (a + b + p) / 3.0f;
+            cluster.normal += n;
+            cluster.area += area;
+        }
+        meshCentroid += cluster.centroid;
+        meshArea += cluster.area;
+        clusters.push_back(cluster);
+    }
+    if (meshArea <= 0.0f)
+        return false;
+    meshCentroid /= meshArea;
+
+    // 越朝外的段越先绘制
+    for (Cluster &cluster : clusters)
+    {
+        const float normalLength = glm::length(cluster.normal);
+        if (cluster.area > 0.0f && normalLength > 0.0f)
+            cluster.sortKey = glm::dot(cluster.centroid / cluster.area - meshCentroid, cluster.normal / normalLength);
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster &a, const Cluster &b)
+                     { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned int> reordered;
+    reordered.reserve(indices.size());
+    for (const Cluster &cluster : clusters)
+        reordered.insert(reordered.end(), indices.begin() + cluster.first * 3, indices.begin() + cluster.end * 3);
+
+    const size_t before = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+    const size_t after = AnalyzeVertexCache(reordered.data(), reordered.size(), vertexCount);
+    if (float(after) > float(before) * threshold)
+        return false;
+    indices.swap(reordered);
+    return true;
+}
+
+std::vector<uint32_t> MeshOptimizer::OptimizeVertexFetchRemap(std::vector<unsigned int> &indices, size_t vertexCount, size_t &newVertexCount)
+{
+    std::vector<uint32_t> remap(vertexCount, NoVertex);
+    uint32_t next = 0;
+    for (unsigned int &index : indices)
+    {
+        if (remap[index] == NoVertex)
+            remap[index] = next++;
+        index = remap[index];
+    }
+    newVertexCount = next;
+    return remap;
+}
+
+size_t MeshOptimizer::AnalyzeVertexCache(const unsigned int *indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+{
+    // 每次未命中时间戳加一, 时间差超过缓存大小说明已被挤出FIFO
+    std::vector<size_t> timestamps(vertexCount, 0);
+    size_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        if (time - timestamps[indices[i]] > cacheSize)
+        {
+            timestamps[indices[i]] = time++;
+            misses++;
+        }
+    }
+    return misses;
+}
+
+bool MeshOptimizer::EncodeCompact(const float *positions, const float *normals, const float *texCoords, size_t stride, size_t vertexCount,
+                                  std::vector<CompactVertex> &out)
+{
+    if (vertexCount == 0)
+        return false;
+    glm::vec3 minimum(std::numeric_limits<float>::max());
+    glm::vec3 maximum(std::numeric_limits<float>::lowest());
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        const glm::vec3 p = PositionAt(positions, stride, static_cast<uint32_t>(v));
+        minimum = glm::min(minimum, p);
+        maximum = glm::max(maximum, p);
+    }
+    const float tolerance = 1e-3f * glm::length(maximum - minimum);
+
+    out.resize(vertexCount);
+    const uint16_t one = HalfFromFloat(1.0f);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        CompactVertex &vertex = out[v];
+        const float *p = AttributeAt(positions, stride, v);
+        for (int c = 0; c < 3; ++c)
+        {
+            if (!(std::abs(p[c]) <= MaxHalf))
+                return false;
+            vertex.position[c] = HalfFromFloat(p[c]);
+            if (std::abs(FloatFromHalf(vertex.position[c]) - p[c]) > tolerance)
+                return false;
+        }
+        vertex.position[3] = one;
+
+        const float *n = AttributeAt(normals, stride, v);
+        vertex.normal = 0;
+        for (int c = 0; c < 3; ++c)
+        {
+            const int q = static_cast<int>(std::lround(std::clamp(n[c], -1.0f, 1.0f) * 511.0f));
+            vertex.normal |= (uint32_t(q) & 0x3FF) << (10 * c);
+        }
+
+        const float *uv = AttributeAt(texCoords, stride, v);
+        for (int c = 0; c < 2; ++c)
+        {
+            if (!(uv[c] >= -TexCoordTolerance && uv[c] <= 1.0f + TexCoordTolerance))
+                return false;
+            vertex.texCoord[c] = static_cast<uint16_t>(std::lround(std::clamp(uv[c], 0.0f, 1.0f) * 65535.0f));
+        }
+    }
+    return true;
+}
+
+uint16_t MeshOptimizer::HalfFromFloat(float value)
+{
+    const uint32_t bits = std::bit_cast<uint32_t>(value);
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const int exponent = int((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    if (exponent >= 31)
+        return sign | 0x7C00;
+    if (exponent <= 0)
+    {
+        // 非规格化数
+        if (exponent < -10)
+            return sign;
+        mantissa |= 0x800000;
+        const int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1)
+            half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+    // 舍入进位可能进入指数位, 结果仍正确
+    uint32_t half = (uint32_t(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000)
+        half++;
+    return static_cast<uint16_t>(sign | half);
+}
+
+float MeshOptimizer::FloatFromHalf(uint16_t half)
+{
+    const uint32_t sign = uint32_t(half & 0x8000) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1F;
+    const uint32_t mantissa = half & 0x3FF;
+    if (exponent == 0)
+    {
+        const float value = std::ldexp(float(mantissa), -24);
+        return sign ? -value : value;
+    }
+    if (exponent == 31)
+        return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+    return std::bit_cast<float>(sign | ((exponent - 15 + 127) << 23) | (mantissa << 13));
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Meshlet.hpp"
+
+/*
+导入时的网格优化, 只改变三角形与顶点的顺序, 绘制结果不变
+顶点缓存: Forsyth 线性时间算法, 按模拟的变换后缓存打分贪心选择下一个三角形
+过度绘制: 在缓存优化的结果上按缓存完全失效处切成若干段, 各段按朝外程度由外向内排序, 使前面的段更可能先遮挡后面的段
+顶点获取: 按索引中首次出现的顺序重排顶点, 使顶点获取尽量顺序访问内存
+另提供紧凑顶点格式的编码: 位置为半精度, 法线为 snorm 10-10-10-2, 纹理坐标为 unorm16, 由顶点获取阶段硬件解码
+*/
+class MeshOptimizer
+{
+public:
+    // Forsyth 算法模拟的缓存大小
+    static constexpr size_t CacheSize = 32;
+    // 统计ACMR时模拟的FIFO缓存大小, 接近常见硬件的变换后缓存
+    static constexpr size_t AnalyzeCacheSize = 16;
+    // 过度绘制重排允许的ACMR增长比例
+    static constexpr float OverdrawThreshold = 1.05f;
+
+    // 与 GeometryBuffer::VertexFormat::Compact 的布局一致
+    struct CompactVertex
+    {
+        uint16_t position[4]; // 半精度 xyz, 第4项为填充
+        uint32_t normal;      // GL_INT_2_10_10_10_REV, snorm
+        uint16_t texCoord[2]; // unorm16
+    };
+    static_assert(sizeof(CompactVertex) == 16, "CompactVertex must be tightly packed");
+
+    /// @brief 导入统计, 累加所有网格
+    struct Stats
+    {
+        size_t meshes = 0;
+        size_t triangles = 0;
+        size_t transformsBefore = 0; // FIFO 模拟中的缓存未命中次数, 除以三角形数即 ACMR
+        size_t transformsAfter = 0;
+        size_t vertices = 0;
+        size_t vertexBytesBefore = 0;
+        size_t vertexBytesAfter = 0;
+        size_t indexBytesBefore = 0;
+        size_t indexBytesAfter = 0;
+        size_t overdrawReordered = 0; // 接受了过度绘制重排的网格数
+        size_t compactMeshes = 0;     // 使用紧凑顶点格式的网格数
+        size_t shortIndexMeshes = 0;  // 使用16位索引的网格数
+        double optimizeMs = 0.0;
+    };
+
+    /// @brief 重排三角形以提高变换后缓存命中率
+    static void OptimizeVertexCache(unsigned int *indices, size_t indexCount, size_t vertexCount);
+
+    /// @brief 在各簇内部做顶点缓存优化, 不改变簇的边界
+    static void OptimizeMeshletVertexCache(std::vector<unsigned int> &indices, const std::vector<Meshlet> &meshlets, size_t vertexCount);
+
+    /// @brief 在已做缓存优化的索引上重排三角形段以减少过度绘制
+    /// @param positions 顶点position首地址(3个float), stride 为相邻顶点之间的字节数
+    /// @return ACMR 增长不超过 threshold 而采用了新顺序时返回 true
+    static bool OptimizeOverdraw(std::vector<unsigned int> &indices, const float *positions, size_t stride, size_t vertexCount,
+                                 float threshold = OverdrawThreshold);
+
+    /// @brief 按首次使用的顺序给顶点重新编号并改写 indices, 未被引用的顶点被丢弃
+    /// @return 旧编号 -> 新编号, 未引用的顶点为 ~0u
+    static std::vector<uint32_t> OptimizeVertexFetchRemap(std::vector<unsigned int> &indices, size_t vertexCount, size_t &newVertexCount);
+
+    template <typename T>
+    static std::vector<T> RemapVertices(const std::vector<T> &vertices, const std::vector<uint32_t> &remap, size_t newVertexCount)
+    {
+        std::vector<T> result(newVertexCount);
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            if (remap[i] != ~uint32_t(0))
+                result[remap[i]] = vertices[i];
+        }
+        return result;
+    }
+
+    /// @brief FIFO 缓存模拟下的顶点变换次数
+    static size_t AnalyzeVertexCache(const unsigned int *indices, size_t indexCount, size_t vertexCount, size_t cacheSize = AnalyzeCacheSize);
+
+    /// @brief 编码为紧凑格式. 位置超出半精度的精度要求(相对包围盒对角线的千分之一)或纹理坐标超出 [0,1] 时返回 false
+    /// @param positions/normals/texCoords 各属性首地址, stride 为相邻顶点之间的字节数
+    static bool EncodeCompact(const float *positions, const float *normals, const float *texCoords, size_t stride, size_t vertexCount,
+                              std::vector<CompactVertex> &out);
+
+    static uint16_t HalfFromFloat(float value);
+    static float FloatFromHalf(uint16_t half);
+};
@@ -0,0 +1,319 @@
+#include "MeshSimplifier.hpp"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+    constexpr uint32_t NoVertex = ~uint32_t(0);
+
+    glm::vec3 PositionAt(const float *positions, size_t stride, uint32_t vertex)
+    {
+        const float *p = reinterpret_cast<const float *>(reinterpret_cast<const char *>(positions) + vertex * stride);
+        // +0.0f 把 -0.0f 规范为 0.0f, 使相等的位置哈希相同
+        return glm::vec3(p[0] + 0.0f, p[1] + 0.0f, p[2] + 0.0f);
+    }
+
+    struct PositionHash
+    {
+        size_t operator()(const glm::vec3 &p) const
+        {
+            uint64_t h = std::bit_cast<uint32_t>(p.x);
+            h = h * 0x9E3779B97F4A7C15ull ^ std::bit_cast<uint32_t>(p.y);
+            h = h * 0x9E3779B97F4A7C15ull ^ std::bit_cast<uint32_t>(p.z);
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    // 对称4x4矩阵的上三角. 对平面 (n, d) 累加后, evaluate(p) 为 p 到各平面距离的平方和
+    struct Quadric
+    {
+        double m[10] = {};
+
+        void addPlane(const glm::dvec3 &n, double d)
+        {
+            m[0] += n.x * n.x, m[1] += n.x * n.y, m[2] += n.x * n.z, m[3] += n.x * d;
+            m[4] += n.y * n.y, m[5] += n.y * n.z, m[6] += n.y * d;
+            m[7] += n.z * n.z, m[8] += n.z * d;
+            m[9] += d * d;
+        }
+        Quadric &operator+=(const Quadric &other)
+        {
+            for (int i = 0; i < 10; ++i)
+                m[i] += other.m[i];
+            return *this;
+        }
+        double evaluate(const glm::dvec3 &p) const
+        {
+            return m[0] * p.x * p.x + 2.0 * m[1] * p.x * p.y + 2.0 * m[2] * p.x * p.z + 2.0 * m[3] * p.x +
+                   m[4] * p.y * p.y + 2.0 * m[5] * p.y * p.z + 2.0 * m[6] * p.y +
+                   m[7] * p.z * p.z + 2.0 * m[8] * p.z +
+                   m[9];
+        }
+    };
+
+    // 把拓扑顶点 from 并入 to. 版本号与入队时不同说明代价已过期
+    struct Collapse
+    {
+        float cost;
+        uint32_t from;
+        uint32_t to;
+        uint32_t fromVersion;
+        uint32_t toVersion;
+        bool operator>(const Collapse &other) const { return cost > other.cost; }
+    };
+
+    uint64_t EdgeKey(uint32_t a, uint32_t b)
+    {
+        if (a > b)
+            std::swap(a, b);
+        return (uint64_t(a) << 32) | b;
+    }
+}
+
+std::vector<unsigned int> MeshSimplifier::Simplify(const float *positions, size_t stride, size_t vertexCount,
+                                                   const std::vector<unsigned int> &indices, size_t targetIndexCount, float &error)
+{
+    error = 0.0f;
+
+    // 顶点按位置合并为拓扑顶点
+    // 接缝按整个顶点缓冲判断而不只是 indices 引用的顶点: 逐级简化时接缝一侧的顶点可能不再被引用, 接缝仍需锁定
+    std::vector<uint32_t> remap(vertexCount, NoVertex);
+    std::vector<glm::vec3> points;
+    std::vector<uint32_t> copies; // 拓扑顶点对应的原顶点数, 大于1表示接缝
+    {
+        std::unordered_map<glm::vec3, uint32_t, PositionHash> vertexOfPosition;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            auto [it, inserted] = vertexOfPosition.try_emplace(PositionAt(positions, stride, v), static_cast<uint32_t>(points.size()));
+            if (inserted)
+            {
+                points.push_back(it->first);
+                copies.push_back(0);
+            }
+            remap[v] = it->second;
+            copies[it->second]++;
+        }
+    }
+    const size_t topologyVertexCount = points.size();
+
+    // 三角形的原顶点角点与拓扑顶点角点, 丢弃退化三角形
+    std::vector<uint32_t> corners;
+    std::vector<uint32_t> topology;
+    corners.reserve(indices.size());
+    topology.reserve(indices.size());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const uint32_t a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+        if (a == b || b == c || a == c)
+            continue;
+        corners.insert(corners.end(), {indices[i], indices[i + 1], indices[i + 2]});
+        topology.insert(topology.end(), {a, b, c});
+    }
+    const size_t triangleCount = topology.size() / 3;
+    size_t aliveTriangles = triangleCount;
+    if (aliveTriangles * 3 <= targetIndexCount)
+        return std::vector<unsigned int>(corners.begin(), corners.end());
+
+    std::vector<std::vector<uint32_t>> vertexTriangles(topologyVertexCount);
+    std::vector<Quadric> quadrics(topologyVertexCount);
+    std::unordered_map<uint64_t, uint32_t> edgeUses;
+    edgeUses.reserve(triangleCount * 3 / 2);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        const uint32_t *v = &topology[t * 3];
+        const glm::dvec3 p0(points[v[0]]), p1(points[v[1]]), p2(points[v[2]]);
+        const glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        const double length = glm::length(normal);
+        for (int k = 0; k < 3; ++k)
+        {
+            vertexTriangles[v[k]].push_back(static_cast<uint32_t>(t));
+            if (length > 0.0)
+                quadrics[v[k]].addPlane(normal / length, -glm::dot(normal / length, p0));
+            edgeUses[EdgeKey(v[k], v[(k + 1) % 3])]++;
+        }
+    }
+
+    // 接缝, 开放边界与非流形边上的顶点只能作为塌缩目标
+    std::vector<uint8_t> locked(topologyVertexCount, 0);
+    for (size_t v = 0; v < topologyVertexCount; ++v)
+        locked[v] = copies[v] > 1;
+    for (const auto &[key, uses] : edgeUses)
+    {
+        if (uses != 2)
+        {
+            locked[key >> 32] = 1;
+            locked[key & 0xFFFFFFFFu] = 1;
+        }
+    }
+
+    std::vector<uint8_t> triangleAlive(triangleCount, 1);
+    std::vector<uint8_t> vertexAlive(topologyVertexCount, 1);
+    std::vector<uint32_t> versions(topologyVertexCount, 0);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+    auto push = [&](uint32_t from, uint32_t to)
+    {
+        if (locked[from])
+            return;
+        Quadric quadric = quadrics[from];
+        quadric += quadrics[to];
+        const float cost = static_cast<float>(std::max(0.0, quadric.evaluate(glm::dvec3(points[to]))));
+        heap.push(Collapse{cost, from, to, versions[from], versions[to]});
+    };
+    for (const auto &[key, uses] : edgeUses)
+    {
+        const uint32_t a = static_cast<uint32_t>(key >> 32), b = static_cast<uint32_t>(key & 0xFFFFFFFFu);
+        push(a, b);
+        push(b, a);
+    }
+    edgeUses = {};
+
+    auto contains = [&](uint32_t t, uint32_t v)
+    {
+        return topology[t * 3] == v || topology[t * 3 + 1] == v || topology[t * 3 + 2] == v;
+    };
+    // 去掉已删除的三角形, 并输出排序后的邻点
+    std::vector<uint32_t> fromNeighbors, toNeighbors;
+    auto collectNeighbors = [&](uint32_t v, std::vector<uint32_t> &out)
+    {
+        std::vector<uint32_t> &triangles = vertexTriangles[v];
+        triangles.erase(std::remove_if(triangles.begin(), triangles.end(), [&](uint32_t t)
+                                       { return !triangleAlive[t]; }),
+                        triangles.end());
+        out.clear();
+        for (uint32_t t : triangles)
+            for (int k = 0; k < 3; ++k)
+                if (topology[t * 3 + k] != v)
+                    out.push_back(topology[t * 3 + k]);
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    };
+
+    while (aliveTriangles * 3 > targetIndexCount && !heap.empty())
+    {
+        const Collapse collapse = heap.top();
+        heap.pop();
+        const uint32_t from = collapse.from, to = collapse.to;
+        if (!vertexAlive[from] || !vertexAlive[to] || versions[from] != collapse.fromVersion || versions[to] != collapse.toVersion)
+            continue;
+
+        // 链接条件: 两端的公共邻点只能是共享三角形的第三个顶点, 否则塌缩后出现非流形边
+        collectNeighbors(from, fromNeighbors);
+        collectNeighbors(to, toNeighbors);
+        std::vector<uint32_t> &fromTriangles = vertexTriangles[from];
+        size_t shared = 0;
+        uint32_t toCorner = NoVertex; // to 在共享三角形中的原顶点, 与 from 位于接缝同侧
+        for (uint32_t t : fromTriangles)
+        {
+            if (!contains(t, to))
+                continue;
+            ++shared;
+            for (int k = 0; k < 3; ++k)
+                if (topology[t * 3 + k] == to)
+                    toCorner = corners[t * 3 + k];
+        }
+        size_t common = 0;
+        for (size_t i = 0, j = 0; i < fromNeighbors.size() && j < toNeighbors.size();)
+        {
+            if (fromNeighbors[i] < toNeighbors[j])
+                ++i;
+            else if (fromNeighbors[i] > toNeighbors[j])
+                ++j;
+            else
+                ++common, ++i, ++j;
+        }
+        if (shared == 0 || common != shared)
+            continue;
+
+        // 其余三角形的法线转动超过约75度(含翻转)时放弃
+        bool flips = false;
+        for (uint32_t t : fromTriangles)
+        {
+            if (contains(t, to))
+                continue;
+            glm::vec3 p[3];
+            for (int k = 0; k < 3; ++k)
+                p[k] = points[topology[t * 3 + k]];
+            const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            for (int k = 0; k < 3; ++k)
+                if (topology[t * 3 + k] == from)
+                    p[k] = points[to];
+            const glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+            if (glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after))
+            {
+                flips = true;
+                break;
+            }
+        }
+        if (flips)
+            continue;
+
+        for (uint32_t t : fromTriangles)
+        {
+            if (contains(t, to))
+            {
+                triangleAlive[t] = 0;
+                --aliveTriangles;
+                continue;
+            }
+            for (int k = 0; k < 3; ++k)
+            {
+                if (topology[t * 3 + k] == from)
+                {
+                    topology[t * 3 + k] = to;
+                    corners[t * 3 + k] = toCorner;
+                }
+            }
+            vertexTriangles[to].push_back(t);
+        }
+        fromTriangles.clear();
+        vertexAlive[from] = 0;
+        quadrics[to] += quadrics[from];
+        versions[to]++;
+        error = std::max(error, std::sqrt(collapse.cost));
+
+        collectNeighbors(to, toNeighbors);
+        for (uint32_t neighbor : toNeighbors)
+        {
+            push(to, neighbor);
+            push(neighbor, to);
+        }
+    }
+
+    std::vector<unsigned int> result;
+    result.reserve(aliveTriangles * 3);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        if (triangleAlive[t])
+            result.insert(result.end(), {corners[t * 3], corners[t * 3 + 1], corners[t * 3 + 2]});
+    }
+    return result;
+}
+
+std::vector<MeshLod> MeshSimplifier::BuildLodChain(const float *positions, size_t stride, size_t vertexCount,
+                                                   const std::vector<unsigned int> &indices)
+{
+    std::vector<MeshLod> lods;
+    if (indices.size() / 3 < MinTrianglesForLod)
+        return lods;
+    lods.reserve(MaxLods);
+    // 每级从上一级继续简化, 误差按级累加作为相对原网格的上界
+    const std::vector<unsigned int> *source = &indices;
+    float accumulatedError = 0.0f;
+    while (lods.size() < MaxLods)
+    {
+        const size_t target = static_cast<size_t>(source->size() / 3 * LevelRatio) * 3;
+        float error = 0.0f;
+        std::vector<unsigned int> simplified = Simplify(positions, stride, vertexCount, *source, target, error);
+        if (simplified.empty() || simplified.size() * 10 > source->size() * 9)
+            break;
+        accumulatedError += error;
+        lods.push_back(MeshLod{std::move(simplified), accumulatedError});
+        source = &lods.back().indices;
+    }
+    return lods;
+}
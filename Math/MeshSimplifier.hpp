@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+二次误差度量(QEM)网格简化, 导入时为网格生成LOD链
+只做半边塌缩(顶点并入相邻顶点), 不产生新顶点: 各层级与原网格共用顶点缓冲, 只有索引不同
+位置相同的顶点视为同一拓扑顶点. 纹理/法线接缝上的顶点(同一位置有多个顶点)和开放边界上的顶点不会被移除, 避免撕开网格
+*/
+struct MeshLod
+{
+    std::vector<unsigned int> indices;
+    float error = 0.0f; // 相对原网格的近似几何误差, 模型空间长度
+};
+
+class MeshSimplifier
+{
+public:
+    static constexpr size_t MaxLods = 4; // 不含原始网格
+    // 三角形数少于此值的网格不生成LOD
+    static constexpr size_t MinTrianglesForLod = 256;
+    // 每一级的目标三角形数为上一级的比例
+    static constexpr float LevelRatio = 0.5f;
+
+    /// @brief 塌缩代价最小的边, 直到索引数不超过 targetIndexCount 或无边可塌缩
+    /// @param positions 顶点position首地址(3个float), stride 为相邻顶点之间的字节数
+    /// @param error 输出本次简化中最大的单次塌缩误差
+    /// @return 引用原顶点的索引
+    static std::vector<unsigned int> Simplify(const float *positions, size_t stride, size_t vertexCount,
+                                              const std::vector<unsigned int> &indices, size_t targetIndexCount, float &error);
+
+    /// @brief 逐级简化生成由细到粗的LOD链. 某一级减少不到10%的三角形时停止
+    static std::vector<MeshLod> BuildLodChain(const float *positions, size_t stride, size_t vertexCount,
+                                              const std::vector<unsigned int> &indices);
+};
@@ -0,0 +1,231 @@
+#include "Meshlet.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    constexpr uint32_t NoMeshlet = std::numeric_limits<uint32_t>::max();
+
+    glm::vec3 PositionAt(const float *positions, size_t stride, uint32_t vertex)
+    {
+        const float *p = reinterpret_cast<const float *>(reinterpret_cast<const char *>(positions) + vertex * stride);
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    // 未归一化的面法线, 长度为面积的2倍
+    glm::vec3 FaceNormal(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c)
+    {
+        return glm::cross(b - a, c - a);
+    }
+}
+
+std::vector<Meshlet> MeshletBuilder::Build(const float *positions, size_t stride, size_t vertexCount,
+                                           std::vector<unsigned int> &indices, size_t maxTriangles, size_t maxVertices)
+{
+    std::vector<Meshlet> meshlets;
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+        return meshlets;
+    maxTriangles = std::max<size_t>(1, maxTriangles);
+    maxVertices = std::max<size_t>(3, maxVertices);
+
+    // 顶点 -> 相邻三角形 (CSR)
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+        adjacencyOffsets[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v)
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t)
+            for (int k = 0; k < 3; ++k)
+                adjacency[cursor[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+    }
+
+    std::vector<glm::vec3> centroids(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        centroids[t] = (PositionAt(positions, stride, indices[t * 3]) +
+                        PositionAt(positions, stride, indices[t * 3 + 1]) +
+                        PositionAt(positions, stride, indices[t * 3 + 2])) /
+                       3.0f;
+    }
+
+    std::vector<unsigned int> reordered;
+    reordered.reserve(indices.size());
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> vertexMeshlet(vertexCount, NoMeshlet); // 顶点当前所属的簇
+    std::vector<uint32_t> frontier;
+    size_t seedCursor = 0;
+    size_t emittedCount = 0;
+
+    while (emittedCount < triangleCount)
+    {
+        const uint32_t meshletId = static_cast<uint32_t>(meshlets.size());
+        Meshlet meshlet;
+        meshlet.firstIndex = static_cast<uint32_t>(reordered.size());
+        size_t meshletVertices = 0;
+        size_t meshletTriangles = 0;
+        glm::vec3 centroidSum(0.0f);
+        frontier.clear();
+
+        const auto newVertexCount = [&](size_t t)
+        {
+            size_t count = 0;
+            for (int k = 0; k < 3; ++k)
+                count += vertexMeshlet[indices[t * 3 + k]] != meshletId ? 1 : 0;
+            return count;
+        };
+        const auto addTriangle = [&](size_t t)
+        {
+            emitted[t] = 1;
+            ++emittedCount;
+            ++meshletTriangles;
+            centroidSum += centroids[t];
+            for (int k = 0; k < 3; ++k)
+            {
+                const unsigned int v = indices[t * 3 + k];
+                reordered.push_back(v);
+                if (vertexMeshlet[v] == meshletId)
+                    continue;
+                vertexMeshlet[v] = meshletId;
+                ++meshletVertices;
+                for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; ++a)
+                {
+                    if (!emitted[adjacency[a]])
+                        frontier.push_back(adjacency[a]);
+                }
+            }
+        };
+
+        while (emitted[seedCursor])
+            ++seedCursor;
+        addTriangle(seedCursor);
+
+        while (meshletTriangles < maxTriangles)
+        {
+            // 优先选新增顶点最少的相邻三角形, 其次选离簇中心最近的
+            const glm::vec3 center = centroidSum / static_cast<float>(meshletTriangles);
+            size_t best = triangleCount;
+            size_t bestNew = 4;
+            float bestDistance = std::numeric_limits<float>::max();
+            size_t kept = 0;
+            for (uint32_t t : frontier)
+            {
+                if (emitted[t])
+                    continue;
+                frontier[kept++] = t;
+                const size_t added = newVertexCount(t);
+                if (meshletVertices + added > maxVertices || added > bestNew)
+                    continue;
+                const glm::vec3 d = centroids[t] - center;
+                const float distance = glm::dot(d, d);
+                if (added < bestNew || distance < bestDistance)
+                {
+                    best = t;
+                    bestNew = added;
+                    bestDistance = distance;
+                }
+            }
+            frontier.resize(kept);
+
+            if (best == triangleCount)
+            {
+                // 没有相邻三角形可用(不连通的部分): 取索引顺序上的下一个三角形
+                if (!frontier.empty())
+                    break;
+                while (seedCursor < triangleCount && emitted[seedCursor])
+                    ++seedCursor;
+                if (seedCursor == triangleCount || meshletVertices + newVertexCount(seedCursor) > maxVertices)
+                    break;
+                best = seedCursor;
+            }
+            addTriangle(best);
+        }
+
+        meshlet.indexCount = static_cast<uint32_t>(reordered.size()) - meshlet.firstIndex;
+        meshlets.push_back(meshlet);
+    }
+
+    indices.swap(reordered);
+    for (Meshlet &meshlet : meshlets)
+        ComputeBounds(meshlet, positions, stride, indices);
+    return meshlets;
+}
+
+void MeshletBuilder::ComputeBounds(Meshlet &meshlet, const float *positions, size_t stride, const std::vector<unsigned int> &indices)
+{
+    const uint32_t begin = meshlet.firstIndex;
+    const uint32_t end = meshlet.firstIndex + meshlet.indexCount;
+
+    // 包围球: 包围盒中心 + 最远顶点距离
+    glm::vec3 boxMin(std::numeric_limits<float>::max());
+    glm::vec3 boxMax(-std::numeric_limits<float>::max());
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const glm::vec3 p = PositionAt(positions, stride, indices[i]);
+        boxMin = glm::min(boxMin, p);
+        boxMax = glm::max(boxMax, p);
+    }
+    meshlet.center = (boxMin + boxMax) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const glm::vec3 d = PositionAt(positions, stride, indices[i]) - meshlet.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(d, d));
+    }
+    meshlet.radius = std::sqrt(radiusSquared);
+
+    // 法线锥: 轴为单位面法线之和的方向, 张角由与轴夹角最大的法线决定
+    meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    meshlet.coneCutoff = 1.0f;
+    meshlet.coneApex = meshlet.center;
+    glm::vec3 normalSum(0.0f);
+    for (uint32_t i = begin; i + 2 < end; i += 3)
+    {
+        const glm::vec3 n = FaceNormal(PositionAt(positions, stride, indices[i]),
+                                       PositionAt(positions, stride, indices[i + 1]),
+                                       PositionAt(positions, stride, indices[i + 2]));
+        const float length = glm::length(n);
+        if (length > 0.0f)
+            normalSum += n / length;
+    }
+    const float sumLength = glm::length(normalSum);
+    if (sumLength <= 1e-6f)
+        return;
+    const glm::vec3 axis = normalSum / sumLength;
+
+    float minDot = 1.0f;
+    for (uint32_t i = begin; i + 2 < end; i += 3)
+    {
+        const glm::vec3 n = FaceNormal(PositionAt(positions, stride, indices[i]),
+                                       PositionAt(positions, stride, indices[i + 1]),
+                                       PositionAt(positions, stride, indices[i + 2]));
+        const float length = glm::length(n);
+        if (length > 0.0f)
+            minDot = std::min(minDot, glm::dot(n / length, axis));
+    }
+    // 锥角接近或超过90度时背面测试几乎不会成立
+    if (minDot <= 0.1f)
+        return;
+
+    // 顶点沿轴向后移动, 直到位于所有三角形平面的背面一侧, 使测试对簇内任意点成立
+    float maxT = 0.0f;
+    for (uint32_t i = begin; i + 2 < end; i += 3)
+    {
+        const glm::vec3 p0 = PositionAt(positions, stride, indices[i]);
+        const glm::vec3 n = FaceNormal(p0, PositionAt(positions, stride, indices[i + 1]),
+                                       PositionAt(positions, stride, indices[i + 2]));
+        const float length = glm::length(n);
+        if (length <= 0.0f)
+            continue;
+        const glm::vec3 unitNormal = n / length;
+        const float t = glm::dot(meshlet.center - p0, unitNormal) / glm::dot(unitNormal, axis);
+        maxT = std::max(maxT, t);
+    }
+    meshlet.coneAxis = axis;
+    meshlet.coneApex = meshlet.center - axis * maxT;
+    meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+网格簇(meshlet): 索引缓冲中连续的一段三角形, 附带模型空间包围球与法线锥
+导入时由 MeshletBuilder::Build 重排三角形, 使每个簇在索引缓冲中连续. 整体绘制的结果不变
+法线锥: 簇内所有三角形的法线都在以 coneAxis 为轴的锥内.
+        normalize(coneApex - 观察点) 与 coneAxis 的点积 >= coneCutoff 时, 簇内三角形全部背向观察者
+*/
+struct Meshlet
+{
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+    glm::vec3 coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    float coneCutoff = 1.0f; // >= 1 表示法线分布太散, 不做背面剔除
+    glm::vec3 coneApex = glm::vec3(0.0f);
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+};
+
+class MeshletBuilder
+{
+public:
+    static constexpr size_t MaxTriangles = 124;
+    static constexpr size_t MaxVertices = 64;
+    // 三角形数少于此值的网格整体剔除即可, 不值得拆分
+    static constexpr size_t MinTrianglesToSplit = 4 * MaxTriangles;
+
+    /// @brief 沿共享顶点贪心生长出簇, 并按簇重排 indices
+    /// @param positions 顶点position首地址(3个float), stride 为相邻顶点之间的字节数
+    /// @return 按索引缓冲顺序排列的簇
+    static std::vector<Meshlet> Build(const float *positions, size_t stride, size_t vertexCount,
+                                      std::vector<unsigned int> &indices,
+                                      size_t maxTriangles = MaxTriangles, size_t maxVertices = MaxVertices);
+
+    /// @brief 计算 indices[firstIndex, firstIndex+indexCount) 的包围球与法线锥
+    static void ComputeBounds(Meshlet &meshlet, const float *positions, size_t stride, const std::vector<unsigned int> &indices);
+};
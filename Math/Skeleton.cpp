@@ -0,0 +1,106 @@
+#include "Skeleton.hpp"
+#include <algorithm>
+
+namespace
+{
+    // times[first, first+count) 中 time 所在的两帧与插值系数
+    struct KeyPair
+    {
+        uint32_t a;
+        uint32_t b;
+        float t;
+    };
+
+    KeyPair FindKeys(const std::vector<float> &times, const AnimationClip::Track &track, float time)
+    {
+        const float *begin = times.data() + track.first;
+        const float *end = begin + track.count;
+        if (track.count == 1 || time <= begin[0])
+            return {track.first, track.first, 0.0f};
+        if (time >= end[-1])
+            return {track.first + track.count - 1, track.first + track.count - 1, 0.0f};
+        const uint32_t b = static_cast<uint32_t>(std::upper_bound(begin, end, time) - times.data());
+        const uint32_t a = b - 1;
+        const float span = times[b] - times[a];
+        return {a, b, span > 0.0f ? (time - times[a]) / span : 0.0f};
+    }
+}
+
+uint32_t Skeleton::addJoint(const std::string &name, int32_t parent, const glm::mat4 &local)
+{
+    names.push_back(name);
+    parents.push_back(parent);
+    const glm::vec3 scale(glm::length(glm::vec3(local[0])), glm::length(glm::vec3(local[1])), glm::length(glm::vec3(local[2])));
+    const glm::mat3 basis(glm::vec3(local[0]) / std::max(scale.x, 1e-8f), glm::vec3(local[1]) / std::max(scale.y, 1e-8f),
+                          glm::vec3(local[2]) / std::max(scale.z, 1e-8f));
+    restTranslations.push_back(glm::vec3(local[3]));
+    restRotations.push_back(glm::normalize(glm::quat_cast(basis)));
+    restScales.push_back(scale);
+    return static_cast<uint32_t>(parents.size() - 1);
+}
+
+size_t Skeleton::findJoint(const std::string &name) const
+{
+    const auto it = std::find(names.begin(), names.end(), name);
+    return static_cast<size_t>(it - names.begin());
+}
+
+void Animation::Sample(const Skeleton &skeleton, const AnimationClip *clip, float time, SkeletonPose &pose)
+{
+    const size_t count = skeleton.jointCount();
+    pose.translations.assign(skeleton.restTranslations.begin(), skeleton.restTranslations.end());
+    pose.rotations.assign(skeleton.restRotations.begin(), skeleton.restRotations.end());
+    pose.scales.assign(skeleton.restScales.begin(), skeleton.restScales.end());
+    if (!clip)
+        return;
+
+    // 各分量单独一趟, 只访问有关键帧的轨道
+    for (size_t j = 0; j < count; ++j)
+    {
+        const AnimationClip::Track &track = clip->translationTracks[j];
+        if (track.count == 0)
+            continue;
+        const KeyPair keys = FindKeys(clip->translationTimes, track, time);
+        pose.translations[j] = glm::mix(clip->translations[keys.a], clip->translations[keys.b], keys.t);
+    }
+    for (size_t j = 0; j < count; ++j)
+    {
+        const AnimationClip::Track &track = clip->rotationTracks[j];
+        if (track.count == 0)
+            continue;
+        const KeyPair keys = FindKeys(clip->rotationTimes, track, time);
+        pose.rotations[j] = glm::normalize(glm::slerp(clip->rotations[keys.a], clip->rotations[keys.b], keys.t));
+    }
+    for (size_t j = 0; j < count; ++j)
+    {
+        const AnimationClip::Track &track = clip->scaleTracks[j];
+        if (track.count == 0)
+            continue;
+        const KeyPair keys = FindKeys(clip->scaleTimes, track, time);
+        pose.scales[j] = glm::mix(clip->scales[keys.a], clip->scales[keys.b], keys.t);
+    }
+}
+
+void Animation::BuildPalette(const Skeleton &skeleton, SkeletonPose &pose, glm::vec4 *palette)
+{
+    const size_t count = skeleton.jointCount();
+    pose.model.resize(count);
+    for (size_t j = 0; j < count; ++j)
+    {
+        glm::mat4 local = glm::mat4_cast(pose.rotations[j]);
+        local[0] *= pose.scales[j].x;
+        local[1] *= pose.scales[j].y;
+        local[2] *= pose.scales[j].z;
+        local[3] = glm::vec4(pose.translations[j], 1.0f);
+        const int32_t parent = skeleton.parents[j];
+        pose.model[j] = parent == Skeleton::NoParent ? local : pose.model[parent] * local;
+    }
+    for (size_t b = 0; b < skeleton.boneCount(); ++b)
+        StoreRows(skeleton.rootInverse * pose.model[skeleton.boneJoints[b]] * skeleton.inverseBind[b], palette + b * PaletteRowsPerBone);
+}
+
+void Animation::StoreRows(const glm::mat4 &matrix, glm::vec4 *rows)
+{
+    for (int r = 0; r < 3; ++r)
+        rows[r] = glm::vec4(matrix[0][r], matrix[1][r], matrix[2][r], matrix[3][r]);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+骨骼动画的CPU部分: 关节层级, 关键帧动画与姿态求值, 不依赖GL
+关节按父节点在前的顺序排列, 一次顺序遍历即可由局部变换得到模型空间变换
+姿态与动画通道按分量分开存放(平移/旋转/缩放各一个数组), 求值时各分量连续访问
+蒙皮矩阵(调色板)只存仿射部分的前三行, 每个骨骼3个vec4, 直接按此布局上传给蒙皮计算着色器
+*/
+struct Skeleton
+{
+    static constexpr int32_t NoParent = -1;
+
+    std::vector<std::string> names;
+    std::vector<int32_t> parents;      // 父关节下标小于自身
+    // 静止姿态的局部变换, 没有动画通道的分量使用它
+    std::vector<glm::vec3> restTranslations;
+    std::vector<glm::quat> restRotations;
+    std::vector<glm::vec3> restScales;
+    glm::mat4 rootInverse = glm::mat4(1.0f); // 根节点变换的逆, 蒙皮结果位于模型根空间
+
+    // 调色板中的骨骼: 所在关节与绑定姿态的逆矩阵(网格空间到骨骼空间)
+    std::vector<uint32_t> boneJoints;
+    std::vector<glm::mat4> inverseBind;
+
+    size_t jointCount() const { return parents.size(); }
+    size_t boneCount() const { return boneJoints.size(); }
+    /// @brief 追加关节, parent 须已加入. local 分解为平移/旋转/缩放, 不保留切变
+    /// @return 新关节的下标
+    uint32_t addJoint(const std::string &name, int32_t parent, const glm::mat4 &local);
+    /// @brief 名字对应的关节, 没有时返回 jointCount()
+    size_t findJoint(const std::string &name) const;
+};
+
+struct AnimationClip
+{
+    // 某个关节某一分量的关键帧在 times/values 中的区间, count 为 0 时使用静止姿态
+    struct Track
+    {
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+
+    std::string name;
+    float duration = 0.0f; // 秒
+
+    // 每个关节一条, 下标与 Skeleton 的关节一致
+    std::vector<Track> translationTracks;
+    std::vector<Track> rotationTracks;
+    std::vector<Track> scaleTracks;
+    // 关键帧时间(秒)与值, 同一轨道内按时间递增
+    std::vector<float> translationTimes;
+    std::vector<glm::vec3> translations;
+    std::vector<float> rotationTimes;
+    std::vector<glm::quat> rotations;
+    std::vector<float> scaleTimes;
+    std::vector<glm::vec3> scales;
+};
+
+/// @brief 一个骨架实例的姿态, 分量分开存放. 作为求值的临时空间可复用
+struct SkeletonPose
+{
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+    std::vector<glm::mat4> model; // 关节的模型空间变换
+};
+
+class Animation
+{
+public:
+    static constexpr size_t PaletteRowsPerBone = 3;
+
+    /// @brief 在 time 秒处对 clip 采样局部姿态. clip 为空时取静止姿态
+    static void Sample(const Skeleton &skeleton, const AnimationClip *clip, float time, SkeletonPose &pose);
+    /// @brief 由局部姿态计算模型空间变换, 并把每个骨骼的蒙皮矩阵前三行写入 palette(boneCount * 3 个 vec4)
+    static void BuildPalette(const Skeleton &skeleton, SkeletonPose &pose, glm::vec4 *palette);
+    /// @brief 蒙皮矩阵前三行
+    static void StoreRows(const glm::mat4 &matrix, glm::vec4 *rows);
+};
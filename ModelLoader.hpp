@@ -3,10 +3,12 @@
 #include <assimp/Importer.hpp>  // C++ importer interface
 #include <assimp/scene.h>       // Output data structure
 #include <assimp/postprocess.h> // Post processing flags
+#include <array>
 #include <unordered_map>
 #include <string>
 #include <filesystem>
 #include <future>
+#include <chrono>
 #include <thread>
 #include <atomic>
 #include <vector>
@@ -14,87 +16,81 @@
 #include "Utils/DebugOutput.hpp"
 #include "../Utils/TextureLoader.hpp"
 #include "Model.hpp"
+#include "Objects/Scene.hpp"
+#include "Objects/ClusteredMesh.hpp"
+#include "Objects/SkinnedModel.hpp"
+#include "Math/ClusterHierarchy.hpp"
 
 class ModelLoader
 {
-private:
-    inline static GLuint TextureFromFile(const char *file, const char *directory)
+public:
+    using PtrImporter = std::unique_ptr<Assimp::Importer>;
+    // 工作线程中由 aiMesh 生成的网格: 顶点与索引已优化, 网格簇与LOD已生成, 主线程只需注册材质并上传
+    struct PreparedMesh
     {
-        std::string texture_path = std::string(directory) + std::string(file);
-        if (tex_file_id.find(texture_path) != tex_file_id.end())
-        {
-            return tex_file_id[texture_path];
-        }
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        static int width, height, nrChannels;
-        // stbi_set_flip_vertically_on_load(true);
-
-        unsigned char *data = stbi_load(texture_path.c_str(), &width, &height, &nrChannels, 0);
-        if (data)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        }
-        else
-        {
-            std::cout << "Failed to load texture" << std::endl;
-        }
-
-        stbi_image_free(data);
+        std::vector<Mesh::Vertex> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<Meshlet> meshlets;
+        std::vector<MeshLod> lods;
+        std::string diffusePath; // 材质纹理的完整路径, 没有时为空
+        std::string specularPath;
+        bool optimized = false; // 没有顶点或三角形的网格不做优化
+        bool overdrawReordered = false;
+        size_t transformsBefore = 0;
+        size_t transformsAfter = 0;
+        size_t verticesBefore = 0;
+        double optimizeMs = 0.0;
+        double lodMs = 0.0;
+    };
+    struct LoadedModel
+    {
+        // aiScene 生命周期与 Importer 一致
+        const aiScene *scene = nullptr;
+        PtrImporter importer;
+        // 下标与 scene->mMeshes 一致. 带骨骼或动画的文件与不加入场景的读取不预处理, 为空
+        std::vector<PreparedMesh> meshes;
+    };
+    using ModelLoadFuture = std::future<LoadedModel>;
 
-        tex_file_id.insert(std::pair<std::string, GLuint>(texture_path, texture));
-        return texture;
-    }
-    inline static std::vector<Mesh::Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName)
+private:
+    // 材质的第一张 type 纹理的完整路径, 没有时为空
+    inline static std::string materialTexturePath(const aiMaterial *mat, aiTextureType type, const std::filesystem::path &directory)
     {
-        // in Mat
-        // do : load texture resources to GL
-        // out textures
-        std::vector<Mesh::Texture> textures;
-        for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
-        {
-            aiString str;
-            mat->GetTexture(type, i, &str);
-            Mesh::Texture texture;
-            DebugOutput::AddLog("texture:{}", str.C_Str());
-            std::string direction = current_file_path.parent_path().string() + "/";
-            texture.id = TextureFromFile(str.C_Str(), direction.c_str());
-            texture.type = typeName;
-            texture.path = str.C_Str();
-            textures.push_back(texture);
-        }
-        return textures;
+        if (mat->GetTextureCount(type) == 0)
+            return {};
+        aiString str;
+        mat->GetTexture(type, 0, &str);
+        return directory.string() + "/" + str.C_Str();
     }
-    inline static Mesh processMesh(aiMesh *mesh, const aiScene *scene)
+
+    /* 在读取文件的工作线程中调用, 不访问GL与全局状态
+     * 三角形网格依次做顶点缓存优化, 拆分网格簇或按过度绘制重排, 顶点按使用顺序重排, 最后逐级简化出LOD链
+     */
+    inline static PreparedMesh prepareMesh(const aiMesh &mesh, const aiScene &scene, const std::filesystem::path &directory)
     {
-        std::vector<Mesh::Vertex> vertices;
-        std::vector<unsigned int> indices;
-        std::vector<Mesh::Texture> textures;
+        PreparedMesh prepared;
+        std::vector<Mesh::Vertex> &vertices = prepared.vertices;
+        std::vector<unsigned int> &indices = prepared.indices;
 
-        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+        vertices.reserve(mesh.mNumVertices);
+        for (unsigned int i = 0; i < mesh.mNumVertices; i++)
         {
             Mesh::Vertex vertex;
             glm::vec3 vector;
-            vector.x = mesh->mVertices[i].x;
-            vector.y = mesh->mVertices[i].y;
-            vector.z = mesh->mVertices[i].z;
+            vector.x = mesh.mVertices[i].x;
+            vector.y = mesh.mVertices[i].y;
+            vector.z = mesh.mVertices[i].z;
             vertex.position = vector;
-            vector.x = mesh->mNormals[i].x;
-            vector.y = mesh->mNormals[i].y;
-            vector.z = mesh->mNormals[i].z;
+            vector.x = mesh.mNormals[i].x;
+            vector.y = mesh.mNormals[i].y;
+            vector.z = mesh.mNormals[i].z;
             vertex.normal = vector;
 
-            if (mesh->mTextureCoords[0]) // does the mesh contain texture coordinates? //默认不同纹理,纹理坐标相同,所以取0
+            if (mesh.mTextureCoords[0]) // does the mesh contain texture coordinates? //默认不同纹理,纹理坐标相同,所以取0
             {
                 glm::vec2 vec;
-                vec.x = mesh->mTextureCoords[0][i].x;
-                vec.y = mesh->mTextureCoords[0][i].y;
+                vec.x = mesh.mTextureCoords[0][i].x;
+                vec.y = mesh.mTextureCoords[0][i].y;
                 vertex.texCoord = vec;
             }
             else
@@ -102,80 +98,395 @@ private:
             vertices.push_back(vertex);
         }
         // process indices
-        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+        for (unsigned int i = 0; i < mesh.mNumFaces; i++)
         {
-            aiFace face = mesh->mFaces[i];
+            const aiFace &face = mesh.mFaces[i];
             for (unsigned int j = 0; j < face.mNumIndices; j++)
                 indices.push_back(face.mIndices[j]);
         }
 
-        if (mesh->mMaterialIndex >= 0)
+        // 纹理打包进 MaterialLibrary 的纹理数组需要GL上下文, 这里只记录路径
+        const aiMaterial *material = scene.mMaterials[mesh.mMaterialIndex];
+        prepared.diffusePath = materialTexturePath(material, aiTextureType_DIFFUSE, directory);
+        prepared.specularPath = materialTexturePath(material, aiTextureType_SPECULAR, directory);
+
+        // 文件中可能出现没有顶点或面的网格, 以下的优化, 簇与LOD都要求至少一个三角形
+        if (vertices.empty() || indices.size() < 3)
+            return prepared;
+        prepared.optimized = true;
+
+        const bool triangles = mesh.mPrimitiveTypes == aiPrimitiveType_TRIANGLE;
+        const auto optimizeStart = std::chrono::steady_clock::now();
+        prepared.transformsBefore = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+        prepared.verticesBefore = vertices.size();
+        if (triangles)
+            MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), vertices.size());
+
+        // 大网格拆成簇, 供GPU驱动路径逐簇剔除. 只重排三角形顺序, 簇内再做一次缓存优化
+        // 不拆分的网格在缓存优化的结果上按段重排以减少过度绘制
+        if (triangles && indices.size() / 3 >= MeshletBuilder::MinTrianglesToSplit)
         {
-            aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-            std::vector<Mesh::Texture> diffuseMaps = loadMaterialTextures(material,
-                                                                          aiTextureType_DIFFUSE, "texture_diffuse");
-            textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-            std::vector<Mesh::Texture> specularMaps = loadMaterialTextures(material,
-                                                                           aiTextureType_SPECULAR, "texture_specular");
-            textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+            prepared.meshlets = MeshletBuilder::Build(&vertices[0].position.x, sizeof(Mesh::Vertex), vertices.size(), indices);
+            MeshOptimizer::OptimizeMeshletVertexCache(indices, prepared.meshlets, vertices.size());
         }
+        else if (triangles)
+            prepared.overdrawReordered = MeshOptimizer::OptimizeOverdraw(indices, &vertices[0].position.x, sizeof(Mesh::Vertex), vertices.size());
+
+        // 顶点按首次使用的顺序排列, 之后的LOD在新编号上生成
+        size_t vertexCount = 0;
+        const std::vector<uint32_t> remap = MeshOptimizer::OptimizeVertexFetchRemap(indices, vertices.size(), vertexCount);
+        vertices = MeshOptimizer::RemapVertices(vertices, remap, vertexCount);
+        prepared.transformsAfter = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+        prepared.optimizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - optimizeStart).count();
 
-        DebugOutput::AddLog("Successfully ProcessMesh vertices:{},indices:{},textures:{}\n", vertices.size(), indices.size(), textures.size());
-        return Mesh(vertices, indices, textures);
+        // 由重排后的索引逐级简化出LOD链
+        if (triangles)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            prepared.lods = MeshSimplifier::BuildLodChain(&vertices[0].position.x, sizeof(Mesh::Vertex), vertices.size(), indices);
+            for (MeshLod &lod : prepared.lods)
+                MeshOptimizer::OptimizeVertexCache(lod.indices.data(), lod.indices.size(), vertices.size());
+            prepared.lodMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        return prepared;
     }
 
-    /* [in]: loadedScene : Obj file imported in memory
-     *  [out]: ptr Model : Model object, which is loaded to OpenGL context
-     *  [process]: OpenGL Object Binding needs synchrours operation
+    /* [in]: prepared : 工作线程处理好的网格, 可被同一文件的多个实例共用
+     *  [out]: 注册材质并上传后的网格. 需在GL线程调用, 导入统计在此累加
      */
-    inline static std::unique_ptr<Model> postProcess(const aiScene &loadedScene,std::filesystem::path& file_name)
+    inline static Mesh createMesh(const PreparedMesh &prepared)
     {
-        DebugOutput::AddLog("nums of Children of Root Node:{}\n", loadedScene.mRootNode->mNumChildren);
-        std::unique_ptr<Model> model = std::make_unique<Model>(file_name.string());//TODO :使得物体名字唯一
-        for (int i = 0; i < loadedScene.mRootNode->mNumChildren; ++i)
+        const std::vector<Mesh::Vertex> &vertices = prepared.vertices;
+        const std::vector<unsigned int> &indices = prepared.indices;
+        if (!prepared.diffusePath.empty())
+            DebugOutput::AddLog("texture:{}", prepared.diffusePath);
+        if (!prepared.specularPath.empty())
+            DebugOutput::AddLog("texture:{}", prepared.specularPath);
+        const uint32_t materialId = MaterialLibrary::Get().addMaterial(prepared.diffusePath, prepared.specularPath);
+
+        if (!prepared.optimized)
+        {
+            DebugOutput::AddLog("Skipped optimizing empty mesh vertices:{},indices:{}\n", vertices.size(), indices.size());
+            return Mesh(vertices, indices, materialId);
+        }
+
+        for (const MeshLod &lod : prepared.lods)
+            DebugOutput::AddLog("LOD triangles:{},error:{}\n", lod.indices.size() / 3, lod.error);
+        if (!prepared.lods.empty())
+            DebugOutput::AddLog("LOD chain built in {:.2f} ms\n", prepared.lodMs);
+
+        DebugOutput::AddLog("Successfully ProcessMesh vertices:{},indices:{},material:{},meshlets:{},lods:{}\n", vertices.size(), indices.size(), materialId, prepared.meshlets.size(), prepared.lods.size());
+        Mesh result(vertices, indices, materialId, prepared.meshlets, prepared.lods);
+
+        const size_t triangleCount = std::max<size_t>(indices.size() / 3, 1);
+        const size_t bytesBefore = sizeof(Mesh::Vertex);
+        const size_t bytesAfter = static_cast<size_t>(result.gpuVertexStride());
+        const size_t indexSizeAfter = static_cast<size_t>(result.gpuIndexSize());
+        DebugOutput::AddLog("Optimized mesh in {:.2f} ms ACMR:{:.3f}->{:.3f},bytes/vertex:{}->{},index bytes:{}->{},overdraw reordered:{}\n",
+                            prepared.optimizeMs, double(prepared.transformsBefore) / triangleCount, double(prepared.transformsAfter) / triangleCount,
+                            bytesBefore, bytesAfter, sizeof(unsigned int), indexSizeAfter, prepared.overdrawReordered);
+        optimize_stats.meshes++;
+        optimize_stats.triangles += indices.size() / 3;
+        optimize_stats.transformsBefore += prepared.transformsBefore;
+        optimize_stats.transformsAfter += prepared.transformsAfter;
+        optimize_stats.vertices += vertices.size();
+        optimize_stats.vertexBytesBefore += prepared.verticesBefore * bytesBefore;
+        optimize_stats.vertexBytesAfter += vertices.size() * bytesAfter;
+        optimize_stats.indexBytesBefore += indices.size() * sizeof(unsigned int);
+        optimize_stats.indexBytesAfter += indices.size() * indexSizeAfter;
+        optimize_stats.overdrawReordered += prepared.overdrawReordered ? 1 : 0;
+        optimize_stats.compactMeshes += bytesAfter < bytesBefore ? 1 : 0;
+        optimize_stats.shortIndexMeshes += indexSizeAfter < sizeof(unsigned int) ? 1 : 0;
+        optimize_stats.optimizeMs += prepared.optimizeMs;
+        return result;
+    }
+
+    // assimp 矩阵为行主序, glm 为列主序
+    inline static glm::mat4 toGlmMatrix(const aiMatrix4x4 &m)
+    {
+        return glm::mat4(
+            m.a1, m.b1, m.c1, m.d1,
+            m.a2, m.b2, m.c2, m.d2,
+            m.a3, m.b3, m.c3, m.d3,
+            m.a4, m.b4, m.c4, m.d4);
+    }
+
+    // 把所有节点的网格按世界矩阵合并为一个网格, 用于构建簇层级
+    inline static void flattenNode(const aiNode &node, const aiScene &loadedScene, const glm::mat4 &parentTransform,
+                                   std::vector<ClusterHierarchy::ClusterVertex> &vertices, std::vector<uint32_t> &indices)
+    {
+        const glm::mat4 transform = parentTransform * toGlmMatrix(node.mTransformation);
+        const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+        for (unsigned int i = 0; i < node.mNumMeshes; ++i)
+        {
+            const aiMesh *mesh = loadedScene.mMeshes[node.mMeshes[i]];
+            if (mesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE)
+                continue;
+            const uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
+            for (unsigned int v = 0; v < mesh->mNumVertices; ++v)
+            {
+                ClusterHierarchy::ClusterVertex vertex;
+                const aiVector3D &p = mesh->mVertices[v];
+                vertex.position = glm::vec3(transform * glm::vec4(p.x, p.y, p.z, 1.0f));
+                const glm::vec3 normal = mesh->mNormals ? glm::vec3(mesh->mNormals[v].x, mesh->mNormals[v].y, mesh->mNormals[v].z) : glm::vec3(0.0f, 1.0f, 0.0f);
+                vertex.normal = glm::normalize(normalMatrix * normal);
+                vertex.texCoord = mesh->mTextureCoords[0] ? glm::vec2(mesh->mTextureCoords[0][v].x, mesh->mTextureCoords[0][v].y) : glm::vec2(0.0f);
+                vertices.push_back(vertex);
+            }
+            for (unsigned int f = 0; f < mesh->mNumFaces; ++f)
+            {
+                const aiFace &face = mesh->mFaces[f];
+                for (unsigned int j = 0; j < face.mNumIndices; ++j)
+                    indices.push_back(baseVertex + face.mIndices[j]);
+            }
+        }
+        for (unsigned int i = 0; i < node.mNumChildren; ++i)
+            flattenNode(*node.mChildren[i], loadedScene, transform, vertices, indices);
+    }
+
+    /* [in]: node : 当前 assimp 节点
+     *  [in]: parent : 父节点在场景中的句柄
+     *  [out]: 节点及其子节点按原层级加入 scene, 局部矩阵取自 node.mTransformation
+     *  [process]: OpenGL Object Binding needs synchrours operation. 网格已在工作线程处理好, 这里只上传
+     */
+    inline static SceneHandle processNode(Scene &scene, const aiNode &node, const LoadedModel &loaded, const std::string &name, SceneHandle parent)
+    {
+        const aiScene &loadedScene = *loaded.scene;
+        std::unique_ptr<Model> model = std::make_unique<Model>(name);
+        DebugOutput::AddLog("nums of Meshes of Node {}:{}\n", name, node.mNumMeshes);
+        for (unsigned int i = 0; i < node.mNumMeshes; ++i)
+        {
+            auto &mesh = loadedScene.mMeshes[node.mMeshes[i]];
+            DebugOutput::AddLog("Name of Meshes of Node {}:{}\n", name, std::string(mesh->mName.C_Str()));
+            auto &mat = loadedScene.mMaterials[mesh->mMaterialIndex];
+            DebugOutput::AddLog("Name of Materials of Node {}:{}\n", name, std::string(mat->GetName().C_Str()));
+            DebugOutput::AddLog("Nums of DIFFUSE of Node {}:{}\n", name, mat->GetTextureCount(aiTextureType_DIFFUSE));
+            DebugOutput::AddLog("Nums of AMBIENT of Node {}:{}\n", name, mat->GetTextureCount(aiTextureType_AMBIENT));
+            DebugOutput::AddLog("Nums of SPECULAR of Node {}:{}\n", name, mat->GetTextureCount(aiTextureType_SPECULAR));
+
+            model->meshes.emplace_back(createMesh(loaded.meshes[node.mMeshes[i]]));
+        }
+        model->updateBounds();
+        SceneHandle handle = scene.addObject(std::move(model), toGlmMatrix(node.mTransformation), parent);
+        for (unsigned int i = 0; i < node.mNumChildren; ++i)
+        {
+            const aiNode &child = *node.mChildren[i];
+            std::string childName = child.mName.length > 0 ? std::string(child.mName.C_Str()) : name + "_" + std::to_string(i);
+            processNode(scene, child, loaded, childName, handle);
+        }
+        return handle;
+    }
+
+    inline static bool hasAnimation(const aiScene &loadedScene)
+    {
+        if (loadedScene.mNumAnimations > 0)
+            return true;
+        for (unsigned int i = 0; i < loadedScene.mNumMeshes; ++i)
+        {
+            if (loadedScene.mMeshes[i]->HasBones())
+                return true;
+        }
+        return false;
+    }
+
+    /* 带骨骼或动画的文件作为一个 SkinnedModel 加入场景
+     * 所有节点成为骨架的关节; 不带骨骼的网格视为完全绑定到所在节点, 随节点动画一起运动
+     * 顶点不重排, 只做顶点缓存优化, 不生成网格簇与LOD
+     */
+    inline static SceneHandle processSkinned(Scene &scene, const aiScene &loadedScene, const std::string &name)
+    {
+        auto asset = std::make_shared<SkinnedAsset>();
+        Skeleton &skeleton = asset->skeleton;
+
+        // 深度优先, 父关节在前
+        std::vector<const aiNode *> nodes;
+        std::vector<std::pair<const aiNode *, int32_t>> stack{{loadedScene.mRootNode, Skeleton::NoParent}};
+        while (!stack.empty())
+        {
+            auto [node, parent] = stack.back();
+            stack.pop_back();
+            const uint32_t joint = skeleton.addJoint(node->mName.C_Str(), parent, toGlmMatrix(node->mTransformation));
+            nodes.push_back(node);
+            for (unsigned int i = node->mNumChildren; i-- > 0;)
+                stack.emplace_back(node->mChildren[i], static_cast<int32_t>(joint));
+        }
+        const glm::mat4 rootTransform = toGlmMatrix(loadedScene.mRootNode->mTransformation);
+        skeleton.rootInverse = glm::inverse(rootTransform);
+
+        // 同名骨骼在各网格间共用调色板下标, 刚性绑定的节点以关节下标区分
+        std::unordered_map<std::string, uint32_t> boneIndex;
+        auto addBone = [&](const std::string &key, uint32_t joint, const glm::mat4 &inverseBind)
         {
-            // DebugOutput::AddLog("nums of Children of Node{}:{}\n", i, loadedScene.mRootNode->mChildren[i]->mNumChildren);
-            auto &node = *(loadedScene.mRootNode->mChildren[i]);
-            // node.mNumMeshes
-            DebugOutput::AddLog("nums of Meshes of Node{}:{}\n", i, node.mNumMeshes);
-            auto &mesh_id = node.mMeshes[0];
-            auto &mesh = loadedScene.mMeshes[mesh_id];
-            // mesh->mName
-            DebugOutput::AddLog("Name of Meshes of Node{}:{}\n", i, std::string(mesh->mName.C_Str()));
-            auto &mat_id = mesh->mMaterialIndex;
-            auto &mat = loadedScene.mMaterials[mat_id];
-            DebugOutput::AddLog("Name of Materials of Node{}:{}\n", i, std::string(mat->GetName().C_Str()));
-            DebugOutput::AddLog("Nums of DIFFUSE of Node{}:{}\n", i, mat->GetTextureCount(aiTextureType_DIFFUSE));
-            DebugOutput::AddLog("Nums of AMBIENT of Node{}:{}\n", i, mat->GetTextureCount(aiTextureType_AMBIENT));
-            DebugOutput::AddLog("Nums of SPECULAR of Node{}:{}\n", i, mat->GetTextureCount(aiTextureType_SPECULAR));
+            auto [it, inserted] = boneIndex.emplace(key, static_cast<uint32_t>(skeleton.boneCount()));
+            if (inserted)
+            {
+                skeleton.boneJoints.push_back(joint);
+                skeleton.inverseBind.push_back(inverseBind);
+            }
+            return it->second;
+        };
+
+        std::vector<bool> meshDone(loadedScene.mNumMeshes, false);
+        std::vector<std::array<std::pair<float, uint32_t>, SkinnedAsset::MaxInfluences>> influences;
+        for (uint32_t joint = 0; joint < nodes.size(); ++joint)
+        {
+            const aiNode &node = *nodes[joint];
+            for (unsigned int m = 0; m < node.mNumMeshes; ++m)
+            {
+                const aiMesh *mesh = loadedScene.mMeshes[node.mMeshes[m]];
+                // 蒙皮网格的顶点不受所在节点变换影响, 被多个节点引用时只需一份
+                if (mesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE || (mesh->HasBones() && meshDone[node.mMeshes[m]]))
+                    continue;
+                meshDone[node.mMeshes[m]] = true;
+
+                // 每个顶点保留权重最大的若干个骨骼
+                influences.assign(mesh->mNumVertices, {});
+                for (unsigned int b = 0; b < mesh->mNumBones; ++b)
+                {
+                    const aiBone &bone = *mesh->mBones[b];
+                    const size_t boneJoint = skeleton.findJoint(bone.mName.C_Str());
+                    if (boneJoint >= skeleton.jointCount())
+                        continue;
+                    const uint32_t palette = addBone(bone.mName.C_Str(), static_cast<uint32_t>(boneJoint), toGlmMatrix(bone.mOffsetMatrix));
+                    for (unsigned int w = 0; w < bone.mNumWeights; ++w)
+                    {
+                        auto &slots = influences[bone.mWeights[w].mVertexId];
+                        auto weakest = std::min_element(slots.begin(), slots.end());
+                        if (bone.mWeights[w].mWeight > weakest->first)
+                            *weakest = {bone.mWeights[w].mWeight, palette};
+                    }
+                }
+
+                SkinnedAsset::Part part;
+                part.firstSource = static_cast<uint32_t>(asset->sources.size());
+                part.vertexCount = mesh->mNumVertices;
+                for (unsigned int v = 0; v < mesh->mNumVertices; ++v)
+                {
+                    auto &slots = influences[v];
+                    float total = 0.0f;
+                    for (const auto &slot : slots)
+                        total += slot.first;
+                    if (total <= 0.0f)
+                    {
+                        // 没有骨骼权重的顶点跟随所在节点
+                        slots[0] = {1.0f, addBone("#node" + std::to_string(joint), joint, glm::mat4(1.0f))};
+                        total = 1.0f;
+                    }
+                    SkinnedAsset::SourceVertex vertex{};
+                    const glm::vec2 texCoord = mesh->mTextureCoords[0] ? glm::vec2(mesh->mTextureCoords[0][v].x, mesh->mTextureCoords[0][v].y) : glm::vec2(0.0f);
+                    const glm::vec3 normal = mesh->mNormals ? glm::vec3(mesh->mNormals[v].x, mesh->mNormals[v].y, mesh->mNormals[v].z) : glm::vec3(0.0f, 1.0f, 0.0f);
+                    vertex.positionU = glm::vec4(mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z, texCoord.x);
+                    vertex.normalV = glm::vec4(normal, texCoord.y);
+                    for (int k = 0; k < SkinnedAsset::MaxInfluences; ++k)
+                    {
+                        const uint32_t weight = static_cast<uint32_t>(std::lround(slots[k].first / total * 65535.0f));
+                        vertex.joints[k / 2] |= (weight ? slots[k].second : 0u) << (16 * (k % 2));
+                        vertex.weights[k / 2] |= weight << (16 * (k % 2));
+                    }
+                    asset->sources.push_back(vertex);
+                }
+                for (unsigned int f = 0; f < mesh->mNumFaces; ++f)
+                {
+                    const aiFace &face = mesh->mFaces[f];
+                    for (unsigned int j = 0; j < face.mNumIndices; ++j)
+                        part.indices.push_back(face.mIndices[j]);
+                }
+                MeshOptimizer::OptimizeVertexCache(part.indices.data(), part.indices.size(), part.vertexCount);
+                aiMaterial *material = loadedScene.mMaterials[mesh->mMaterialIndex];
+                part.materialId = MaterialLibrary::Get().addMaterial(materialTexturePath(material, aiTextureType_DIFFUSE, current_file_path.parent_path()),
+                                                                     materialTexturePath(material, aiTextureType_SPECULAR, current_file_path.parent_path()));
+                asset->parts.push_back(std::move(part));
+            }
+        }
 
-            model->meshes.emplace_back(processMesh(mesh, &loadedScene));
+        // 关键帧时间由 tick 换算为秒
+        for (unsigned int a = 0; a < loadedScene.mNumAnimations; ++a)
+        {
+            const aiAnimation &animation = *loadedScene.mAnimations[a];
+            const double ticksPerSecond = animation.mTicksPerSecond > 0.0 ? animation.mTicksPerSecond : 25.0;
+            AnimationClip clip;
+            clip.name = animation.mName.length > 0 ? std::string(animation.mName.C_Str()) : "Clip" + std::to_string(a);
+            clip.duration = static_cast<float>(animation.mDuration / ticksPerSecond);
+            clip.translationTracks.resize(skeleton.jointCount());
+            clip.rotationTracks.resize(skeleton.jointCount());
+            clip.scaleTracks.resize(skeleton.jointCount());
+            for (unsigned int c = 0; c < animation.mNumChannels; ++c)
+            {
+                const aiNodeAnim &channel = *animation.mChannels[c];
+                const size_t joint = skeleton.findJoint(channel.mNodeName.C_Str());
+                if (joint >= skeleton.jointCount())
+                    continue;
+                clip.translationTracks[joint] = {static_cast<uint32_t>(clip.translationTimes.size()), channel.mNumPositionKeys};
+                for (unsigned int k = 0; k < channel.mNumPositionKeys; ++k)
+                {
+                    const aiVectorKey &key = channel.mPositionKeys[k];
+                    clip.translationTimes.push_back(static_cast<float>(key.mTime / ticksPerSecond));
+                    clip.translations.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z);
+                }
+                clip.rotationTracks[joint] = {static_cast<uint32_t>(clip.rotationTimes.size()), channel.mNumRotationKeys};
+                for (unsigned int k = 0; k < channel.mNumRotationKeys; ++k)
+                {
+                    const aiQuatKey &key = channel.mRotationKeys[k];
+                    clip.rotationTimes.push_back(static_cast<float>(key.mTime / ticksPerSecond));
+                    clip.rotations.emplace_back(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z);
+                }
+                clip.scaleTracks[joint] = {static_cast<uint32_t>(clip.scaleTimes.size()), channel.mNumScalingKeys};
+                for (unsigned int k = 0; k < channel.mNumScalingKeys; ++k)
+                {
+                    const aiVectorKey &key = channel.mScalingKeys[k];
+                    clip.scaleTimes.push_back(static_cast<float>(key.mTime / ticksPerSecond));
+                    clip.scales.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z);
+                }
+            }
+            asset->clips.push_back(std::move(clip));
         }
-        return model;
+
+        asset->computeBounds();
+        DebugOutput::AddLog("Skinned model {}: {} joints, {} bones, {} clips, {} meshes, {} vertices\n", name, skeleton.jointCount(),
+                            skeleton.boneCount(), asset->clips.size(), asset->parts.size(), asset->sources.size());
+        return scene.addObject(std::make_unique<SkinnedModel>(std::move(asset), name), rootTransform);
+    }
+
+    /* [in]: loaded : Obj file imported in memory, 网格已由 LoadModelAsync 预处理
+     *  [out]: 根节点句柄, 根节点以文件名命名, 子节点保持 assimp 层级. 带骨骼或动画的文件为一个 SkinnedModel
+     */
+    inline static SceneHandle postProcess(Scene &scene, const LoadedModel &loaded, std::filesystem::path &file_name)
+    {
+        const aiScene &loadedScene = *loaded.scene;
+        DebugOutput::AddLog("nums of Children of Root Node:{}\n", loadedScene.mRootNode->mNumChildren);
+        if (hasAnimation(loadedScene))
+            return processSkinned(scene, loadedScene, file_name.string());
+        if (loaded.meshes.size() != loadedScene.mNumMeshes)
+            throw std::runtime_error("Model meshes were not prepared: " + file_name.string());
+        return processNode(scene, *loadedScene.mRootNode, loaded, file_name.string(), SceneHandle{});
     }
 
 public:
-    using PtrImporter = std::unique_ptr<Assimp::Importer>;
-    using ModelLoadFuture = std::future<std::pair<const aiScene *, PtrImporter>>;
     struct ImportingContext
     {
         ModelLoadFuture model_future;
         std::string file_path;
     };
-    inline static std::unordered_map<std::string, GLuint> tex_file_id;
     inline static std::filesystem::path current_file_path;
     inline static std::vector<ImportingContext> importing_vec;
+    // 簇层级文件: 工作线程读取元数据, 读取后加入场景
+    inline static std::vector<std::pair<std::future<ClusterHierarchy>, std::string>> cluster_loading_vec;
+    // 离线构建的簇层级文件
+    inline static std::vector<std::pair<std::future<ClusterHierarchy::BuildStats>, std::string>> cluster_building_vec;
+    // 导入时网格优化的累计统计
+    inline static MeshOptimizer::Stats optimize_stats;
 
 public:
     ModelLoader()
     {
     }
-    ModelLoadFuture inline static LoadModelAsync(const std::string &path)
+    /// @param prepareMeshes 在工作线程中完成网格优化, 网格簇与LOD的生成, 结果要加入场景时必须为 true
+    ModelLoadFuture inline static LoadModelAsync(const std::string &path, bool prepareMeshes = true)
     {
         // aiScene 必须在 Importer 上下文环境才有效
         // aiScene 生命周期必须与 Importer 一致
         return std::async(
-            std::launch::async, [path]
+            std::launch::async, [path, prepareMeshes]
             {   
                 auto importer = std::make_unique<Assimp::Importer>();
                 const aiScene* scene = importer->ReadFile(
@@ -183,20 +494,56 @@ public:
                     aiProcess_CalcTangentSpace |
                     aiProcess_Triangulate |
                     aiProcess_JoinIdenticalVertices |
+                    aiProcess_LimitBoneWeights |
                     aiProcess_SortByPType);
                 
                 if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) {
                     throw std::runtime_error("Load Failed: " + std::string(importer->GetErrorString()));
                 }
-                return std::make_pair(scene, std::move(importer)); });
+                LoadedModel loaded;
+                loaded.scene = scene;
+                loaded.importer = std::move(importer);
+                if (prepareMeshes && !hasAnimation(*scene))
+                {
+                    const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+                    loaded.meshes.reserve(scene->mNumMeshes);
+                    for (unsigned int i = 0; i < scene->mNumMeshes; ++i)
+                        loaded.meshes.push_back(prepareMesh(*scene->mMeshes[i], *scene, directory));
+                }
+                return loaded; });
     }
 
-    // 发送加载模型请求
+    // 发送加载模型请求. .clusters 文件作为流式网格加载
     inline static void loadFile(const std::string &pFile)
     {
+        if (std::filesystem::path(pFile).extension() == ".clusters")
+        {
+            cluster_loading_vec.emplace_back(std::async(std::launch::async, [pFile]
+                                                        { return ClusterHierarchy::Load(pFile); }),
+                                             pFile);
+            return;
+        }
         importing_vec.emplace_back(ImportingContext{LoadModelAsync(pFile), pFile});
     }
 
+    /* 在工作线程读取模型文件, 合并为一个网格后构建簇层级, 写入同目录下的同名 .clusters 文件
+     * 构建期间整个网格位于内存中, 运行时只读取元数据与所需的页
+     */
+    inline static void buildClusterFile(const std::string &pFile)
+    {
+        std::filesystem::path output(pFile);
+        output.replace_extension(".clusters");
+        cluster_building_vec.emplace_back(std::async(std::launch::async, [pFile, output]
+                                                     {
+                LoadedModel loaded = LoadModelAsync(pFile, false).get();
+                std::vector<ClusterHierarchy::ClusterVertex> vertices;
+                std::vector<uint32_t> indices;
+                flattenNode(*loaded.scene->mRootNode, *loaded.scene, glm::mat4(1.0f), vertices, indices);
+                loaded.importer.reset();
+                return ClusterHierarchy::Build(vertices, indices, output); }),
+                                          output.string());
+    }
+
     // TODO 异常处理优化 ; 进度输出;
     /*
     [in]: scene 场景对象
@@ -204,6 +551,7 @@ public:
     */
     inline static void run(Scene &scene)
     {
+        runClusterFiles(scene);
         auto it = importing_vec.begin();
         while (it != importing_vec.end())
         {
@@ -220,14 +568,65 @@ public:
             }
         }
     }
+    inline static void runClusterFiles(Scene &scene)
+    {
+        for (auto it = cluster_loading_vec.begin(); it != cluster_loading_vec.end();)
+        {
+            if (it->first.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready)
+            {
+                ++it;
+                continue;
+            }
+            try
+            {
+                ClusterHierarchy hierarchy = it->first.get();
+                DebugOutput::AddLog("Cluster file {}: {} triangles, {} clusters, {} pages\n", it->second,
+                                    hierarchy.header.sourceTriangles, hierarchy.clusters.size(), hierarchy.pages.size());
+                scene.addObject(std::make_unique<ClusteredMesh>(std::move(hierarchy), it->second), glm::mat4(1.0f));
+            }
+            catch (std::exception &e)
+            {
+                std::cout << e.what() << std::endl;
+            }
+            it = cluster_loading_vec.erase(it);
+        }
+        for (auto it = cluster_building_vec.begin(); it != cluster_building_vec.end();)
+        {
+            if (it->first.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready)
+            {
+                ++it;
+                continue;
+            }
+            try
+            {
+                const ClusterHierarchy::BuildStats stats = it->first.get();
+                DebugOutput::AddLog("Built {}: {} triangles -> {} clusters, {} groups, {} pages, {} levels, root {} triangles, {:.1f} MB, {:.0f} ms\n",
+                                    it->second, stats.sourceTriangles, stats.clusters, stats.groups, stats.pages, stats.levels,
+                                    stats.rootTriangles, stats.fileBytes / (1024.0 * 1024.0), stats.buildMs);
+            }
+            catch (std::exception &e)
+            {
+                std::cout << e.what() << std::endl;
+            }
+            it = cluster_building_vec.erase(it);
+        }
+    }
+    /* [in]: loaded : LoadModelAsync 读取并预处理的文件, 纹理路径相对 path 所在目录. 可多次加入, 各实例共用预处理结果
+     *  [out]: 根节点句柄. 需在GL线程调用, 只做材质注册与GL上传
+     */
+    inline static SceneHandle AddToScene(Scene &scene, const LoadedModel &loaded, const std::filesystem::path &path)
+    {
+        current_file_path = path;
+        auto file_name = current_file_path.filename();
+        return postProcess(scene, loaded, file_name);
+    }
     inline static void LoadAndProcessModel(Scene &scene, ModelLoadFuture &model_future, std::filesystem::path& file_name)
     {
         try
         {
-            auto [raw_model, importer] = model_future.get();
-            outputRawModelDebugInfos(raw_model);
-            auto &&model = postProcess(*raw_model,file_name);
-            scene.addObject(std::move(model));
+            LoadedModel loaded = model_future.get();
+            outputRawModelDebugInfos(loaded.scene);
+            postProcess(scene, loaded, file_name);
         }
         catch (std::exception &e)
         {
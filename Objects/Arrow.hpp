@@ -11,14 +11,16 @@ private:
     glm::vec3 m_end = glm::vec3(1.0f, 0.0f, 0.0f);
     glm::vec3 m_color = glm::vec3(1.0f, 0.0f, 0.0f);
     float m_thickness = 0.05f;
+    // 箭头各部分都用单位尺寸的共享网格, 长度与粗细由模型矩阵缩放, 修改箭头不需要重新生成几何体
+    // 锥体半径与高为 thickness 的 2.5 与 6 倍, 等比缩放; 圆柱半径与长度分别缩放, 侧面法线方向不变
     Cone m_cone;
     Cylinder m_cylinder;
 public:
     Arrow(const glm::vec3& start = glm::vec3(0.0f), const glm::vec3& end = glm::vec3(1.0f,0.0f,0.0f),
           const glm::vec3& color = glm::vec3(1.0f,0.0f,0.0f), float thickness = 0.05f)
         : m_start(start), m_end(end), m_color(color), m_thickness(thickness),
-          m_cone(thickness*2.5f, thickness*6.0f, 16, color, "ArrowCone"),
-          m_cylinder(thickness, glm::length(end-start)-thickness*6.0f, 16, color, "ArrowCylinder")
+          m_cone(2.5f, 6.0f, 16, color, "ArrowCone"),
+          m_cylinder(1.0f, 1.0f, 16, color, "ArrowCylinder")
     {
         name = "Arrow";
     }
@@ -28,13 +30,6 @@ public:
         m_end = end;
         m_color = color;
         m_thickness = thickness;
-        float arrowLen = glm::length(m_end - m_start);
-        float coneHeight = m_thickness * 6.0f;
-        float coneRadius = m_thickness * 2.5f;
-        float shaftLen = arrowLen - coneHeight;
-        if (shaftLen < 0.01f) shaftLen = arrowLen * 0.5f;
-        m_cone = Cone(coneRadius, coneHeight, 16, color, "ArrowCone");
-        m_cylinder = Cylinder(m_thickness, shaftLen, 16, color, "ArrowCylinder");
     }
 
 
@@ -57,7 +52,7 @@ public:
             float angle = acos(glm::clamp(dot, -1.0f, 1.0f));
             shaftModel = glm::rotate(shaftModel, angle, glm::normalize(axis));
         }
-        shaftModel = glm::scale(shaftModel, glm::vec3(1.0f, 1.0f, 1.0f));
+        shaftModel = glm::scale(shaftModel, glm::vec3(m_thickness, m_thickness, shaftLen));
         m_cylinder.draw(shaftModel, shaders);
 
         // Cone
@@ -68,7 +63,7 @@ public:
             float angle = acos(glm::clamp(dot, -1.0f, 1.0f));
             coneModel = glm::rotate(coneModel, angle, glm::normalize(axis));
         }
-        coneModel = glm::scale(coneModel, glm::vec3(1.0f, 1.0f, 1.0f));
+        coneModel = glm::scale(coneModel, glm::vec3(m_thickness));
         m_cone.draw(coneModel, shaders);
     }
 
@@ -0,0 +1,174 @@
+#include "ClusteredMesh.hpp"
+#include "../Shading/ClusterPagePool.hpp"
+#include "../Shading/MaterialLibrary.hpp"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+ClusteredMesh::ClusteredMesh(ClusterHierarchy hierarchy, const std::filesystem::path &path)
+    : m_hierarchy(std::move(hierarchy)), m_path(path)
+{
+    setName(path.stem().string());
+    const size_t pageCount = m_hierarchy.pages.size();
+    m_pageState.assign(pageCount, PageState::Absent);
+    m_pageSlot.assign(pageCount, ClusterHierarchy::None);
+    m_groupVisited.assign(m_hierarchy.groups.size(), 0);
+    m_groupRefined.assign(m_hierarchy.groups.size(), 0);
+
+    const ClusterHierarchy::FileHeader &header = m_hierarchy.header;
+    const glm::vec3 corners[2] = {glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]),
+                                  glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2])};
+    localBounds = BoundingVolume::FromPositions(corners, 2, sizeof(glm::vec3));
+}
+
+ClusteredMesh::~ClusteredMesh()
+{
+    ClusterPagePool::Get().release(*this);
+}
+
+void ClusteredMesh::onPageResident(uint32_t page, uint32_t slot)
+{
+    m_pageState[page] = PageState::Resident;
+    m_pageSlot[page] = slot;
+}
+
+void ClusteredMesh::onPageEvicted(uint32_t page)
+{
+    m_pageState[page] = PageState::Absent;
+    m_pageSlot[page] = ClusterHierarchy::None;
+}
+
+void ClusteredMesh::addCluster(uint32_t cluster)
+{
+    const ClusterHierarchy::ClusterRecord &record = m_hierarchy.clusters[cluster];
+    const uint32_t slot = m_pageSlot[record.page];
+    if (slot == ClusterHierarchy::None)
+        return;
+    m_counts.push_back(static_cast<GLsizei>(record.indexCount));
+    m_offsets.push_back(reinterpret_cast<const void *>((size_t(slot) * ClusterHierarchy::PageIndices + record.firstIndex) * sizeof(uint16_t)));
+    m_baseVertices.push_back(static_cast<GLint>(size_t(slot) * ClusterHierarchy::PageVertices));
+}
+
+void ClusteredMesh::selectCut(const glm::mat4 &modelMatrix)
+{
+    ClusterPagePool &pool = ClusterPagePool::Get();
+    const auto start = std::chrono::steady_clock::now();
+    m_cutFrame = pool.frame();
+    m_counts.clear();
+    m_offsets.clear();
+    m_baseVertices.clear();
+    m_refinedGroups.clear();
+
+    const glm::vec3 camera = pool.cameraPosition();
+    const float scale = std::max({glm::length(glm::vec3(modelMatrix[0])), glm::length(glm::vec3(modelMatrix[1])),
+                                  glm::length(glm::vec3(modelMatrix[2]))});
+    const float threshold = std::max(pool.getSettings().pixelError, 1e-3f);
+    // 组误差投影到屏幕的像素数, 取包围球上离相机最近的点. 相机在包围球内时尽量细化
+    auto projectedError = [&](const ClusterHierarchy::GroupRecord &group)
+    {
+        const glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(glm::vec3(group.bounds), 1.0f));
+        const float distance = glm::length(center - camera) - group.bounds.w * scale;
+        if (distance <= 1e-4f)
+            return std::numeric_limits<float>::max();
+        return group.error * scale * pool.pixelScale() / distance;
+    };
+
+    // 父组编号大于子组, 按编号从大到小处理保证父组先于子组决定是否细化
+    const std::vector<uint32_t> &lists = m_hierarchy.lists;
+    m_heap.clear();
+    for (uint32_t g = 0; g < m_hierarchy.groups.size(); ++g)
+    {
+        if (m_hierarchy.groups[g].parentCount == 0)
+            m_heap.push_back(g);
+    }
+    std::make_heap(m_heap.begin(), m_heap.end());
+    while (!m_heap.empty())
+    {
+        std::pop_heap(m_heap.begin(), m_heap.end());
+        const uint32_t g = m_heap.back();
+        m_heap.pop_back();
+        if (m_groupVisited[g] == m_cutFrame)
+            continue;
+        m_groupVisited[g] = m_cutFrame;
+
+        const ClusterHierarchy::GroupRecord &group = m_hierarchy.groups[g];
+        bool parentsRefined = true;
+        for (uint32_t i = 0; i < group.parentCount && parentsRefined; ++i)
+            parentsRefined = isRefined(lists[group.parentFirst + i]);
+        if (!parentsRefined)
+            continue;
+        const float error = projectedError(group);
+        if (error <= threshold)
+            continue;
+
+        // 成员页全部驻留才能细化, 否则请求缺失的页, 本帧仍绘制粗一级的簇
+        bool resident = true;
+        for (uint32_t i = 0; i < group.memberPageCount; ++i)
+        {
+            const uint32_t page = lists[group.memberPageFirst + i];
+            if (m_pageState[page] != PageState::Resident)
+            {
+                resident = false;
+                if (m_pageState[page] == PageState::Absent)
+                    pool.request(*this, page, error);
+            }
+        }
+        if (!resident)
+            continue;
+
+        m_groupRefined[g] = m_cutFrame;
+        m_refinedGroups.push_back(g);
+        for (uint32_t i = 0; i < group.childCount; ++i)
+        {
+            m_heap.push_back(lists[group.childFirst + i]);
+            std::push_heap(m_heap.begin(), m_heap.end());
+        }
+    }
+
+    // 簇 c 绘制当且仅当所在组已细化(根簇视为已细化)且生成它的组未细化
+    size_t triangles = 0;
+    auto consider = [&](uint32_t cluster)
+    {
+        const ClusterHierarchy::ClusterRecord &record = m_hierarchy.clusters[cluster];
+        if (isRefined(record.generatingGroup))
+            return;
+        addCluster(cluster);
+        triangles += record.indexCount / 3;
+    };
+    for (uint32_t i = 0; i < m_hierarchy.header.rootCount; ++i)
+    {
+        const uint32_t cluster = lists[m_hierarchy.header.rootFirst + i];
+        if (m_pageState[m_hierarchy.clusters[cluster].page] != PageState::Resident)
+            pool.request(*this, m_hierarchy.clusters[cluster].page, std::numeric_limits<float>::max());
+        consider(cluster);
+    }
+    for (uint32_t g : m_refinedGroups)
+    {
+        const ClusterHierarchy::GroupRecord &group = m_hierarchy.groups[g];
+        for (uint32_t i = 0; i < group.memberPageCount; ++i)
+            pool.touch(m_pageSlot[lists[group.memberPageFirst + i]]);
+        for (uint32_t i = 0; i < group.memberCount; ++i)
+            consider(lists[group.memberFirst + i]);
+    }
+
+    const double selectMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    pool.addCutStats(m_counts.size(), triangles, m_refinedGroups.size(), selectMs);
+}
+
+void ClusteredMesh::draw(glm::mat4 modelMatrix, Shader &shaders)
+{
+    ClusterPagePool &pool = ClusterPagePool::Get();
+    if (pool.getVAO() == 0)
+        return;
+    if (m_cutFrame != pool.frame())
+        selectCut(modelMatrix);
+    if (m_counts.empty())
+        return;
+
+    glBindVertexArray(pool.getVAO());
+    shaders.setInt("materialId", MaterialLibrary::DefaultMaterial);
+    shaders.setMat4("model", modelMatrix);
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, m_counts.data(), GL_UNSIGNED_SHORT, m_offsets.data(),
+                                  static_cast<GLsizei>(m_counts.size()), m_baseVertices.data());
+    glBindVertexArray(0);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Object.hpp"
+#include "../Math/ClusterHierarchy.hpp"
+#include <filesystem>
+#include <vector>
+
+/*
+从簇层级文件流式绘制的网格. 只常驻元数据与含根簇的页, 其余页按当前视角的误差需要由 ClusterPagePool 读入页池
+每帧第一次绘制时按 ClusterPagePool 记录的相机选择cut(见 ClusterHierarchy), 同一帧的其他pass复用同一个cut
+不提供 DrawRange, 由 RenderQueue 的逐对象路径调用 draw, 一次 glMultiDrawElementsBaseVertex 绘制所有选中的簇
+*/
+class ClusteredMesh : public Object
+{
+public:
+    ClusteredMesh(ClusterHierarchy hierarchy, const std::filesystem::path &path);
+    ~ClusteredMesh() override;
+    ClusteredMesh(const ClusteredMesh &) = delete;
+    ClusteredMesh &operator=(const ClusteredMesh &) = delete;
+
+    void draw(glm::mat4 modelMatrix, Shader &shaders) override;
+
+    // ClusterPagePool 回调
+    const std::filesystem::path &getPath() const { return m_path; }
+    const ClusterHierarchy::PageRecord &pageRecord(uint32_t page) const { return m_hierarchy.pages[page]; }
+    bool needsPage(uint32_t page) const { return m_pageState[page] == PageState::Absent; }
+    void onPageLoading(uint32_t page) { m_pageState[page] = PageState::Loading; }
+    void onPageDropped(uint32_t page) { m_pageState[page] = PageState::Absent; }
+    void onPageResident(uint32_t page, uint32_t slot);
+    void onPageEvicted(uint32_t page);
+
+private:
+    enum class PageState : uint8_t
+    {
+        Absent,
+        Loading,
+        Resident
+    };
+
+    ClusterHierarchy m_hierarchy;
+    std::filesystem::path m_path;
+    std::vector<PageState> m_pageState;
+    std::vector<uint32_t> m_pageSlot;
+    // 以帧号为标记, 不必每帧清零
+    std::vector<uint64_t> m_groupVisited;
+    std::vector<uint64_t> m_groupRefined;
+    std::vector<uint32_t> m_refinedGroups;
+    std::vector<uint32_t> m_heap;
+    uint64_t m_cutFrame = 0;
+
+    // 当前cut的绘制参数
+    std::vector<GLsizei> m_counts;
+    std::vector<const void *> m_offsets;
+    std::vector<GLint> m_baseVertices;
+
+    void selectCut(const glm::mat4 &modelMatrix);
+    void addCluster(uint32_t cluster);
+    bool isRefined(uint32_t group) const { return group != ClusterHierarchy::None && m_groupRefined[group] == m_cutFrame; }
+};
@@ -2,55 +2,104 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, uint32_t materialId,
+           std::vector<Meshlet> meshlets, const std::vector<MeshLod> &lods)
 {
     this->vertices = vertices;
     this->indices = indices;
-    this->textures = textures;
-    setupMesh();
+    this->materialId = materialId;
+    batchKey = MaterialLibrary::Get().batchKey(materialId);
+    this->meshlets = std::move(meshlets);
+    localBounds = BoundingVolume::FromPositions(this->vertices.data(), this->vertices.size(), sizeof(Vertex));
+    setupMesh(lods);
 }
 
 void Mesh::draw(glm::mat4 modelMatrix, Shader &shaders)
 {
-    glBindVertexArray(VAO);
-    if (textures.size() >= 1)
-    {
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, textures[0].id);
-        shaders.setInt("texture_diff", 1);
-    }
-    if (textures.size() >= 2)
+    buffer->bind();
+    shaders.setInt("materialId", static_cast<int>(materialId));
+    shaders.setMat4("model", modelMatrix);
+
+    buffer->draw(*geometry, 0, static_cast<GLuint>(indices.size()));
+    shaders.setInt("materialId", MaterialLibrary::DefaultMaterial);
+    glBindVertexArray(0);
+}
+
+void Mesh::collectDrawRanges(std::vector<DrawRange> &out) const
+{
+    const GLuint vao = buffer->getVAO();
+    const GLuint depthVao = buffer->getDepthVAO();
+    const GLint baseVertex = static_cast<GLint>(geometry->firstVertex);
+    if (meshlets.empty())
     {
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, textures[1].id);
-        shaders.setInt("texture_spec", 2);
+        DrawRange range{vao, static_cast<GLuint>(indices.size()), geometry->firstIndex, baseVertex};
+        range.materialId = materialId;
+        range.material = batchKey;
+        range.lods = lods.data();
+        range.lodCount = static_cast<uint32_t>(lods.size());
+        range.indexType = buffer->getIndexType();
+        range.depthVao = depthVao;
+        out.push_back(range);
+        return;
     }
-    if (textures.size() >= 1)
+    // 每个簇一个范围, 由GPU逐簇剔除. CPU路径中各簇合并回整个网格后按LOD替换
+    for (const Meshlet &meshlet : meshlets)
     {
-        shaders.setInt("enable_tex", 1);
+        DrawRange range{vao, meshlet.indexCount, geometry->firstIndex + meshlet.firstIndex, baseVertex};
+        range.materialId = materialId;
+        range.material = batchKey;
+        range.sphere = glm::vec4(meshlet.center, meshlet.radius);
+        range.cone = glm::vec4(meshlet.coneAxis, meshlet.coneCutoff);
+        range.coneApex = meshlet.coneApex;
+        range.lods = lods.data();
+        range.lodCount = static_cast<uint32_t>(lods.size());
+        range.indexType = buffer->getIndexType();
+        range.depthVao = depthVao;
+        out.push_back(range);
     }
-    shaders.setMat4("model", modelMatrix);
+}
 
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-    shaders.setInt("enable_tex", 0);
-    glBindVertexArray(0);
+size_t Mesh::cpuBytes() const
+{
+    return vertices.size() * sizeof(Vertex) + indices.size() * sizeof(unsigned int) +
+           meshlets.size() * sizeof(Meshlet) + lods.size() * sizeof(DrawLod);
 }
 
-void Mesh::setupMesh()
+size_t Mesh::gpuBytes() const
 {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, normal));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, texCoord));
-    glBindVertexArray(0);
+    return size_t(geometry->vertexCount) * (buffer->getStride() + buffer->getPositionStride()) +
+           size_t(geometry->indexCount) * buffer->getIndexSize();
+}
+
+void Mesh::collectOccluderGeometry(std::vector<OccluderGeometry> &out) const
+{
+    out.push_back({reinterpret_cast<const float *>(vertices.data()), sizeof(Vertex), vertices.size(), indices.data(), indices.size()});
+}
+
+void Mesh::setupMesh(const std::vector<MeshLod> &lodChain)
+{
+    static_assert(sizeof(Vertex) == GeometryBuffer::StandardStride, "Mesh::Vertex must match the standard vertex layout");
+    std::vector<unsigned int> allIndices = indices;
+    std::vector<GLuint> lodOffsets;
+    for (const MeshLod &lod : lodChain)
+    {
+        lodOffsets.push_back(static_cast<GLuint>(allIndices.size()));
+        allIndices.insert(allIndices.end(), lod.indices.begin(), lod.indices.end());
+    }
+    const GLenum indexType = vertices.size() <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    std::vector<MeshOptimizer::CompactVertex> compact;
+    if (!vertices.empty() && MeshOptimizer::EncodeCompact(&vertices[0].position.x, &vertices[0].normal.x, &vertices[0].texCoord.x, sizeof(Vertex), vertices.size(), compact))
+    {
+        static_assert(sizeof(MeshOptimizer::CompactVertex) == GeometryBuffer::CompactStride, "CompactVertex must match the compact vertex layout");
+        buffer = &GeometryBuffer::Shared(GeometryBuffer::VertexFormat::Compact, indexType);
+        geometry = buffer->allocate(compact.data(), compact.size(), allIndices.data(), allIndices.size());
+    }
+    else
+    {
+        buffer = &GeometryBuffer::Shared(GeometryBuffer::VertexFormat::Standard, indexType);
+        geometry = buffer->allocate(vertices.data(), vertices.size(), allIndices.data(), allIndices.size());
+    }
+    lods.clear();
+    for (size_t i = 0; i < lodChain.size(); ++i)
+        lods.push_back(DrawLod{geometry->firstIndex + lodOffsets[i], static_cast<GLuint>(lodChain[i].indices.size()), lodChain[i].error});
 }
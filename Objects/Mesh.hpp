@@ -1,6 +1,11 @@
 #pragma once
 
 #include "Object.hpp"
+#include "../Math/Meshlet.hpp"
+#include "../Math/MeshOptimizer.hpp"
+#include "../Math/MeshSimplifier.hpp"
+#include "../Shading/GeometryBuffer.hpp"
+#include "../Shading/MaterialLibrary.hpp"
 
 class Mesh : public Object
 {
@@ -11,19 +16,33 @@ public:
         glm::vec3 normal;
         glm::vec2 texCoord;
     };
-    struct Texture
-    {
-        unsigned int id;
-        std::string type;
-        std::string path;
-    };
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
-    std::vector<Texture> textures;
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
+    // MaterialLibrary 中的材质编号
+    uint32_t materialId = MaterialLibrary::DefaultMaterial;
+    // 导入时拆分的网格簇, 为空时整体绘制与剔除
+    std::vector<Meshlet> meshlets;
+    /// @param lods 由细到粗的简化层级, 与 vertices 共用顶点, 和原索引一起上传到同一次分配
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, uint32_t materialId,
+         std::vector<Meshlet> meshlets = {}, const std::vector<MeshLod> &lods = {});
     void draw(glm::mat4 modelMatrix, Shader &shaders) override;
+    void collectOccluderGeometry(std::vector<OccluderGeometry> &out) const override;
+    void collectDrawRanges(std::vector<DrawRange> &out) const override;
+    // 上传到GPU的每顶点与每索引字节数
+    GLsizei gpuVertexStride() const { return buffer->getStride(); }
+    GLsizei gpuIndexSize() const { return buffer->getIndexSize(); }
+    /// @brief CPU端数据与GPU分配(含位置流与LOD索引)的字节数, 内容相同而共享的GPU分配按未共享计
+    size_t memoryBytes() const { return cpuBytes() + gpuBytes(); }
+    size_t cpuBytes() const;
+    size_t gpuBytes() const;
+    // 内容相同的网格共用同一分配, 可用 get() 判断是否共享
+    const GeometryHandle &getGeometry() const { return geometry; }
 
 private:
-    GLuint VAO, VBO, EBO;
-    void setupMesh();
+    // 能无损(在精度要求内)编码时使用紧凑顶点格式, 顶点数不超过65536时使用16位索引. CPU端 vertices 保持原精度, 供遮挡剔除使用
+    GeometryBuffer *buffer = nullptr;
+    GeometryHandle geometry; // 在 buffer 中的位置, 原索引之后依次是各LOD的索引
+    uint64_t batchKey = 0;   // MaterialLibrary::batchKey(materialId)
+    std::vector<DrawLod> lods;
+    void setupMesh(const std::vector<MeshLod> &lodChain);
 };
\ No newline at end of file
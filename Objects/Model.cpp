@@ -12,6 +12,15 @@ void Model::spawnMesh()
     // 实现可选
 }
 
+void Model::updateBounds()
+{
+    localBounds = BoundingVolume();
+    for (auto &mesh : meshes)
+    {
+        localBounds.merge(mesh.getLocalBounds());
+    }
+}
+
 void Model::draw(glm::mat4 modelMatrix, Shader &shaders)
 {
     for (auto &mesh : meshes)
@@ -19,3 +28,29 @@ void Model::draw(glm::mat4 modelMatrix, Shader &shaders)
         mesh.draw(modelMatrix, shaders);
     }
 }
+
+void Model::collectOccluderGeometry(std::vector<OccluderGeometry> &out) const
+{
+    for (const auto &mesh : meshes)
+    {
+        mesh.collectOccluderGeometry(out);
+    }
+}
+
+void Model::collectDrawRanges(std::vector<DrawRange> &out) const
+{
+    for (const auto &mesh : meshes)
+    {
+        mesh.collectDrawRanges(out);
+    }
+}
+
+size_t Model::memoryBytes() const
+{
+    size_t bytes = 0;
+    for (const auto &mesh : meshes)
+    {
+        bytes += mesh.memoryBytes();
+    }
+    return bytes;
+}
@@ -8,6 +8,13 @@ class Model : public Object
 public:
     Model(const std::string _name = "Model");
     void spawnMesh();
+    // 合并所有网格的包围体. 修改meshes后调用
+    void updateBounds();
     void draw(glm::mat4 modelMatrix, Shader &shaders) override;
+    void collectOccluderGeometry(std::vector<OccluderGeometry> &out) const override;
+    // 各网格的范围, 材质编号取自所属网格
+    void collectDrawRanges(std::vector<DrawRange> &out) const override;
+    // 所有网格的 Mesh::memoryBytes 之和
+    size_t memoryBytes() const;
     std::vector<Mesh> meshes;
 };
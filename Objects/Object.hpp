@@ -1,116 +1,69 @@
 #pragma once
 #include "../Shading/Shader.hpp"
+#include "../Math/Bounds.hpp"
 #include <string>
 #include <unordered_map>
+#include <vector>
 
-class Object
+/// @brief 遮挡剔除用的三角形数据, 指向对象自身保存的CPU端顶点
+struct OccluderGeometry
 {
-public:
-    std::string name; // 如何确保name 唯一? 让Name设置交给一个类管理,而不是输入名字就传给对象
-    glm::mat4 modelMatrix = glm::identity<glm::mat4>();
-    Object();
-    virtual void draw(glm::mat4 modelMatrix, Shader &shaders) = 0;
-    virtual ~Object();
-    void setName(const std::string &_name);
-    void setModelTransform(glm::mat4 &_transform);
+    const float *positions = nullptr;
+    size_t stride = 0; // 相邻顶点position之间的字节数
+    size_t vertexCount = 0;
+    const uint32_t *indices = nullptr; // 为空时按顶点顺序组成三角形
+    size_t indexCount = 0;
 };
-// using Scene = std::vector<std::unique_ptr<Object>>;
 
-class Scene
+/// @brief DrawRange 的一个简化层级, 与原范围共用顶点(相同 baseVertex)
+struct DrawLod
 {
-public: // 方便调试 应该是private
-    size_t m_nextObjectID = 0;
-    std::unordered_map<size_t, std::unique_ptr<Object>> m_objectMap;
-    std::unordered_set<size_t> m_eraseSet;
-    std::unordered_map<std::string, size_t> m_nameCountMap;
-
-public:
-    Scene() = default;
-    ~Scene() = default;
-    // 禁用拷贝构造和赋值
-    Scene(const Scene &) = delete;
-    Scene &operator=(const Scene &) = delete;
-    // 启用移动构造和赋值
-    Scene(Scene &&) = default;
-    Scene &operator=(Scene &&) = default;
-
-public: // 迭代器方法
-    auto begin()
-    {
-        return m_objectMap.begin();
-    }
+    GLuint firstIndex = 0;
+    GLuint indexCount = 0;
+    float error = 0.0f; // 模型空间几何误差
+};
 
-    auto end()
-    {
-        return m_objectMap.end();
-    }
-    auto begin() const
-    {
-        return m_objectMap.begin();
-    }
+/// @brief GPU驱动绘制用的索引范围. 同一 vao 的范围共享顶点格式, 材质由着色器按 materialId 读取
+struct DrawRange
+{
+    GLuint vao = 0;
+    GLuint indexCount = 0;
+    GLuint firstIndex = 0;
+    GLint baseVertex = 0;
+    uint32_t materialId = 0; // MaterialLibrary 中的材质编号, 绘制时作为 uniform 或逐命令数据传入
+    uint64_t material = 0;   // 批次键(MaterialLibrary::batchKey), vao 与 material 都相同的范围合并为一次间接绘制
+    // 网格簇的模型空间包围球(w 为半径)与法线锥(xyz 轴, w 余弦阈值). 半径 < 0 时只按对象包围盒剔除
+    glm::vec4 sphere = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+    glm::vec4 cone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    glm::vec3 coneApex = glm::vec3(0.0f);
+    // 由细到粗的简化层级(不含范围自身), 指向对象持有的数组. 只用于CPU提交路径, GPU驱动路径总是绘制原范围
+    const DrawLod *lods = nullptr;
+    uint32_t lodCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT; // GL_UNSIGNED_SHORT 或 GL_UNSIGNED_INT, 由 vao 的索引缓冲决定
+    GLuint depthVao = 0;                // 只读位置流的VAO, 与 vao 共用索引缓冲. 0 表示没有, 深度pass也使用 vao
 
-    auto end() const
+    // firstIndex 在索引缓冲中的字节偏移
+    const void *indexOffset() const
     {
-        return m_objectMap.end();
+        return reinterpret_cast<const void *>(size_t(firstIndex) * (indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint)));
     }
+};
 
+class Object
+{
 public:
-    //// @brief 添加对象,返回对象ID 避免对象重名
-    size_t addObject(std::unique_ptr<Object> obj)
-    {
-        if (m_nameCountMap.find(obj->name) != m_nameCountMap.end())
-        {
-            size_t &count = m_nameCountMap[obj->name];
-            obj->setName(obj->name + std::to_string(count));
-            count++;
-        }
-        else
-        {
-            m_nameCountMap[obj->name] = 1;
-        }
-        size_t id = m_nextObjectID++;
-        m_objectMap[id] = std::move(obj);
-        return id;
-    }
-
-    /// @brief 通过ID获取对象引用
-    auto getObject(size_t id) -> Object &
-    {
-        auto it = m_objectMap.find(id);
-        if (it == m_objectMap.end())
-            throw std::runtime_error("Object with ID " + std::to_string(id) + " not found.");
-        return *(it->second);
-    }
-    auto getObject(const std::string &name) -> Object &
-    {
-        for (auto &[id, obj] : m_objectMap)
-        {
-            if (obj->name == name)
-                return *obj;
-        }
-        throw std::runtime_error("Object with name " + name + " not found.");
-    }
-
-    /// @brief 通过ID删除对象
-    void removeObject(size_t id)
-    {
-        m_eraseSet.insert(id);
-        // m_objectMap.erase(id);
-    }
+    std::string name; // 如何确保name 唯一? 让Name设置交给一个类管理,而不是输入名字就传给对象
+    Object();
+    virtual void draw(glm::mat4 modelMatrix, Shader &shaders) = 0;
+    virtual ~Object();
+    void setName(const std::string &_name);
+    // 模型空间包围体, 在顶点上传时计算. 无效包围体表示不参与剔除
+    const BoundingVolume &getLocalBounds() const { return localBounds; }
+    // 作为遮挡体时提交的模型空间三角形, 默认不提供
+    virtual void collectOccluderGeometry(std::vector<OccluderGeometry> &out) const {}
+    // GPU驱动绘制的索引范围(GL_TRIANGLES, 索引类型见 DrawRange::indexType). 不提供时该对象仍走 draw
+    virtual void collectDrawRanges(std::vector<DrawRange> &out) const {}
 
-    void update()
-    {
-        deferredRemove();
-    }
-    ///////////////内部方法////////////////
-private:
-    /// @brief 延迟删除对象,在帧更新时调用
-    void deferredRemove()
-    {
-        for (auto id : m_eraseSet)
-        {
-            m_objectMap.erase(id);
-        }
-        m_eraseSet.clear();
-    }
+protected:
+    BoundingVolume localBounds;
 };
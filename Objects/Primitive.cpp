@@ -0,0 +1,30 @@
+#include "Primitive.hpp"
+
+void Primitive::setPrimitive(PrimitiveHandle handle)
+{
+    primitive = std::move(handle);
+    localBounds = primitive->bounds;
+}
+
+void Primitive::draw(glm::mat4 modelMatrix, Shader &shaders)
+{
+    GeometryBuffer &buffer = GeometryBuffer::Standard();
+    shaders.setMat4("model", modelMatrix);
+    buffer.bind();
+    buffer.draw(*primitive->geometry);
+    glBindVertexArray(0);
+}
+
+void Primitive::collectOccluderGeometry(std::vector<OccluderGeometry> &out) const
+{
+    out.push_back({&primitive->vertices[0].position.x, sizeof(PrimitiveVertex), primitive->vertices.size(),
+                   primitive->indices.data(), primitive->indices.size()});
+}
+
+void Primitive::collectDrawRanges(std::vector<DrawRange> &out) const
+{
+    const GeometryRange &geometry = *primitive->geometry;
+    DrawRange range{GeometryBuffer::Standard().getVAO(), geometry.indexCount, geometry.firstIndex, static_cast<GLint>(geometry.firstVertex)};
+    range.depthVao = GeometryBuffer::Standard().getDepthVAO();
+    out.push_back(range);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "Object.hpp"
+#include "PrimitiveRegistry.hpp"
+
+/// @brief 几何体来自 PrimitiveRegistry 的对象基类. 相同参数的对象共用同一份网格
+class Primitive : public Object
+{
+public:
+    void draw(glm::mat4 modelMatrix, Shader &shaders) override;
+    void collectOccluderGeometry(std::vector<OccluderGeometry> &out) const override;
+    void collectDrawRanges(std::vector<DrawRange> &out) const override;
+
+protected:
+    PrimitiveHandle primitive;
+
+    // 由派生类构造时调用, 同时设置模型空间包围体
+    void setPrimitive(PrimitiveHandle handle);
+};
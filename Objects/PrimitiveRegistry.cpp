@@ -0,0 +1,268 @@
+#include "PrimitiveRegistry.hpp"
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+}
+
+PrimitiveRegistry &PrimitiveRegistry::Get()
+{
+    static PrimitiveRegistry registry;
+    return registry;
+}
+
+PrimitiveHandle PrimitiveRegistry::sphere(float radius, int sectorCount, int stackCount)
+{
+    return acquire(Key{Type::Sphere, glm::vec3(radius, 0.0f, 0.0f), {std::max(3, sectorCount), std::max(2, stackCount)}});
+}
+
+PrimitiveHandle PrimitiveRegistry::cube(const glm::vec3 &size)
+{
+    return acquire(Key{Type::Cube, size, {0, 0}});
+}
+
+PrimitiveHandle PrimitiveRegistry::plane(float width, float depth)
+{
+    return acquire(Key{Type::Plane, glm::vec3(width, 0.0f, depth), {0, 0}});
+}
+
+PrimitiveHandle PrimitiveRegistry::cone(float radius, float height, int segments)
+{
+    return acquire(Key{Type::Cone, glm::vec3(radius, height, 0.0f), {std::max(3, segments), 0}});
+}
+
+PrimitiveHandle PrimitiveRegistry::cylinder(float radius, float height, int segments)
+{
+    return acquire(Key{Type::Cylinder, glm::vec3(radius, height, 0.0f), {std::max(3, segments), 0}});
+}
+
+PrimitiveHandle PrimitiveRegistry::acquire(const Key &key)
+{
+    m_stats.requests++;
+    if (auto it = m_primitives.find(key); it != m_primitives.end())
+    {
+        if (PrimitiveHandle existing = it->second.lock())
+            return existing;
+    }
+
+    // 生成新网格的次数远少于命中, 顺便清理已销毁的条目
+    std::erase_if(m_primitives, [](const auto &entry)
+                  { return entry.second.expired(); });
+
+    const Clock::time_point start = Clock::now();
+    auto primitive = std::make_shared<PrimitiveGeometry>();
+    Generate(key, *primitive);
+    primitive->bounds = BoundingVolume::FromPositions(&primitive->vertices[0].position, primitive->vertices.size(), sizeof(PrimitiveVertex));
+    primitive->geometry = GeometryBuffer::Standard().allocate(primitive->vertices.data(), primitive->vertices.size(),
+                                                              primitive->indices.data(), primitive->indices.size());
+    m_stats.lastUploadMs = ElapsedMs(start);
+    m_stats.uploadMs += m_stats.lastUploadMs;
+    m_stats.generated++;
+
+    m_primitives[key] = primitive;
+    return primitive;
+}
+
+PrimitiveRegistry::Stats PrimitiveRegistry::getStats() const
+{
+    Stats stats = m_stats;
+    for (const auto &[key, weak] : m_primitives)
+    {
+        const long users = weak.use_count();
+        if (users == 0)
+            continue;
+        PrimitiveHandle primitive = weak.lock();
+        stats.primitives++;
+        stats.users += users;
+        stats.residentBytes += primitive->vertices.size() * sizeof(PrimitiveVertex) + primitive->indices.size() * sizeof(GLuint);
+        stats.unsharedBytes += users * primitive->indices.size() * sizeof(PrimitiveVertex);
+    }
+    return stats;
+}
+
+void PrimitiveRegistry::Generate(const Key &key, PrimitiveGeometry &primitive)
+{
+    switch (key.type)
+    {
+    case Type::Sphere:
+        GenerateSphere(key.size.x, key.segments[0], key.segments[1], primitive);
+        break;
+    case Type::Cube:
+        GenerateCube(key.size, primitive);
+        break;
+    case Type::Plane:
+        GeneratePlane(key.size.x, key.size.z, primitive);
+        break;
+    case Type::Cone:
+        GenerateCone(key.size.x, key.size.y, key.segments[0], primitive);
+        break;
+    case Type::Cylinder:
+        GenerateCylinder(key.size.x, key.size.y, key.segments[0], primitive);
+        break;
+    }
+}
+
+void PrimitiveRegistry::GenerateSphere(float radius, int sectorCount, int stackCount, PrimitiveGeometry &primitive)
+{
+    const float PI = glm::pi<float>();
+    primitive.vertices.reserve(size_t(stackCount + 1) * (sectorCount + 1));
+    for (int i = 0; i <= stackCount; ++i)
+    {
+        const float stackAngle = PI / 2 - i * (PI / stackCount);
+        const float xy = radius * cosf(stackAngle);
+        const float z = radius * sinf(stackAngle);
+        for (int j = 0; j <= sectorCount; ++j)
+        {
+            const float sectorAngle = j * (2 * PI / sectorCount);
+            const glm::vec3 position(xy * cosf(sectorAngle), xy * sinf(sectorAngle), z);
+            const glm::vec2 texCoord(static_cast<float>(j) / sectorCount, static_cast<float>(i) / stackCount);
+            primitive.vertices.push_back({position, position / radius, texCoord});
+        }
+    }
+    // 两极处退化的三角形不生成
+    for (int i = 0; i < stackCount; ++i)
+    {
+        GLuint k1 = i * (sectorCount + 1);
+        GLuint k2 = k1 + sectorCount + 1;
+        for (int j = 0; j < sectorCount; ++j, ++k1, ++k2)
+        {
+            if (i != 0)
+                primitive.indices.insert(primitive.indices.end(), {k1, k2, k1 + 1});
+            if (i != (stackCount - 1))
+                primitive.indices.insert(primitive.indices.end(), {k1 + 1, k2, k2 + 1});
+        }
+    }
+}
+
+void PrimitiveRegistry::GenerateCube(const glm::vec3 &size, PrimitiveGeometry &primitive)
+{
+    const glm::vec3 halfSize = size * 0.5f;
+    const glm::vec3 corners[8] = {
+        {-halfSize.x, -halfSize.y, halfSize.z},
+        {halfSize.x, -halfSize.y, halfSize.z},
+        {halfSize.x, halfSize.y, halfSize.z},
+        {-halfSize.x, halfSize.y, halfSize.z},
+        {-halfSize.x, -halfSize.y, -halfSize.z},
+        {halfSize.x, -halfSize.y, -halfSize.z},
+        {halfSize.x, halfSize.y, -halfSize.z},
+        {-halfSize.x, halfSize.y, -halfSize.z}};
+    // 每个面逆时针的4个角
+    const int faces[6][4] = {
+        {0, 1, 2, 3},
+        {1, 5, 6, 2},
+        {5, 4, 7, 6},
+        {4, 0, 3, 7},
+        {4, 5, 1, 0},
+        {3, 2, 6, 7}};
+    const glm::vec3 normals[6] = {
+        {0, 0, 1}, {1, 0, 0}, {0, 0, -1}, {-1, 0, 0}, {0, -1, 0}, {0, 1, 0}};
+    const glm::vec2 texCoords[4] = {
+        {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+    // 面法线不同, 角点不能在面之间共享: 24个顶点, 36个索引
+    for (int face = 0; face < 6; ++face)
+    {
+        const GLuint base = static_cast<GLuint>(primitive.vertices.size());
+        for (int corner = 0; corner < 4; ++corner)
+            primitive.vertices.push_back({corners[faces[face][corner]], normals[face], texCoords[corner]});
+        primitive.indices.insert(primitive.indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    }
+}
+
+void PrimitiveRegistry::GeneratePlane(float width, float depth, PrimitiveGeometry &primitive)
+{
+    const float halfWidth = width * 0.5f;
+    const float halfDepth = depth * 0.5f;
+    primitive.vertices = {
+        {{-halfWidth, 0.0f, -halfDepth}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}},
+        {{halfWidth, 0.0f, -halfDepth}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f}},
+        {{halfWidth, 0.0f, halfDepth}, {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f}},
+        {{-halfWidth, 0.0f, halfDepth}, {0.0f, 1.0f, 0.0f}, {0.0f, 1.0f}}};
+    primitive.indices = {0, 1, 2, 0, 2, 3};
+}
+
+void PrimitiveRegistry::GenerateCone(float radius, float height, int segments, PrimitiveGeometry &primitive)
+{
+    std::vector<PrimitiveVertex> &vertices = primitive.vertices;
+    std::vector<GLuint> &indices = primitive.indices;
+    const glm::vec3 apexPos(0, 0, height);
+
+    // 底面: 圆心 + 圆周, 法线朝 -z
+    const glm::vec3 bottomNormal(0, 0, -1);
+    const GLuint bottomCenterIndex = static_cast<GLuint>(vertices.size());
+    vertices.push_back({glm::vec3(0, 0, 0), bottomNormal, glm::vec2(0.5f, 0.5f)});
+    for (int i = 0; i < segments; ++i)
+    {
+        const float theta = 2.0f * glm::pi<float>() * static_cast<float>(i) / static_cast<float>(segments);
+        const float x = radius * cos(theta);
+        const float y = radius * sin(theta);
+        vertices.push_back({glm::vec3(x, y, 0), bottomNormal, glm::vec2(0.5f * (x / radius) + 0.5f, 0.5f * (y / radius) + 0.5f)});
+    }
+    for (int i = 0; i < segments; ++i)
+    {
+        indices.push_back(bottomCenterIndex);
+        indices.push_back(bottomCenterIndex + i + 1);
+        indices.push_back(bottomCenterIndex + (i + 1) % segments + 1);
+    }
+
+    // 侧面: 每个三角形独立的3个顶点, 使用面法线
+    const GLuint sideBaseIndex = static_cast<GLuint>(vertices.size());
+    for (int i = 0; i < segments; ++i)
+    {
+        const float theta1 = 2.0f * glm::pi<float>() * static_cast<float>(i) / static_cast<float>(segments);
+        const float theta2 = 2.0f * glm::pi<float>() * static_cast<float>(i + 1) / static_cast<float>(segments);
+        const glm::vec3 v1(radius * cos(theta1), radius * sin(theta1), 0);
+        const glm::vec3 v2(radius * cos(theta2), radius * sin(theta2), 0);
+        // 逆时针顶点顺序 v1 -> v2 -> apexPos, 法线朝外
+        const glm::vec3 normal = glm::normalize(glm::cross(v2 - v1, apexPos - v1));
+
+        vertices.push_back({v1, normal, glm::vec2(static_cast<float>(i) / segments, 0.0f)});
+        vertices.push_back({v2, normal, glm::vec2(static_cast<float>(i + 1) / segments, 0.0f)});
+        vertices.push_back({apexPos, normal, glm::vec2(0.5f, 1.0f)});
+        indices.insert(indices.end(), {sideBaseIndex + i * 3, sideBaseIndex + i * 3 + 1, sideBaseIndex + i * 3 + 2});
+    }
+}
+
+void PrimitiveRegistry::GenerateCylinder(float radius, float height, int segments, PrimitiveGeometry &primitive)
+{
+    std::vector<PrimitiveVertex> &vertices = primitive.vertices;
+    std::vector<GLuint> &indices = primitive.indices;
+    // 索引0: 顶面圆心, 索引1: 底面圆心
+    vertices.push_back({glm::vec3(0, 0, height * 0.5f), glm::vec3(0, 0, 1), glm::vec2(0.5f, 0.5f)});
+    vertices.push_back({glm::vec3(0, 0, -height * 0.5f), glm::vec3(0, 0, -1), glm::vec2(0.5f, 0.5f)});
+
+    // 每段4个顶点: 顶面圆环, 底面圆环, 侧面顶, 侧面底
+    for (int i = 0; i <= segments; ++i)
+    {
+        const float theta = 2.0f * glm::pi<float>() * static_cast<float>(i) / static_cast<float>(segments);
+        const float x = radius * cos(theta);
+        const float y = radius * sin(theta);
+        const glm::vec3 sideNormal = glm::normalize(glm::vec3(x, y, 0));
+        const glm::vec2 capTexCoord(0.5f * (x / radius) + 0.5f, 0.5f * (y / radius) + 0.5f);
+
+        vertices.push_back({glm::vec3(x, y, height * 0.5f), glm::vec3(0, 0, 1), capTexCoord});
+        vertices.push_back({glm::vec3(x, y, -height * 0.5f), glm::vec3(0, 0, -1), capTexCoord});
+        vertices.push_back({glm::vec3(x, y, height * 0.5f), sideNormal, glm::vec2(static_cast<float>(i) / segments, 1.0f)});
+        vertices.push_back({glm::vec3(x, y, -height * 0.5f), sideNormal, glm::vec2(static_cast<float>(i) / segments, 0.0f)});
+    }
+
+    for (int i = 0; i < segments; ++i)
+        indices.insert(indices.end(), {0u, GLuint(2 + i * 4), GLuint(2 + ((i + 1) % segments) * 4)});
+    for (int i = 0; i < segments; ++i)
+        indices.insert(indices.end(), {1u, GLuint(3 + ((i + 1) % segments) * 4), GLuint(3 + i * 4)});
+    for (int i = 0; i < segments; ++i)
+    {
+        const GLuint v0 = 4 + i * 4;
+        const GLuint v1 = 5 + i * 4;
+        const GLuint v2 = 4 + (i + 1) * 4;
+        const GLuint v3 = 5 + (i + 1) * 4;
+        indices.insert(indices.end(), {v0, v3, v1, v0, v2, v3});
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "../Math/Bounds.hpp"
+#include "../Shading/GeometryBuffer.hpp"
+
+/// @brief 标准顶点格式, 与 GeometryBuffer::StandardStride 一致
+struct PrimitiveVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+};
+static_assert(sizeof(PrimitiveVertex) == GeometryBuffer::StandardStride, "PrimitiveVertex must match the standard vertex layout");
+
+/// @brief 一种参数组合的索引网格. CPU端数据保留给遮挡剔除, GPU端为 GeometryBuffer 中的一段
+struct PrimitiveGeometry
+{
+    std::vector<PrimitiveVertex> vertices;
+    std::vector<GLuint> indices;
+    GeometryHandle geometry;
+    BoundingVolume bounds;
+};
+// 所有持有者释放后网格被销毁, 下次请求时重新生成
+using PrimitiveHandle = std::shared_ptr<const PrimitiveGeometry>;
+
+/*
+程序化基本体注册表: 每种(基本体, 参数)组合只生成一次索引网格并上传一次, 对象之间通过句柄共享
+相同参数的 Sphere/Cube 等共用同一份CPU顶点与同一段GPU缓冲, 实例化与间接绘制也因此能识别它们
+注册表只持有弱引用, 不会让不再使用的网格常驻
+*/
+class PrimitiveRegistry
+{
+public:
+    struct Stats
+    {
+        size_t requests = 0;  // 累计请求数
+        size_t generated = 0; // 累计生成并上传的次数, 其余请求命中缓存
+        size_t primitives = 0; // 当前存活的网格数
+        size_t users = 0;      // 当前持有这些网格的句柄数
+        // 当前共享索引网格占用的顶点+索引字节数
+        size_t residentBytes = 0;
+        // 每个持有者各自保存展开后的三角形顶点(不共享, 不索引)时需要的字节数
+        size_t unsharedBytes = 0;
+        double uploadMs = 0.0;     // 累计生成与上传耗时
+        double lastUploadMs = 0.0; // 最近一次生成与上传耗时
+    };
+
+    /// @brief 全局注册表, 网格上传到 GeometryBuffer::Standard(), 需要GL上下文
+    static PrimitiveRegistry &Get();
+
+    /// @brief z轴为极轴的UV球
+    PrimitiveHandle sphere(float radius, int sectorCount = 36, int stackCount = 18);
+    /// @brief 以原点为中心的长方体, 每个面4个顶点
+    PrimitiveHandle cube(const glm::vec3 &size);
+    /// @brief y轴朝上的 xz 平面
+    PrimitiveHandle plane(float width, float depth);
+    /// @brief 底面在 z=0, 顶点在 z=height
+    PrimitiveHandle cone(float radius, float height, int segments);
+    /// @brief 以原点为中心, 轴为z轴
+    PrimitiveHandle cylinder(float radius, float height, int segments);
+
+    /// @brief 存活网格相关的统计在调用时遍历计算
+    Stats getStats() const;
+
+private:
+    enum class Type
+    {
+        Sphere,
+        Cube,
+        Plane,
+        Cone,
+        Cylinder
+    };
+    struct Key
+    {
+        Type type;
+        glm::vec3 size;
+        int segments[2];
+
+        bool operator<(const Key &other) const
+        {
+            return std::tie(type, size.x, size.y, size.z, segments[0], segments[1]) <
+                   std::tie(other.type, other.size.x, other.size.y, other.size.z, other.segments[0], other.segments[1]);
+        }
+    };
+
+    std::map<Key, std::weak_ptr<const PrimitiveGeometry>> m_primitives;
+    Stats m_stats;
+
+    PrimitiveRegistry() = default;
+    PrimitiveHandle acquire(const Key &key);
+    static void Generate(const Key &key, PrimitiveGeometry &primitive);
+    static void GenerateSphere(float radius, int sectorCount, int stackCount, PrimitiveGeometry &primitive);
+    static void GenerateCube(const glm::vec3 &size, PrimitiveGeometry &primitive);
+    static void GeneratePlane(float width, float depth, PrimitiveGeometry &primitive);
+    static void GenerateCone(float radius, float height, int segments, PrimitiveGeometry &primitive);
+    static void GenerateCylinder(float radius, float height, int segments, PrimitiveGeometry &primitive);
+};
@@ -0,0 +1,94 @@
+#include "Scene.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <random>
+
+namespace
+{
+    constexpr int WalkIterations = 10;
+
+    using Clock = std::chrono::steady_clock;
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // 与旧存储中的对象布局相同: 矩阵保存在堆上的对象内
+    class BenchmarkObject : public Object
+    {
+    public:
+        glm::mat4 modelMatrix = glm::identity<glm::mat4>();
+        void draw(glm::mat4 modelMatrix, Shader &shaders) override {}
+    };
+}
+
+Scene::BenchmarkResult Scene::Benchmark(size_t objectCount, uint32_t seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+
+    std::unordered_map<size_t, std::unique_ptr<Object>> objectMap;
+    Scene scene;
+    std::vector<SceneHandle> handles;
+    handles.reserve(objectCount);
+    for (size_t id = 0; id < objectCount; ++id)
+    {
+        const glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(position(generator), position(generator), position(generator)));
+        auto mapped = std::make_unique<BenchmarkObject>();
+        mapped->modelMatrix = transform;
+        objectMap.emplace(id, std::move(mapped));
+        handles.push_back(scene.addObject(std::make_unique<BenchmarkObject>(), transform));
+    }
+    const glm::mat4 root = glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
+    scene.updateTransforms(root);
+
+    BenchmarkResult result;
+    result.objectCount = objectCount;
+    // 累加矩阵分量, 避免遍历被优化掉
+    float checksum = 0.0f;
+    std::vector<DrawRange> ranges;
+
+    auto start = Clock::now();
+    for (int iteration = 0; iteration < WalkIterations; ++iteration)
+    {
+        for (auto &[id, object] : objectMap)
+        {
+            const glm::mat4 world = root * static_cast<const BenchmarkObject &>(*object).modelMatrix;
+            object->collectDrawRanges(ranges);
+            checksum += world[3][0];
+        }
+    }
+    result.mapWalkMs = ElapsedMs(start) / WalkIterations;
+
+    start = Clock::now();
+    for (int iteration = 0; iteration < WalkIterations; ++iteration)
+    {
+        for (size_t i = 0; i < scene.size(); ++i)
+        {
+            const glm::mat4 &world = scene.worldTransformAt(i);
+            scene.objectAt(i).collectDrawRanges(ranges);
+            checksum += world[3][0];
+        }
+    }
+    result.denseWalkMs = ElapsedMs(start) / WalkIterations;
+
+    std::vector<size_t> order(objectCount);
+    for (size_t i = 0; i < objectCount; ++i)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), generator);
+
+    start = Clock::now();
+    for (size_t id : order)
+        checksum += static_cast<const BenchmarkObject &>(*objectMap.find(id)->second).modelMatrix[3][1];
+    result.mapLookupMs = ElapsedMs(start);
+
+    start = Clock::now();
+    for (size_t id : order)
+        checksum += scene.getWorldTransform(handles[id])[3][1];
+    result.handleLookupMs = ElapsedMs(start);
+
+    // 结果不用于判断, 只防止以上循环被当作无副作用代码删除
+    volatile float sink = checksum;
+    (void)sink;
+    return result;
+}
@@ -0,0 +1,509 @@
+#pragma once
+#include "Object.hpp"
+#include "../Math/BVH.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief 场景对象句柄. index 指向稀疏槽位, generation 用于识别槽位复用后的失效句柄
+struct SceneHandle
+{
+    static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+    uint32_t index = InvalidIndex;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != InvalidIndex; }
+    bool operator==(const SceneHandle &other) const = default;
+};
+
+/*
+场景存储: generational slot map + SoA 稠密数组
+稀疏槽位 m_slots[handle.index] -> 稠密下标
+稠密数组中同一下标对应同一对象, 删除时与末尾交换保持连续
+渲染pass只遍历稠密数组, 不再经过哈希节点
+
+变换层级: 每个对象保存父句柄与局部矩阵, 世界矩阵每帧由 updateTransforms 按深度顺序批量计算一次
+修改局部矩阵只置脏标记, 脏标记沿父子关系向下传播, 未变化的对象直接复用缓存
+
+空间查询: 世界包围体上建 BVH4. 增删对象后重建, 仅变换变化时 refit
+*/
+class Scene
+{
+private:
+    struct Slot
+    {
+        uint32_t denseIndex = SceneHandle::InvalidIndex;
+        uint32_t generation = 0;
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+
+    // 稠密数组(SoA)
+    std::vector<SceneHandle> m_handles;
+    std::vector<SceneHandle> m_parents;
+    std::vector<glm::mat4> m_localTransforms;
+    std::vector<glm::mat4> m_worldTransforms;
+    std::vector<BoundingVolume> m_worldBounds; // 随世界矩阵一起更新, 供各pass剔除
+    std::vector<uint8_t> m_localDirty;   // 局部矩阵被修改, 等待下一次 updateTransforms
+    std::vector<uint8_t> m_worldChanged; // 最近一次 updateTransforms 中世界矩阵发生变化
+    std::vector<uint8_t> m_occluder;     // 作为软件遮挡剔除的遮挡体
+    std::vector<std::unique_ptr<Object>> m_objects;
+
+    // 按深度排序的稠密下标, 保证父节点先于子节点计算
+    std::vector<uint32_t> m_updateOrder;
+    bool m_hierarchyChanged = false;
+    glm::mat4 m_rootTransform = glm::identity<glm::mat4>();
+
+    std::unordered_map<std::string, SceneHandle> m_nameIndex;
+    std::unordered_map<std::string, size_t> m_nameCountMap;
+    std::vector<SceneHandle> m_eraseList;
+
+    BVH4 m_bvh;
+    bool m_bvhDirty = true;
+    std::vector<uint32_t> m_unbounded;      // 无包围体的对象, 不进BVH, 查询时总是返回
+    std::vector<uint32_t> m_changedIndices; // 本帧世界矩阵变化的对象
+    uint64_t m_structureVersion = 0;        // 增删对象(稠密下标变化)时递增
+
+public:
+    /// @brief 自上次 clearChangeLog 以来增删的句柄, 供增量维护的索引(如层次面板)使用
+    ///        记录超过 MaxChangeLog 条时清空并置 overflow, 使用者应整体重建
+    struct ChangeLog
+    {
+        std::vector<SceneHandle> added;
+        std::vector<SceneHandle> removed;
+        bool overflow = false;
+    };
+    static constexpr size_t MaxChangeLog = 1 << 16;
+
+    struct BenchmarkResult
+    {
+        size_t objectCount = 0;
+        // 每帧遍历全部对象(读取世界矩阵并调用 collectDrawRanges)的平均耗时
+        double mapWalkMs = 0.0; // 旧存储: unordered_map<size_t, unique_ptr<Object>>, 矩阵保存在对象内
+        double denseWalkMs = 0.0;
+        // 按编号/句柄随机查找 objectCount 次的总耗时
+        double mapLookupMs = 0.0;
+        double handleLookupMs = 0.0;
+    };
+
+    /// @brief 生成 objectCount 个对象, 分别放入旧的哈希表存储与稠密数组, 比较遍历与查找耗时
+    static BenchmarkResult Benchmark(size_t objectCount, uint32_t seed = 1);
+
+private:
+    ChangeLog m_changeLog;
+
+public:
+    Scene() = default;
+    ~Scene() = default;
+    // 禁用拷贝构造和赋值
+    Scene(const Scene &) = delete;
+    Scene &operator=(const Scene &) = delete;
+    // 启用移动构造和赋值
+    Scene(Scene &&) = default;
+    Scene &operator=(Scene &&) = default;
+
+public: // 稠密遍历
+    size_t size() const { return m_objects.size(); }
+    bool empty() const { return m_objects.empty(); }
+
+    SceneHandle handleAt(size_t denseIndex) const { return m_handles[denseIndex]; }
+    Object &objectAt(size_t denseIndex) { return *m_objects[denseIndex]; }
+    const Object &objectAt(size_t denseIndex) const { return *m_objects[denseIndex]; }
+    SceneHandle parentAt(size_t denseIndex) const { return m_parents[denseIndex]; }
+    const glm::mat4 &localTransformAt(size_t denseIndex) const { return m_localTransforms[denseIndex]; }
+    /// @brief 缓存的世界矩阵, 已包含根变换. 在 updateTransforms 之后有效
+    const glm::mat4 &worldTransformAt(size_t denseIndex) const { return m_worldTransforms[denseIndex]; }
+    bool worldChangedAt(size_t denseIndex) const { return m_worldChanged[denseIndex] != 0; }
+    /// @brief 最近一次 updateTransforms 使用的根变换, 即根节点的父世界矩阵
+    const glm::mat4 &getRootTransform() const { return m_rootTransform; }
+    /// @brief 世界空间包围体. 无效时表示对象不参与剔除
+    const BoundingVolume &worldBoundsAt(size_t denseIndex) const { return m_worldBounds[denseIndex]; }
+    bool isOccluderAt(size_t denseIndex) const { return m_occluder[denseIndex] != 0; }
+
+    const std::vector<glm::mat4> &worldTransforms() const { return m_worldTransforms; }
+    /// @brief 最近一次 updateTransforms 中世界矩阵变化的稠密下标
+    const std::vector<uint32_t> &changedIndices() const { return m_changedIndices; }
+    /// @brief 增删对象后变化, 缓存稠密下标的使用者据此重建
+    uint64_t structureVersion() const { return m_structureVersion; }
+    const ChangeLog &changeLog() const { return m_changeLog; }
+    void clearChangeLog() { m_changeLog = ChangeLog{}; }
+
+public:
+    /// @brief 添加对象,返回句柄 避免对象重名
+    /// @param transform 相对父节点的局部矩阵
+    /// @param parent 父节点句柄, 无效句柄表示挂在根下
+    SceneHandle addObject(std::unique_ptr<Object> obj, const glm::mat4 &transform = glm::identity<glm::mat4>(), SceneHandle parent = SceneHandle{})
+    {
+        if (parent.isValid() && !contains(parent))
+            throw std::runtime_error("Parent of object " + obj->name + " not found.");
+
+        makeNameUnique(*obj);
+
+        uint32_t slotIndex;
+        if (!m_freeSlots.empty())
+        {
+            slotIndex = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else
+        {
+            slotIndex = static_cast<uint32_t>(m_slots.size());
+            m_slots.emplace_back();
+        }
+        Slot &slot = m_slots[slotIndex];
+        slot.denseIndex = static_cast<uint32_t>(m_objects.size());
+
+        SceneHandle handle{slotIndex, slot.generation};
+        m_nameIndex[obj->name] = handle;
+        m_handles.push_back(handle);
+        m_parents.push_back(parent);
+        m_localTransforms.push_back(transform);
+        m_worldTransforms.push_back(transform);
+        m_worldBounds.push_back(obj->getLocalBounds().transform(transform));
+        m_localDirty.push_back(1);
+        m_worldChanged.push_back(1);
+        m_occluder.push_back(0);
+        m_objects.push_back(std::move(obj));
+        m_hierarchyChanged = true;
+        m_bvhDirty = true;
+        m_structureVersion++;
+        logChange(m_changeLog.added, handle);
+        return handle;
+    }
+
+    bool contains(SceneHandle handle) const
+    {
+        return handle.index < m_slots.size() &&
+               m_slots[handle.index].generation == handle.generation &&
+               m_slots[handle.index].denseIndex != SceneHandle::InvalidIndex;
+    }
+
+    /// @brief 句柄对应的稠密下标. 句柄失效时抛出异常
+    size_t denseIndexOf(SceneHandle handle) const
+    {
+        if (!contains(handle))
+            throw std::runtime_error("Object with handle " + std::to_string(handle.index) + ":" + std::to_string(handle.generation) + " not found.");
+        return m_slots[handle.index].denseIndex;
+    }
+
+    /// @brief 通过句柄获取对象引用
+    auto getObject(SceneHandle handle) -> Object &
+    {
+        return *m_objects[denseIndexOf(handle)];
+    }
+    auto getObject(const std::string &name) -> Object &
+    {
+        SceneHandle handle = findObject(name);
+        if (!handle.isValid())
+            throw std::runtime_error("Object with name " + name + " not found.");
+        return getObject(handle);
+    }
+
+    /// @brief 按名字查找句柄, O(1). 未找到返回无效句柄
+    SceneHandle findObject(const std::string &name) const
+    {
+        auto it = m_nameIndex.find(name);
+        if (it == m_nameIndex.end())
+            return SceneHandle{};
+        return it->second;
+    }
+
+    auto getLocalTransform(SceneHandle handle) const -> const glm::mat4 &
+    {
+        return m_localTransforms[denseIndexOf(handle)];
+    }
+    auto getWorldTransform(SceneHandle handle) const -> const glm::mat4 &
+    {
+        return m_worldTransforms[denseIndexOf(handle)];
+    }
+    void setLocalTransform(SceneHandle handle, const glm::mat4 &transform)
+    {
+        size_t denseIndex = denseIndexOf(handle);
+        m_localTransforms[denseIndex] = transform;
+        m_localDirty[denseIndex] = 1;
+    }
+
+    /// @brief 标记为遮挡体. 遮挡体应是大而简单的不透明物体, 如地面和墙
+    void setOccluder(SceneHandle handle, bool occluder)
+    {
+        m_occluder[denseIndexOf(handle)] = occluder ? 1 : 0;
+    }
+    bool isOccluder(SceneHandle handle) const
+    {
+        return m_occluder[denseIndexOf(handle)] != 0;
+    }
+
+    SceneHandle getParent(SceneHandle handle) const
+    {
+        return m_parents[denseIndexOf(handle)];
+    }
+    /// @brief 重新挂接父节点, 拒绝形成环
+    void setParent(SceneHandle handle, SceneHandle parent)
+    {
+        size_t denseIndex = denseIndexOf(handle);
+        for (SceneHandle it = parent; it.isValid(); it = m_parents[denseIndexOf(it)])
+        {
+            if (it == handle)
+                throw std::runtime_error("Cannot parent object " + m_objects[denseIndex]->name + " to its own descendant.");
+        }
+        m_parents[denseIndex] = parent;
+        m_localDirty[denseIndex] = 1;
+        m_hierarchyChanged = true;
+    }
+
+    /// @brief 每帧调用一次, 按深度顺序批量计算世界矩阵
+    /// @param rootTransform 作用于所有根节点的变换. 变化时整棵树重新计算
+    void updateTransforms(const glm::mat4 &rootTransform)
+    {
+        if (m_hierarchyChanged)
+        {
+            rebuildUpdateOrder();
+        }
+        // 本帧变化标记从局部脏标记开始
+        m_worldChanged.swap(m_localDirty);
+        std::fill(m_localDirty.begin(), m_localDirty.end(), 0);
+        if (rootTransform != m_rootTransform)
+        {
+            m_rootTransform = rootTransform;
+            std::fill(m_worldChanged.begin(), m_worldChanged.end(), 1);
+        }
+
+        m_changedIndices.clear();
+        for (uint32_t i : m_updateOrder)
+        {
+            const SceneHandle parent = m_parents[i];
+            if (parent.isValid())
+            {
+                const uint32_t p = m_slots[parent.index].denseIndex;
+                m_worldChanged[i] |= m_worldChanged[p];
+                if (m_worldChanged[i])
+                    m_worldTransforms[i] = m_worldTransforms[p] * m_localTransforms[i];
+            }
+            else if (m_worldChanged[i])
+            {
+                m_worldTransforms[i] = m_rootTransform * m_localTransforms[i];
+            }
+            if (m_worldChanged[i])
+            {
+                m_worldBounds[i] = m_objects[i]->getLocalBounds().transform(m_worldTransforms[i]);
+                m_changedIndices.push_back(i);
+            }
+        }
+        updateBVH();
+    }
+
+    /// @brief 收集与视锥相交的对象稠密下标, 追加到 out. 无包围体的对象总是返回
+    void queryVisible(const FrustumPlanes &frustum, std::vector<uint32_t> &out) const
+    {
+        out.insert(out.end(), m_unbounded.begin(), m_unbounded.end());
+        m_bvh.queryFrustum(frustum, m_worldBounds, out);
+    }
+    /// @brief 收集与球相交的对象稠密下标, 追加到 out
+    void queryVisible(const BoundingSphere &range, std::vector<uint32_t> &out) const
+    {
+        out.insert(out.end(), m_unbounded.begin(), m_unbounded.end());
+        m_bvh.querySphere(range, m_worldBounds, out);
+    }
+    /// @brief 射线拾取, 返回包围盒最先命中的对象. 未命中返回无效句柄
+    SceneHandle raycast(const glm::vec3 &origin, const glm::vec3 &direction) const
+    {
+        BVH4::RayHit hit = m_bvh.raycast(origin, direction, m_worldBounds);
+        return hit.isValid() ? m_handles[hit.primitive] : SceneHandle{};
+    }
+    const BVH4 &bvh() const { return m_bvh; }
+
+    /// @brief 通过句柄删除对象, 子节点一并删除
+    void removeObject(SceneHandle handle)
+    {
+        m_eraseList.push_back(handle);
+    }
+
+    void update()
+    {
+        deferredRemove();
+    }
+    ///////////////内部方法////////////////
+private:
+    void makeNameUnique(Object &obj)
+    {
+        auto it = m_nameCountMap.find(obj.name);
+        if (it == m_nameCountMap.end())
+        {
+            m_nameCountMap[obj.name] = 1;
+            if (!m_nameIndex.contains(obj.name))
+                return;
+            it = m_nameCountMap.find(obj.name);
+        }
+        const std::string baseName = obj.name;
+        size_t &count = it->second;
+        std::string candidate;
+        do
+        {
+            candidate = baseName + std::to_string(count);
+            count++;
+        } while (m_nameIndex.contains(candidate));
+        obj.setName(candidate);
+    }
+
+    /// @brief 与末尾交换后弹出, 保持稠密数组连续
+    void eraseDense(SceneHandle handle)
+    {
+        if (!contains(handle))
+            return;
+        Slot &slot = m_slots[handle.index];
+        const uint32_t denseIndex = slot.denseIndex;
+        const uint32_t lastIndex = static_cast<uint32_t>(m_objects.size() - 1);
+
+        m_nameIndex.erase(m_objects[denseIndex]->name);
+
+        if (denseIndex != lastIndex)
+        {
+            m_handles[denseIndex] = m_handles[lastIndex];
+            m_parents[denseIndex] = m_parents[lastIndex];
+            m_localTransforms[denseIndex] = m_localTransforms[lastIndex];
+            m_worldTransforms[denseIndex] = m_worldTransforms[lastIndex];
+            m_worldBounds[denseIndex] = m_worldBounds[lastIndex];
+            m_localDirty[denseIndex] = m_localDirty[lastIndex];
+            m_worldChanged[denseIndex] = m_worldChanged[lastIndex];
+            m_occluder[denseIndex] = m_occluder[lastIndex];
+            m_objects[denseIndex] = std::move(m_objects[lastIndex]);
+            m_slots[m_handles[denseIndex].index].denseIndex = denseIndex;
+        }
+        m_handles.pop_back();
+        m_parents.pop_back();
+        m_localTransforms.pop_back();
+        m_worldTransforms.pop_back();
+        m_worldBounds.pop_back();
+        m_localDirty.pop_back();
+        m_worldChanged.pop_back();
+        m_occluder.pop_back();
+        m_objects.pop_back();
+
+        slot.denseIndex = SceneHandle::InvalidIndex;
+        slot.generation++;
+        m_freeSlots.push_back(handle.index);
+        m_structureVersion++;
+        logChange(m_changeLog.removed, handle);
+    }
+
+    void logChange(std::vector<SceneHandle> &log, SceneHandle handle)
+    {
+        if (m_changeLog.overflow)
+            return;
+        if (m_changeLog.added.size() + m_changeLog.removed.size() >= MaxChangeLog)
+        {
+            m_changeLog = ChangeLog{};
+            m_changeLog.overflow = true;
+            return;
+        }
+        log.push_back(handle);
+    }
+
+    void rebuildBVH()
+    {
+        m_bvh.build(m_worldBounds);
+        m_unbounded.clear();
+        for (uint32_t i = 0; i < m_worldBounds.size(); ++i)
+        {
+            if (!m_worldBounds[i].isValid())
+                m_unbounded.push_back(i);
+        }
+        m_bvhDirty = false;
+    }
+
+    /// @brief 少量对象变化时只 refit 变化的叶子, 大量变化时整体 refit
+    void updateBVH()
+    {
+        if (m_bvhDirty)
+        {
+            rebuildBVH();
+            return;
+        }
+        if (m_changedIndices.empty())
+            return;
+        if (m_changedIndices.size() * 4 > m_worldBounds.size())
+            m_bvh.refitAll(m_worldBounds);
+        else if (!m_bvh.refit(m_worldBounds, m_changedIndices))
+            rebuildBVH();
+    }
+
+    /// @brief 计算各对象深度并按深度做计数排序
+    void rebuildUpdateOrder()
+    {
+        const uint32_t count = static_cast<uint32_t>(m_objects.size());
+        constexpr uint32_t Unknown = SceneHandle::InvalidIndex;
+        std::vector<uint32_t> depths(count, Unknown);
+        std::vector<uint32_t> chain;
+        uint32_t maxDepth = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            // 沿父链向上直到遇到已知深度的节点, 再回填
+            uint32_t current = i;
+            while (depths[current] == Unknown && m_parents[current].isValid())
+            {
+                chain.push_back(current);
+                current = m_slots[m_parents[current].index].denseIndex;
+            }
+            uint32_t depth = (depths[current] == Unknown) ? 0 : depths[current];
+            depths[current] = depth;
+            while (!chain.empty())
+            {
+                depths[chain.back()] = ++depth;
+                chain.pop_back();
+            }
+            maxDepth = std::max(maxDepth, depths[i]);
+        }
+
+        std::vector<uint32_t> offsets(maxDepth + 2, 0);
+        for (uint32_t i = 0; i < count; ++i)
+            offsets[depths[i] + 1]++;
+        for (uint32_t d = 1; d < offsets.size(); ++d)
+            offsets[d] += offsets[d - 1];
+        m_updateOrder.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+            m_updateOrder[offsets[depths[i]]++] = i;
+
+        m_hierarchyChanged = false;
+    }
+
+    /// @brief 延迟删除对象,在帧更新时调用
+    void deferredRemove()
+    {
+        if (m_eraseList.empty())
+            return;
+        // 父节点被删除时子节点一并删除. 深度顺序保证父节点先被标记
+        if (m_hierarchyChanged)
+            rebuildUpdateOrder();
+        std::vector<uint8_t> erased(m_objects.size(), 0);
+        for (auto handle : m_eraseList)
+        {
+            if (contains(handle))
+                erased[m_slots[handle.index].denseIndex] = 1;
+        }
+        for (uint32_t i : m_updateOrder)
+        {
+            const SceneHandle parent = m_parents[i];
+            if (parent.isValid() && erased[m_slots[parent.index].denseIndex])
+                erased[i] = 1;
+        }
+        std::vector<SceneHandle> toErase;
+        for (size_t i = 0; i < erased.size(); ++i)
+        {
+            if (erased[i])
+                toErase.push_back(m_handles[i]);
+        }
+        for (auto handle : toErase)
+        {
+            eraseDense(handle);
+        }
+        m_eraseList.clear();
+        m_hierarchyChanged = true;
+        // 稠密下标已变化, 立即重建, 保证帧间查询(如拾取)不越界
+        rebuildBVH();
+    }
+};
@@ -0,0 +1,267 @@
+#include "SceneGenerator.hpp"
+#include "Cone.hpp"
+#include "Cube.hpp"
+#include "Cylinder.hpp"
+#include "Plane.hpp"
+#include "Sphere.hpp"
+#include "Terrain.hpp"
+#include "WorldPartition.hpp"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+namespace
+{
+    // 只使用引擎的原始输出, 保证不同标准库实现下结果一致
+    class Random
+    {
+    public:
+        explicit Random(uint32_t seed) : m_engine(seed) {}
+        float next() { return static_cast<float>(m_engine() >> 8) * (1.0f / 16777216.0f); }
+        float range(float low, float high) { return low + (high - low) * next(); }
+        uint32_t below(uint32_t count) { return count > 0 ? static_cast<uint32_t>(m_engine() % count) : 0; }
+
+    private:
+        std::mt19937 m_engine;
+    };
+
+    constexpr int ScaleLevels = 4;
+
+    glm::vec3 HueToColor(float hue)
+    {
+        // HSV 转 RGB, 饱和度 0.8, 明度 1
+        glm::vec3 color;
+        for (int i = 0; i < 3; ++i)
+        {
+            const float k = std::fmod(float(5 - 2 * i) + hue * 6.0f, 6.0f);
+            color[i] = 1.0f - 0.8f * std::clamp(std::min(k, 4.0f - k), 0.0f, 1.0f);
+        }
+        return color;
+    }
+
+    class Placement
+    {
+    public:
+        Placement(const SceneGenerator::Settings &settings, Random &random) : m_settings(settings), m_random(random)
+        {
+            for (size_t i = 0; i < settings.clusterCount; ++i)
+                m_centers.emplace_back(random.range(-settings.extent, settings.extent), random.range(-settings.extent, settings.extent));
+        }
+
+        /// count 个位置中的第 index 个, 只有 Grid 分布用到序号
+        glm::vec2 position(size_t index, size_t count)
+        {
+            const float extent = m_settings.extent;
+            switch (m_settings.distribution)
+            {
+            case SceneGenerator::Distribution::Grid:
+            {
+                const size_t side = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(double(count)))));
+                const float spacing = 2.0f * extent / float(side);
+                const glm::vec2 cell(float(index % side) + 0.5f, float(index / side) + 0.5f);
+                const glm::vec2 jitter(m_random.range(-0.25f, 0.25f), m_random.range(-0.25f, 0.25f));
+                return glm::vec2(-extent) + (cell + jitter) * spacing;
+            }
+            case SceneGenerator::Distribution::Clustered:
+                if (!m_centers.empty())
+                {
+                    // 三个均匀分布之和近似正态, 密度向中心集中
+                    const glm::vec2 &center = m_centers[m_random.below(static_cast<uint32_t>(m_centers.size()))];
+                    auto offset = [&]
+                    { return (m_random.next() + m_random.next() + m_random.next() - 1.5f) / 1.5f * m_settings.clusterRadius; };
+                    return glm::clamp(center + glm::vec2(offset(), offset()), glm::vec2(-extent), glm::vec2(extent));
+                }
+                [[fallthrough]];
+            case SceneGenerator::Distribution::Uniform:
+            default:
+                return glm::vec2(m_random.range(-extent, extent), m_random.range(-extent, extent));
+            }
+        }
+
+    private:
+        const SceneGenerator::Settings &m_settings;
+        Random &m_random;
+        std::vector<glm::vec2> m_centers;
+    };
+}
+
+SceneGenerator::Result SceneGenerator::Generate(Scene &scene, Lights &lights, const Settings &settings)
+{
+    const auto start = std::chrono::steady_clock::now();
+    Result result;
+    Random random(settings.seed);
+    Placement placement(settings, random);
+
+    bool terrain = false;
+    if (settings.ground && settings.terrain)
+    {
+        Terrain::Desc desc;
+        desc.heightmap = settings.terrainHeightmap;
+        desc.resolution = settings.terrainResolution;
+        // 一个格子至少1个单位, 地形比对象分布范围大时中心部分覆盖分布范围
+        desc.worldSize = std::max(2.0f * settings.extent, float(settings.terrainResolution - 1));
+        desc.heightScale = settings.terrainHeight;
+        desc.seed = settings.seed;
+        try
+        {
+            Terrain::Get().create(desc);
+            terrain = true;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "SceneGenerator: " << e.what() << std::endl;
+        }
+    }
+    // 地形外或未使用地形时为0
+    const auto groundHeight = [terrain](const glm::vec2 &position)
+    {
+        return terrain ? Terrain::Get().heightAt(position.x, position.y) : 0.0f;
+    };
+    if (settings.ground && !terrain)
+    {
+        SceneHandle ground = scene.addObject(std::make_unique<Plane>(2.0f * settings.extent, 2.0f * settings.extent, "StressGround"));
+        scene.setOccluder(ground, true);
+    }
+
+    for (size_t i = 0; i < settings.objects; ++i)
+    {
+        const glm::vec2 position = placement.position(i, settings.objects);
+        const float yaw = random.range(0.0f, glm::two_pi<float>());
+        const bool model = !settings.models.empty() && random.next() < settings.modelFraction;
+        if (model)
+        {
+            const float scale = random.range(settings.minScale, settings.maxScale);
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(position.x, groundHeight(position), position.y));
+            transform = glm::rotate(transform, yaw, glm::vec3(0.0f, 1.0f, 0.0f));
+            transform = glm::scale(transform, glm::vec3(scale));
+            WorldPartition::Get().addInstance(settings.models[random.below(static_cast<uint32_t>(settings.models.size()))], transform);
+            result.modelInstances++;
+            continue;
+        }
+
+        // 尺寸只取几档, 同参数的网格共享
+        const int level = static_cast<int>(random.below(ScaleLevels));
+        const float size = settings.minScale + (settings.maxScale - settings.minScale) * float(level) / float(ScaleLevels - 1);
+        std::unique_ptr<Object> object;
+        switch (random.below(4))
+        {
+        case 0:
+            object = std::make_unique<Cube>(glm::vec3(size));
+            break;
+        case 1:
+            object = std::make_unique<Sphere>(0.5f * size);
+            break;
+        case 2:
+            object = std::make_unique<Cylinder>(0.5f * size, size);
+            break;
+        default:
+            object = std::make_unique<Cone>(0.5f * size, size);
+            break;
+        }
+        glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(position.x, groundHeight(position) + 0.5f * size, position.y));
+        transform = glm::rotate(transform, yaw, glm::vec3(0.0f, 1.0f, 0.0f));
+        scene.addObject(std::move(object), transform);
+        result.primitives++;
+    }
+
+    const size_t pointLightCount = settings.pointLights;
+    const size_t dirLightCount = settings.dirLights;
+
+    lights.pointLights.reserve(lights.pointLights.size() + pointLightCount);
+    for (size_t i = 0; i < pointLightCount; ++i)
+    {
+        const glm::vec2 position = placement.position(i, pointLightCount);
+        const float height = groundHeight(position) + random.range(2.0f, 10.0f);
+        lights.pointLights.emplace_back(HueToColor(random.next()), glm::vec3(position.x, height, position.y),
+                                        settings.pointShadowResolution, settings.pointLightRange);
+        result.pointLights++;
+    }
+
+    lights.dirLights.reserve(lights.dirLights.size() + dirLightCount);
+    const float dirIntensity = dirLightCount > 0 ? 1.0f / float(dirLightCount) : 0.0f;
+    for (size_t i = 0; i < dirLightCount; ++i)
+    {
+        // 方向光的位置表示光线来向
+        const float azimuth = random.range(0.0f, glm::two_pi<float>());
+        const float elevation = glm::radians(random.range(30.0f, 70.0f));
+        const glm::vec3 direction(std::cos(elevation) * std::cos(azimuth), std::sin(elevation), std::cos(elevation) * std::sin(azimuth));
+        lights.dirLights.emplace_back(glm::vec3(dirIntensity), direction * 100.0f, settings.dirShadowResolution);
+        result.dirLights++;
+    }
+
+    result.generateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+bool SceneGenerator::ParseArguments(int argc, char **argv, Settings &settings)
+{
+    bool found = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string flag = argv[i];
+        if (flag.rfind("--stress", 0) != 0)
+            continue;
+        found = true;
+        if (flag == "--stress")
+            continue;
+        if (i + 1 >= argc)
+            throw std::runtime_error("Missing value for " + flag);
+        const std::string value = argv[++i];
+        try
+        {
+            if (flag == "--stress-objects")
+                settings.objects = std::stoull(value);
+            else if (flag == "--stress-point-lights")
+                settings.pointLights = std::stoull(value);
+            else if (flag == "--stress-dir-lights")
+                settings.dirLights = std::stoull(value);
+            else if (flag == "--stress-seed")
+                settings.seed = static_cast<uint32_t>(std::stoul(value));
+            else if (flag == "--stress-extent")
+                settings.extent = std::stof(value);
+            else if (flag == "--stress-clusters")
+                settings.clusterCount = std::stoull(value);
+            else if (flag == "--stress-cluster-radius")
+                settings.clusterRadius = std::stof(value);
+            else if (flag == "--stress-model")
+                settings.models.push_back(value);
+            else if (flag == "--stress-model-fraction")
+                settings.modelFraction = std::stof(value);
+            else if (flag == "--stress-point-shadow-resolution")
+                settings.pointShadowResolution = std::stoi(value);
+            else if (flag == "--stress-terrain")
+            {
+                settings.terrain = true;
+                settings.terrainHeightmap = value == "procedural" ? std::string() : value;
+            }
+            else if (flag == "--stress-terrain-height")
+                settings.terrainHeight = std::stof(value);
+            else if (flag == "--stress-terrain-resolution")
+                settings.terrainResolution = static_cast<uint32_t>(std::stoul(value));
+            else if (flag == "--stress-distribution")
+            {
+                if (value == "uniform")
+                    settings.distribution = Distribution::Uniform;
+                else if (value == "grid")
+                    settings.distribution = Distribution::Grid;
+                else if (value == "clustered")
+                    settings.distribution = Distribution::Clustered;
+                else
+                    throw std::invalid_argument(value);
+            }
+            else
+                throw std::runtime_error("Unknown option " + flag);
+        }
+        catch (const std::logic_error &)
+        {
+            throw std::runtime_error("Invalid value '" + value + "' for " + flag);
+        }
+    }
+    return found;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Scene.hpp"
+#include "../LightSource/LightSource.hpp"
+
+/*
+压力测试场景生成器, 作为剔除/阴影/多光源的基准输入
+N 个对象(基本体与模型实例混合), M 个点光源, K 个方向光, 按给定分布放在 [-extent, extent]^2 的地面上
+同一种子在任何平台上生成相同的场景: 随机数只使用 std::mt19937 的原始输出, 不经过实现定义的标准分布
+基本体尺寸只取少数几档, 相同参数的网格由 PrimitiveRegistry 共享, 可被实例化合并
+模型实例交给 WorldPartition, 按相机距离流式加载. 点光源的阴影分辨率单独设置, 避免大量光源耗尽显存
+开启 terrain 时地面为覆盖 [-extent, extent]^2 的CDLOD地形(Terrain)而不是平面网格, 对象与光源放在地形高度上
+    高度按生成时常驻的概览查询, 近处瓦片读入后对象可能略微悬空或陷入地面
+光源存放在光源表(LightBuffer)中, 数目只受显存限制; 点光源阴影分辨率与主光源不同时各占一个阴影贴图数组
+*/
+class SceneGenerator
+{
+public:
+    enum class Distribution
+    {
+        Uniform,   // 均匀随机
+        Grid,      // 规则网格, 带少量抖动
+        Clustered  // 集中在若干个随机中心附近, 模拟城镇等密度不均的场景
+    };
+
+    struct Settings
+    {
+        size_t objects = 1000;
+        size_t pointLights = 8; // 可以为 0
+        size_t dirLights = 1;   // 可以为 0, 此时天空使用默认太阳
+        uint32_t seed = 1;
+        Distribution distribution = Distribution::Uniform;
+        float extent = 200.0f;         // 地面半边长
+        size_t clusterCount = 16;      // Clustered 分布的中心数
+        float clusterRadius = 20.0f;
+        float minScale = 0.5f;
+        float maxScale = 2.0f;
+        std::vector<std::string> models; // 模型实例使用的文件, 为空时全部为基本体
+        float modelFraction = 0.1f;      // 对象中模型实例的比例
+        int pointShadowResolution = 256;
+        int dirShadowResolution = 2048;
+        float pointLightRange = 30.0f;
+        bool ground = true;
+        bool terrain = false;         // 用地形代替平面地面
+        std::string terrainHeightmap; // 为空时程序生成
+        float terrainHeight = 60.0f;
+        uint32_t terrainResolution = 4097;
+    };
+
+    struct Result
+    {
+        size_t primitives = 0;
+        size_t modelInstances = 0;
+        size_t pointLights = 0;
+        size_t dirLights = 0;
+        double generateMs = 0.0;
+    };
+
+    /// @brief 向 scene 与 lights 追加对象与光源, 已有内容保留
+    static Result Generate(Scene &scene, Lights &lights, const Settings &settings);
+
+    /// @brief 解析 --stress 开头的命令行参数, 例如
+    ///        --stress-objects 10000 --stress-point-lights 64 --stress-dir-lights 2 --stress-seed 7
+    ///        --stress-distribution clustered --stress-extent 500 --stress-model path/to/model.obj --stress-model-fraction 0.2
+    ///        --stress-terrain procedural|path/to/height.r16 --stress-terrain-height 120 --stress-terrain-resolution 8193
+    /// @return 出现任何 --stress 参数时返回 true. 参数值无效时抛出 std::runtime_error
+    static bool ParseArguments(int argc, char **argv, Settings &settings);
+};
@@ -0,0 +1,180 @@
+#include "SkinnedModel.hpp"
+#include "../Shading/SkinningSystem.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // 计算包围体时每个动画的采样数
+    constexpr int BoundsSamplesPerClip = 32;
+
+    uint32_t Influence(const uint32_t packed[2], int k)
+    {
+        return (packed[k / 2] >> (16 * (k % 2))) & 0xFFFFu;
+    }
+}
+
+SkinnedAsset::~SkinnedAsset()
+{
+    if (m_sourceBuffer)
+        glDeleteBuffers(1, &m_sourceBuffer);
+}
+
+void SkinnedAsset::computeBounds()
+{
+    // 每个骨骼影响到的顶点在绑定姿态下的包围盒
+    std::vector<AABB> boneBoxes(skeleton.boneCount());
+    for (const SourceVertex &vertex : sources)
+    {
+        for (int k = 0; k < MaxInfluences; ++k)
+        {
+            if (Influence(vertex.weights, k) != 0)
+                boneBoxes[Influence(vertex.joints, k)].expand(glm::vec3(vertex.positionU));
+        }
+    }
+
+    // 蒙皮后的顶点位于其各骨骼变换结果的凸包内, 各骨骼变换后包围盒的并集是保守的
+    std::vector<glm::vec3> corners;
+    std::vector<glm::vec4> palette(skeleton.boneCount() * Animation::PaletteRowsPerBone);
+    SkeletonPose pose;
+    auto addPose = [&](const AnimationClip *clip, float time)
+    {
+        Animation::Sample(skeleton, clip, time, pose);
+        Animation::BuildPalette(skeleton, pose, palette.data());
+        for (size_t b = 0; b < boneBoxes.size(); ++b)
+        {
+            if (!boneBoxes[b].isValid())
+                continue;
+            const glm::vec4 *rows = palette.data() + b * Animation::PaletteRowsPerBone;
+            for (int c = 0; c < 8; ++c)
+            {
+                const glm::vec4 p((c & 1) ? boneBoxes[b].max.x : boneBoxes[b].min.x, (c & 2) ? boneBoxes[b].max.y : boneBoxes[b].min.y,
+                                  (c & 4) ? boneBoxes[b].max.z : boneBoxes[b].min.z, 1.0f);
+                corners.emplace_back(glm::dot(rows[0], p), glm::dot(rows[1], p), glm::dot(rows[2], p));
+            }
+        }
+    };
+    addPose(nullptr, 0.0f);
+    for (const AnimationClip &clip : clips)
+    {
+        for (int i = 0; i <= BoundsSamplesPerClip; ++i)
+            addPose(&clip, clip.duration * float(i) / float(BoundsSamplesPerClip));
+    }
+    bounds = corners.empty() ? BoundingVolume() : BoundingVolume::FromPositions(corners.data(), corners.size(), sizeof(glm::vec3));
+}
+
+GLuint SkinnedAsset::sourceBuffer()
+{
+    if (m_sourceBuffer == 0)
+    {
+        glGenBuffers(1, &m_sourceBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_sourceBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(1, sources.size()) * sizeof(SourceVertex), sources.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    return m_sourceBuffer;
+}
+
+SkinnedModel::SkinnedModel(std::shared_ptr<SkinnedAsset> asset, const std::string &name)
+    : m_asset(std::move(asset))
+{
+    setName(name);
+    localBounds = m_asset->bounds;
+    m_clip = m_asset->clips.empty() ? -1 : 0;
+
+    // 先以绑定姿态填充, 首次蒙皮(下一次 SkinningSystem::update)后被覆盖
+    std::vector<float> vertices;
+    for (const SkinnedAsset::Part &source : m_asset->parts)
+    {
+        vertices.resize(size_t(source.vertexCount) * 8);
+        for (uint32_t v = 0; v < source.vertexCount; ++v)
+        {
+            const SkinnedAsset::SourceVertex &vertex = m_asset->sources[source.firstSource + v];
+            float *out = vertices.data() + size_t(v) * 8;
+            out[0] = vertex.positionU.x;
+            out[1] = vertex.positionU.y;
+            out[2] = vertex.positionU.z;
+            out[3] = vertex.normalV.x;
+            out[4] = vertex.normalV.y;
+            out[5] = vertex.normalV.z;
+            out[6] = vertex.positionU.w;
+            out[7] = vertex.normalV.w;
+        }
+        // 蒙皮由计算着色器按 float 写入, 只能使用标准顶点格式
+        Part part;
+        part.buffer = &GeometryBuffer::Shared(GeometryBuffer::VertexFormat::Standard,
+                                              source.vertexCount <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+        part.geometry = part.buffer->allocate(vertices.data(), source.vertexCount, source.indices.data(), source.indices.size(), false);
+        part.batchKey = MaterialLibrary::Get().batchKey(source.materialId);
+        m_parts.push_back(std::move(part));
+    }
+    SkinningSystem::Get().add(*this);
+}
+
+SkinnedModel::~SkinnedModel()
+{
+    SkinningSystem::Get().remove(*this);
+}
+
+void SkinnedModel::setClip(int clip)
+{
+    m_clip = clip >= 0 && clip < static_cast<int>(m_asset->clips.size()) ? clip : -1;
+    m_time = 0.0f;
+    m_poseDirty = true;
+}
+
+void SkinnedModel::setTime(float time)
+{
+    m_time = std::max(time, 0.0f);
+    m_poseDirty = true;
+}
+
+bool SkinnedModel::advance(float deltaSeconds)
+{
+    bool changed = m_poseDirty;
+    m_poseDirty = false;
+    const AnimationClip *clip = currentClip();
+    if (!clip || !playing || deltaSeconds * speed == 0.0f)
+        return changed;
+
+    m_time += deltaSeconds * speed;
+    if (clip->duration <= 0.0f)
+        m_time = 0.0f;
+    else if (loop)
+        m_time = m_time - clip->duration * std::floor(m_time / clip->duration);
+    else if (m_time >= clip->duration || m_time <= 0.0f)
+    {
+        m_time = std::clamp(m_time, 0.0f, clip->duration);
+        playing = false;
+    }
+    return true;
+}
+
+void SkinnedModel::draw(glm::mat4 modelMatrix, Shader &shaders)
+{
+    shaders.setMat4("model", modelMatrix);
+    for (size_t i = 0; i < m_parts.size(); ++i)
+    {
+        const Part &part = m_parts[i];
+        part.buffer->bind();
+        shaders.setInt("materialId", static_cast<int>(m_asset->parts[i].materialId));
+        part.buffer->draw(*part.geometry);
+    }
+    shaders.setInt("materialId", MaterialLibrary::DefaultMaterial);
+    glBindVertexArray(0);
+}
+
+void SkinnedModel::collectDrawRanges(std::vector<DrawRange> &out) const
+{
+    for (size_t i = 0; i < m_parts.size(); ++i)
+    {
+        const Part &part = m_parts[i];
+        DrawRange range{part.buffer->getVAO(), part.geometry->indexCount, part.geometry->firstIndex,
+                        static_cast<GLint>(part.geometry->firstVertex)};
+        range.materialId = m_asset->parts[i].materialId;
+        range.material = part.batchKey;
+        range.indexType = part.buffer->getIndexType();
+        range.depthVao = part.buffer->getDepthVAO();
+        out.push_back(range);
+    }
+}
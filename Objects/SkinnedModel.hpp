@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Object.hpp"
+#include "../Math/Skeleton.hpp"
+#include "../Shading/GeometryBuffer.hpp"
+#include "../Shading/MaterialLibrary.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+/// @brief 导入的骨骼动画模型数据, 导入后不再修改, 同一模型的各实例共享
+struct SkinnedAsset
+{
+    static constexpr int MaxInfluences = 4;
+
+    // 蒙皮输入顶点, 与 Shaders/Skinning/skin.comp 中的 SourceVertex 布局一致
+    struct SourceVertex
+    {
+        glm::vec4 positionU;   // 绑定姿态位置, w 为纹理坐标 u
+        glm::vec4 normalV;     // 绑定姿态法线, w 为纹理坐标 v
+        uint32_t joints[2];    // 4个16位调色板下标
+        uint32_t weights[2];   // 4个 unorm16 权重, 和为1
+    };
+    static_assert(sizeof(SourceVertex) == 48, "SourceVertex must match the std430 layout in skin.comp");
+
+    // 一个网格: sources 中的一段顶点与引用它的索引
+    struct Part
+    {
+        uint32_t firstSource = 0;
+        uint32_t vertexCount = 0;
+        std::vector<unsigned int> indices;
+        uint32_t materialId = MaterialLibrary::DefaultMaterial;
+    };
+
+    Skeleton skeleton;
+    std::vector<AnimationClip> clips;
+    std::vector<SourceVertex> sources;
+    std::vector<Part> parts;
+    BoundingVolume bounds; // 静止姿态与所有动画采样姿态的保守包围体
+
+    SkinnedAsset() = default;
+    ~SkinnedAsset();
+    SkinnedAsset(const SkinnedAsset &) = delete;
+    SkinnedAsset &operator=(const SkinnedAsset &) = delete;
+
+    /// @brief 由每个骨骼影响到的顶点范围与各动画的采样姿态计算 bounds. 导入完成后调用一次
+    void computeBounds();
+    /// @brief sources 的SSBO, 首次调用时上传. 需在GL线程调用
+    GLuint sourceBuffer();
+
+private:
+    GLuint m_sourceBuffer = 0;
+};
+
+/*
+骨骼动画模型: 每帧由 SkinningSystem 在工作线程求值姿态, 再用计算着色器把蒙皮结果写入共享几何缓冲中本实例独占的顶点
+各pass(GBuffer, 级联阴影, 点光源立方体阴影, 仅位置的深度pass)按普通 DrawRange 读取同一份蒙皮结果, 顶点着色器不做蒙皮
+姿态不变(暂停, 停在末帧)时不重新蒙皮. 包围体取导入时对所有动画采样的保守结果, 不随姿态更新
+*/
+class SkinnedModel : public Object
+{
+public:
+    struct Part
+    {
+        GeometryBuffer *buffer = nullptr;
+        GeometryHandle geometry; // 不与其他分配合并, 蒙皮结果写入这里
+        uint64_t batchKey = 0;
+    };
+
+    SkinnedModel(std::shared_ptr<SkinnedAsset> asset, const std::string &name = "SkinnedModel");
+    ~SkinnedModel() override;
+    SkinnedModel(const SkinnedModel &) = delete;
+    SkinnedModel &operator=(const SkinnedModel &) = delete;
+
+    void draw(glm::mat4 modelMatrix, Shader &shaders) override;
+    void collectDrawRanges(std::vector<DrawRange> &out) const override;
+
+    const SkinnedAsset &getAsset() const { return *m_asset; }
+    const std::vector<Part> &getParts() const { return m_parts; }
+
+    /// @brief -1 表示静止姿态
+    int getClip() const { return m_clip; }
+    void setClip(int clip);
+    float getTime() const { return m_time; }
+    void setTime(float time);
+    float speed = 1.0f;
+    bool playing = true;
+    bool loop = true;
+
+    // SkinningSystem 调用
+    /// @brief 推进播放时间, 返回姿态是否需要重新求值与蒙皮
+    bool advance(float deltaSeconds);
+    const AnimationClip *currentClip() const { return m_clip >= 0 ? &m_asset->clips[m_clip] : nullptr; }
+    GLuint sourceBuffer() { return m_asset->sourceBuffer(); }
+
+private:
+    std::shared_ptr<SkinnedAsset> m_asset;
+    std::vector<Part> m_parts;
+    int m_clip = -1;
+    float m_time = 0.0f;
+    bool m_poseDirty = true; // 首帧及手动修改后需要蒙皮
+};
@@ -1,16 +1,9 @@
 #pragma once
-#include "Object.hpp"
+#include "Primitive.hpp"
 
-class Sphere : public Object
+class Sphere : public Primitive
 {
-private:
-    std::vector<float> vertices;
-    GLuint vao;
-    GLuint vbo;
-    std::vector<float> generateSphereVertices(float radius = 1.0f, int sectorCount = 36, int stackCount = 18);
-
 public:
     Sphere(float radius, int sectorCount = 36, int stackCount = 18, const std::string _name = "Sphere");
-    void draw(glm::mat4 modelMatrix, Shader &shaders) override;
     ~Sphere();
-};
\ No newline at end of file
+};
@@ -0,0 +1,803 @@
+#include "Terrain.hpp"
+#include "../Shading/Shader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t NoTile = std::numeric_limits<uint32_t>::max();
+    constexpr uint32_t TileSamples = Terrain::TileQuads + 1;
+    constexpr uint32_t LeavesPerTile = Terrain::TileQuads / Terrain::GridQuads;
+    constexpr GLsizei QuadrantIndices = Terrain::GridQuads * Terrain::GridQuads / 4 * 6;
+    constexpr float SampleScale = 1.0f / 65535.0f;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    template <typename T>
+    bool IsReady(const std::future<T> &future)
+    {
+        return future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready;
+    }
+
+    bool IsPowerOfTwo(uint32_t value)
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    uint32_t Log2(uint32_t value)
+    {
+        uint32_t result = 0;
+        while (value > 1)
+        {
+            value >>= 1;
+            result++;
+        }
+        return result;
+    }
+
+    // 整数哈希, 程序生成的地形在任何平台上都相同
+    uint32_t Hash(int32_t x, int32_t z, uint32_t seed)
+    {
+        uint32_t h = static_cast<uint32_t>(x) * 0x8da6b343u ^ static_cast<uint32_t>(z) * 0xd8163841u ^ seed * 0xcb1ab31fu;
+        h ^= h >> 16;
+        h *= 0x7feb352du;
+        h ^= h >> 15;
+        h *= 0x846ca68bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    float ValueNoise(float x, float z, uint32_t seed)
+    {
+        const float fx = std::floor(x);
+        const float fz = std::floor(z);
+        const int32_t ix = static_cast<int32_t>(fx);
+        const int32_t iz = static_cast<int32_t>(fz);
+        float tx = x - fx;
+        float tz = z - fz;
+        tx = tx * tx * (3.0f - 2.0f * tx);
+        tz = tz * tz * (3.0f - 2.0f * tz);
+        auto corner = [&](int32_t dx, int32_t dz)
+        { return static_cast<float>(Hash(ix + dx, iz + dz, seed) >> 8) * (1.0f / 16777216.0f); };
+        const float bottom = corner(0, 0) + (corner(1, 0) - corner(0, 0)) * tx;
+        const float top = corner(0, 1) + (corner(1, 1) - corner(0, 1)) * tx;
+        return bottom + (top - bottom) * tz;
+    }
+
+    // 归一化坐标 (0~1) 处的分形噪声, 结果在 0~1. 最细一级的周期约为两个采样
+    float ProceduralHeight(float u, float v, uint32_t seed, uint32_t octaves)
+    {
+        float sum = 0.0f;
+        float weight = 0.0f;
+        float amplitude = 0.5f;
+        float frequency = 4.0f;
+        for (uint32_t octave = 0; octave < octaves; ++octave)
+        {
+            sum += amplitude * ValueNoise(u * frequency, v * frequency, seed + octave);
+            weight += amplitude;
+            amplitude *= 0.5f;
+            frequency *= 2.0f;
+        }
+        // 噪声集中在0.5附近, 拉开后平方, 得到平缓的低地与较陡的山峰
+        const float h = std::clamp((sum / weight - 0.2f) / 0.6f, 0.0f, 1.0f);
+        return h * h;
+    }
+
+    /// 从 (x0, z0) 起每隔 stride 个采样读取 count x count 个采样
+    std::vector<uint16_t> ReadSamples(const Terrain::Desc &desc, uint32_t x0, uint32_t z0, uint32_t count, uint32_t stride)
+    {
+        std::vector<uint16_t> samples(size_t(count) * count);
+        const uint32_t quads = desc.resolution - 1;
+        if (desc.heightmap.empty())
+        {
+            const uint32_t octaves = std::clamp<uint32_t>(Log2(quads) - 2, 1, 16);
+            const float scale = 1.0f / float(quads);
+            for (uint32_t z = 0; z < count; ++z)
+                for (uint32_t x = 0; x < count; ++x)
+                {
+                    const float h = ProceduralHeight(float(x0 + x * stride) * scale, float(z0 + z * stride) * scale, desc.seed, octaves);
+                    samples[size_t(z) * count + x] = static_cast<uint16_t>(std::lround(h * 65535.0f));
+                }
+            return samples;
+        }
+
+        std::ifstream file(desc.heightmap, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("cannot open " + desc.heightmap.string());
+        // 按行读取连续的一段, 再按步长抽取. 文件为小端序
+        std::vector<unsigned char> row((size_t(count - 1) * stride + 1) * 2);
+        for (uint32_t z = 0; z < count; ++z)
+        {
+            const uint64_t offset = (uint64_t(z0 + z * stride) * desc.resolution + x0) * 2;
+            file.seekg(static_cast<std::streamoff>(offset));
+            file.read(reinterpret_cast<char *>(row.data()), static_cast<std::streamsize>(row.size()));
+            if (!file)
+                throw std::runtime_error("truncated heightmap " + desc.heightmap.string());
+            for (uint32_t x = 0; x < count; ++x)
+            {
+                const size_t i = size_t(x) * stride * 2;
+                samples[size_t(z) * count + x] = static_cast<uint16_t>(row[i] | (row[i + 1] << 8));
+            }
+        }
+        return samples;
+    }
+
+    float DistanceSquared(const AABB &box, const glm::vec3 &point)
+    {
+        const glm::vec3 d = glm::max(glm::max(box.min - point, point - box.max), glm::vec3(0.0f));
+        return glm::dot(d, d);
+    }
+
+    bool Intersects(const FrustumPlanes &frustum, const AABB &box)
+    {
+        return frustum.intersects(box);
+    }
+
+    bool Intersects(const BoundingSphere &sphere, const AABB &box)
+    {
+        return DistanceSquared(box, sphere.center) <= sphere.radius * sphere.radius;
+    }
+
+    // 双线性插值, s 为采样坐标
+    float Bilinear(const uint16_t *samples, uint32_t size, glm::vec2 s)
+    {
+        s = glm::clamp(s, glm::vec2(0.0f), glm::vec2(float(size - 1)));
+        const uint32_t x = std::min(static_cast<uint32_t>(s.x), size - 2);
+        const uint32_t z = std::min(static_cast<uint32_t>(s.y), size - 2);
+        const float tx = s.x - float(x);
+        const float tz = s.y - float(z);
+        const uint16_t *row = samples + size_t(z) * size + x;
+        const float bottom = row[0] + (float(row[1]) - row[0]) * tx;
+        const float top = row[size] + (float(row[size + 1]) - row[size]) * tx;
+        return (bottom + (top - bottom) * tz) * SampleScale;
+    }
+}
+
+Terrain &Terrain::Get()
+{
+    static Terrain terrain;
+    return terrain;
+}
+
+Terrain::~Terrain()
+{
+    for (PendingTile &pending : m_pending)
+    {
+        if (pending.data.valid())
+            pending.data.wait();
+    }
+    for (auto &future : m_abandoned)
+    {
+        if (future.valid())
+            future.wait();
+    }
+    // GL上下文在静态对象析构时可能已销毁, 纹理与缓冲随上下文释放
+}
+
+void Terrain::create(const Desc &desc)
+{
+    clear();
+    if (desc.resolution < 2 || desc.worldSize <= 0.0f)
+        throw std::runtime_error("invalid terrain size");
+    const uint32_t quads = desc.resolution - 1;
+    if (quads % TileQuads != 0 || !IsPowerOfTwo(quads / TileQuads))
+        throw std::runtime_error("terrain resolution must be " + std::to_string(TileQuads) + " * 2^n + 1, got " + std::to_string(desc.resolution));
+    const uint32_t levels = Log2(quads / GridQuads) + 1;
+    if (levels > MaxLevels)
+        throw std::runtime_error("terrain resolution " + std::to_string(desc.resolution) + " exceeds " + std::to_string(MaxLevels) + " LOD levels");
+    if (!desc.heightmap.empty())
+    {
+        std::error_code error;
+        const uintmax_t bytes = std::filesystem::file_size(desc.heightmap, error);
+        if (error || bytes != uintmax_t(desc.resolution) * desc.resolution * 2)
+            throw std::runtime_error(desc.heightmap.string() + " is not a " + std::to_string(desc.resolution) + "x" +
+                                     std::to_string(desc.resolution) + " 16-bit raw heightmap");
+    }
+
+    m_desc = desc;
+    m_quads = quads;
+    m_tileLevel = Log2(TileQuads / GridQuads);
+    m_tilesPerSide = quads / TileQuads;
+    // 概览步长不超过比瓦片粗一级的顶点间距, 使用概览的节点的顶点都落在真实采样上
+    m_overviewQuads = std::min(quads, std::max<uint32_t>(OverviewMinQuads, quads >> (m_tileLevel + 1)));
+    m_overviewStride = quads / m_overviewQuads;
+    m_quadSize = desc.worldSize / float(quads);
+    m_origin = glm::vec2(-0.5f * desc.worldSize);
+    m_overview = ReadSamples(desc, 0, 0, m_overviewQuads + 1, m_overviewStride);
+    m_tiles.assign(size_t(m_tilesPerSide) * m_tilesPerSide, Tile{});
+    m_levels = levels;
+
+    initNodeRanges();
+    if (!m_vao)
+        createGrid();
+    createTextures();
+    computeRanges();
+    m_stats.levels = m_levels;
+    m_stats.tiles = m_tiles.size();
+}
+
+void Terrain::clear()
+{
+    for (PendingTile &pending : m_pending)
+        m_abandoned.push_back(std::move(pending.data));
+    m_pending.clear();
+    m_levels = 0;
+    m_overview.clear();
+    m_nodeRange.clear();
+    m_tiles.clear();
+    m_tileSamples.clear();
+    m_layerTile.clear();
+    m_freeLayers.clear();
+    m_wanted.clear();
+    m_receiverBounds.clear();
+    releaseTextures();
+    m_stats = Stats{};
+    m_frame = Stats{};
+}
+
+void Terrain::createGrid()
+{
+    constexpr uint32_t side = GridQuads + 1;
+    std::vector<glm::vec2> vertices;
+    vertices.reserve(side * side);
+    for (uint32_t j = 0; j < side; ++j)
+        for (uint32_t i = 0; i < side; ++i)
+            vertices.emplace_back(float(i) / GridQuads, float(j) / GridQuads);
+
+    // 按象限排列索引, 每个象限是一段连续的索引; 从上方看为逆时针
+    constexpr uint32_t half = GridQuads / 2;
+    std::vector<uint16_t> indices;
+    indices.reserve(size_t(QuadrantIndices) * 4);
+    for (uint32_t quadrant = 0; quadrant < 4; ++quadrant)
+    {
+        const uint32_t i0 = (quadrant & 1) * half;
+        const uint32_t j0 = (quadrant >> 1) * half;
+        for (uint32_t j = j0; j < j0 + half; ++j)
+            for (uint32_t i = i0; i < i0 + half; ++i)
+            {
+                const uint16_t v00 = static_cast<uint16_t>(j * side + i);
+                const uint16_t v10 = static_cast<uint16_t>(v00 + 1);
+                const uint16_t v01 = static_cast<uint16_t>(v00 + side);
+                const uint16_t v11 = static_cast<uint16_t>(v01 + 1);
+                indices.insert(indices.end(), {v00, v01, v10, v10, v01, v11});
+            }
+    }
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_vbo);
+    glGenBuffers(1, &m_ebo);
+    glGenBuffers(1, &m_nodeBuffer);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void *)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Terrain::createTextures()
+{
+    releaseTextures();
+    const uint32_t layers = std::max<uint32_t>(m_settings.tileCacheLayers, 1);
+    // 16位采样的行长度不一定是4字节的倍数
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+
+    const GLsizei overviewSize = static_cast<GLsizei>(m_overviewQuads + 1);
+    glGenTextures(1, &m_overviewTexture);
+    glBindTexture(GL_TEXTURE_2D, m_overviewTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, overviewSize, overviewSize, 0, GL_RED, GL_UNSIGNED_SHORT, m_overview.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenTextures(1, &m_tileTexture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_tileTexture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R16, TileSamples, TileSamples, layers, 0, GL_RED, GL_UNSIGNED_SHORT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    m_layerTile.assign(layers, NoTile);
+    m_freeLayers.clear();
+    for (uint32_t layer = layers; layer-- > 0;)
+        m_freeLayers.push_back(layer);
+    m_tileSamples.assign(size_t(layers) * TileSamples * TileSamples, 0);
+    m_stats.cacheBytes = (size_t(overviewSize) * overviewSize + size_t(layers) * TileSamples * TileSamples) * sizeof(uint16_t);
+}
+
+void Terrain::releaseTextures()
+{
+    if (m_overviewTexture)
+        glDeleteTextures(1, &m_overviewTexture);
+    if (m_tileTexture)
+        glDeleteTextures(1, &m_tileTexture);
+    m_overviewTexture = 0;
+    m_tileTexture = 0;
+}
+
+void Terrain::computeRanges()
+{
+    const float morphStart = std::clamp(m_settings.morphStart, 0.0f, 0.95f);
+    float range = float(GridQuads) * m_quadSize * std::max(m_settings.lodRangeScale, 1.0f);
+    float previous = 0.0f;
+    for (uint32_t level = 0; level < m_levels; ++level)
+    {
+        const float start = previous + (range - previous) * morphStart;
+        m_ranges[level] = range;
+        m_morph[level] = glm::vec4(start, 1.0f / (range - start), 0.0f, 0.0f);
+        previous = range;
+        range *= 2.0f;
+    }
+}
+
+void Terrain::initNodeRanges()
+{
+    // 叶节点的范围取覆盖它的概览采样, 用概览绘制时顶点的高度不会超出
+    const uint32_t leaves = m_quads / GridQuads;
+    const uint32_t overviewSize = m_overviewQuads + 1;
+    m_nodeRange.assign(m_levels, {});
+    m_nodeRange[0].resize(size_t(leaves) * leaves);
+    for (uint32_t lz = 0; lz < leaves; ++lz)
+    {
+        const uint32_t z0 = lz * GridQuads / m_overviewStride;
+        const uint32_t z1 = ((lz + 1) * GridQuads + m_overviewStride - 1) / m_overviewStride;
+        for (uint32_t lx = 0; lx < leaves; ++lx)
+        {
+            const uint32_t x0 = lx * GridQuads / m_overviewStride;
+            const uint32_t x1 = ((lx + 1) * GridQuads + m_overviewStride - 1) / m_overviewStride;
+            uint16_t low = std::numeric_limits<uint16_t>::max();
+            uint16_t high = 0;
+            for (uint32_t z = z0; z <= z1; ++z)
+                for (uint32_t x = x0; x <= x1; ++x)
+                {
+                    const uint16_t sample = m_overview[size_t(z) * overviewSize + x];
+                    low = std::min(low, sample);
+                    high = std::max(high, sample);
+                }
+            m_nodeRange[0][size_t(lz) * leaves + lx] = glm::vec2(low, high) * SampleScale;
+        }
+    }
+    for (uint32_t level = 1; level < m_levels; ++level)
+    {
+        const uint32_t n = leaves >> level;
+        m_nodeRange[level].resize(size_t(n) * n);
+        for (uint32_t z = 0; z < n; ++z)
+            for (uint32_t x = 0; x < n; ++x)
+            {
+                glm::vec2 range(1.0f, 0.0f);
+                for (uint32_t child = 0; child < 4; ++child)
+                {
+                    const glm::vec2 &c = m_nodeRange[level - 1][size_t(z * 2 + (child >> 1)) * (n * 2) + x * 2 + (child & 1)];
+                    range = glm::vec2(std::min(range.x, c.x), std::max(range.y, c.y));
+                }
+                m_nodeRange[level][size_t(z) * n + x] = range;
+            }
+    }
+}
+
+void Terrain::updateNodeRanges(uint32_t tile, const std::vector<glm::vec2> &leafRange)
+{
+    // 与概览得到的范围合并, 无论瓦片是否常驻都是保守的
+    const uint32_t leaves = m_quads / GridQuads;
+    const uint32_t tx = tile % m_tilesPerSide;
+    const uint32_t tz = tile / m_tilesPerSide;
+    for (uint32_t lz = 0; lz < LeavesPerTile; ++lz)
+        for (uint32_t lx = 0; lx < LeavesPerTile; ++lx)
+        {
+            glm::vec2 &range = m_nodeRange[0][size_t(tz * LeavesPerTile + lz) * leaves + tx * LeavesPerTile + lx];
+            const glm::vec2 &tileRange = leafRange[lz * LeavesPerTile + lx];
+            range = glm::vec2(std::min(range.x, tileRange.x), std::max(range.y, tileRange.y));
+        }
+    // 向上更新覆盖该瓦片的各级节点
+    for (uint32_t level = 1; level < m_levels; ++level)
+    {
+        const uint32_t n = leaves >> level;
+        const uint32_t x0 = (tx * LeavesPerTile) >> level;
+        const uint32_t x1 = ((tx + 1) * LeavesPerTile - 1) >> level;
+        const uint32_t z0 = (tz * LeavesPerTile) >> level;
+        const uint32_t z1 = ((tz + 1) * LeavesPerTile - 1) >> level;
+        for (uint32_t z = z0; z <= z1; ++z)
+            for (uint32_t x = x0; x <= x1; ++x)
+            {
+                glm::vec2 &range = m_nodeRange[level][size_t(z) * n + x];
+                for (uint32_t child = 0; child < 4; ++child)
+                {
+                    const glm::vec2 &c = m_nodeRange[level - 1][size_t(z * 2 + (child >> 1)) * (n * 2) + x * 2 + (child & 1)];
+                    range = glm::vec2(std::min(range.x, c.x), std::max(range.y, c.y));
+                }
+            }
+    }
+}
+
+Terrain::TileData Terrain::LoadTile(const Desc &desc, uint32_t tileX, uint32_t tileZ)
+{
+    TileData data;
+    data.samples = ReadSamples(desc, tileX * TileQuads, tileZ * TileQuads, TileSamples, 1);
+    data.leafRange.resize(LeavesPerTile * LeavesPerTile);
+    for (uint32_t lz = 0; lz < LeavesPerTile; ++lz)
+        for (uint32_t lx = 0; lx < LeavesPerTile; ++lx)
+        {
+            uint16_t low = std::numeric_limits<uint16_t>::max();
+            uint16_t high = 0;
+            for (uint32_t z = lz * GridQuads; z <= (lz + 1) * GridQuads; ++z)
+                for (uint32_t x = lx * GridQuads; x <= (lx + 1) * GridQuads; ++x)
+                {
+                    const uint16_t sample = data.samples[size_t(z) * TileSamples + x];
+                    low = std::min(low, sample);
+                    high = std::max(high, sample);
+                }
+            data.leafRange[lz * LeavesPerTile + lx] = glm::vec2(low, high) * SampleScale;
+        }
+    return data;
+}
+
+void Terrain::update(const glm::vec3 &cameraPosition, const FrustumPlanes &cameraFrustum)
+{
+    // 上一帧的绘制统计
+    m_stats.passes = m_frame.passes;
+    m_stats.nodes = m_frame.nodes;
+    m_stats.culledNodes = m_frame.culledNodes;
+    m_stats.triangles = m_frame.triangles;
+    m_stats.selectMs = m_frame.selectMs;
+    m_frame = Stats{};
+
+    for (auto it = m_abandoned.begin(); it != m_abandoned.end();)
+    {
+        if (IsReady(*it))
+            it = m_abandoned.erase(it);
+        else
+            ++it;
+    }
+    if (!isEnabled())
+        return;
+
+    m_lodCamera = cameraPosition;
+    computeRanges();
+    uploadReadyTiles();
+    requestTiles(cameraPosition);
+
+    // 相机可见的节点作为阴影接收体, 象限只取对应子节点的范围
+    m_receiverBounds.clear();
+    if (m_settings.visible)
+    {
+        selectAll(cameraFrustum);
+        for (const Selected &selected : m_selected)
+        {
+            if (selected.part == Full)
+                m_receiverBounds.push_back(nodeBounds(selected.level, selected.x, selected.z));
+            else
+                m_receiverBounds.push_back(nodeBounds(selected.level - 1, selected.x * 2 + (selected.part & 1), selected.z * 2 + (selected.part >> 1)));
+        }
+    }
+
+    m_stats.residentTiles = m_layerTile.size() - m_freeLayers.size();
+    m_stats.inFlightReads = m_pending.size();
+}
+
+void Terrain::requestTiles(const glm::vec3 &cameraPosition)
+{
+    // 只有瓦片级及更细的节点使用瓦片, 它们都在瓦片级的LOD范围内. 按水平距离判断, 比节点选择用的三维距离保守
+    const float radius = m_ranges[m_tileLevel];
+    const float tileSize = float(TileQuads) * m_quadSize;
+    const glm::vec2 camera(cameraPosition.x, cameraPosition.z);
+    const glm::vec2 first = glm::floor((camera - radius - m_origin) / tileSize);
+    const glm::vec2 last = glm::floor((camera + radius - m_origin) / tileSize);
+    const int maxTile = static_cast<int>(m_tilesPerSide) - 1;
+    const int x0 = std::clamp(static_cast<int>(first.x), 0, maxTile);
+    const int z0 = std::clamp(static_cast<int>(first.y), 0, maxTile);
+    const int x1 = std::clamp(static_cast<int>(last.x), 0, maxTile);
+    const int z1 = std::clamp(static_cast<int>(last.y), 0, maxTile);
+
+    std::vector<std::pair<float, uint32_t>> candidates;
+    for (int z = z0; z <= z1; ++z)
+        for (int x = x0; x <= x1; ++x)
+        {
+            const glm::vec2 low = m_origin + glm::vec2(x, z) * tileSize;
+            const glm::vec2 d = glm::max(glm::max(low - camera, camera - low - tileSize), glm::vec2(0.0f));
+            const float distance = glm::length(d);
+            if (distance <= radius)
+                candidates.emplace_back(distance, static_cast<uint32_t>(z) * m_tilesPerSide + static_cast<uint32_t>(x));
+        }
+    std::sort(candidates.begin(), candidates.end());
+    // 超出缓存容量的远处瓦片不请求, 由概览绘制
+    candidates.resize(std::min(candidates.size(), m_layerTile.size()));
+
+    m_wanted.clear();
+    for (const auto &[distance, tile] : candidates)
+    {
+        m_wanted.push_back(tile);
+        if (m_tiles[tile].state != TileState::Absent || m_pending.size() >= m_settings.maxInFlightReads)
+            continue;
+        m_tiles[tile].state = TileState::Loading;
+        m_pending.push_back(PendingTile{tile, std::async(std::launch::async, LoadTile, m_desc, tile % m_tilesPerSide, tile / m_tilesPerSide)});
+    }
+}
+
+int Terrain::acquireLayer()
+{
+    if (!m_freeLayers.empty())
+    {
+        const uint32_t layer = m_freeLayers.back();
+        m_freeLayers.pop_back();
+        return static_cast<int>(layer);
+    }
+    // 替换本帧不需要的瓦片中最远的一个
+    const float tileSize = float(TileQuads) * m_quadSize;
+    const glm::vec2 camera(m_lodCamera.x, m_lodCamera.z);
+    int best = -1;
+    float bestDistance = -1.0f;
+    for (uint32_t layer = 0; layer < m_layerTile.size(); ++layer)
+    {
+        const uint32_t tile = m_layerTile[layer];
+        if (tile == NoTile || std::find(m_wanted.begin(), m_wanted.end(), tile) != m_wanted.end())
+            continue;
+        const glm::vec2 center = m_origin + (glm::vec2(tile % m_tilesPerSide, tile / m_tilesPerSide) + 0.5f) * tileSize;
+        const float distance = glm::length(center - camera);
+        if (distance > bestDistance)
+        {
+            bestDistance = distance;
+            best = static_cast<int>(layer);
+        }
+    }
+    if (best >= 0)
+    {
+        m_tiles[m_layerTile[best]] = Tile{};
+        m_layerTile[best] = NoTile;
+        m_stats.evictions++;
+    }
+    return best;
+}
+
+void Terrain::uploadReadyTiles()
+{
+    m_stats.uploads = 0;
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        if (m_stats.uploads >= m_settings.maxUploadsPerFrame)
+            break;
+        if (!IsReady(it->data))
+        {
+            ++it;
+            continue;
+        }
+        const uint32_t tile = it->tile;
+        TileData data;
+        try
+        {
+            data = it->data.get();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Terrain: " << e.what() << std::endl;
+            m_tiles[tile] = Tile{};
+            it = m_pending.erase(it);
+            continue;
+        }
+        it = m_pending.erase(it);
+
+        // 缓存已满且都在使用时丢弃, 仍需要时之后重新请求
+        const int layer = acquireLayer();
+        if (layer < 0)
+        {
+            m_tiles[tile] = Tile{};
+            continue;
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, m_tileTexture);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, TileSamples, TileSamples, 1, GL_RED, GL_UNSIGNED_SHORT, data.samples.data());
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        std::copy(data.samples.begin(), data.samples.end(), m_tileSamples.begin() + size_t(layer) * TileSamples * TileSamples);
+
+        m_tiles[tile] = Tile{TileState::Resident, layer};
+        m_layerTile[layer] = tile;
+        updateNodeRanges(tile, data.leafRange);
+        m_stats.uploads++;
+        m_stats.tilesLoaded++;
+    }
+}
+
+float Terrain::heightAt(float x, float z) const
+{
+    if (!isEnabled())
+        return m_desc.baseHeight;
+    const glm::vec2 s = (glm::vec2(x, z) - m_origin) / m_quadSize;
+    if (s.x < 0.0f || s.y < 0.0f || s.x > float(m_quads) || s.y > float(m_quads))
+        return m_desc.baseHeight;
+
+    const uint32_t tx = std::min(static_cast<uint32_t>(s.x) / TileQuads, m_tilesPerSide - 1);
+    const uint32_t tz = std::min(static_cast<uint32_t>(s.y) / TileQuads, m_tilesPerSide - 1);
+    const Tile &tile = m_tiles[size_t(tz) * m_tilesPerSide + tx];
+    float h;
+    if (tile.state == TileState::Resident)
+        h = Bilinear(m_tileSamples.data() + size_t(tile.layer) * TileSamples * TileSamples, TileSamples,
+                     s - glm::vec2(tx, tz) * float(TileQuads));
+    else
+        h = Bilinear(m_overview.data(), m_overviewQuads + 1, s / float(m_overviewStride));
+    return m_desc.baseHeight + h * m_desc.heightScale;
+}
+
+AABB Terrain::nodeBounds(uint32_t level, uint32_t x, uint32_t z) const
+{
+    const float size = float(GridQuads << level) * m_quadSize;
+    const uint32_t n = (m_quads / GridQuads) >> level;
+    const glm::vec2 &range = m_nodeRange[level][size_t(z) * n + x];
+    AABB box;
+    box.min = glm::vec3(m_origin.x + float(x) * size, m_desc.baseHeight + range.x * m_desc.heightScale, m_origin.y + float(z) * size);
+    box.max = glm::vec3(box.min.x + size, m_desc.baseHeight + range.y * m_desc.heightScale, box.min.z + size);
+    return box;
+}
+
+Terrain::NodeInstance Terrain::makeInstance(uint32_t level, uint32_t x, uint32_t z) const
+{
+    NodeInstance instance;
+    const float size = float(GridQuads << level) * m_quadSize;
+    instance.node = glm::vec4(m_origin.x + float(x) * size, m_origin.y + float(z) * size, size, float(level));
+    // 不比瓦片大的节点在瓦片常驻时使用瓦片, uv 落在采样中心上
+    if (level <= m_tileLevel)
+    {
+        const uint32_t tx = x >> (m_tileLevel - level);
+        const uint32_t tz = z >> (m_tileLevel - level);
+        const Tile &tile = m_tiles[size_t(tz) * m_tilesPerSide + tx];
+        if (tile.state == TileState::Resident)
+        {
+            const glm::vec2 tileOrigin = m_origin + glm::vec2(tx, tz) * (float(TileQuads) * m_quadSize);
+            const float scale = 1.0f / (m_quadSize * float(TileSamples));
+            instance.source = glm::vec4(0.5f / float(TileSamples) - tileOrigin * scale, scale, float(tile.layer));
+            return instance;
+        }
+    }
+    const float overviewSamples = float(m_overviewQuads + 1);
+    const float scale = 1.0f / (m_quadSize * float(m_overviewStride) * overviewSamples);
+    instance.source = glm::vec4(0.5f / overviewSamples - m_origin * scale, scale, -1.0f);
+    return instance;
+}
+
+bool Terrain::inRange(const AABB &box, uint32_t level) const
+{
+    return DistanceSquared(box, m_lodCamera) <= m_ranges[level] * m_ranges[level];
+}
+
+template <typename Volume>
+bool Terrain::select(const Volume &volume, uint32_t level, uint32_t x, uint32_t z)
+{
+    const AABB box = nodeBounds(level, x, z);
+    if (!inRange(box, level))
+        return false;
+    if (!Intersects(volume, box))
+    {
+        m_selectCulled++;
+        return true;
+    }
+    if (level == 0 || !inRange(box, level - 1))
+    {
+        m_selected.push_back(Selected{level, x, z, Full});
+        return true;
+    }
+    for (uint8_t child = 0; child < 4; ++child)
+    {
+        const uint32_t cx = x * 2 + (child & 1);
+        const uint32_t cz = z * 2 + (child >> 1);
+        if (select(volume, level - 1, cx, cz))
+            continue;
+        // 子节点在更细一级的范围外, 用本级网格的对应象限绘制
+        if (Intersects(volume, nodeBounds(level - 1, cx, cz)))
+            m_selected.push_back(Selected{level, x, z, child});
+        else
+            m_selectCulled++;
+    }
+    return true;
+}
+
+template <typename Volume>
+void Terrain::selectAll(const Volume &volume)
+{
+    m_selected.clear();
+    m_selectCulled = 0;
+    const uint32_t root = m_levels - 1;
+    if (select(volume, root, 0, 0))
+        return;
+    // 相机在最粗一级的范围外, 整个地形按最粗一级绘制
+    if (Intersects(volume, nodeBounds(root, 0, 0)))
+        m_selected.push_back(Selected{root, 0, 0, Full});
+    else
+        m_selectCulled++;
+}
+
+void Terrain::draw(const FrustumPlanes &frustum, Shader &shaders)
+{
+    if (!isVisible())
+        return;
+    const auto start = Clock::now();
+    selectAll(frustum);
+    m_frame.selectMs += ElapsedMs(start);
+    submit(shaders);
+}
+
+void Terrain::draw(const BoundingSphere &range, Shader &shaders)
+{
+    if (!isVisible())
+        return;
+    const auto start = Clock::now();
+    selectAll(range);
+    m_frame.selectMs += ElapsedMs(start);
+    submit(shaders);
+}
+
+void Terrain::submit(Shader &shaders)
+{
+    m_frame.passes++;
+    m_frame.culledNodes += m_selectCulled;
+    if (m_selected.empty())
+        return;
+
+    for (auto &part : m_parts)
+        part.clear();
+    for (const Selected &selected : m_selected)
+        m_parts[selected.part].push_back(makeInstance(selected.level, selected.x, selected.z));
+    GLuint first[PartCount];
+    m_instances.clear();
+    for (int part = 0; part < PartCount; ++part)
+    {
+        first[part] = static_cast<GLuint>(m_instances.size());
+        m_instances.insert(m_instances.end(), m_parts[part].begin(), m_parts[part].end());
+    }
+
+    // 同一帧内每个pass都会重写, 重新指定存储避免等待上一次绘制
+    const size_t bytes = m_instances.size() * sizeof(NodeInstance);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_nodeBuffer);
+    if (bytes > m_nodeCapacity)
+        m_nodeCapacity = std::max(bytes, m_nodeCapacity * 2);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, m_nodeCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bytes, m_instances.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glActiveTexture(GL_TEXTURE0 + FirstTextureUnit);
+    glBindTexture(GL_TEXTURE_2D, m_overviewTexture);
+    glActiveTexture(GL_TEXTURE0 + FirstTextureUnit + 1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_tileTexture);
+    glActiveTexture(GL_TEXTURE0);
+    shaders.setInt("terrainOverview"_uniform, FirstTextureUnit);
+    shaders.setInt("terrainTiles"_uniform, FirstTextureUnit + 1);
+    shaders.setUniform("lodCamera"_uniform, m_lodCamera);
+    shaders.setUniform4fv("morphRanges"_uniform, MaxLevels, &m_morph[0].x);
+    shaders.setFloat("gridQuads"_uniform, float(GridQuads));
+    shaders.setFloat("heightScale"_uniform, m_desc.heightScale);
+    shaders.setFloat("baseHeight"_uniform, m_desc.baseHeight);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, NodeBinding, m_nodeBuffer);
+    glBindVertexArray(m_vao);
+    for (int part = 0; part < PartCount; ++part)
+    {
+        const GLsizei count = static_cast<GLsizei>(m_parts[part].size());
+        if (count == 0)
+            continue;
+        const GLsizei indexCount = part == Full ? QuadrantIndices * 4 : QuadrantIndices;
+        const size_t offset = part == Full ? 0 : size_t(part) * QuadrantIndices * sizeof(uint16_t);
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, (void *)offset, count, first[part]);
+        m_frame.triangles += size_t(count) * indexCount / 3;
+    }
+    glBindVertexArray(0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, NodeBinding, 0);
+    m_frame.nodes += m_instances.size();
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <vector>
+
+#include "../Math/Bounds.hpp"
+#include "../Math/Frustum.hpp"
+
+class Shader;
+
+/*
+CDLOD 高度场地形(Strugar, Continuous Distance-Dependent Level of Detail)
+高度图按四叉树划分, 每个节点都用同一张 GridQuads x GridQuads 的网格绘制, 顶点着色器从高度纹理采样位移, 显存中没有地形三角形
+    LOD只由到主相机的距离决定: 0级(叶节点, 一个网格格子对应一个采样)的范围为 lodRangeScale 个叶节点边长, 每级翻倍
+    每级范围的末段顶点逐渐吸附到上一级的网格, 相邻两级在交界处完全一致, 不需要拼接带
+    选择在每个pass中按该pass的视锥(或点光源范围)单独进行, 剔除不可见节点; 距离始终按主相机计算, 阴影与相机视图的几何一致
+    选中节点作为实例写入SSBO, 按整节点与四个象限(只覆盖父节点的一部分)分5次实例化绘制
+高度数据:
+    概览纹理: 整张高度图按固定步长抽样, 常驻, 用于较粗的节点与尚未读入的瓦片
+    瓦片: 每 TileQuads x TileQuads 个格子一张, 相机附近的瓦片由工作线程读取(或程序生成)后上传到纹理数组中的空闲层
+    粗节点的顶点间距是概览步长的整数倍, 顶点正好落在两种数据共有的采样上, 稳定状态下瓦片与概览的交界没有裂缝
+高度图为小端16位无符号的原始文件(.r16/.raw), 每边 resolution 个采样; 没有文件时用分形噪声程序生成
+*/
+class Terrain
+{
+public:
+    static constexpr int GridQuads = 32;          // 共享网格每边的格数, 与叶节点覆盖的采样格数一致
+    static constexpr int TileQuads = 256;         // 瓦片每边的格数, 纹理每边 TileQuads + 1 个采样
+    static constexpr int OverviewMinQuads = 1024; // 概览纹理每边至少的格数(不超过高度图本身)
+    static constexpr int MaxLevels = 16;          // 与 terrain.glsl 中 morphRanges 的长度一致
+    static constexpr GLuint NodeBinding = 6;      // 实例SSBO的绑定点, 与 terrain.glsl 一致
+    static constexpr GLint FirstTextureUnit = 16; // 概览与瓦片纹理, 在 MaterialLibrary 的纹理单元之后
+
+    struct Desc
+    {
+        std::filesystem::path heightmap; // 为空时程序生成
+        uint32_t resolution = 4097;      // 每边采样数. resolution - 1 须为 TileQuads 的2的幂倍
+        float worldSize = 4096.0f;       // 每边长度, 地形中心在原点
+        float heightScale = 300.0f;      // 高度图最大值对应的高度
+        float baseHeight = 0.0f;         // 高度图0值对应的高度
+        uint32_t seed = 1;               // 程序生成的种子
+    };
+
+    struct Settings
+    {
+        float lodRangeScale = 4.0f;    // 0级范围 = 叶节点边长 * lodRangeScale, 小于约3时相邻节点可能相差两级
+        float morphStart = 0.7f;       // 各级范围内开始向上一级过渡的位置(比例)
+        uint32_t tileCacheLayers = 64; // 瓦片纹理数组的层数, 创建地形时生效
+        size_t maxInFlightReads = 8;
+        size_t maxUploadsPerFrame = 4;
+        bool visible = true;
+        bool showLevels = false; // GBuffer中按LOD级别着色
+    };
+
+    struct Stats
+    {
+        uint32_t levels = 0;
+        size_t tiles = 0;
+        size_t residentTiles = 0;
+        size_t inFlightReads = 0;
+        size_t uploads = 0;   // 本帧上传的瓦片
+        size_t evictions = 0; // 累计
+        size_t tilesLoaded = 0;
+        size_t cacheBytes = 0; // 概览与瓦片纹理
+        // 上一帧所有pass合计
+        size_t passes = 0;
+        size_t nodes = 0;
+        size_t culledNodes = 0;
+        size_t triangles = 0;
+        double selectMs = 0.0;
+    };
+
+    /// @brief 全局地形, 未创建时各pass不绘制
+    static Terrain &Get();
+
+    Terrain(const Terrain &) = delete;
+    Terrain &operator=(const Terrain &) = delete;
+    ~Terrain();
+
+    /// @brief 读取概览并替换当前地形. 需要GL上下文, 参数无效或读取失败时抛出 std::runtime_error
+    void create(const Desc &desc);
+    void clear();
+    bool isEnabled() const { return m_levels > 0; }
+    bool isVisible() const { return isEnabled() && m_settings.visible; }
+
+    /// @brief 每帧渲染前调用一次: 上传读取完成的瓦片, 按相机距离请求瓦片, 记录LOD使用的相机位置
+    ///        cameraFrustum 用于计算相机可见的地形节点, 作为阴影投射体剔除的接收体
+    void update(const glm::vec3 &cameraPosition, const FrustumPlanes &cameraFrustum);
+
+    /// @brief 选择与视锥相交的节点并绘制. shaders 需包含 terrain.glsl, 调用方负责 use 与视图相关的uniform
+    void draw(const FrustumPlanes &frustum, Shader &shaders);
+    /// @brief 选择与球形范围相交的节点并绘制. 用于点光源阴影
+    void draw(const BoundingSphere &range, Shader &shaders);
+
+    /// @brief 高度查询, 使用概览与已读入的瓦片. 地形外返回 baseHeight
+    float heightAt(float x, float z) const;
+    /// @brief 上一次 update 时相机可见节点的包围盒
+    const std::vector<AABB> &getReceiverBounds() const { return m_receiverBounds; }
+    const Desc &getDesc() const { return m_desc; }
+
+    Settings &getSettings() { return m_settings; }
+    const Stats &getStats() const { return m_stats; }
+
+private:
+    // 实例数据, 与 terrain.glsl 中的 TerrainNode 布局一致
+    struct NodeInstance
+    {
+        glm::vec4 node;   // 世界坐标xz起点, 边长, LOD级别
+        glm::vec4 source; // 高度纹理坐标 uv = xz * source.z + source.xy, source.w 为瓦片层(< 0 为概览)
+    };
+
+    // 0~3 为网格的四个象限, 各占索引的四分之一, 编号与子节点相同(bit0: x方向后半, bit1: z方向后半). Full 为整个网格
+    enum Part : uint8_t
+    {
+        Quadrant0 = 0,
+        Full = 4,
+        PartCount
+    };
+
+    struct Selected
+    {
+        uint32_t level;
+        uint32_t x;
+        uint32_t z;
+        uint8_t part;
+    };
+
+    enum class TileState : uint8_t
+    {
+        Absent,
+        Loading,
+        Resident
+    };
+
+    struct Tile
+    {
+        TileState state = TileState::Absent;
+        int layer = -1;
+    };
+
+    struct TileData
+    {
+        std::vector<uint16_t> samples; // (TileQuads + 1)^2
+        std::vector<glm::vec2> leafRange; // 瓦片内各叶节点的最低与最高高度(归一化)
+    };
+
+    struct PendingTile
+    {
+        uint32_t tile;
+        std::future<TileData> data;
+    };
+
+    Desc m_desc;
+    Settings m_settings;
+    Stats m_stats;
+    Stats m_frame; // 本帧累计的绘制统计
+
+    uint32_t m_levels = 0;         // 0 表示未创建
+    uint32_t m_quads = 0;          // 每边格数
+    uint32_t m_tileLevel = 0;      // 节点与瓦片一样大的级别
+    uint32_t m_tilesPerSide = 0;
+    uint32_t m_overviewStride = 1; // 概览相邻采样在高度图中的间隔
+    uint32_t m_overviewQuads = 0;
+    float m_quadSize = 1.0f;       // 一个格子的世界边长
+    glm::vec2 m_origin = glm::vec2(0.0f);
+
+    std::vector<uint16_t> m_overview;
+    // 每级节点的最低与最高高度(归一化), m_nodeRange[level][z * n + x]
+    std::vector<std::vector<glm::vec2>> m_nodeRange;
+    std::vector<Tile> m_tiles;
+    std::vector<uint16_t> m_tileSamples; // 常驻瓦片的CPU副本, 按层存放, 供 heightAt 使用
+    std::vector<uint32_t> m_layerTile;   // 层 -> 瓦片, 空闲层为 NoTile
+    std::vector<uint32_t> m_freeLayers;
+    std::vector<PendingTile> m_pending;
+    std::vector<std::future<TileData>> m_abandoned;
+    std::vector<uint32_t> m_wanted; // 本帧按距离排序的需要的瓦片
+
+    glm::vec3 m_lodCamera = glm::vec3(0.0f);
+    float m_ranges[MaxLevels] = {};
+    glm::vec4 m_morph[MaxLevels] = {}; // 每级过渡的起点与 1 / 长度
+    std::vector<AABB> m_receiverBounds;
+
+    GLuint m_vao = 0;
+    GLuint m_vbo = 0;
+    GLuint m_ebo = 0;
+    GLuint m_nodeBuffer = 0;
+    size_t m_nodeCapacity = 0; // 以字节计
+    GLuint m_overviewTexture = 0;
+    GLuint m_tileTexture = 0;
+    std::vector<Selected> m_selected;
+    size_t m_selectCulled = 0;
+    std::vector<NodeInstance> m_parts[PartCount];
+    std::vector<NodeInstance> m_instances;
+
+    Terrain() = default;
+
+    static TileData LoadTile(const Desc &desc, uint32_t tileX, uint32_t tileZ);
+
+    void createGrid();
+    void createTextures();
+    void releaseTextures();
+    void computeRanges();
+    void initNodeRanges();
+    void updateNodeRanges(uint32_t tile, const std::vector<glm::vec2> &leafRange);
+    void uploadReadyTiles();
+    void requestTiles(const glm::vec3 &cameraPosition);
+    int acquireLayer();
+
+    AABB nodeBounds(uint32_t level, uint32_t x, uint32_t z) const;
+    NodeInstance makeInstance(uint32_t level, uint32_t x, uint32_t z) const;
+    bool inRange(const AABB &box, uint32_t level) const;
+    // 选择结果写入 m_selected, 节点不在本级范围内时返回 false, 由父节点绘制这部分
+    template <typename Volume>
+    bool select(const Volume &volume, uint32_t level, uint32_t x, uint32_t z);
+    template <typename Volume>
+    void selectAll(const Volume &volume);
+    void submit(Shader &shaders);
+};
@@ -0,0 +1,561 @@
+#include "WorldPartition.hpp"
+#include "Model.hpp"
+#include "../ModelLoader.hpp"
+#include "../Utils/DebugOutput.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+
+namespace
+{
+    bool IsReady(const ModelLoader::ModelLoadFuture &future)
+    {
+        return future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready;
+    }
+}
+
+WorldPartition &WorldPartition::Get()
+{
+    static WorldPartition partition;
+    return partition;
+}
+
+WorldPartition::~WorldPartition()
+{
+    // 等待仍在读取的文件, 避免进程退出时工作线程访问已销毁的对象
+    for (auto &[key, cell] : m_cells)
+    {
+        for (auto &read : cell.reads)
+        {
+            if (read.second.valid())
+                read.second.wait();
+        }
+    }
+    for (auto &future : m_abandonedReads)
+    {
+        if (future.valid())
+            future.wait();
+    }
+}
+
+void WorldPartition::loadWorld(const std::filesystem::path &path)
+{
+    std::ifstream file(path);
+    if (!file)
+        throw std::runtime_error("Failed to open world file: " + path.string());
+
+    float cellSize = DefaultCellSize;
+    std::vector<Instance> instances;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+        std::istringstream stream(line);
+        std::string keyword;
+        if (!(stream >> keyword))
+            continue;
+
+        if (keyword == "cellSize")
+        {
+            if (!(stream >> cellSize) || cellSize <= 0.0f)
+                throw std::runtime_error(path.string() + ":" + std::to_string(lineNumber) + ": invalid cellSize");
+        }
+        else if (keyword == "model")
+        {
+            std::string modelPath;
+            glm::vec3 position(0.0f);
+            if (!(stream >> modelPath >> position.x >> position.y >> position.z))
+                throw std::runtime_error(path.string() + ":" + std::to_string(lineNumber) + ": expected 'model <path> <x> <y> <z>'");
+            float yaw = 0.0f;
+            float scale = 1.0f;
+            if (stream >> yaw)
+                stream >> scale;
+
+            std::filesystem::path resolved(modelPath);
+            if (resolved.is_relative())
+                resolved = path.parent_path() / resolved;
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), position);
+            transform = glm::rotate(transform, glm::radians(yaw), glm::vec3(0.0f, 1.0f, 0.0f));
+            transform = glm::scale(transform, glm::vec3(scale));
+            instances.push_back(Instance{resolved.lexically_normal().string(), transform});
+        }
+        else
+        {
+            throw std::runtime_error(path.string() + ":" + std::to_string(lineNumber) + ": unknown keyword '" + keyword + "'");
+        }
+    }
+
+    clear(cellSize);
+    for (const Instance &instance : instances)
+        addInstance(instance.path, instance.transform);
+    DebugOutput::AddLog("World '{}': {} instances in {} cells\n", path.filename().string(), m_instances.size(), m_cells.size());
+}
+
+void WorldPartition::clear(float cellSize)
+{
+    // 旧世界的格子在下次 update 时全部卸载, 这里只替换格子表
+    for (uint64_t key : m_activeCells)
+    {
+        Cell &cell = m_cells[key];
+        for (auto &read : cell.reads)
+            m_abandonedReads.push_back(std::move(read.second));
+        m_pendingEvictions.insert(m_pendingEvictions.end(), cell.roots.begin(), cell.roots.end());
+        // 根节点在下次 update 开头删除, 早于绘制, 材质引用可以现在释放
+        releaseShared(cell);
+        if (cell.state == CellState::Reading || cell.state == CellState::Uploading)
+            m_stats.cancelledLoads++;
+    }
+    m_activeCells.clear();
+    m_sharedGeometry.clear();
+    m_sharedTextures.clear();
+    m_cells.clear();
+    m_instances.clear();
+    m_residentBytes = 0;
+    m_reservedBytes = 0;
+    m_cellSize = std::max(cellSize, 1.0f);
+    refreshStats();
+}
+
+void WorldPartition::addInstance(const std::string &modelPath, const glm::mat4 &transform)
+{
+    const glm::ivec2 coord = cellCoord(glm::vec3(transform[3]));
+    Cell &cell = m_cells[CellKey(coord)];
+    cell.coord = coord;
+    cell.instances.push_back(static_cast<uint32_t>(m_instances.size()));
+    m_instances.push_back(Instance{modelPath, transform});
+    m_stats.cells = m_cells.size();
+    m_stats.instances = m_instances.size();
+}
+
+void WorldPartition::update(Scene &scene, const glm::vec3 &cameraPosition)
+{
+    const Clock::time_point now = Clock::now();
+    glm::vec3 velocity(0.0f);
+    if (m_hasLastPosition)
+    {
+        const float dt = std::chrono::duration<float>(now - m_lastUpdate).count();
+        if (dt > 0.0f)
+            velocity = (cameraPosition - m_lastPosition) / dt;
+    }
+    m_lastPosition = cameraPosition;
+    m_lastUpdate = now;
+    m_hasLastPosition = true;
+
+    for (SceneHandle root : m_pendingEvictions)
+        scene.removeObject(root);
+    m_pendingEvictions.clear();
+    pollAbandonedReads();
+
+    // 前瞻位置. 相机一帧跨过多个格子时, 沿途格子在到达之前已经开始读取
+    const glm::vec3 focus = cameraPosition + velocity * m_settings.lookAheadSeconds;
+    const float loadRadius = std::max(m_settings.loadRadius, 0.0f);
+    const float unloadRadius = loadRadius + std::max(m_settings.hysteresis, 0.0f);
+
+    // 1. 卸载离开范围的格子
+    for (size_t i = 0; i < m_activeCells.size();)
+    {
+        Cell &cell = m_cells[m_activeCells[i]];
+        if (cellDistance(cell, cameraPosition, focus) > unloadRadius)
+        {
+            evict(scene, cell);
+            m_activeCells[i] = m_activeCells.back();
+            m_activeCells.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    // 2. 读取完成的格子进入上传阶段
+    size_t reading = 0;
+    for (uint64_t key : m_activeCells)
+    {
+        Cell &cell = m_cells[key];
+        if (cell.state == CellState::Reading)
+            pollReads(cell);
+        if (cell.state == CellState::Reading)
+            ++reading;
+    }
+
+    // 3. 按时间预算加入场景
+    uploadPending(scene, cameraPosition, focus);
+
+    // 4. 请求范围内未加载的格子, 近的优先
+    if (reading < m_settings.maxConcurrentLoads)
+    {
+        std::vector<std::pair<float, uint64_t>> candidates;
+        const int reach = static_cast<int>(std::ceil(loadRadius / m_cellSize)) + 1;
+        auto gather = [&](const glm::vec3 &center)
+        {
+            const glm::ivec2 origin = cellCoord(center);
+            for (int z = origin.y - reach; z <= origin.y + reach; ++z)
+            {
+                for (int x = origin.x - reach; x <= origin.x + reach; ++x)
+                {
+                    const uint64_t key = CellKey(glm::ivec2(x, z));
+                    auto it = m_cells.find(key);
+                    if (it == m_cells.end() || it->second.state != CellState::Unloaded)
+                        continue;
+                    const float distance = cellDistance(it->second, cameraPosition, focus);
+                    if (distance <= loadRadius)
+                        candidates.emplace_back(distance, key);
+                }
+            }
+        };
+        gather(cameraPosition);
+        // 前瞻位置与当前位置相距较远时两处都收集, 之间的格子由之后的帧补上
+        if (cellCoord(focus) != cellCoord(cameraPosition))
+            gather(focus);
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        for (const auto &[distance, key] : candidates)
+        {
+            if (reading >= m_settings.maxConcurrentLoads)
+                break;
+            Cell &cell = m_cells[key];
+            if (cell.state != CellState::Unloaded)
+                continue;
+            const size_t estimate = estimateBytes(cell);
+            bool fits = true;
+            while (m_residentBytes + m_reservedBytes + estimate > m_settings.memoryBudget)
+            {
+                if (!evictFarthest(scene, cameraPosition, focus, distance))
+                {
+                    fits = false;
+                    break;
+                }
+            }
+            if (!fits)
+            {
+                // 更远的格子估计值更可能放不下, 本帧不再请求
+                m_stats.budgetRejections++;
+                break;
+            }
+            cell.reservedBytes = estimate;
+            m_reservedBytes += estimate;
+            startReading(cell);
+            m_activeCells.push_back(key);
+            ++reading;
+        }
+    }
+
+    refreshStats();
+}
+
+uint64_t WorldPartition::CellKey(glm::ivec2 coord)
+{
+    return (uint64_t(uint32_t(coord.x)) << 32) | uint64_t(uint32_t(coord.y));
+}
+
+glm::ivec2 WorldPartition::cellCoord(const glm::vec3 &position) const
+{
+    // 极远处的坐标钳制在 int 范围内
+    constexpr float Limit = 1.0e9f;
+    return glm::ivec2(static_cast<int>(std::floor(std::clamp(position.x / m_cellSize, -Limit, Limit))),
+                      static_cast<int>(std::floor(std::clamp(position.z / m_cellSize, -Limit, Limit))));
+}
+
+float WorldPartition::cellDistance(const Cell &cell, const glm::vec3 &position) const
+{
+    const glm::vec2 minCorner = glm::vec2(cell.coord) * m_cellSize;
+    const glm::vec2 maxCorner = minCorner + glm::vec2(m_cellSize);
+    const glm::vec2 point(position.x, position.z);
+    return glm::length(point - glm::clamp(point, minCorner, maxCorner));
+}
+
+float WorldPartition::cellDistance(const Cell &cell, const glm::vec3 &position, const glm::vec3 &focus) const
+{
+    return std::min(cellDistance(cell, position), cellDistance(cell, focus));
+}
+
+size_t WorldPartition::estimateBytes(const Cell &cell) const
+{
+    size_t bytes = 0;
+    std::unordered_set<std::string_view> counted;
+    for (uint32_t index : cell.instances)
+    {
+        const std::string &path = m_instances[index].path;
+        auto it = m_bytesOfPath.find(path);
+        if (it != m_bytesOfPath.end())
+        {
+            bytes += it->second.instance;
+            if (counted.insert(path).second)
+                bytes += it->second.shared;
+            continue;
+        }
+        // 未加载过的文件按文件大小的两倍估计, 加入场景后以实测值替换
+        std::error_code error;
+        const auto fileSize = std::filesystem::file_size(path, error);
+        if (!error)
+            bytes += static_cast<size_t>(fileSize) * 2;
+    }
+    return bytes;
+}
+
+void WorldPartition::startReading(Cell &cell)
+{
+    cell.state = CellState::Reading;
+    cell.nextInstance = 0;
+    for (uint32_t index : cell.instances)
+    {
+        const std::string &path = m_instances[index].path;
+        const bool requested = std::any_of(cell.reads.begin(), cell.reads.end(),
+                                           [&](const auto &read) { return read.first == path; });
+        if (!requested)
+            cell.reads.emplace_back(path, ModelLoader::LoadModelAsync(path));
+    }
+}
+
+void WorldPartition::pollReads(Cell &cell)
+{
+    for (auto it = cell.reads.begin(); it != cell.reads.end();)
+    {
+        if (!IsReady(it->second))
+        {
+            ++it;
+            continue;
+        }
+        try
+        {
+            cell.imported.emplace(it->first, it->second.get());
+        }
+        catch (const std::exception &e)
+        {
+            // 读取失败的文件跳过, 格子中的其他实例照常加载
+            std::cerr << "World partition: " << it->first << ": " << e.what() << std::endl;
+        }
+        it = cell.reads.erase(it);
+    }
+    if (cell.reads.empty())
+        cell.state = CellState::Uploading;
+}
+
+void WorldPartition::uploadPending(Scene &scene, const glm::vec3 &position, const glm::vec3 &focus)
+{
+    const Clock::time_point start = Clock::now();
+    m_stats.lastUploadMs = 0.0;
+    while (true)
+    {
+        Cell *nearest = nullptr;
+        float nearestDistance = std::numeric_limits<float>::max();
+        for (uint64_t key : m_activeCells)
+        {
+            Cell &cell = m_cells[key];
+            if (cell.state != CellState::Uploading)
+                continue;
+            const float distance = cellDistance(cell, position, focus);
+            if (distance < nearestDistance)
+            {
+                nearest = &cell;
+                nearestDistance = distance;
+            }
+        }
+        if (!nearest)
+            break;
+
+        const double before = m_stats.lastUploadMs;
+        uploadInstance(scene, *nearest);
+        m_stats.lastUploadMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        m_stats.maxInstanceUploadMs = std::max(m_stats.maxInstanceUploadMs, m_stats.lastUploadMs - before);
+        if (m_stats.lastUploadMs >= m_settings.uploadBudgetMs)
+            break;
+    }
+}
+
+void WorldPartition::uploadInstance(Scene &scene, Cell &cell)
+{
+    if (cell.nextInstance < cell.instances.size())
+    {
+        const Instance &instance = m_instances[cell.instances[cell.nextInstance++]];
+        auto it = cell.imported.find(instance.path);
+        if (it != cell.imported.end() && it->second.scene)
+        {
+            // 新对象追加在稠密数组末尾, 删除在 Scene::update 中才执行, 这段下标就是本实例的全部节点
+            const size_t first = scene.size();
+            const SceneHandle root = ModelLoader::AddToScene(scene, it->second, instance.path);
+            scene.setLocalTransform(root, instance.transform * scene.getLocalTransform(root));
+            // 网格的材质引用由 ModelLoader 注册材质时取得, 卸载时释放
+            MaterialLibrary &materials = MaterialLibrary::Get();
+            PathBytes bytes;
+            std::unordered_set<const GeometryRange *> instanceGeometry;
+            std::unordered_set<uint32_t> instanceMaterials;
+            for (size_t i = first; i < scene.size(); ++i)
+            {
+                const Model *model = dynamic_cast<const Model *>(&scene.objectAt(i));
+                if (!model)
+                    continue;
+                for (const Mesh &mesh : model->meshes)
+                {
+                    const GeometryRange *geometry = mesh.getGeometry().get();
+                    const size_t geometryBytes = mesh.gpuBytes();
+                    const size_t textureBytes = materials.textureBytes(mesh.materialId);
+                    bytes.instance += mesh.cpuBytes();
+                    if (instanceGeometry.insert(geometry).second)
+                        bytes.shared += geometryBytes;
+                    if (instanceMaterials.insert(mesh.materialId).second)
+                        bytes.shared += textureBytes;
+                    m_residentBytes += AddReference(m_sharedGeometry, geometry, geometryBytes);
+                    m_residentBytes += AddReference(m_sharedTextures, mesh.materialId, textureBytes);
+                    cell.geometry.push_back(geometry);
+                    cell.materials.push_back(mesh.materialId);
+                }
+            }
+            m_bytesOfPath[instance.path] = bytes;
+            cell.roots.push_back(root);
+            cell.objects += scene.size() - first;
+            cell.bytes += bytes.instance;
+            m_residentBytes += bytes.instance;
+        }
+    }
+    if (cell.nextInstance < cell.instances.size())
+        return;
+
+    // 全部加入场景, 释放解析结果, 预占的估计值换成实测值
+    cell.imported.clear();
+    m_reservedBytes -= std::min(m_reservedBytes, cell.reservedBytes);
+    cell.reservedBytes = 0;
+    cell.state = CellState::Resident;
+    m_stats.loadsCompleted++;
+}
+
+void WorldPartition::evict(Scene &scene, Cell &cell)
+{
+    if (cell.state == CellState::Reading || cell.state == CellState::Uploading)
+        m_stats.cancelledLoads++;
+    else if (cell.state == CellState::Resident)
+        m_stats.evictions++;
+
+    for (auto &read : cell.reads)
+        m_abandonedReads.push_back(std::move(read.second));
+    cell.reads.clear();
+    cell.imported.clear();
+    // 删除延迟到 Scene::update, 本帧不再渲染之外的引用都已结束
+    for (SceneHandle root : cell.roots)
+        scene.removeObject(root);
+    cell.roots.clear();
+    releaseShared(cell);
+
+    m_residentBytes -= std::min(m_residentBytes, cell.bytes);
+    m_reservedBytes -= std::min(m_reservedBytes, cell.reservedBytes);
+    cell.bytes = 0;
+    cell.reservedBytes = 0;
+    cell.objects = 0;
+    cell.nextInstance = 0;
+    cell.state = CellState::Unloaded;
+}
+
+void WorldPartition::releaseShared(Cell &cell)
+{
+    for (const GeometryRange *geometry : cell.geometry)
+        m_residentBytes -= std::min(m_residentBytes, RemoveReference(m_sharedGeometry, geometry));
+    MaterialLibrary &materials = MaterialLibrary::Get();
+    for (uint32_t material : cell.materials)
+    {
+        m_residentBytes -= std::min(m_residentBytes, RemoveReference(m_sharedTextures, material));
+        materials.release(material);
+    }
+    cell.geometry.clear();
+    cell.materials.clear();
+}
+
+template <typename Key>
+size_t WorldPartition::AddReference(std::unordered_map<Key, SharedBytes> &shared, const Key &key, size_t bytes)
+{
+    SharedBytes &entry = shared[key];
+    if (entry.refs++ > 0)
+        return 0;
+    entry.bytes = bytes;
+    return bytes;
+}
+
+template <typename Key>
+size_t WorldPartition::RemoveReference(std::unordered_map<Key, SharedBytes> &shared, const Key &key)
+{
+    auto it = shared.find(key);
+    if (it == shared.end() || --it->second.refs > 0)
+        return 0;
+    const size_t bytes = it->second.bytes;
+    shared.erase(it);
+    return bytes;
+}
+
+bool WorldPartition::evictFarthest(Scene &scene, const glm::vec3 &position, const glm::vec3 &focus, float distance)
+{
+    size_t farthest = m_activeCells.size();
+    float farthestDistance = distance;
+    for (size_t i = 0; i < m_activeCells.size(); ++i)
+    {
+        const Cell &cell = m_cells[m_activeCells[i]];
+        if (cell.state == CellState::Unloaded)
+            continue;
+        const float cellDist = cellDistance(cell, position, focus);
+        if (cellDist > farthestDistance)
+        {
+            farthest = i;
+            farthestDistance = cellDist;
+        }
+    }
+    if (farthest == m_activeCells.size())
+        return false;
+    evict(scene, m_cells[m_activeCells[farthest]]);
+    m_activeCells[farthest] = m_activeCells.back();
+    m_activeCells.pop_back();
+    return true;
+}
+
+void WorldPartition::pollAbandonedReads()
+{
+    for (auto it = m_abandonedReads.begin(); it != m_abandonedReads.end();)
+    {
+        if (!it->valid() || IsReady(*it))
+        {
+            // 结果中的 Importer 在这里析构, 释放解析出的 aiScene
+            try
+            {
+                if (it->valid())
+                    it->get();
+            }
+            catch (const std::exception &)
+            {
+            }
+            it = m_abandonedReads.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void WorldPartition::refreshStats()
+{
+    m_stats.cells = m_cells.size();
+    m_stats.instances = m_instances.size();
+    m_stats.residentCells = 0;
+    m_stats.loadingCells = 0;
+    m_stats.residentObjects = 0;
+    for (uint64_t key : m_activeCells)
+    {
+        const Cell &cell = m_cells[key];
+        if (cell.state == CellState::Resident)
+            m_stats.residentCells++;
+        else
+            m_stats.loadingCells++;
+        m_stats.residentObjects += cell.objects;
+    }
+    m_stats.residentBytes = m_residentBytes;
+}
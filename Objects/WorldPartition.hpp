@@ -0,0 +1,185 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Scene.hpp"
+#include "../ModelLoader.hpp"
+
+struct GeometryRange;
+
+/*
+世界分区流式加载: 世界在XZ平面上划分为正方形格子, 每个格子是一组模型实例(文件 + 世界矩阵)
+每帧按相机到格子的距离决定加载与卸载, 距离同时按相机当前速度前瞻的位置计算, 高速飞行时提前加载前方格子
+    距离 <= loadRadius 的格子请求加载, 距离 > loadRadius + hysteresis 的格子卸载, 介于两者之间的保持原状态, 避免在边界反复加载
+加载分两步: 工作线程读取文件并完成网格处理(ModelLoader::LoadModelAsync, 缓存优化, 网格簇与LOD), 主线程按每帧时间预算把结果加入场景
+    主线程只注册材质并上传GL缓冲, 同一文件的多个实例共用工作线程的处理结果
+常驻字节数超过预算时先卸载比请求格子更远的格子, 仍放不下则暂不加载
+    每个实例的CPU顶点/索引单独计, 内容相同而共享的GPU几何分配与材质纹理按引用计数, 无论被多少网格引用都只计一次
+    格子卸载时释放网格持有的材质引用, 不再被引用的纹理层由 MaterialLibrary 回收
+读取中的格子离开范围后结果直接丢弃. 带动画的模型(SkinnedModel)的材质引用不随格子释放
+*/
+class WorldPartition
+{
+public:
+    static constexpr float DefaultCellSize = 64.0f;
+
+    struct Settings
+    {
+        float loadRadius = 192.0f;
+        float hysteresis = 64.0f;               // 卸载距离 = loadRadius + hysteresis
+        size_t memoryBudget = size_t(1) << 30;  // 常驻字节预算
+        size_t maxConcurrentLoads = 4;          // 同时读取中的格子数
+        double uploadBudgetMs = 4.0;            // 每帧主线程加入场景的时间预算, 每帧至少处理一个实例
+        float lookAheadSeconds = 0.5f;
+    };
+
+    struct Stats
+    {
+        size_t cells = 0;
+        size_t instances = 0;
+        size_t residentCells = 0;
+        size_t loadingCells = 0; // 读取中与等待加入场景的格子
+        size_t residentBytes = 0;
+        size_t residentObjects = 0;
+        size_t loadsCompleted = 0;
+        size_t evictions = 0;
+        size_t cancelledLoads = 0;   // 读取完成前离开范围而丢弃的格子数
+        size_t budgetRejections = 0; // 因内存预算推迟加载的次数
+        double lastUploadMs = 0.0;
+        double maxInstanceUploadMs = 0.0; // 单个实例加入场景的最长耗时, 预算只在实例之间检查
+    };
+
+    /// @brief 全局世界分区, 加入场景的对象需要GL上下文
+    static WorldPartition &Get();
+
+    WorldPartition(const WorldPartition &) = delete;
+    WorldPartition &operator=(const WorldPartition &) = delete;
+    ~WorldPartition();
+
+    /// @brief 读取世界描述文件并替换当前世界, 已加载的格子在下次 update 时卸载
+    ///        每行一条: "cellSize <size>" 或 "model <path> <x> <y> <z> [yawDegrees] [scale]", # 开头为注释
+    ///        相对路径相对于世界文件所在目录. 读取失败时抛出 std::runtime_error
+    void loadWorld(const std::filesystem::path &path);
+    /// @brief 清空世界, 之后加入的实例按 cellSize 划分
+    void clear(float cellSize = DefaultCellSize);
+    /// @brief 加入一个实例, 按平移分量所在的格子归类
+    void addInstance(const std::string &modelPath, const glm::mat4 &transform);
+
+    /// @brief 每帧调用一次, 在 ModelLoader::run 之后, Scene::updateTransforms 之前
+    void update(Scene &scene, const glm::vec3 &cameraPosition);
+
+    Settings &getSettings() { return m_settings; }
+    float getCellSize() const { return m_cellSize; }
+    const Stats &getStats() const { return m_stats; }
+
+private:
+    using ImportResult = ModelLoader::LoadedModel;
+    using Clock = std::chrono::steady_clock;
+
+    enum class CellState
+    {
+        Unloaded,
+        Reading,   // 工作线程读取文件中
+        Uploading, // 读取完成, 逐个实例加入场景中
+        Resident
+    };
+
+    struct Instance
+    {
+        std::string path;
+        glm::mat4 transform;
+    };
+
+    struct Cell
+    {
+        glm::ivec2 coord = glm::ivec2(0);
+        std::vector<uint32_t> instances; // m_instances 下标
+        CellState state = CellState::Unloaded;
+        // 每个不同的文件读取一次, 格子内同一文件的实例共用
+        std::vector<std::pair<std::string, std::future<ImportResult>>> reads;
+        std::unordered_map<std::string, ImportResult> imported;
+        size_t nextInstance = 0;
+        std::vector<SceneHandle> roots;
+        size_t objects = 0;
+        size_t bytes = 0;          // 已加入场景部分的CPU端实测字节数, 共享部分见 m_sharedGeometry 与 m_sharedTextures
+        size_t reservedBytes = 0;  // 加载完成前按估计值预占的预算
+        // 已加入场景的网格各自的几何分配与材质, 每个网格一项
+        std::vector<const GeometryRange *> geometry;
+        std::vector<uint32_t> materials;
+    };
+
+    // 一个文件的一个实例加入场景后的实测字节数
+    struct PathBytes
+    {
+        size_t instance = 0; // 每个实例各有一份的CPU端数据
+        size_t shared = 0;   // 同一文件的实例共用的GPU几何与纹理
+    };
+
+    // 被格子内网格引用的共享资源
+    struct SharedBytes
+    {
+        size_t refs = 0;
+        size_t bytes = 0;
+    };
+
+    Settings m_settings;
+    float m_cellSize = DefaultCellSize;
+    std::vector<Instance> m_instances;
+    std::unordered_map<uint64_t, Cell> m_cells;
+    std::vector<uint64_t> m_activeCells; // 非 Unloaded 的格子
+    // 文件路径 -> 一个实例加入场景后的实测字节数, 用于估计尚未加载的格子
+    std::unordered_map<std::string, PathBytes> m_bytesOfPath;
+    // 常驻格子引用的几何分配与材质纹理, 首次引用时计入 m_residentBytes, 引用全部释放时扣除
+    std::unordered_map<const GeometryRange *, SharedBytes> m_sharedGeometry;
+    std::unordered_map<uint32_t, SharedBytes> m_sharedTextures;
+    // 已放弃但仍在读取的文件, 完成后丢弃. future 析构会等待读取结束, 不能直接销毁
+    std::vector<std::future<ImportResult>> m_abandonedReads;
+    // clear 时仍在场景中的根节点, 下次 update 时删除
+    std::vector<SceneHandle> m_pendingEvictions;
+
+    size_t m_residentBytes = 0;
+    size_t m_reservedBytes = 0;
+    glm::vec3 m_lastPosition = glm::vec3(0.0f);
+    Clock::time_point m_lastUpdate;
+    bool m_hasLastPosition = false;
+    Stats m_stats;
+
+    WorldPartition() = default;
+
+    static uint64_t CellKey(glm::ivec2 coord);
+    glm::ivec2 cellCoord(const glm::vec3 &position) const;
+    // XZ平面上点到格子矩形的距离
+    float cellDistance(const Cell &cell, const glm::vec3 &position) const;
+    float cellDistance(const Cell &cell, const glm::vec3 &position, const glm::vec3 &focus) const;
+    // 同一文件的多个实例共用部分只计一次, 与其他格子共用的部分也按未共享估计
+    size_t estimateBytes(const Cell &cell) const;
+
+    void startReading(Cell &cell);
+    void pollReads(Cell &cell);
+    // 按时间预算把等待中的实例加入场景, 近的格子优先
+    void uploadPending(Scene &scene, const glm::vec3 &position, const glm::vec3 &focus);
+    void uploadInstance(Scene &scene, Cell &cell);
+    void evict(Scene &scene, Cell &cell);
+    // 释放格子中网格的几何与材质引用, 扣除不再被引用的共享字节
+    void releaseShared(Cell &cell);
+    // 返回新计入的字节数, 已被引用时为0
+    template <typename Key>
+    static size_t AddReference(std::unordered_map<Key, SharedBytes> &shared, const Key &key, size_t bytes);
+    // 返回引用全部释放时扣除的字节数
+    template <typename Key>
+    static size_t RemoveReference(std::unordered_map<Key, SharedBytes> &shared, const Key &key);
+    // 卸载最远的一个常驻格子, 它必须比 distance 更远. 没有这样的格子时返回 false
+    bool evictFarthest(Scene &scene, const glm::vec3 &position, const glm::vec3 &focus, float distance);
+    void pollAbandonedReads();
+    void refreshStats();
+};
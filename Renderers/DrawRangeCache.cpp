@@ -0,0 +1,78 @@
+#include "DrawRangeCache.hpp"
+
+namespace
+{
+    uint64_t HashCombine(uint64_t seed, uint64_t value)
+    {
+        return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+}
+
+bool DrawRangeCache::update(Scene &scene)
+{
+    if (m_sceneVersion == scene.structureVersion())
+        return false;
+    rebuild(scene);
+    return true;
+}
+
+void DrawRangeCache::rebuild(Scene &scene)
+{
+    m_ranges.clear();
+    m_rangeBegin.assign(scene.size() + 1, 0);
+    m_rangeHash.assign(scene.size(), 0);
+    for (size_t i = 0; i < scene.size(); ++i)
+    {
+        const uint32_t begin = static_cast<uint32_t>(m_ranges.size());
+        m_rangeBegin[i] = begin;
+        m_scratch.clear();
+        scene.objectAt(i).collectDrawRanges(m_scratch);
+        for (const DrawRange &range : m_scratch)
+        {
+            if (m_ranges.size() > begin)
+            {
+                DrawRange &last = m_ranges.back();
+                // 同一网格的簇合并回整个网格, 保留其LOD
+                if (last.vao == range.vao && last.material == range.material && last.materialId == range.materialId &&
+                    last.lods == range.lods &&
+                    last.baseVertex == range.baseVertex && last.firstIndex + last.indexCount == range.firstIndex)
+                {
+                    last.indexCount += range.indexCount;
+                    continue;
+                }
+            }
+            m_ranges.push_back(range);
+        }
+
+        uint64_t hash = m_ranges.size() - begin;
+        for (size_t r = begin; r < m_ranges.size(); ++r)
+        {
+            const DrawRange &range = m_ranges[r];
+            hash = HashCombine(hash, range.vao);
+            hash = HashCombine(hash, range.material);
+            hash = HashCombine(hash, range.materialId);
+            hash = HashCombine(hash, range.firstIndex);
+            hash = HashCombine(hash, range.indexCount);
+            hash = HashCombine(hash, static_cast<uint32_t>(range.baseVertex));
+        }
+        m_rangeHash[i] = hash;
+    }
+    m_rangeBegin[scene.size()] = static_cast<uint32_t>(m_ranges.size());
+    m_sceneVersion = scene.structureVersion();
+}
+
+bool DrawRangeCache::sameRanges(uint32_t a, uint32_t b) const
+{
+    const uint32_t count = end(a) - begin(a);
+    if (count != end(b) - begin(b))
+        return false;
+    for (uint32_t k = 0; k < count; ++k)
+    {
+        const DrawRange &x = m_ranges[begin(a) + k];
+        const DrawRange &y = m_ranges[begin(b) + k];
+        if (x.vao != y.vao || x.material != y.material || x.materialId != y.materialId || x.firstIndex != y.firstIndex ||
+            x.indexCount != y.indexCount || x.baseVertex != y.baseVertex)
+            return false;
+    }
+    return true;
+}
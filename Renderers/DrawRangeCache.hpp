@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Objects/Scene.hpp"
+
+/*
+按稠密下标缓存每个对象的 DrawRange, 场景结构变化时重建
+网格簇的范围在索引缓冲中首尾相接, CPU提交时合并回整段, 每个对象每种材质通常只剩一个范围
+*/
+class DrawRangeCache
+{
+public:
+    /// @brief 场景结构版本变化时重建, 返回是否重建
+    bool update(Scene &scene);
+
+    uint32_t begin(uint32_t denseIndex) const { return m_rangeBegin[denseIndex]; }
+    uint32_t end(uint32_t denseIndex) const { return m_rangeBegin[denseIndex + 1]; }
+    bool empty(uint32_t denseIndex) const { return begin(denseIndex) == end(denseIndex); }
+    const DrawRange &range(uint32_t r) const { return m_ranges[r]; }
+    // 范围完全相同的对象哈希相同, 反之不一定
+    uint64_t hash(uint32_t denseIndex) const { return m_rangeHash[denseIndex]; }
+    bool sameRanges(uint32_t a, uint32_t b) const;
+
+private:
+    static constexpr uint64_t InvalidVersion = ~uint64_t(0);
+
+    std::vector<DrawRange> m_ranges;
+    std::vector<DrawRange> m_scratch;
+    std::vector<uint32_t> m_rangeBegin; // 末尾多一个哨兵
+    std::vector<uint64_t> m_rangeHash;
+    uint64_t m_sceneVersion = InvalidVersion;
+
+    void rebuild(Scene &scene);
+};
@@ -38,11 +38,11 @@ private:
         "Resource/skybox/back.jpg"};
     int width = 1600;
     int height = 900;
+    // 阴影pass的LOD屏幕误差相对相机视图的倍数
+    static constexpr float ShadowLodErrorScale = 4.0f;
 
     unsigned int skyboxCube;
 
-    const int MAX_POINT_LIGHTS = 10;
-
     PointShadowPass pointShadowPass;
     DirShadowPass dirShadowPass;
     GBufferPass gBufferPass;
@@ -68,6 +68,16 @@ private:
 
     GBufferRendererGUI rendererGUI;
 
+    // 相机可见对象(视锥 + 上一帧Hi-Z), 阴影pass据此剔除投射体
+    std::vector<uint32_t> visibleReceivers;
+
+    // 相机与各级CSM共用的GPU驱动剔除数据
+    GPUDrivenCulling gpuDrivenCulling;
+
+    // 点光源与平行光阴影贴图的GPU耗时
+    GPUTimer pointShadowTimer;
+    GPUTimer dirShadowTimer;
+
 public:
     GBufferRenderer()
         : gBufferPass(GBufferPass(width, height, "Shaders/GBuffer/gbuffer.vs", "Shaders/GBuffer/gbuffer.fs")),
@@ -110,6 +120,7 @@ public:
         dirShadowSATPass.reloadCurrentShaders();
         texture2DArrayTestPass.reloadCurrentShaders();
         textureArrayUnfoldPass.reloadCurrentShaders();
+        gpuDrivenCulling.reloadShaders();
         contextSetup();
     }
 
@@ -154,20 +165,117 @@ public:
     }
 
 private:
+    void collectVisibleReceivers(Camera &cam, Scene &scene)
+    {
+        if (!GUI::DebugToggleShadowCasterCulling())
+        {
+            pointShadowPass.setVisibleReceivers(nullptr);
+            dirShadowPass.setVisibleReceivers(nullptr);
+            return;
+        }
+        visibleReceivers.clear();
+        scene.queryVisible(cam.getFrustum().getPlanes(), visibleReceivers);
+        if (GUI::enableHiZCulling)
+        {
+            HiZCulling &hiZ = gBufferPass.getHiZCulling();
+            hiZ.fetchReadback();
+            std::erase_if(visibleReceivers, [&](uint32_t i)
+                          { return !hiZ.isVisible(scene.worldBoundsAt(i).box); });
+        }
+        pointShadowPass.setVisibleReceivers(&visibleReceivers);
+        dirShadowPass.setVisibleReceivers(&visibleReceivers);
+    }
+
+    // 每帧读取一次开关, 交给会绘制场景的各pass
+    void setupInstancing()
+    {
+        const bool enable = GUI::DebugToggleInstancing();
+        pointShadowPass.setInstancing(enable);
+        dirShadowPass.setInstancing(enable);
+        gBufferPass.setInstancing(enable);
+        pointShadowPass.resetInstancingStats();
+        dirShadowPass.resetInstancingStats();
+        gBufferPass.resetInstancingStats();
+    }
+
+    // 每帧读取一次渲染队列排序开关, 并清零各pass的状态切换统计
+    void setupRenderQueue()
+    {
+        const bool sorting = GUI::DebugToggleRenderQueue();
+        pointShadowPass.setRenderQueueSorting(sorting);
+        dirShadowPass.setRenderQueueSorting(sorting);
+        gBufferPass.setRenderQueueSorting(sorting);
+        pointShadowPass.resetRenderQueueStats();
+        dirShadowPass.resetRenderQueueStats();
+        gBufferPass.resetRenderQueueStats();
+
+        // 阴影贴图只需要轮廓, 允许比相机视图更粗的LOD
+        const float lodPixelError = GUI::DebugLodPixelError();
+        gBufferPass.setLodPixelError(lodPixelError);
+        dirShadowPass.setLodPixelError(lodPixelError * ShadowLodErrorScale);
+        pointShadowPass.setLodPixelError(lodPixelError * ShadowLodErrorScale);
+
+        // 阴影投射体只需要位置
+        const bool positionOnly = GUI::DebugTogglePositionOnlyShadows();
+        dirShadowPass.setPositionOnly(positionOnly);
+        pointShadowPass.setPositionOnly(positionOnly);
+    }
+
+    // GPU驱动剔除开启时同步场景数据, 并交给GBuffer与平行光阴影pass
+    GPUDrivenCulling *setupGPUDrivenCulling(Scene &scene)
+    {
+        GPUDrivenCulling *culling = nullptr;
+        if (GUI::DebugToggleGPUDrivenCulling())
+        {
+            gpuDrivenCulling.beginFrame(scene);
+            gpuDrivenCulling.setClusterCulling(GUI::DebugToggleSmallClusterCulling(), GUI::DebugToggleClusterConeCulling());
+            culling = &gpuDrivenCulling;
+        }
+        else
+        {
+            gpuDrivenCulling.invalidate();
+        }
+        gBufferPass.setGPUDrivenCulling(culling);
+        dirShadowPass.setGPUDrivenCulling(culling);
+        return culling;
+    }
+
     void renderLight(RenderParameters &renderParameters)
     {
         auto &[allLights, cam, scene, model, window] = renderParameters;
         auto &[pointLights, dirLights] = allLights;
 
         rendererGUI.render();
+        GUI::DebugToggleCulling();
+        pointShadowPass.resetCullingStats();
+        dirShadowPass.resetCullingStats();
+        gBufferPass.resetCullingStats();
+        collectVisibleReceivers(cam, scene);
+        const GPUDrivenCulling *gpuCulling = setupGPUDrivenCulling(scene);
+        setupInstancing();
+        setupRenderQueue();
+        gBufferPass.setObjectIds(GUI::DebugToggleObjectIdPicking(gBufferPass.getObjectPicker()));
         /****************************阴影贴图渲染*********************************************/
-        // 点光源阴影贴图
+        // 阴影贴图分配在光源表的纹理数组中, 光源的阴影纹理是各自所在层的视图
         for (auto &light : pointLights)
         {
-            light.useVSM = true;
-            if (!rendererGUI.toggleVSM)
+            light.useVSM = rendererGUI.toggleVSM;
+        }
+        for (auto &light : dirLights)
+        {
+            light.useVSM = rendererGUI.toggleVSM;
+        }
+        LightBuffer &lightBuffer = lightPass.getLightBuffer();
+        lightBuffer.allocateShadowMaps(allLights);
+
+        // 点光源阴影贴图. 超出阴影贴图数组层数上限的光源没有阴影
+        pointShadowTimer.begin();
+        for (size_t i = 0; i < pointLights.size(); ++i)
+        {
+            auto &light = pointLights[i];
+            if (!lightBuffer.hasPointShadow(i))
             {
-                light.useVSM = false;
+                continue;
             }
             light.generateShadowTexResource();
             if (rendererGUI.togglePointShadow)
@@ -175,9 +283,8 @@ private:
                 pointShadowPass.renderToTexture(
                     light,
                     scene,
-                    model,
-                    light.texResolution,
-                    light.texResolution);
+                    light.shadowResolution,
+                    light.shadowResolution);
                 if (light.useVSM)
                 {
                     pointShadowVSMPass.renderToVSMTexture(light);
@@ -185,14 +292,17 @@ private:
             }
         }
 
+        pointShadowTimer.end();
+
         GUI::DebugToggleDrawFrustum();
         // 平行光源阴影贴图
-        for (auto &light : dirLights)
+        dirShadowTimer.begin();
+        for (size_t i = 0; i < dirLights.size(); ++i)
         {
-            light.useVSM = true;
-            if (!rendererGUI.toggleVSM)
+            auto &light = dirLights[i];
+            if (!lightBuffer.hasDirShadow(i))
             {
-                light.useVSM = false;
+                continue;
             }
             light.generateShadowTexResource();
             if (rendererGUI.toggleDirShadow)
@@ -212,7 +322,7 @@ private:
                     // light.CSMComponent->update(-glm::normalize(light.getPosition()), camFrustum);
                     light.CSMComponent->update(-glm::normalize(light.getPosition()), cam.getFrustum());
                 }
-                dirShadowPass.render(*light.CSMComponent, scene, model);
+                dirShadowPass.render(*light.CSMComponent, scene);
 
                 std::vector<GLuint> shadowTexIDs;
 
@@ -227,7 +337,7 @@ private:
                 }
                 rendererGUI.renderPassInspector(shadowTexIDs);
 
-                dirShadowPass.render(light.shadowUnit, scene, model);
+                dirShadowPass.render(light.shadowUnit, scene);
 
                 // Camera camTmp(1600, 900, 1.0f, 1.0f);
                 // auto camFrustum = camTmp.getFrustum();
@@ -257,11 +367,31 @@ private:
                 }
             }
         }
+        dirShadowTimer.end();
 
         /****************************GBuffer渲染*********************************************/
         gBufferPass.render(renderParameters);
         auto [gPosition, gNormal, gAlbedoSpec, gViewPosition] = gBufferPass.getTextures();
 
+        GUI::DebugCullingStats("PointShadow", pointShadowPass.getCullingStats());
+        GUI::DebugCullingStats("DirShadow", dirShadowPass.getCullingStats());
+        GUI::DebugCullingStats("GBuffer", gBufferPass.getCullingStats());
+        if (gpuCulling)
+            GUI::DebugGPUDrivenStats(gpuCulling->getStats());
+        GUI::DebugInstancingStats("PointShadow", pointShadowPass.getInstancingStats());
+        GUI::DebugInstancingStats("DirShadow", dirShadowPass.getInstancingStats());
+        GUI::DebugInstancingStats("GBuffer", gBufferPass.getInstancingStats());
+        GUI::DebugRenderQueueStats("PointShadow", pointShadowPass.getRenderQueueStats());
+        GUI::DebugRenderQueueStats("DirShadow", dirShadowPass.getRenderQueueStats());
+        GUI::DebugRenderQueueStats("GBuffer", gBufferPass.getRenderQueueStats());
+        GUI::DebugShadowTiming(pointShadowTimer, dirShadowTimer);
+        // 逐对象绘制(CPU路径与间接绘制的回退对象)的提交次数
+        GUI::DebugGeometryStats(GeometryBuffer::SharedStats());
+        GUI::DebugMeshOptimizeStats(ModelLoader::optimize_stats);
+        GUI::DebugPrimitiveStats(PrimitiveRegistry::Get().getStats());
+        GUI::DebugMaterialStats(MaterialLibrary::Get().getStats());
+        GeometryBuffer::ResetSharedFrameStats();
+
         /****************************SSAO渲染*********************************************/
         unsigned int ssaoPassTex = 0;
         unsigned int ssaoBlurTex = 0;
@@ -352,9 +482,16 @@ private:
 
         ImGui::Begin("RendererGUI");
         {
-            ImGui::DragFloat("OrthoScale", &allLights.dirLights[0].orthoScale, 5.f, 1e3);
-            ImGui::DragFloat("FarPlane", &allLights.dirLights[0].farPlane, 1e1f, 1e7);
-            ImGui::DragFloat("NearPlane", &allLights.dirLights[0].nearPlane, 1e-2f, 2.f);
+            if (!allLights.dirLights.empty())
+            {
+                ImGui::DragFloat("OrthoScale", &allLights.dirLights[0].orthoScale, 5.f, 1e3);
+                ImGui::DragFloat("FarPlane", &allLights.dirLights[0].farPlane, 1e1f, 1e7);
+                ImGui::DragFloat("NearPlane", &allLights.dirLights[0].nearPlane, 1e-2f, 2.f);
+            }
+            else
+            {
+                ImGui::TextUnformatted("No directional light");
+            }
             ImGui::End();
         }
 
@@ -0,0 +1,269 @@
+#include "GPUDrivenCulling.hpp"
+#include <algorithm>
+#include <map>
+#include <unordered_set>
+
+#include "HiZCulling.hpp"
+
+GPUDrivenCulling::CullView GPUDrivenCulling::CullView::FromFrustum(const FrustumBase &frustum, int viewportHeight)
+{
+    const glm::mat4 projection = frustum.getProjectionMatrix();
+    CullView view;
+    view.planes = frustum.getPlanes();
+    view.viewProj = frustum.getProjViewMatrix();
+    view.position = frustum.getPosition();
+    view.direction = glm::normalize(frustum.getFront());
+    view.orthographic = projection[3][3] == 1.0f;
+    // 裁剪空间 y 的半高为 w, 对应 viewportHeight/2 个像素
+    view.pixelScale = 0.5f * static_cast<float>(viewportHeight) * projection[1][1];
+    view.coneCulling = true;
+    return view;
+}
+
+GPUDrivenCulling::CullView GPUDrivenCulling::CullView::FromPlanes(const FrustumPlanes &planes)
+{
+    CullView view;
+    view.planes = planes;
+    return view;
+}
+
+GPUDrivenCulling::GPUDrivenCulling()
+{
+    glGenBuffers(1, &m_objectBuffer);
+    glGenBuffers(1, &m_itemBuffer);
+    glGenBuffers(1, &m_commandBuffer);
+    glGenBuffers(1, &m_commandMaterialBuffer);
+    glGenBuffers(1, &m_countBuffer);
+}
+
+GPUDrivenCulling::~GPUDrivenCulling()
+{
+    glDeleteBuffers(1, &m_objectBuffer);
+    glDeleteBuffers(1, &m_itemBuffer);
+    glDeleteBuffers(1, &m_commandBuffer);
+    glDeleteBuffers(1, &m_commandMaterialBuffer);
+    glDeleteBuffers(1, &m_countBuffer);
+}
+
+void GPUDrivenCulling::reloadShaders()
+{
+    cullShader = ComputeShader("Shaders/GPUDriven/cull.comp");
+}
+
+void GPUDrivenCulling::beginFrame(Scene &scene)
+{
+    m_viewCount = 0;
+    m_frameStats.drawCalls = 0;
+    m_frameStats.vaoBinds = 0;
+    if (m_sceneVersion != scene.structureVersion())
+    {
+        rebuild(scene);
+        return;
+    }
+
+    const std::vector<uint32_t> &changed = scene.changedIndices();
+    if (changed.empty() || m_objects.empty())
+        return;
+    // 大量变化时整体上传, 否则逐对象上传. 项中只有模型空间数据, 不需要更新
+    if (changed.size() * 4 > scene.size())
+    {
+        for (size_t i = 0; i < scene.size(); ++i)
+            writeTransform(scene, i);
+        uploadObjects(0, m_objects.size());
+        return;
+    }
+    for (uint32_t i : changed)
+    {
+        writeTransform(scene, i);
+        uploadObjects(i, 1);
+    }
+}
+
+void GPUDrivenCulling::rebuild(Scene &scene)
+{
+    m_objects.assign(scene.size(), DrawObject{});
+    m_items.clear();
+    m_batches.clear();
+    m_fallback.clear();
+    m_clusterCount = 0;
+
+    // 有序键使同一VAO的批次相邻, 绘制时连续的批次不必重新绑定
+    std::map<std::pair<GLuint, uint64_t>, uint32_t> batchOfKey;
+    std::vector<DrawRange> ranges;
+    for (size_t i = 0; i < scene.size(); ++i)
+    {
+        Object &object = scene.objectAt(i);
+        ranges.clear();
+        object.collectDrawRanges(ranges);
+        if (ranges.empty())
+        {
+            m_fallback.push_back(static_cast<uint32_t>(i));
+            continue;
+        }
+        for (const DrawRange &range : ranges)
+        {
+            auto [it, inserted] = batchOfKey.try_emplace({range.vao, range.material}, static_cast<uint32_t>(m_batches.size()));
+            if (inserted)
+                m_batches.push_back(Batch{range.vao, range.depthVao, range.indexType, range.material, 0, 0});
+            m_batches[it->second].capacity++;
+
+            DrawItem item{};
+            item.sphere = range.sphere;
+            item.cone = range.cone;
+            item.coneApex = glm::vec4(range.coneApex, 1.0f);
+            item.indexCount = range.indexCount;
+            item.firstIndex = range.firstIndex;
+            item.baseVertex = range.baseVertex;
+            item.batch = it->second;
+            item.object = static_cast<GLuint>(i);
+            item.materialId = range.materialId;
+            m_items.push_back(item);
+            if (range.sphere.w >= 0.0f)
+                ++m_clusterCount;
+        }
+    }
+
+    // 批次按键排序后重新编号
+    std::vector<Batch> sorted;
+    std::vector<uint32_t> remap(m_batches.size());
+    sorted.reserve(m_batches.size());
+    for (const auto &[key, batch] : batchOfKey)
+    {
+        remap[batch] = static_cast<uint32_t>(sorted.size());
+        sorted.push_back(m_batches[batch]);
+    }
+    m_batches.swap(sorted);
+
+    GLuint offset = 0;
+    std::unordered_set<GLuint> vaos;
+    for (Batch &batch : m_batches)
+    {
+        batch.commandOffset = offset;
+        offset += batch.capacity;
+        vaos.insert(batch.vao);
+    }
+    m_frameStats.vaos = vaos.size();
+    for (DrawItem &item : m_items)
+    {
+        item.batch = remap[item.batch];
+        item.commandOffset = m_batches[item.batch].commandOffset;
+    }
+    for (size_t i = 0; i < scene.size(); ++i)
+        writeTransform(scene, i);
+
+    // 命令区按最坏情况(全部可见)分配, 每个视图一份
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(1, m_objects.size()) * sizeof(DrawObject), m_objects.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_itemBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(1, m_items.size()) * sizeof(DrawItem), m_items.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(1, MaxViews * m_items.size()) * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandMaterialBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(1, MaxViews * m_items.size()) * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(1, MaxViews * m_batches.size()) * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    m_sceneVersion = scene.structureVersion();
+}
+
+void GPUDrivenCulling::writeTransform(const Scene &scene, size_t denseIndex)
+{
+    const AABB &box = scene.worldBoundsAt(denseIndex).box;
+    const float valid = box.isValid() ? 1.0f : 0.0f;
+    DrawObject &object = m_objects[denseIndex];
+    object.model = scene.worldTransformAt(denseIndex);
+    object.boundsMin = glm::vec4(box.min, valid);
+    object.boundsMax = glm::vec4(box.max, static_cast<float>(denseIndex));
+}
+
+void GPUDrivenCulling::uploadObjects(size_t first, size_t count)
+{
+    if (count == 0)
+        return;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, first * sizeof(DrawObject), count * sizeof(DrawObject), &m_objects[first]);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+int GPUDrivenCulling::cull(const CullView &cullView, const HiZCulling *hiZ)
+{
+    if (m_viewCount >= MaxViews)
+        return -1;
+    const int view = m_viewCount++;
+    if (m_items.empty())
+        return view;
+
+    // 清零本视图各批次的计数
+    const GLsizeiptr countBytes = m_batches.size() * sizeof(GLuint);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_countBuffer);
+    glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, view * countBytes, countBytes, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    cullShader.use();
+    cullShader.setUniform4fv("frustumPlanes"_uniform, FrustumPlanes::Count, &cullView.planes.planes[0].x);
+    cullShader.setUniform("view"_uniform, view);
+    cullShader.setUniform("itemCount"_uniform, static_cast<int>(m_items.size()));
+    cullShader.setUniform("batchCount"_uniform, static_cast<int>(m_batches.size()));
+    cullShader.setUniform("viewProj"_uniform, cullView.viewProj);
+    cullShader.setUniform("viewPosition"_uniform, cullView.position);
+    cullShader.setUniform("viewDirection"_uniform, cullView.direction);
+    cullShader.setUniform("orthographic"_uniform, cullView.orthographic ? 1 : 0);
+    cullShader.setUniform("pixelScale"_uniform, m_smallClusterCulling ? cullView.pixelScale : 0.0f);
+    cullShader.setUniform("coneCulling"_uniform, m_coneCulling && cullView.coneCulling ? 1 : 0);
+    const bool useHiZ = hiZ && hiZ->hasPyramid();
+    cullShader.setUniform("useHiZ"_uniform, useHiZ ? 1 : 0);
+    if (useHiZ)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, hiZ->getPyramidTexture());
+        cullShader.setUniform("hiZPyramid"_uniform, 0);
+        cullShader.setUniform("hiZViewProj"_uniform, hiZ->getPyramidViewProj());
+        cullShader.setUniform("hiZLevelCount"_uniform, hiZ->getLevelCount());
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_objectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_itemBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_commandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_countBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_commandMaterialBuffer);
+    glDispatchCompute(static_cast<GLuint>((m_items.size() + GroupSize - 1) / GroupSize), 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+    return view;
+}
+
+void GPUDrivenCulling::draw(int view, Shader &shaders, bool positionOnly)
+{
+    if (view < 0 || m_items.empty())
+        return;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_objectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_commandMaterialBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+    glBindBuffer(GL_PARAMETER_BUFFER, m_countBuffer);
+
+    const size_t viewCommands = size_t(view) * m_items.size();
+    const size_t viewCounts = size_t(view) * m_batches.size();
+    GLuint boundVao = 0;
+    for (size_t b = 0; b < m_batches.size(); ++b)
+    {
+        Batch &batch = m_batches[b];
+        const GLuint vao = positionOnly && batch.depthVao ? batch.depthVao : batch.vao;
+        if (vao != boundVao)
+        {
+            glBindVertexArray(vao);
+            boundVao = vao;
+            m_frameStats.vaoBinds++;
+        }
+        // 命令的材质编号位于 materialCommandBase + gl_DrawID
+        shaders.setInt("materialCommandBase"_uniform, static_cast<int>(viewCommands + batch.commandOffset));
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, batch.indexType,
+                                         reinterpret_cast<const void *>((viewCommands + batch.commandOffset) * sizeof(DrawElementsIndirectCommand)),
+                                         static_cast<GLintptr>((viewCounts + b) * sizeof(GLuint)),
+                                         static_cast<GLsizei>(batch.capacity), 0);
+        m_frameStats.drawCalls++;
+    }
+    shaders.setInt("materialCommandBase"_uniform, -1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_PARAMETER_BUFFER, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "../Shading/Shader.hpp"
+#include "../Math/Frustum.hpp"
+#include "../Objects/Scene.hpp"
+
+class HiZCulling;
+
+/*
+GPU 驱动剔除 + 间接绘制
+数据: 每个场景对象在对象SSBO中一项(世界矩阵, 世界包围盒), 每个 DrawRange 在项SSBO中一项(索引范围, 所属对象,
+      网格簇的包围球与法线锥). 增删对象时整体重建, 之后每帧只上传世界矩阵变化的对象
+剔除: 每个视图(相机, CSM 各级)一次 dispatch, 每个线程测试一项.
+      整体项: 对象包围盒的视锥 + 可选 Hi-Z(上一帧GBuffer深度金字塔).
+      网格簇: 包围球的视锥 + Hi-Z, 投影小于一个像素的簇, 以及法线锥整体背向观察点的簇.
+      可见项经原子计数追加 DrawElementsIndirectCommand 到所在批次的命令区, baseInstance 记录对象下标,
+      顶点着色器用 gl_BaseInstance 读取世界矩阵
+绘制: 按 (VAO, 材质) 分批, 每批一次 glMultiDrawElementsIndirectCount, 绘制数量由GPU写入的计数决定.
+      几何体位于 GeometryBuffer 时共用一个VAO, 批次数即材质数.
+      CPU 每帧开销只与批次数有关, 与对象数、簇数和可见数无关
+*/
+class GPUDrivenCulling
+{
+public:
+    static constexpr int MaxViews = 16;
+    static constexpr int GroupSize = 64; // 与 cull.comp 的 local_size_x 一致
+
+    struct Stats
+    {
+        size_t items = 0;
+        size_t clusters = 0; // items 中网格簇的数量
+        size_t batches = 0;
+        size_t fallback = 0; // 不支持间接绘制, 由调用方走CPU路径的对象
+        size_t vaos = 0;     // 批次用到的不同VAO数
+        int views = 0;
+        // 本帧 draw 提交的间接绘制调用与VAO绑定次数
+        size_t drawCalls = 0;
+        size_t vaoBinds = 0;
+    };
+
+    /// @brief 一个剔除视图
+    struct CullView
+    {
+        FrustumPlanes planes;
+        glm::mat4 viewProj = glm::mat4(1.0f);
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+        bool orthographic = false;
+        float pixelScale = 0.0f;  // 距离1处单位长度投影到的像素数(正交投影与距离无关), 0 时不做小簇剔除
+        bool coneCulling = false; // 法线锥背面剔除
+
+        /// @param viewportHeight 视图渲染目标的高度(像素)
+        static CullView FromFrustum(const FrustumBase &frustum, int viewportHeight);
+        /// @brief 只有平面时只做视锥剔除
+        static CullView FromPlanes(const FrustumPlanes &planes);
+    };
+
+    GPUDrivenCulling();
+    ~GPUDrivenCulling();
+    GPUDrivenCulling(const GPUDrivenCulling &) = delete;
+    GPUDrivenCulling &operator=(const GPUDrivenCulling &) = delete;
+
+    void reloadShaders();
+
+    /// @brief 同步场景数据并开始新的一帧. 在 Scene::updateTransforms 之后, 各视图剔除之前调用
+    void beginFrame(Scene &scene);
+    /// @brief 下次 beginFrame 时全部重建. 停用期间不跟踪场景变化, 重新启用前调用
+    void invalidate() { m_sceneVersion = InvalidVersion; }
+
+    /// @brief 网格簇的小簇/法线锥剔除开关. 关闭时簇只做视锥与Hi-Z测试
+    void setClusterCulling(bool smallClusters, bool cones)
+    {
+        m_smallClusterCulling = smallClusters;
+        m_coneCulling = cones;
+    }
+
+    /// @brief 剔除一个视图, 结果写入该视图的间接命令区
+    /// @param hiZ 非空时额外做Hi-Z遮挡测试, 只应用于生成金字塔的相机视图
+    /// @return 视图编号. 本帧视图超过 MaxViews 时返回 -1, 调用方应改走CPU路径
+    int cull(const CullView &view, const HiZCulling *hiZ = nullptr);
+
+    /// @brief 绘制视图中的可见项. 着色器需按 gl_BaseInstance 从 binding=0 的SSBO读取世界矩阵
+    /// @param positionOnly 使用各批次的位置流VAO, 供只写深度的pass使用
+    void draw(int view, Shader &shaders, bool positionOnly = false);
+
+    /// @brief 没有 DrawRange 的对象的稠密下标, 调用方用 Object::draw 绘制
+    const std::vector<uint32_t> &getFallbackIndices() const { return m_fallback; }
+
+    Stats getStats() const
+    {
+        Stats stats = m_frameStats;
+        stats.items = m_items.size();
+        stats.clusters = m_clusterCount;
+        stats.batches = m_batches.size();
+        stats.fallback = m_fallback.size();
+        stats.views = m_viewCount;
+        return stats;
+    }
+
+private:
+    static constexpr uint64_t InvalidVersion = ~uint64_t(0);
+
+    // 与 Shaders/GPUDriven/drawObject.glsl 的 std430 布局一致, 按稠密下标排列
+    struct DrawObject
+    {
+        glm::mat4 model;
+        glm::vec4 boundsMin; // w=1 时包围盒有效, 否则总是可见
+        glm::vec4 boundsMax; // w 为稠密下标, 写入GBuffer对象ID
+    };
+    static_assert(sizeof(DrawObject) == 96, "DrawObject must match std430 layout");
+
+    // 与 cull.comp 的 DrawItem 布局一致
+    struct DrawItem
+    {
+        glm::vec4 sphere; // 模型空间包围球, w < 0 时按对象包围盒剔除
+        glm::vec4 cone;   // 法线锥轴与余弦阈值
+        glm::vec4 coneApex;
+        GLuint indexCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint batch;
+        GLuint commandOffset; // 所在批次的命令区在视图内的起点
+        GLuint object;
+        GLuint materialId; // 随命令写出, 供着色器按 gl_DrawID 读取
+        GLuint padding;
+    };
+    static_assert(sizeof(DrawItem) == 80, "DrawItem must match std430 layout");
+
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // 同一批次的项共用顶点格式与纹理数组组合, 各命令的材质编号由剔除着色器写出
+    struct Batch
+    {
+        GLuint vao;
+        GLuint depthVao;  // 同一 vao 的范围位置流VAO相同
+        GLenum indexType; // 同一 vao 的范围索引类型相同
+        uint64_t material;
+        GLuint commandOffset;
+        GLuint capacity;
+    };
+
+    ComputeShader cullShader = ComputeShader("Shaders/GPUDriven/cull.comp");
+    GLuint m_objectBuffer = 0;
+    GLuint m_itemBuffer = 0;
+    GLuint m_commandBuffer = 0;         // MaxViews * 项数 条命令
+    GLuint m_commandMaterialBuffer = 0; // 与命令一一对应的材质编号
+    GLuint m_countBuffer = 0;           // MaxViews * 批次数 个计数
+
+    std::vector<DrawObject> m_objects;
+    std::vector<DrawItem> m_items;
+    std::vector<Batch> m_batches;
+    std::vector<uint32_t> m_fallback;
+    size_t m_clusterCount = 0;
+    Stats m_frameStats; // 只使用 vaos, drawCalls, vaoBinds
+    uint64_t m_sceneVersion = InvalidVersion;
+    int m_viewCount = 0;
+    bool m_smallClusterCulling = true;
+    bool m_coneCulling = false;
+
+    void rebuild(Scene &scene);
+    void writeTransform(const Scene &scene, size_t denseIndex);
+    void uploadObjects(size_t first, size_t count);
+};
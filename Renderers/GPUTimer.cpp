@@ -0,0 +1,59 @@
+#include "GPUTimer.hpp"
+
+namespace
+{
+    // 滑动平均中新样本的权重
+    constexpr double AverageWeight = 0.1;
+}
+
+GPUTimer::GPUTimer()
+{
+    glGenQueries(QueryCount, m_queries);
+}
+
+GPUTimer::~GPUTimer()
+{
+    glDeleteQueries(QueryCount, m_queries);
+}
+
+void GPUTimer::collect()
+{
+    // m_current 处是最早发起的查询. 按发起顺序读取, 遇到未完成的即停止
+    for (int i = 0; i < QueryCount; ++i)
+    {
+        const int slot = (m_current + i) % QueryCount;
+        if (!m_pending[slot])
+            continue;
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(m_queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(m_queries[slot], GL_QUERY_RESULT, &elapsed);
+        m_pending[slot] = false;
+        m_lastMs = double(elapsed) * 1e-6;
+        m_averageMs = m_averageMs == 0.0 ? m_lastMs : m_averageMs + AverageWeight * (m_lastMs - m_averageMs);
+    }
+}
+
+void GPUTimer::begin()
+{
+    if (m_running)
+        return;
+    collect();
+    // 所有查询都还未完成时丢弃本次计时, 不等待GPU
+    if (m_pending[m_current])
+        return;
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[m_current]);
+    m_running = true;
+}
+
+void GPUTimer::end()
+{
+    if (!m_running)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    m_pending[m_current] = true;
+    m_current = (m_current + 1) % QueryCount;
+    m_running = false;
+}
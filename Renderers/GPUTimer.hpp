@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glad/glad.h>
+
+/*
+GPU计时: begin/end 之间的GPU耗时, 用 GL_TIME_ELAPSED 查询测量
+结果在若干帧之后才可用, 各查询轮流使用, 只读取已完成的结果, 不阻塞渲染线程
+同一时刻只能有一个 GL_TIME_ELAPSED 查询进行中, 计时区间不能嵌套
+*/
+class GPUTimer
+{
+public:
+    static constexpr int QueryCount = 4;
+
+    GPUTimer();
+    ~GPUTimer();
+    GPUTimer(const GPUTimer &) = delete;
+    GPUTimer &operator=(const GPUTimer &) = delete;
+
+    void begin();
+    void end();
+
+    /// @brief 最近一次完成的计时(毫秒), 比当前帧晚几帧
+    double getLastMs() const { return m_lastMs; }
+    /// @brief 指数滑动平均(毫秒)
+    double getAverageMs() const { return m_averageMs; }
+
+private:
+    GLuint m_queries[QueryCount] = {};
+    bool m_pending[QueryCount] = {};
+    int m_current = 0;
+    bool m_running = false;
+    double m_lastMs = 0.0;
+    double m_averageMs = 0.0;
+
+    // 读取已完成的查询结果
+    void collect();
+};
@@ -0,0 +1,205 @@
+#include "HiZCulling.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+HiZCulling::HiZCulling()
+{
+    glGenBuffers(1, &m_pbo);
+}
+
+HiZCulling::~HiZCulling()
+{
+    if (m_fence)
+        glDeleteSync(m_fence);
+    glDeleteBuffers(1, &m_pbo);
+}
+
+void HiZCulling::reloadShaders()
+{
+    buildShader = ComputeShader("Shaders/HiZ/hizBuild.comp");
+}
+
+void HiZCulling::resize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_levelCount = 1 + static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(width, height)))));
+    pyramid.generateComputeStorage(width, height, GL_RG32F, m_levelCount);
+    glBindTexture(GL_TEXTURE_2D, pyramid.ID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void HiZCulling::build(GLuint depthTexture, int width, int height, const glm::mat4 &viewProj)
+{
+    if (width <= 0 || height <= 0)
+        return;
+    if (width != m_width || height != m_height)
+        resize(width, height);
+
+    buildShader.use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    buildShader.setUniform("depthMap", 0);
+
+    int levelWidth = width;
+    int levelHeight = height;
+    for (int level = 0; level < m_levelCount; ++level)
+    {
+        buildShader.setUniform("firstLevel", level == 0 ? 1 : 0);
+        if (level > 0)
+            glBindImageTexture(0, pyramid.ID, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_RG32F);
+        glBindImageTexture(1, pyramid.ID, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+        glDispatchCompute(ComputeShader::GetGroupSize(levelWidth), ComputeShader::GetGroupSize(levelHeight), 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        levelWidth = std::max(1, levelWidth / 2);
+        levelHeight = std::max(1, levelHeight / 2);
+    }
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+    m_pyramidViewProj = viewProj;
+
+    // 上一次回读还在进行中时不发起新的, 避免等待
+    if (m_fence)
+        return;
+
+    int level = 0;
+    glm::ivec2 size(width, height);
+    while (size.x > ReadbackMaxWidth && level + 1 < m_levelCount)
+    {
+        size = glm::max(size / 2, glm::ivec2(1));
+        ++level;
+    }
+
+    // 只回读最大深度通道
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, size.x * size.y * sizeof(float), nullptr, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, pyramid.ID);
+    glGetTexImage(GL_TEXTURE_2D, level, GL_GREEN, GL_FLOAT, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_pendingLevel = level;
+    m_pendingSize = size;
+    m_pendingBaseSize = glm::ivec2(width, height);
+    m_pendingViewProj = viewProj;
+}
+
+void HiZCulling::fetchReadback()
+{
+    if (!m_fence)
+        return;
+    const GLenum status = glClientWaitSync(m_fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        return;
+    glDeleteSync(m_fence);
+    m_fence = nullptr;
+
+    const size_t count = size_t(m_pendingSize.x) * m_pendingSize.y;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+    const void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, count * sizeof(float), GL_MAP_READ_BIT);
+    if (data)
+    {
+        m_cpuLevels.resize(1);
+        m_cpuLevels[0].resize(count);
+        std::memcpy(m_cpuLevels[0].data(), data, count * sizeof(float));
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+        m_cpuSizes.assign(1, m_pendingSize);
+        m_cpuBaseLevel = m_pendingLevel;
+        m_cpuFullSize = m_pendingBaseSize;
+        m_cpuViewProj = m_pendingViewProj;
+        buildCpuLevels();
+        m_ready = true;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void HiZCulling::buildCpuLevels()
+{
+    // 与着色器相同的归约规则: 奇数尺寸时多出的行列并入最后一个texel
+    while (m_cpuSizes.back().x > 1 || m_cpuSizes.back().y > 1)
+    {
+        const glm::ivec2 src = m_cpuSizes.back();
+        const glm::ivec2 dst = glm::max(src / 2, glm::ivec2(1));
+        std::vector<float> level(size_t(dst.x) * dst.y, 0.0f);
+        const std::vector<float> &prev = m_cpuLevels.back();
+        for (int y = 0; y < dst.y; ++y)
+        {
+            const int y1 = (y == dst.y - 1) ? src.y : std::min(src.y, y * 2 + 2);
+            for (int x = 0; x < dst.x; ++x)
+            {
+                const int x1 = (x == dst.x - 1) ? src.x : std::min(src.x, x * 2 + 2);
+                float maxDepth = 0.0f;
+                for (int sy = y * 2; sy < y1; ++sy)
+                    for (int sx = x * 2; sx < x1; ++sx)
+                        maxDepth = std::max(maxDepth, prev[size_t(sy) * src.x + sx]);
+                level[size_t(y) * dst.x + x] = maxDepth;
+            }
+        }
+        m_cpuLevels.push_back(std::move(level));
+        m_cpuSizes.push_back(dst);
+    }
+}
+
+bool HiZCulling::isVisible(const AABB &worldBox) const
+{
+    if (!m_ready || !worldBox.isValid())
+        return true;
+
+    glm::vec2 ndcMin(std::numeric_limits<float>::max());
+    glm::vec2 ndcMax(-std::numeric_limits<float>::max());
+    float nearestDepth = 1.0f;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        const glm::vec3 p((corner & 1) ? worldBox.max.x : worldBox.min.x,
+                          (corner & 2) ? worldBox.max.y : worldBox.min.y,
+                          (corner & 4) ? worldBox.max.z : worldBox.min.z);
+        const glm::vec4 clip = m_cpuViewProj * glm::vec4(p, 1.0f);
+        // 跨过近平面, 保守认为可见
+        if (clip.w <= 1e-5f || clip.z < -clip.w)
+            return true;
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        ndcMin = glm::min(ndcMin, glm::vec2(ndc));
+        ndcMax = glm::max(ndcMax, glm::vec2(ndc));
+        nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+    }
+    // 完全在屏幕外的交给视锥剔除
+    if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f)
+        return true;
+
+    // 全分辨率像素范围
+    const glm::vec2 fullSize(m_cpuFullSize);
+    const glm::ivec2 pixelMin = glm::clamp(glm::ivec2(glm::floor((glm::clamp(ndcMin, -1.0f, 1.0f) * 0.5f + 0.5f) * fullSize)),
+                                           glm::ivec2(0), m_cpuFullSize - 1);
+    const glm::ivec2 pixelMax = glm::clamp(glm::ivec2(glm::floor((glm::clamp(ndcMax, -1.0f, 1.0f) * 0.5f + 0.5f) * fullSize)),
+                                           glm::ivec2(0), m_cpuFullSize - 1);
+
+    // 选择覆盖范围不超过2x2个texel的级别
+    int level = 0;
+    const auto texelOf = [&](const glm::ivec2 &pixel, int cpuLevel)
+    {
+        const int shift = m_cpuBaseLevel + cpuLevel;
+        return glm::min(glm::ivec2(pixel.x >> shift, pixel.y >> shift), m_cpuSizes[cpuLevel] - 1);
+    };
+    while (level + 1 < static_cast<int>(m_cpuLevels.size()))
+    {
+        const glm::ivec2 span = texelOf(pixelMax, level) - texelOf(pixelMin, level);
+        if (span.x <= 1 && span.y <= 1)
+            break;
+        ++level;
+    }
+
+    const glm::ivec2 texelMin = texelOf(pixelMin, level);
+    const glm::ivec2 texelMax = texelOf(pixelMax, level);
+    const std::vector<float> &depth = m_cpuLevels[level];
+    const int rowWidth = m_cpuSizes[level].x;
+    float occluderDepth = 0.0f;
+    for (int y = texelMin.y; y <= texelMax.y; ++y)
+        for (int x = texelMin.x; x <= texelMax.x; ++x)
+            occluderDepth = std::max(occluderDepth, depth[size_t(y) * rowWidth + x]);
+
+    return nearestDepth <= occluderDepth;
+}
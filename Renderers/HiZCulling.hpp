@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "../Shading/Shader.hpp"
+#include "../Shading/Texture.hpp"
+#include "../Math/Bounds.hpp"
+
+/*
+GPU Hi-Z 遮挡剔除
+构建: 计算着色器从GBuffer深度纹理生成 min/max 深度金字塔 (RG32F, 全部mip)
+测试: 金字塔中不超过 ReadbackMaxWidth 的第一级经PBO异步回读, 用fence判断完成, 不阻塞渲染线程.
+      CPU在回读级别上继续归约出剩余级别, 用生成该金字塔时的视图投影矩阵测试包围盒.
+      因此测试使用的是上一帧(或更早)的深度, 遮挡体突然移开时被遮挡物会晚一帧出现
+深度约定: OpenGL 默认 [0,1], 越大越远. 包围盒最近深度大于覆盖区域的最大深度即被遮挡
+*/
+class HiZCulling
+{
+public:
+    static constexpr int ReadbackMaxWidth = 256;
+
+    HiZCulling();
+    ~HiZCulling();
+    HiZCulling(const HiZCulling &) = delete;
+    HiZCulling &operator=(const HiZCulling &) = delete;
+
+    void reloadShaders();
+
+    /// @brief 由深度纹理构建金字塔, 并在上一次回读完成时发起新的回读
+    /// @param viewProj 渲染该深度时的视图投影矩阵
+    void build(GLuint depthTexture, int width, int height, const glm::mat4 &viewProj);
+
+    /// @brief 取回已完成的回读. 不等待GPU, 每帧剔除之前调用
+    void fetchReadback();
+
+    /// @brief 已有可用的回读数据
+    bool isReady() const { return m_ready; }
+
+    /// @brief 世界空间包围盒在回读的深度金字塔中是否可能可见
+    bool isVisible(const AABB &worldBox) const;
+
+    GLuint getPyramidTexture() const { return pyramid.ID; }
+    int getLevelCount() const { return m_levelCount; }
+    // GPU端金字塔对应最近一次 build, 比CPU回读新. 供计算着色器直接采样
+    bool hasPyramid() const { return m_levelCount > 0; }
+    const glm::mat4 &getPyramidViewProj() const { return m_pyramidViewProj; }
+    glm::ivec2 getPyramidSize() const { return glm::ivec2(m_width, m_height); }
+
+private:
+    ComputeShader buildShader = ComputeShader("Shaders/HiZ/hizBuild.comp");
+    Texture2D pyramid;
+    int m_width = 0;
+    int m_height = 0;
+    int m_levelCount = 0;
+    glm::mat4 m_pyramidViewProj = glm::mat4(1.0f);
+
+    // 进行中的回读
+    GLuint m_pbo = 0;
+    GLsync m_fence = nullptr;
+    int m_pendingLevel = 0;
+    glm::ivec2 m_pendingSize = glm::ivec2(0);
+    glm::ivec2 m_pendingBaseSize = glm::ivec2(0);
+    glm::mat4 m_pendingViewProj = glm::mat4(1.0f);
+
+    // CPU 端最大深度金字塔, 第0级对应GPU的 m_cpuBaseLevel 级
+    bool m_ready = false;
+    int m_cpuBaseLevel = 0;
+    glm::ivec2 m_cpuFullSize = glm::ivec2(0); // 构建时的全分辨率尺寸
+    glm::mat4 m_cpuViewProj = glm::mat4(1.0f);
+    std::vector<std::vector<float>> m_cpuLevels;
+    std::vector<glm::ivec2> m_cpuSizes;
+
+    void resize(int width, int height);
+    void buildCpuLevels();
+};
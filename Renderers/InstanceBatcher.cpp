@@ -0,0 +1,102 @@
+#include "InstanceBatcher.hpp"
+#include <algorithm>
+#include <limits>
+
+InstanceBatcher::InstanceBatcher()
+{
+    glGenBuffers(1, &m_instanceBuffer);
+}
+
+InstanceBatcher::~InstanceBatcher()
+{
+    glDeleteBuffers(1, &m_instanceBuffer);
+}
+
+void InstanceBatcher::draw(Scene &scene, const std::vector<uint32_t> &visible, Shader &instancedShaders, Shader &shaders, RenderQueue &queue)
+{
+    const DrawRangeCache &ranges = queue.getDrawRanges();
+
+    // 按范围分组. 哈希相同但范围不同(碰撞)的对象不参与实例化
+    m_groupOfHash.clear();
+    m_groups.clear();
+    m_groupOfVisible.assign(visible.size(), NoGroup);
+    for (size_t k = 0; k < visible.size(); ++k)
+    {
+        const uint32_t i = visible[k];
+        if (ranges.empty(i))
+            continue;
+        auto [it, inserted] = m_groupOfHash.try_emplace(ranges.hash(i), static_cast<uint32_t>(m_groups.size()));
+        if (inserted)
+            m_groups.push_back(Group{i, 0, 0, 0, std::numeric_limits<float>::max()});
+        else if (!ranges.sameRanges(m_groups[it->second].representative, i))
+            continue;
+        m_groups[it->second].memberCount++;
+        m_groupOfVisible[k] = it->second;
+    }
+
+    uint32_t instanceCount = 0;
+    for (Group &group : m_groups)
+    {
+        if (group.memberCount < MinInstances)
+            continue;
+        group.firstInstance = instanceCount;
+        instanceCount += group.memberCount;
+    }
+    m_instances.resize(instanceCount);
+    m_singles.clear();
+    for (size_t k = 0; k < visible.size(); ++k)
+    {
+        const uint32_t g = m_groupOfVisible[k];
+        if (g == NoGroup || m_groups[g].memberCount < MinInstances)
+        {
+            m_singles.push_back(visible[k]);
+            continue;
+        }
+        Group &group = m_groups[g];
+        InstanceData &instance = m_instances[group.firstInstance + group.filled++];
+        instance.model = scene.worldTransformAt(visible[k]);
+        instance.boundsMax.w = static_cast<float>(visible[k]);
+        group.lodErrorBudget = std::min(group.lodErrorBudget, queue.lodErrorBudget(visible[k]));
+    }
+
+    if (instanceCount > 0)
+    {
+        upload();
+        instancedShaders.use();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_instanceBuffer);
+        for (const Group &group : m_groups)
+        {
+            if (group.memberCount < MinInstances)
+                continue;
+            for (uint32_t r = ranges.begin(group.representative); r < ranges.end(group.representative); ++r)
+            {
+                const DrawRange &full = ranges.range(r);
+                const DrawRange range = RenderQueue::LodRange(full, RenderQueue::SelectLod(full, group.lodErrorBudget));
+                glBindVertexArray(queue.drawVao(range));
+                instancedShaders.setInt("materialId"_uniform, static_cast<int>(range.materialId));
+                glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), range.indexType,
+                                                              range.indexOffset(),
+                                                              static_cast<GLsizei>(group.memberCount), range.baseVertex, group.firstInstance);
+                m_stats.drawCalls++;
+            }
+            m_stats.groups++;
+            m_stats.instancedObjects += group.memberCount;
+        }
+        instancedShaders.setInt("materialId"_uniform, MaterialLibrary::DefaultMaterial);
+        glBindVertexArray(0);
+    }
+
+    queue.add(m_singles);
+    queue.submit(scene, shaders);
+    m_stats.singleObjects += m_singles.size();
+}
+
+void InstanceBatcher::upload()
+{
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
+    // 同一帧内多次调用(CSM 各级等)时重新分配存储, 避免等待上一次绘制读完
+    m_instanceCapacity = std::max(m_instanceCapacity, m_instances.size());
+    glBufferData(GL_SHADER_STORAGE_BUFFER, m_instanceCapacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_instances.size() * sizeof(InstanceData), m_instances.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../Shading/Shader.hpp"
+#include "../Objects/Scene.hpp"
+#include "RenderQueue.hpp"
+
+/*
+自动实例化: 绘制范围(DrawRange)完全相同的可见对象合并为实例化绘制
+几何体在 GeometryBuffer 中按内容合并, 相同参数创建的 Sphere/Cube 等以及同一模型的多个副本范围相同.
+每帧把各组对象的世界矩阵写入实例SSBO(布局同 GPUDrivenCulling 的 DrawObject), 每组每个范围一次
+glDrawElementsInstancedBaseVertexBaseInstance, 顶点着色器以 gl_BaseInstance + gl_InstanceID 读取世界矩阵
+只出现一次的对象和没有 DrawRange 的对象交给 RenderQueue 排序后绘制
+*/
+class InstanceBatcher
+{
+public:
+    // 少于此数的组逐对象绘制
+    static constexpr size_t MinInstances = 2;
+
+    struct Stats
+    {
+        size_t groups = 0;           // 实例化绘制的组数
+        size_t instancedObjects = 0; // 以实例化绘制的对象数
+        size_t singleObjects = 0;    // 逐对象绘制的对象数
+        size_t drawCalls = 0;        // 实例化绘制调用数
+    };
+
+    InstanceBatcher();
+    ~InstanceBatcher();
+    InstanceBatcher(const InstanceBatcher &) = delete;
+    InstanceBatcher &operator=(const InstanceBatcher &) = delete;
+
+    /// @brief 绘制 visible 中的对象. 先用 instancedShaders 绘制实例组, 再经 queue 用 shaders 绘制其余对象
+    ///        两个着色器的视图相关 uniform 需由调用方提前设置
+    /// @param visible 稠密下标, 通常来自 Renderer::CollectVisible
+    /// @param queue 已调用 begin, 分组使用它缓存的 DrawRange
+    void draw(Scene &scene, const std::vector<uint32_t> &visible, Shader &instancedShaders, Shader &shaders, RenderQueue &queue);
+
+    /// @brief 自上次 resetStats 以来的累计值, 一个pass可能调用多次 draw
+    const Stats &getStats() const { return m_stats; }
+    void resetStats() { m_stats = Stats{}; }
+
+private:
+    static constexpr uint32_t NoGroup = ~uint32_t(0);
+
+    // 与 Shaders/GPUDriven/drawObject.glsl 布局一致, 包围盒不使用
+    struct InstanceData
+    {
+        glm::mat4 model;
+        glm::vec4 boundsMin;
+        glm::vec4 boundsMax; // 只使用 w: 对象的稠密下标, 写入GBuffer对象ID
+    };
+    static_assert(sizeof(InstanceData) == 96, "InstanceData must match std430 layout");
+
+    struct Group
+    {
+        uint32_t representative; // 整组按该对象的范围绘制
+        uint32_t memberCount;
+        uint32_t firstInstance;
+        uint32_t filled;
+        float lodErrorBudget; // 成员中最小的LOD误差预算, 整组共用一个层级
+    };
+
+    GLuint m_instanceBuffer = 0;
+    size_t m_instanceCapacity = 0;
+
+    // 每帧的临时数据
+    std::unordered_map<uint64_t, uint32_t> m_groupOfHash;
+    std::vector<Group> m_groups;
+    std::vector<uint32_t> m_groupOfVisible; // 与 visible 对应, NoGroup 表示未分组
+    std::vector<InstanceData> m_instances;
+    std::vector<uint32_t> m_singles;
+    Stats m_stats;
+
+    void upload();
+};
@@ -0,0 +1,487 @@
+#include "MaskedOcclusionCulling.hpp"
+#include <bit>
+#include <cmath>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOC_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define MOC_USE_SSE 0
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    constexpr uint32_t FullRow = 0xFFFFFFFFu;
+    constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+    // [begin, end) 位为1的行掩码, begin/end 已限制在 [0, 32]
+    uint32_t RowMask(int begin, int end)
+    {
+        if (end <= begin)
+            return 0;
+        const uint64_t bits = ((uint64_t(1) << end) - 1) & ~((uint64_t(1) << begin) - 1);
+        return static_cast<uint32_t>(bits);
+    }
+
+    // 边函数 a*x + b*y + c, 三角形内部 >= 0
+    struct Edge
+    {
+        float a, b, c;
+    };
+}
+
+MaskedOcclusionCulling::MaskedOcclusionCulling(int width, int height, unsigned workerCount)
+{
+    if (workerCount == 0)
+    {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        workerCount = hardware > 1 ? hardware - 1 : 1;
+    }
+    m_workerCount = workerCount;
+    resize(width, height);
+    for (unsigned i = 1; i < m_workerCount; ++i)
+        m_threads.emplace_back(&MaskedOcclusionCulling::workerLoop, this);
+}
+
+MaskedOcclusionCulling::~MaskedOcclusionCulling()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_stopping = true;
+    }
+    m_jobReady.notify_all();
+    for (auto &thread : m_threads)
+        thread.join();
+}
+
+void MaskedOcclusionCulling::runJobs(size_t jobCount, const std::function<void(size_t)> &job)
+{
+    if (m_threads.empty() || jobCount <= 1)
+    {
+        for (size_t i = 0; i < jobCount; ++i)
+            job(i);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_job = &job;
+        m_jobCount = jobCount;
+        m_nextJob.store(0);
+        m_jobGeneration++;
+    }
+    m_jobReady.notify_all();
+    for (size_t i = m_nextJob.fetch_add(1); i < jobCount; i = m_nextJob.fetch_add(1))
+        job(i);
+
+    // 已领取任务的工作线程全部完成后才清空, 之后醒来的线程看到没有任务直接继续等待
+    std::unique_lock<std::mutex> lock(m_jobMutex);
+    m_jobDone.wait(lock, [this] { return m_busyWorkers == 0; });
+    m_job = nullptr;
+}
+
+void MaskedOcclusionCulling::workerLoop()
+{
+    uint64_t generation = 0;
+    while (true)
+    {
+        const std::function<void(size_t)> *job = nullptr;
+        size_t jobCount = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobReady.wait(lock, [&] { return m_stopping || m_jobGeneration != generation; });
+            if (m_stopping)
+                return;
+            generation = m_jobGeneration;
+            if (!m_job)
+                continue;
+            job = m_job;
+            jobCount = m_jobCount;
+            m_busyWorkers++;
+        }
+        for (size_t i = m_nextJob.fetch_add(1); i < jobCount; i = m_nextJob.fetch_add(1))
+            (*job)(i);
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            if (--m_busyWorkers == 0)
+                m_jobDone.notify_one();
+        }
+    }
+}
+
+void MaskedOcclusionCulling::resize(int width, int height)
+{
+    m_tilesX = std::max(1, (width + TileWidth - 1) / TileWidth);
+    m_tilesY = std::max(1, (height + TileHeight - 1) / TileHeight);
+    m_width = m_tilesX * TileWidth;
+    m_height = m_tilesY * TileHeight;
+    m_tiles.assign(size_t(m_tilesX) * m_tilesY, Tile{});
+}
+
+void MaskedOcclusionCulling::beginFrame(const glm::mat4 &viewProj)
+{
+    m_viewProj = viewProj;
+    for (auto &tile : m_tiles)
+    {
+        std::fill(std::begin(tile.mask), std::end(tile.mask), 0u);
+        tile.zMin0 = 0.0f;
+        tile.zMin1 = 0.0f;
+    }
+    m_triangles.clear();
+    m_stats = Stats{};
+}
+
+void MaskedOcclusionCulling::addOccluder(const float *positions, size_t stride, size_t vertexCount,
+                                         const uint32_t *indices, size_t indexCount, const glm::mat4 &model)
+{
+    if (positions == nullptr || vertexCount == 0)
+        return;
+
+    const glm::mat4 mvp = m_viewProj * model;
+    const auto *bytes = reinterpret_cast<const uint8_t *>(positions);
+    if (m_clip.size() < vertexCount)
+        m_clip.resize(vertexCount);
+    glm::vec4 *clip = m_clip.data();
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const auto &p = *reinterpret_cast<const glm::vec3 *>(bytes + i * stride);
+        clip[i] = mvp * glm::vec4(p, 1.0f);
+    }
+
+    const size_t triangleCount = indices ? indexCount / 3 : vertexCount / 3;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        uint32_t id[3];
+        for (int k = 0; k < 3; ++k)
+            id[k] = indices ? indices[t * 3 + k] : uint32_t(t * 3 + k);
+        if (id[0] >= vertexCount || id[1] >= vertexCount || id[2] >= vertexCount)
+            continue;
+
+        // 只裁剪近平面 (z >= -w), 其余方向在屏幕空间按 tile 范围截断
+        glm::vec4 input[3] = {clip[id[0]], clip[id[1]], clip[id[2]]};
+        glm::vec4 output[4];
+        int outputCount = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const glm::vec4 &a = input[k];
+            const glm::vec4 &b = input[(k + 1) % 3];
+            const float da = a.z + a.w;
+            const float db = b.z + b.w;
+            if (da >= 0.0f)
+                output[outputCount++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+                output[outputCount++] = a + (b - a) * (da / (da - db));
+        }
+        for (int k = 1; k + 1 < outputCount; ++k)
+            addClippedTriangle(output[0], output[k], output[k + 1]);
+    }
+}
+
+void MaskedOcclusionCulling::addClippedTriangle(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c)
+{
+    ScreenTriangle triangle;
+    const glm::vec4 *clip[3] = {&a, &b, &c};
+    for (int k = 0; k < 3; ++k)
+    {
+        const glm::vec4 &p = *clip[k];
+        if (p.w <= 0.0f)
+            return;
+        const float invW = 1.0f / p.w;
+        triangle.v[k] = glm::vec3((p.x * invW * 0.5f + 0.5f) * m_width,
+                                  (p.y * invW * 0.5f + 0.5f) * m_height,
+                                  invW);
+    }
+
+    const glm::vec3 &v0 = triangle.v[0];
+    const glm::vec3 &v1 = triangle.v[1];
+    const glm::vec3 &v2 = triangle.v[2];
+    const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    if (!(std::abs(area) > 1e-6f))
+        return;
+
+    const float minX = std::min({v0.x, v1.x, v2.x});
+    const float maxX = std::max({v0.x, v1.x, v2.x});
+    const float minY = std::min({v0.y, v1.y, v2.y});
+    const float maxY = std::max({v0.y, v1.y, v2.y});
+    if (maxX < 0.0f || maxY < 0.0f || minX >= float(m_width) || minY >= float(m_height))
+        return;
+
+    // 先在浮点下截断到缓冲范围, 近平面附近的坐标可能超出 int 范围
+    triangle.tileMinX = int(std::max(minX, 0.0f)) / TileWidth;
+    triangle.tileMaxX = int(std::min(maxX, float(m_width - 1))) / TileWidth;
+    triangle.tileMinY = int(std::max(minY, 0.0f)) / TileHeight;
+    triangle.tileMaxY = int(std::min(maxY, float(m_height - 1))) / TileHeight;
+    m_triangles.push_back(triangle);
+}
+
+void MaskedOcclusionCulling::rasterize()
+{
+    const auto start = Clock::now();
+    m_stats.occluderTriangles = m_triangles.size();
+    if (m_triangles.empty())
+        return;
+
+    // 按 tile 行分带, 每个线程独占若干行 tile
+    const int workers = std::max(1, std::min(int(m_workerCount), m_tilesY));
+    const int rowsPerBand = (m_tilesY + workers - 1) / workers;
+    runJobs(size_t((m_tilesY + rowsPerBand - 1) / rowsPerBand), [&](size_t band)
+            {
+                const int row = int(band) * rowsPerBand;
+                rasterizeBand(row, std::min(m_tilesY, row + rowsPerBand));
+            });
+    m_stats.rasterizeMs = ElapsedMs(start);
+}
+
+void MaskedOcclusionCulling::rasterizeBand(int tileRowBegin, int tileRowEnd)
+{
+    for (const auto &triangle : m_triangles)
+    {
+        if (triangle.tileMaxY < tileRowBegin || triangle.tileMinY >= tileRowEnd)
+            continue;
+        rasterizeTriangle(triangle, tileRowBegin, tileRowEnd);
+    }
+}
+
+void MaskedOcclusionCulling::rasterizeTriangle(const ScreenTriangle &triangle, int tileRowBegin, int tileRowEnd)
+{
+    const glm::vec3 &v0 = triangle.v[0];
+    const glm::vec3 &v1 = triangle.v[1];
+    const glm::vec3 &v2 = triangle.v[2];
+    const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    const float orientation = area > 0.0f ? 1.0f : -1.0f;
+
+    Edge edges[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        const glm::vec3 &p = triangle.v[k];
+        const glm::vec3 &q = triangle.v[(k + 1) % 3];
+        // 逆时针时内部在边的左侧
+        edges[k].a = (p.y - q.y) * orientation;
+        edges[k].b = (q.x - p.x) * orientation;
+        edges[k].c = -(edges[k].a * p.x + edges[k].b * p.y);
+    }
+
+    // 深度平面 z = z0 + dzdx * (x - x0) + dzdy * (y - y0)
+    const float invArea = 1.0f / area;
+    const float dzdx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) * invArea;
+    const float dzdy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) * invArea;
+    const float zVertexMin = std::min({v0.z, v1.z, v2.z});
+    const float triMinX = std::min({v0.x, v1.x, v2.x});
+    const float triMaxX = std::max({v0.x, v1.x, v2.x});
+    const float triMinY = std::min({v0.y, v1.y, v2.y});
+    const float triMaxY = std::max({v0.y, v1.y, v2.y});
+
+    const int rowBegin = std::max(triangle.tileMinY, tileRowBegin);
+    const int rowEnd = std::min(triangle.tileMaxY + 1, tileRowEnd);
+    for (int ty = rowBegin; ty < rowEnd; ++ty)
+    {
+        const float tileY0 = float(ty * TileHeight);
+
+        // 8行像素中心处每条边给出的 x 上下界, 与列无关, 每个 tile 行只算一次
+        alignas(16) float left[TileHeight];
+        alignas(16) float right[TileHeight];
+#if MOC_USE_SSE
+        __m128 leftV[2] = {_mm_set1_ps(-Infinity), _mm_set1_ps(-Infinity)};
+        __m128 rightV[2] = {_mm_set1_ps(Infinity), _mm_set1_ps(Infinity)};
+        const __m128 rowY[2] = {
+            _mm_setr_ps(tileY0 + 0.5f, tileY0 + 1.5f, tileY0 + 2.5f, tileY0 + 3.5f),
+            _mm_setr_ps(tileY0 + 4.5f, tileY0 + 5.5f, tileY0 + 6.5f, tileY0 + 7.5f)};
+        for (const Edge &edge : edges)
+        {
+            for (int half = 0; half < 2; ++half)
+            {
+                // by + c
+                const __m128 offset = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edge.b), rowY[half]), _mm_set1_ps(edge.c));
+                if (edge.a > 0.0f)
+                {
+                    const __m128 x = _mm_mul_ps(offset, _mm_set1_ps(-1.0f / edge.a));
+                    leftV[half] = _mm_max_ps(leftV[half], x);
+                }
+                else if (edge.a < 0.0f)
+                {
+                    const __m128 x = _mm_mul_ps(offset, _mm_set1_ps(-1.0f / edge.a));
+                    rightV[half] = _mm_min_ps(rightV[half], x);
+                }
+                else
+                {
+                    // 水平边: 整行在外侧时令区间为空
+                    const __m128 outside = _mm_cmplt_ps(offset, _mm_setzero_ps());
+                    leftV[half] = _mm_or_ps(_mm_andnot_ps(outside, leftV[half]), _mm_and_ps(outside, _mm_set1_ps(Infinity)));
+                }
+            }
+        }
+        _mm_store_ps(left, leftV[0]);
+        _mm_store_ps(left + 4, leftV[1]);
+        _mm_store_ps(right, rightV[0]);
+        _mm_store_ps(right + 4, rightV[1]);
+#else
+        for (int row = 0; row < TileHeight; ++row)
+        {
+            const float y = tileY0 + float(row) + 0.5f;
+            left[row] = -Infinity;
+            right[row] = Infinity;
+            for (const Edge &edge : edges)
+            {
+                const float offset = edge.b * y + edge.c;
+                if (edge.a > 0.0f)
+                    left[row] = std::max(left[row], -offset / edge.a);
+                else if (edge.a < 0.0f)
+                    right[row] = std::min(right[row], -offset / edge.a);
+                else if (offset < 0.0f)
+                    left[row] = Infinity;
+            }
+        }
+#endif
+
+        const float rectMinY = std::max(tileY0, triMinY);
+        const float rectMaxY = std::min(tileY0 + float(TileHeight), triMaxY);
+        for (int tx = triangle.tileMinX; tx <= triangle.tileMaxX; ++tx)
+        {
+            const float tileX0 = float(tx * TileWidth);
+            uint32_t coverage[TileHeight];
+            uint32_t any = 0;
+            for (int row = 0; row < TileHeight; ++row)
+            {
+                // 像素中心 tileX0 + i + 0.5 落在 [left, right] 内
+                const float first = std::ceil(std::clamp(left[row] - tileX0 - 0.5f, 0.0f, float(TileWidth)));
+                const float last = std::floor(std::clamp(right[row] - tileX0 - 0.5f, -1.0f, float(TileWidth - 1)));
+                coverage[row] = RowMask(int(first), int(last) + 1);
+                any |= coverage[row];
+            }
+            if (any == 0)
+                continue;
+
+            // 三角形在 tile 内的保守最小深度: 平面在 (tile ∩ 三角形包围盒) 四角的最小值, 不低于顶点最小深度
+            const float rectMinX = std::max(tileX0, triMinX);
+            const float rectMaxX = std::min(tileX0 + float(TileWidth), triMaxX);
+            const float zAtMin = v0.z + dzdx * (rectMinX - v0.x) + dzdy * (rectMinY - v0.y);
+            const float zPlaneMin = zAtMin + std::min(0.0f, dzdx * (rectMaxX - rectMinX)) + std::min(0.0f, dzdy * (rectMaxY - rectMinY));
+            const float zTriangle = std::max(zPlaneMin, zVertexMin);
+
+            updateTile(m_tiles[size_t(ty) * m_tilesX + tx], coverage, zTriangle);
+        }
+    }
+}
+
+void MaskedOcclusionCulling::updateTile(Tile &tile, const uint32_t coverage[TileHeight], float zTriangle)
+{
+    // 比已保证的深度还远, 没有新信息
+    if (zTriangle <= tile.zMin0)
+        return;
+
+    bool coversTile = true;
+    bool layerEmpty = true;
+    for (int row = 0; row < TileHeight; ++row)
+    {
+        coversTile &= coverage[row] == FullRow;
+        layerEmpty &= tile.mask[row] == 0;
+    }
+
+    if (coversTile)
+    {
+        // 单个三角形覆盖整个 tile: 直接抬高底层, 工作层不比它近时丢弃
+        tile.zMin0 = zTriangle;
+        if (tile.zMin1 <= zTriangle)
+        {
+            std::fill(std::begin(tile.mask), std::end(tile.mask), 0u);
+            tile.zMin1 = 0.0f;
+        }
+        return;
+    }
+
+    // 并入工作层, 深度取较远者以保持保守
+    tile.zMin1 = layerEmpty ? zTriangle : std::min(tile.zMin1, zTriangle);
+    bool layerFull = true;
+    for (int row = 0; row < TileHeight; ++row)
+    {
+        tile.mask[row] |= coverage[row];
+        layerFull &= tile.mask[row] == FullRow;
+    }
+    if (layerFull)
+    {
+        tile.zMin0 = tile.zMin1;
+        std::fill(std::begin(tile.mask), std::end(tile.mask), 0u);
+        tile.zMin1 = 0.0f;
+    }
+}
+
+bool MaskedOcclusionCulling::isVisible(const AABB &worldBox) const
+{
+    if (!worldBox.isValid())
+        return true;
+
+    float minX = Infinity, minY = Infinity;
+    float maxX = -Infinity, maxY = -Infinity;
+    float zNearest = 0.0f;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        const glm::vec3 p((corner & 1) ? worldBox.max.x : worldBox.min.x,
+                          (corner & 2) ? worldBox.max.y : worldBox.min.y,
+                          (corner & 4) ? worldBox.max.z : worldBox.min.z);
+        const glm::vec4 clip = m_viewProj * glm::vec4(p, 1.0f);
+        // 包围盒跨过近平面, 保守认为可见
+        if (clip.w <= 1e-5f || clip.z < -clip.w)
+            return true;
+        const float invW = 1.0f / clip.w;
+        const float sx = (clip.x * invW * 0.5f + 0.5f) * m_width;
+        const float sy = (clip.y * invW * 0.5f + 0.5f) * m_height;
+        minX = std::min(minX, sx);
+        maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy);
+        maxY = std::max(maxY, sy);
+        zNearest = std::max(zNearest, invW);
+    }
+
+    // 覆盖的像素范围 [x0, x1) x [y0, y1)
+    const int x0 = int(std::floor(std::clamp(minX, 0.0f, float(m_width))));
+    const int x1 = int(std::ceil(std::clamp(maxX, -1.0f, float(m_width - 1)))) + 1;
+    const int y0 = int(std::floor(std::clamp(minY, 0.0f, float(m_height))));
+    const int y1 = int(std::ceil(std::clamp(maxY, -1.0f, float(m_height - 1)))) + 1;
+    if (x0 >= x1 || y0 >= y1)
+        return false;
+
+    for (int ty = y0 / TileHeight; ty <= (y1 - 1) / TileHeight; ++ty)
+    {
+        const int rowBegin = std::max(y0 - ty * TileHeight, 0);
+        const int rowEnd = std::min(y1 - ty * TileHeight, TileHeight);
+        for (int tx = x0 / TileWidth; tx <= (x1 - 1) / TileWidth; ++tx)
+        {
+            const Tile &tile = m_tiles[size_t(ty) * m_tilesX + tx];
+            const uint32_t bits = RowMask(std::max(x0 - tx * TileWidth, 0), std::min(x1 - tx * TileWidth, TileWidth));
+
+            // 矩形内像素全在工作层中时可用两层中较近的深度
+            bool insideLayer = tile.zMin1 > tile.zMin0;
+            for (int row = rowBegin; row < rowEnd && insideLayer; ++row)
+                insideLayer = (tile.mask[row] & bits) == bits;
+            const float occluderDepth = insideLayer ? tile.zMin1 : tile.zMin0;
+
+            if (zNearest >= occluderDepth)
+                return true;
+        }
+    }
+    return false;
+}
+
+void MaskedOcclusionCulling::exportDepth(std::vector<float> &out) const
+{
+    out.assign(size_t(m_width) * m_height, 0.0f);
+    for (int ty = 0; ty < m_tilesY; ++ty)
+    {
+        for (int tx = 0; tx < m_tilesX; ++tx)
+        {
+            const Tile &tile = m_tiles[size_t(ty) * m_tilesX + tx];
+            for (int row = 0; row < TileHeight; ++row)
+            {
+                float *line = out.data() + size_t(ty * TileHeight + row) * m_width + tx * TileWidth;
+                for (int i = 0; i < TileWidth; ++i)
+                    line[i] = (tile.mask[row] >> i) & 1u ? std::max(tile.zMin0, tile.zMin1) : tile.zMin0;
+            }
+        }
+    }
+}
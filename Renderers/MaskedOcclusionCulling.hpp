@@ -0,0 +1,166 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../Math/Bounds.hpp"
+
+/*
+CPU 软件遮挡剔除 (Masked Occlusion Culling 思路)
+不依赖OpenGL, 可在无窗口环境下单独测试
+
+深度: 存 1/w, 值越大越近. 每个 32x8 像素 tile 存两层保守深度:
+  zMin0 : tile 内所有像素的遮挡体深度 >= zMin0
+  zMin1 + mask : mask 中的像素深度 >= zMin1 (工作层)
+  mask 填满时工作层并入 zMin0. 每行像素覆盖用一个32位掩码表示
+光栅化: 遮挡体三角形先在调用线程变换/近平面裁剪, 再按 tile 行分带交给工作线程, 各线程只写自己的带, 无需加锁
+工作线程在构造时创建并常驻, 每帧的光栅化与测试只唤醒它们, 调用线程也参与执行
+测试: 包围盒投影为屏幕矩形与最近深度, 逐 tile 与保守深度比较
+*/
+class MaskedOcclusionCulling
+{
+public:
+    static constexpr int TileWidth = 32;
+    static constexpr int TileHeight = 8;
+
+    struct Stats
+    {
+        size_t occluderTriangles = 0; // 裁剪后进入光栅化的三角形数
+        double rasterizeMs = 0.0;
+        double testMs = 0.0;
+        size_t tested = 0;
+        size_t occluded = 0;
+    };
+
+    /// @param width,height 遮挡缓冲分辨率, 会向上取整到 tile 大小
+    /// @param workerCount 并行执行的线程数(含调用线程), 0 表示按硬件线程数
+    MaskedOcclusionCulling(int width = 320, int height = 192, unsigned workerCount = 0);
+    ~MaskedOcclusionCulling();
+    MaskedOcclusionCulling(const MaskedOcclusionCulling &) = delete;
+    MaskedOcclusionCulling &operator=(const MaskedOcclusionCulling &) = delete;
+
+    void resize(int width, int height);
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    /// @brief 清空缓冲与三角形队列, 设置本帧视图投影矩阵
+    void beginFrame(const glm::mat4 &viewProj);
+
+    /// @brief 提交遮挡体三角形
+    /// @param positions 顶点position首地址(3个float)
+    /// @param stride 相邻顶点position之间的字节数
+    /// @param indices 三角形索引, 为空时按顶点顺序每3个组成三角形
+    /// @param model 模型矩阵
+    void addOccluder(const float *positions, size_t stride, size_t vertexCount,
+                     const uint32_t *indices, size_t indexCount, const glm::mat4 &model);
+
+    /// @brief 多线程光栅化本帧提交的遮挡体
+    void rasterize();
+
+    /// @brief 世界空间包围盒是否可能可见. 需在 rasterize 之后调用, 线程安全
+    bool isVisible(const AABB &worldBox) const;
+
+    /// @brief 多线程测试 indices 中的对象, 移除被遮挡的项并保持原有顺序
+    /// @param boxOf 下标 -> 世界空间包围盒
+    /// @return 被遮挡的数量
+    template <typename BoxFn>
+    size_t filterVisible(std::vector<uint32_t> &indices, BoxFn &&boxOf);
+
+    const Stats &getStats() const { return m_stats; }
+
+    /// @brief 导出 zMin0 为灰度图, 用于调试显示 (行优先, 自下而上)
+    void exportDepth(std::vector<float> &out) const;
+
+private:
+    struct Tile
+    {
+        uint32_t mask[TileHeight];
+        float zMin0;
+        float zMin1;
+    };
+    // 屏幕空间三角形, xy 为像素坐标, z 为 1/w
+    struct ScreenTriangle
+    {
+        glm::vec3 v[3];
+        int tileMinX, tileMaxX, tileMinY, tileMaxY;
+    };
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_tilesX = 0;
+    int m_tilesY = 0;
+    unsigned m_workerCount = 1;
+    glm::mat4 m_viewProj = glm::mat4(1.0f);
+    std::vector<Tile> m_tiles;
+    std::vector<ScreenTriangle> m_triangles;
+    std::vector<glm::vec4> m_clip; // addOccluder 中裁剪空间顶点的临时数据, 跨调用复用
+    Stats m_stats;
+
+    // 常驻工作线程, 共 m_workerCount - 1 个. m_job 为空时没有任务
+    std::vector<std::thread> m_threads;
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobReady;
+    std::condition_variable m_jobDone;
+    const std::function<void(size_t)> *m_job = nullptr;
+    size_t m_jobCount = 0;
+    std::atomic<size_t> m_nextJob{0};
+    size_t m_busyWorkers = 0;
+    uint64_t m_jobGeneration = 0;
+    bool m_stopping = false;
+
+    /// @brief 在工作线程与调用线程上执行 job(0) .. job(jobCount - 1), 全部完成后返回
+    void runJobs(size_t jobCount, const std::function<void(size_t)> &job);
+    void workerLoop();
+
+    void addClippedTriangle(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c);
+    void rasterizeBand(int tileRowBegin, int tileRowEnd);
+    void rasterizeTriangle(const ScreenTriangle &triangle, int tileRowBegin, int tileRowEnd);
+    void updateTile(Tile &tile, const uint32_t coverage[TileHeight], float zTriangle);
+};
+
+template <typename BoxFn>
+size_t MaskedOcclusionCulling::filterVisible(std::vector<uint32_t> &indices, BoxFn &&boxOf)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> visible(indices.size(), 1);
+    // 对象较少时不值得分线程
+    constexpr size_t MinChunk = 256;
+    const size_t workers = std::max<size_t>(1, std::min<size_t>(m_workerCount, indices.size() / MinChunk));
+    const size_t chunk = (indices.size() + workers - 1) / workers;
+    const auto testRange = [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            visible[i] = isVisible(boxOf(indices[i])) ? 1 : 0;
+    };
+    if (workers == 1)
+    {
+        testRange(0, indices.size());
+    }
+    else
+    {
+        runJobs((indices.size() + chunk - 1) / chunk, [&](size_t job)
+                { testRange(job * chunk, std::min(indices.size(), (job + 1) * chunk)); });
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        if (visible[i])
+            indices[kept++] = indices[i];
+    }
+    const size_t occluded = indices.size() - kept;
+    indices.resize(kept);
+
+    m_stats.tested += visible.size();
+    m_stats.occluded += occluded;
+    m_stats.testMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return occluded;
+}
@@ -0,0 +1,60 @@
+#include "ObjectPicker.hpp"
+
+ObjectPicker::ObjectPicker()
+{
+    glGenBuffers(1, &m_pbo);
+}
+
+ObjectPicker::~ObjectPicker()
+{
+    if (m_fence)
+        glDeleteSync(m_fence);
+    glDeleteBuffers(1, &m_pbo);
+}
+
+void ObjectPicker::request(GLenum attachment, const glm::ivec2 &pixel, uint64_t sceneVersion)
+{
+    if (m_fence)
+        glDeleteSync(m_fence);
+
+    // 重新指定存储, 不等待被放弃的那次回读
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(GLuint), nullptr, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadBuffer(attachment);
+    glReadPixels(pixel.x, pixel.y, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_pendingVersion = sceneVersion;
+    m_pendingFrames = 0;
+}
+
+bool ObjectPicker::fetch(const Scene &scene, SceneHandle &handle)
+{
+    if (!m_fence)
+        return false;
+    ++m_pendingFrames;
+    const GLenum status = glClientWaitSync(m_fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        return false;
+    glDeleteSync(m_fence);
+    m_fence = nullptr;
+
+    GLuint id = 0;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo);
+    const void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(GLuint), GL_MAP_READ_BIT);
+    if (data)
+    {
+        id = *static_cast<const GLuint *>(data);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_lastLatencyFrames = m_pendingFrames;
+    if (!data || m_pendingVersion != scene.structureVersion())
+        return false;
+
+    handle = (id > 0 && id <= scene.size()) ? scene.handleAt(id - 1) : SceneHandle{};
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+
+#include "../Objects/Scene.hpp"
+
+/*
+GPU对象ID拾取
+GBuffer的对象ID附件(R32UI)中每个像素为最前面对象的稠密下标 + 1, 0 表示没有场景对象(背景, 地形)
+请求时把一个texel读入PBO并插入fence, 之后每帧检查fence, 完成后才映射读取, 渲染线程不等待GPU
+拾取的代价是一个texel的回读, 与对象数和网格复杂度无关. 结果晚一到两帧, 期间场景结构变化(稠密下标重排)时丢弃
+*/
+class ObjectPicker
+{
+public:
+    ObjectPicker();
+    ~ObjectPicker();
+    ObjectPicker(const ObjectPicker &) = delete;
+    ObjectPicker &operator=(const ObjectPicker &) = delete;
+
+    /// @brief 从当前绑定FBO的 attachment 回读 pixel 处的对象ID. 未完成的上一次请求被放弃
+    /// @param sceneVersion 渲染该附件时的 Scene::structureVersion
+    void request(GLenum attachment, const glm::ivec2 &pixel, uint64_t sceneVersion);
+
+    /// @brief 取回已完成的回读, 不等待GPU. 每帧调用一次
+    /// @return true 时 handle 为拾取结果, 无效表示该像素没有场景对象
+    bool fetch(const Scene &scene, SceneHandle &handle);
+
+    bool isPending() const { return m_fence != nullptr; }
+    /// @brief 最近一次结果从请求到取回经过的帧数
+    uint32_t getLastLatencyFrames() const { return m_lastLatencyFrames; }
+
+private:
+    GLuint m_pbo = 0;
+    GLsync m_fence = nullptr;
+    uint64_t m_pendingVersion = 0;
+    uint32_t m_pendingFrames = 0;
+    uint32_t m_lastLatencyFrames = 0;
+};
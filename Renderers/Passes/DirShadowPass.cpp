@@ -4,8 +4,11 @@
 #include "../../Objects/FrustumWireframe.hpp"
 #include "../DebugObjectRenderer.hpp"
 #include "../../Utils/Random.hpp"
+#include "../../Objects/Terrain.hpp"
 DirShadowPass::DirShadowPass(std::string _vs_path, std::string _fs_path)
-    : Pass(0, 0, _vs_path, _fs_path)
+    : Pass(0, 0, _vs_path, _fs_path),
+      indirectShaders(Shader("Shaders/ShadowDepthTexture/dirShadowIndirect.vs", _fs_path.c_str())),
+      terrainShaders(Shader("Shaders/Terrain/terrain_depth.vs", _fs_path.c_str()))
 {
     initializeGLResources();
     contextSetup();
@@ -25,6 +28,13 @@ void DirShadowPass::resize(int _width, int _height)
 {
     // void 此处应该是缩放阴影贴图大小
 }
+
+void DirShadowPass::reloadCurrentShaders()
+{
+    Pass::reloadCurrentShaders();
+    indirectShaders = Shader("Shaders/ShadowDepthTexture/dirShadowIndirect.vs", fs_path.c_str());
+    terrainShaders = Shader("Shaders/Terrain/terrain_depth.vs", fs_path.c_str());
+}
 /// @brief 将输入的深度图attach到FBO
 /// @param _depthMap 通道输出纹理对象
 void DirShadowPass::attachDepthMap(const unsigned int _depthMap)
@@ -36,11 +46,70 @@ void DirShadowPass::attachDepthMap(const unsigned int _depthMap)
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+SceneCulling DirShadowPass::receiverCulling(const glm::mat4 &lightSpaceMatrix, const Scene &scene)
+{
+    SceneCulling culling;
+    if (visibleReceivers)
+    {
+        receiverMask.build(lightSpaceMatrix, scene, *visibleReceivers);
+        for (const AABB &box : Terrain::Get().getReceiverBounds())
+            receiverMask.addReceiver(box);
+        culling.receivers = &receiverMask;
+    }
+    return culling;
+}
+
+/// @brief 计算着色器剔除光源视锥并间接绘制. 未启用或本帧视图已用尽时返回 false
+bool DirShadowPass::renderGPUDriven(const GPUDrivenCulling::CullView &cullView, const glm::mat4 &lightSpaceMatrix, Scene &scene)
+{
+    if (!gpuCulling)
+        return false;
+    const int view = gpuCulling->cull(cullView);
+    if (view < 0)
+        return false;
+
+    indirectShaders.use();
+    indirectShaders.setMat4("lightSpaceMatrix", lightSpaceMatrix);
+    gpuCulling->draw(view, indirectShaders, positionOnly);
+
+    shaders.use();
+    Renderer::DrawScene(scene, shaders, gpuCulling->getFallbackIndices());
+    return true;
+}
+
+/// @brief CPU剔除路径. 开启实例化时几何相同的投射体合并绘制, 其余经渲染队列排序提交
+void DirShadowPass::renderCulled(const FrustumPlanes &frustumPlanes, const glm::mat4 &lightSpaceMatrix, int resolution, Scene &scene)
+{
+    const SceneCulling culling = receiverCulling(lightSpaceMatrix, scene);
+    cullingStats += Renderer::CollectVisible(scene, frustumPlanes, culling, visibleIndices);
+    renderQueue.setLodSelection(static_cast<float>(resolution), lodPixelError);
+    renderQueue.begin(scene, lightSpaceMatrix);
+    if (!useInstancing)
+    {
+        renderQueue.add(visibleIndices);
+        renderQueue.submit(scene, shaders);
+        return;
+    }
+    indirectShaders.use();
+    indirectShaders.setMat4("lightSpaceMatrix", lightSpaceMatrix);
+    instancing.draw(scene, visibleIndices, indirectShaders, shaders, renderQueue);
+}
+
+/// @brief 地形节点按光源视锥选择, LOD仍按主相机距离, 与相机视图的几何一致
+void DirShadowPass::renderTerrain(const FrustumPlanes &frustumPlanes, const glm::mat4 &lightSpaceMatrix)
+{
+    Terrain &terrain = Terrain::Get();
+    if (!terrain.isVisible())
+        return;
+    terrainShaders.use();
+    terrainShaders.setMat4("viewProjection", lightSpaceMatrix);
+    terrain.draw(frustumPlanes, terrainShaders);
+}
+
 /// @brief 输入存在的Tex对象,绑定Tex对象到FBO,结果输出到Tex.
 void DirShadowPass::renderToTexture(
     const DirectionLight &light,
     Scene &scene,
-    glm::mat4 &model,
     int width,
     int height)
 {
@@ -56,7 +125,10 @@ void DirShadowPass::renderToTexture(
     glBindFramebuffer(GL_FRAMEBUFFER, FBO);
     glClear(GL_DEPTH_BUFFER_BIT);
 
-    Renderer::DrawScene(scene, model, shaders);
+    const FrustumPlanes frustumPlanes = FrustumPlanes::FromMatrix(light.lightSpaceMatrix);
+    if (!renderGPUDriven(GPUDrivenCulling::CullView::FromPlanes(frustumPlanes), light.lightSpaceMatrix, scene))
+        renderCulled(frustumPlanes, light.lightSpaceMatrix, height, scene);
+    renderTerrain(frustumPlanes, light.lightSpaceMatrix);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // if (GUI::drawCameraFrustumWireframe)
@@ -68,7 +140,7 @@ void DirShadowPass::renderToTexture(
     // }
 }
 
-void DirShadowPass::render(DirShadowUnit &shadowUnit, Scene &scene, glm::mat4 &model)
+void DirShadowPass::render(DirShadowUnit &shadowUnit, Scene &scene)
 {
     attachDepthMap(shadowUnit.depthTexture->ID);
 
@@ -82,7 +154,14 @@ void DirShadowPass::render(DirShadowUnit &shadowUnit, Scene &scene, glm::mat4 &m
     glBindFramebuffer(GL_FRAMEBUFFER, FBO);
     glClear(GL_DEPTH_BUFFER_BIT);
 
-    Renderer::DrawScene(scene, model, shaders);
+    const glm::mat4 lightSpaceMatrix = shadowUnit.frustum.getProjViewMatrix();
+    // 面剔除关闭, 阴影贴图同样依赖背向光源的面, 只做簇的视锥与小簇剔除
+    auto cullView = GPUDrivenCulling::CullView::FromFrustum(shadowUnit.frustum, shadowUnit.resolution);
+    cullView.coneCulling = false;
+    const FrustumPlanes frustumPlanes = shadowUnit.frustum.getPlanes();
+    if (!renderGPUDriven(cullView, lightSpaceMatrix, scene))
+        renderCulled(frustumPlanes, lightSpaceMatrix, shadowUnit.resolution, scene);
+    renderTerrain(frustumPlanes, lightSpaceMatrix);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
     // if (GUI::drawCameraFrustumWireframe)
@@ -92,11 +171,11 @@ void DirShadowPass::render(DirShadowUnit &shadowUnit, Scene &scene, glm::mat4 &m
     // }
 }
 
-void DirShadowPass::render(CascadedShadowComponent &CSMComponent, Scene &scene, glm::mat4 &model)
+void DirShadowPass::render(CascadedShadowComponent &CSMComponent, Scene &scene)
 {
     for (auto &unit : CSMComponent.shadowUnits)
     {
-        render(unit, scene, model);
+        render(unit, scene);
     }
 }
 
@@ -4,6 +4,7 @@
 #include "../LightSource/Shadow.hpp"
 
 #include "../Shading/Texture.hpp"
+#include "../ShadowReceiverMask.hpp"
 /*
 Feature:
 输入:Tex对象,Tex分辨率,dirLight
@@ -13,10 +14,28 @@ Feature:
 */
 class DirShadowPass : public Pass
 {
+    const std::vector<uint32_t> *visibleReceivers = nullptr;
+    ShadowReceiverMask receiverMask;
+    // GPU驱动路径, 每个阴影视图(CSM 每一级)单独剔除
+    GPUDrivenCulling *gpuCulling = nullptr;
+    // 间接绘制与实例化共用, 世界矩阵从SSBO读取
+    Shader indirectShaders;
+    // CDLOD地形, 顶点由高度纹理位移
+    Shader terrainShaders;
+    InstanceBatcher instancing;
+    bool useInstancing = false;
+    RenderQueue renderQueue;
+    float lodPixelError = 0.0f;
+    bool positionOnly = false;
+    std::vector<uint32_t> visibleIndices;
 
     void initializeGLResources();
     void cleanUpGLResources() override;
     void attachDepthMap(const unsigned int _depthMap);
+    SceneCulling receiverCulling(const glm::mat4 &lightSpaceMatrix, const Scene &scene);
+    bool renderGPUDriven(const GPUDrivenCulling::CullView &cullView, const glm::mat4 &lightSpaceMatrix, Scene &scene);
+    void renderCulled(const FrustumPlanes &frustumPlanes, const glm::mat4 &lightSpaceMatrix, int resolution, Scene &scene);
+    void renderTerrain(const FrustumPlanes &frustumPlanes, const glm::mat4 &lightSpaceMatrix);
 
 public:
     DirShadowPass(std::string _vs_path, std::string _fs_path);
@@ -26,15 +45,38 @@ public:
 
     void resize(int _width, int _height) override;
 
+    void reloadCurrentShaders() override;
+
+    /// @brief 设置GPU驱动剔除, nullptr 使用CPU剔除路径. GPU路径不做接收体剔除
+    void setGPUDrivenCulling(GPUDrivenCulling *culling) { gpuCulling = culling; }
+
+    /// @brief CPU剔除路径中几何相同的投射体合并为实例化绘制
+    void setInstancing(bool enable) { useInstancing = enable; }
+    const InstanceBatcher::Stats &getInstancingStats() const { return instancing.getStats(); }
+    void resetInstancingStats() { instancing.resetStats(); }
+    void setRenderQueueSorting(bool enable) { renderQueue.setSorting(enable); }
+    const RenderQueue::Stats &getRenderQueueStats() const { return renderQueue.getStats(); }
+    void resetRenderQueueStats() { renderQueue.resetStats(); }
+    /// @brief CPU路径按阴影贴图上的投影尺寸选择LOD, 允许的屏幕误差(texel). <= 0 时总是绘制原网格
+    void setLodPixelError(float error) { lodPixelError = error; }
+    /// @brief 投射体只从紧密排列的位置流读取顶点(GeometryBuffer 的深度VAO)
+    void setPositionOnly(bool enable)
+    {
+        positionOnly = enable;
+        renderQueue.setPositionOnly(enable);
+    }
+
+    /// @brief 设置相机可见对象, 只绘制可能投影到它们上的投射体(相机可见的地形节点同样作为接收体). nullptr 关闭
+    void setVisibleReceivers(const std::vector<uint32_t> *receivers) { visibleReceivers = receivers; }
+
     void renderToTexture(
         const DirectionLight &light,
         Scene &scene,
-        glm::mat4 &model,
         int width,
         int height);
 
-    void render(DirShadowUnit &shadowUnit, Scene &scene, glm::mat4 &model);
-    void render(CascadedShadowComponent &CSMComponent, Scene &scene, glm::mat4 &model);
+    void render(DirShadowUnit &shadowUnit, Scene &scene);
+    void render(CascadedShadowComponent &CSMComponent, Scene &scene);
 };
 
 class DirShadowVSMPass : public Pass
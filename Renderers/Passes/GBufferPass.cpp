@@ -2,19 +2,24 @@
 #include "../../Shading/Shader.hpp"
 #include "../../Shading/RenderTarget.hpp"
 #include "../../Shading/Texture.hpp"
+#include "../../Shading/MaterialLibrary.hpp"
 #include "../DebugObjectRenderer.hpp"
 #include "GBufferPass.hpp"
 #include "../../Math/Frustum.hpp"
+#include "../../Objects/Terrain.hpp"
 
 #include "../../GUI.hpp"
 GBufferPass::GBufferPass(int _vp_width, int _vp_height, std::string _vs_path, std::string _fs_path)
-    : Pass(_vp_width, _vp_height, _vs_path, _fs_path)
+    : Pass(_vp_width, _vp_height, _vs_path, _fs_path),
+      indirectShaders(Shader("Shaders/GBuffer/gbufferIndirect.vs", _fs_path.c_str())),
+      terrainShaders(Shader("Shaders/Terrain/terrain.vs", "Shaders/Terrain/terrain.fs"))
 {
     renderTarget = std::make_shared<RenderTarget>(_vp_width, _vp_height);
     gViewPosition = std::make_shared<Texture2D>();
     gPosition = std::make_shared<Texture2D>();
     gNormal = std::make_shared<Texture2D>();
     gAlbedoSpec = std::make_shared<Texture2D>();
+    gDepth = std::make_shared<Texture2D>();
     initializeGLResources();
     contextSetup();
 }
@@ -38,15 +43,23 @@ void GBufferPass::initializeGLResources()
     gViewPosition->setFilterMax(GL_NEAREST);
     gViewPosition->generate(vp_width, vp_height, GL_RGBA16F, GL_RGBA, GL_FLOAT, NULL, false);
 
-    glGenRenderbuffers(1, &depthRenderBuffer);
-    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderBuffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, vp_width, vp_height);
+    // 可采样的深度纹理, 供Hi-Z等后续pass使用
+    gDepth->setFilterMin(GL_NEAREST);
+    gDepth->setFilterMax(GL_NEAREST);
+    gDepth->generate(vp_width, vp_height, GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT, NULL, false);
 }
 
 void GBufferPass::cleanUpGLResources()
 {
     glDeleteFramebuffers(1, &FBO);
-    glDeleteRenderbuffers(1, &depthRenderBuffer);
+}
+
+void GBufferPass::reloadCurrentShaders()
+{
+    Pass::reloadCurrentShaders();
+    indirectShaders = Shader("Shaders/GBuffer/gbufferIndirect.vs", fs_path.c_str());
+    terrainShaders = Shader("Shaders/Terrain/terrain.vs", "Shaders/Terrain/terrain.fs");
+    hiZCulling.reloadShaders();
 }
 
 void GBufferPass::contextSetup()
@@ -56,8 +69,35 @@ void GBufferPass::contextSetup()
     renderTarget->attachColorTexture2D(gNormal->ID, GL_COLOR_ATTACHMENT1);
     renderTarget->attachColorTexture2D(gAlbedoSpec->ID, GL_COLOR_ATTACHMENT2);
     renderTarget->attachColorTexture2D(gViewPosition->ID, GL_COLOR_ATTACHMENT3);
+    if (objectIds)
+        renderTarget->attachColorTexture2D(gObjectId->ID, ObjectIdAttachment);
+    renderTarget->enableColorAttachments();
+    renderTarget->attachDepthTexture2D(gDepth->ID);
+    renderTarget->unbind();
+}
+
+void GBufferPass::setObjectIds(bool enable)
+{
+    if (enable == objectIds)
+        return;
+    objectIds = enable;
+    renderQueue.setObjectIds(enable);
+    if (enable)
+    {
+        if (!gObjectId)
+        {
+            gObjectId = std::make_shared<Texture2D>();
+            gObjectId->setFilterMin(GL_NEAREST);
+            gObjectId->setFilterMax(GL_NEAREST);
+            gObjectId->generate(vp_width, vp_height, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL, false);
+        }
+        renderTarget->attachColorTexture2D(gObjectId->ID, ObjectIdAttachment);
+    }
+    else
+    {
+        renderTarget->detachColorAttachment(ObjectIdAttachment);
+    }
     renderTarget->enableColorAttachments();
-    renderTarget->attachDepthRenderBuffer(depthRenderBuffer, GL_DEPTH_ATTACHMENT);
     renderTarget->unbind();
 }
 void GBufferPass::resize(int _width, int _height)
@@ -71,10 +111,9 @@ void GBufferPass::resize(int _width, int _height)
     gNormal->resize(vp_width, vp_height);
     gAlbedoSpec->resize(vp_width, vp_height);
     gViewPosition->resize(vp_width, vp_height);
-
-    glGenRenderbuffers(1, &depthRenderBuffer);
-    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderBuffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, vp_width, vp_height);
+    gDepth->resize(vp_width, vp_height);
+    if (gObjectId)
+        gObjectId->resize(vp_width, vp_height);
 
     contextSetup();
 }
@@ -86,8 +125,17 @@ void GBufferPass::render(RenderParameters &renderParameters)
 
     renderTarget->setViewport();
     renderTarget->clearBuffer(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    if (objectIds)
+    {
+        // 整数附件不能用浮点清除色清除. 对象ID在绘制缓冲列表的最后
+        const GLuint noObject[4] = {0, 0, 0, 0};
+        glClearBufferuiv(GL_COLOR, 4, noObject);
+    }
 
     shaders.use();
+    // 材质表与纹理数组整帧只绑定一次, 各绘制只传材质编号
+    MaterialLibrary &materials = MaterialLibrary::Get();
+    materials.bind(shaders);
 
     /****************************************视口设置****************************************************/
     shaders.setInt("width", vp_width);
@@ -95,20 +143,109 @@ void GBufferPass::render(RenderParameters &renderParameters)
 
     cam.resize(vp_width, vp_height);
     cam.setToShader(shaders);
+    const FrustumPlanes frustumPlanes = cam.getFrustum().getPlanes();
+    const glm::mat4 viewProj = cam.getPerspectiveMatrix() * cam.getViewMatrix();
 
-    if (GUI::DebugToggleDrawWireframe())
+    const bool drawWireframe = GUI::DebugToggleDrawWireframe();
+    if (drawWireframe)
     {
-        DebugObjectRenderer::AddDrawCall([&](Shader &debugObjectShaders)
+        DebugObjectRenderer::AddDrawCall([&, frustumPlanes](Shader &debugObjectShaders)
                                          {
                                     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-                                    Renderer::DrawScene(scene, model, debugObjectShaders);
+                                    Renderer::DrawScene(scene, debugObjectShaders, frustumPlanes);
                                     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL); });
     }
-    else
+    else if (!renderGPUDriven(scene, cam))
     {
-        Renderer::DrawScene(scene, model, shaders);
+        SceneCulling culling;
+        if (GUI::DebugToggleOcclusionCulling())
+        {
+            occlusionCulling.beginFrame(viewProj);
+            culling.occlusion = &occlusionCulling;
+        }
+        if (GUI::DebugToggleHiZCulling())
+        {
+            hiZCulling.fetchReadback();
+            culling.hiZ = &hiZCulling;
+        }
+        cullingStats += Renderer::CollectVisible(scene, frustumPlanes, culling, visibleIndices);
+        renderQueue.setLodSelection(static_cast<float>(vp_height), lodPixelError);
+        renderQueue.begin(scene, viewProj);
+        if (useInstancing)
+        {
+            indirectShaders.use();
+            cam.setToShader(indirectShaders);
+            materials.bind(indirectShaders);
+            instancing.draw(scene, visibleIndices, indirectShaders, shaders, renderQueue);
+        }
+        else
+        {
+            renderQueue.add(visibleIndices);
+            renderQueue.submit(scene, shaders);
+        }
+        if (culling.occlusion)
+            GUI::DebugOcclusionStats(occlusionCulling);
     }
 
+    // 地形写入同一深度, Hi-Z金字塔也包含地形
+    renderTerrain(cam, frustumPlanes, drawWireframe);
+    pickObject(scene);
+
     // glBindFramebuffer(GL_FRAMEBUFFER, 0);
     renderTarget->unbind();
+
+    // 线框模式下深度为空, 不更新金字塔
+    if (!drawWireframe)
+        hiZCulling.build(gDepth->ID, vp_width, vp_height, viewProj);
+}
+
+/// @brief 取回上一次拾取的结果, 并为本帧的点击发起回读. 线框模式下GBuffer中没有场景对象, 由 GUI 改用射线拾取
+void GBufferPass::pickObject(Scene &scene)
+{
+    SceneHandle picked;
+    if (objectPicker.fetch(scene, picked))
+        GUI::SelectPickedObject(picked);
+    glm::vec2 uv;
+    if (!objectIds || !GUI::TakePickRequest(uv))
+        return;
+    const glm::ivec2 pixel = glm::clamp(glm::ivec2(uv * glm::vec2(vp_width, vp_height)), glm::ivec2(0), glm::ivec2(vp_width - 1, vp_height - 1));
+    objectPicker.request(ObjectIdAttachment, pixel, scene.structureVersion());
+}
+
+void GBufferPass::renderTerrain(Camera &cam, const FrustumPlanes &frustumPlanes, bool wireframe)
+{
+    Terrain &terrain = Terrain::Get();
+    if (!terrain.isVisible())
+        return;
+    terrainShaders.use();
+    cam.setToShader(terrainShaders);
+    terrainShaders.setInt("showLevels", terrain.getSettings().showLevels ? 1 : 0);
+    if (wireframe)
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    terrain.draw(frustumPlanes, terrainShaders);
+    if (wireframe)
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+}
+
+/// @brief 计算着色器剔除相机视图(可选上一帧Hi-Z)并间接绘制. 本帧视图已用尽时返回 false
+bool GBufferPass::renderGPUDriven(Scene &scene, Camera &cam)
+{
+    if (!gpuCulling)
+        return false;
+    const auto cullView = GPUDrivenCulling::CullView::FromFrustum(cam.getFrustum(), vp_height);
+    const int view = gpuCulling->cull(cullView, GUI::DebugToggleHiZCulling() ? &hiZCulling : nullptr);
+    if (view < 0)
+        return false;
+
+    indirectShaders.use();
+    cam.setToShader(indirectShaders);
+    MaterialLibrary::Get().bind(indirectShaders);
+    gpuCulling->draw(view, indirectShaders);
+
+    // 不支持间接绘制的对象经渲染队列逐对象绘制, 对象ID也由队列设置
+    renderQueue.setLodSelection(static_cast<float>(vp_height), 0.0f);
+    renderQueue.begin(scene, cam.getPerspectiveMatrix() * cam.getViewMatrix());
+    renderQueue.add(gpuCulling->getFallbackIndices());
+    renderQueue.submit(scene, shaders);
+    return true;
 }
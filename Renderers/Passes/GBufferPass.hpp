@@ -1,5 +1,7 @@
 #pragma once
 #include "Pass.hpp"
+#include "../HiZCulling.hpp"
+#include "../ObjectPicker.hpp"
 class RenderTarget;
 class Texture2D;
 class GBufferPass : public Pass
@@ -10,11 +12,36 @@ private:
     std::shared_ptr<Texture2D> gPosition = nullptr;
     std::shared_ptr<Texture2D> gNormal = nullptr;
     std::shared_ptr<Texture2D> gAlbedoSpec = nullptr;
-    unsigned int depthRenderBuffer;
+    std::shared_ptr<Texture2D> gDepth = nullptr;
+    // 可选的对象ID附件(R32UI), 开启拾取时才创建
+    std::shared_ptr<Texture2D> gObjectId = nullptr;
+    bool objectIds = false;
+    ObjectPicker objectPicker;
+    // 低分辨率CPU遮挡缓冲, 与视口分辨率无关
+    MaskedOcclusionCulling occlusionCulling;
+    // 由 gDepth 构建, 供下一帧剔除
+    HiZCulling hiZCulling;
+    // GPU驱动路径: 非空时由计算着色器剔除并间接绘制, 世界矩阵从SSBO读取
+    GPUDrivenCulling *gpuCulling = nullptr;
+    // 间接绘制与实例化共用, 世界矩阵从SSBO读取
+    Shader indirectShaders;
+    // CDLOD地形, 顶点由高度纹理位移
+    Shader terrainShaders;
+    InstanceBatcher instancing;
+    bool useInstancing = false;
+    // CPU剔除路径的逐对象绘制按状态与深度排序后提交
+    RenderQueue renderQueue;
+    float lodPixelError = 0.0f;
+    std::vector<uint32_t> visibleIndices;
     void initializeGLResources();
     void cleanUpGLResources() override;
+    bool renderGPUDriven(Scene &scene, Camera &cam);
+    void renderTerrain(Camera &cam, const FrustumPlanes &frustumPlanes, bool wireframe);
+    void pickObject(Scene &scene);
 
 public:
+    static constexpr GLenum ObjectIdAttachment = GL_COLOR_ATTACHMENT4;
+
     GBufferPass(int _vp_width, int _vp_height, std::string _vs_path, std::string _fs_path);
     ~GBufferPass()
     {
@@ -25,10 +52,29 @@ public:
 
     void resize(int _width, int _height) override;
 
+    void reloadCurrentShaders() override;
+
     void render(RenderParameters &renderParameters);
 
     inline auto getTextures()
     {
         return std::make_tuple(gPosition->ID, gNormal->ID, gAlbedoSpec->ID, gViewPosition->ID);
     }
+    /// @brief 设置GPU驱动剔除, nullptr 使用CPU剔除路径
+    void setGPUDrivenCulling(GPUDrivenCulling *culling) { gpuCulling = culling; }
+    /// @brief CPU剔除路径中几何相同的对象合并为实例化绘制
+    void setInstancing(bool enable) { useInstancing = enable; }
+    const InstanceBatcher::Stats &getInstancingStats() const { return instancing.getStats(); }
+    void resetInstancingStats() { instancing.resetStats(); }
+    /// @brief 关闭时按稠密下标顺序逐对象绘制
+    void setRenderQueueSorting(bool enable) { renderQueue.setSorting(enable); }
+    const RenderQueue::Stats &getRenderQueueStats() const { return renderQueue.getStats(); }
+    void resetRenderQueueStats() { renderQueue.resetStats(); }
+    /// @brief CPU路径按屏幕投影尺寸选择LOD, 允许的屏幕误差(像素). <= 0 时总是绘制原网格
+    void setLodPixelError(float error) { lodPixelError = error; }
+    /// @brief 开关对象ID附件. 开启时GBuffer额外写入每个像素的对象, 供 GUI 的场景拾取回读
+    void setObjectIds(bool enable);
+    const ObjectPicker &getObjectPicker() const { return objectPicker; }
+    GLuint getDepthTexture() const { return gDepth->ID; }
+    HiZCulling &getHiZCulling() { return hiZCulling; }
 };
@@ -4,10 +4,13 @@
 #include "../../Utils/Random.hpp"
 #include "LightPass.hpp"
 #include "../../GUI.hpp"
+#include <chrono>
 
 LightPass::LightPass(int _vp_width, int _vp_height, std::string _vs_path, std::string _fs_path)
     : Pass(_vp_width, _vp_height, _vs_path, _fs_path),
-      shaderSetting(std::make_unique<LightShaderSetting>())
+      shaderSetting(std::make_unique<LightShaderSetting>()),
+      shadowKernel(Random::GenerateShadowKernel(128)),
+      skyboxKernel(Random::GenerateSemiSphereKernel(32))
 {
     initializeGLResources();
     contextSetup();
@@ -57,11 +60,6 @@ void LightPass::render(RenderParameters &renderParameters,
 {
 
     auto &[allLights, cam, scene, model, window] = renderParameters;
-    auto &[pointLights, dirLights] = allLights;
-
-    static auto shadowKernel = Random::GenerateShadowKernel(128);
-
-    static const auto skyboxKernel = Random::GenerateSemiSphereKernel(32);
 
     auto noise = Random::GenerateNoise();
     shadowNoiseTex.setData(&noise[0]);
@@ -82,20 +80,18 @@ void LightPass::render(RenderParameters &renderParameters,
     shaders.setTextureAuto(skybox, GL_TEXTURE_CUBE_MAP, 0, "skybox");
     shaders.setTextureAuto(skyEnvmap, GL_TEXTURE_CUBE_MAP, 0, "skyEnvmap");
 
-    /****************************************点光源输入**************************************************/
-    LightSource::InitialzeShaderLightArray(shaders);
-    shaders.setInt("numPointLights", static_cast<int>(pointLights.size()));
-    for (size_t i = 0; i < pointLights.size(); ++i)
+    /****************************************光源与采样核输入**************************************************/
+    // 基准写入的值随后被正常上传覆盖
+    if (int iterations = GUI::DebugUniformUpload(uniformStats); iterations > 0)
     {
-        pointLights[i].setToShaderLightArray(shaders, i);
+        benchmarkUniformUpload(iterations);
     }
+    const auto uploadStart = std::chrono::steady_clock::now();
+    uploadLightUniforms(allLights);
+    uniformStats.uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count();
+    GUI::DebugLightBuffer(lightBuffer.getStats());
+
     shaders.setInt("usePCSS", GUI::DebugToggleUsePCSS());
-    /****************************************方向光源输入**************************************************/
-    shaders.setInt("numDirLights", static_cast<int>(dirLights.size()));
-    for (size_t i = 0; i < dirLights.size(); ++i)
-    {
-        dirLights[i].setToShaderLightArray(shaders, i);
-    }
     shaders.setInt("useBias", 0);
     if (GUI::DebugToggleUseBias())
     {
@@ -117,18 +113,60 @@ void LightPass::render(RenderParameters &renderParameters,
     SkySetting::SetShaderUniforms(shaders);
     SkySetting::RenderUI();
 
-    /****************************************采样器设置**************************************************/
-    for (unsigned int i = 0; i < shadowKernel.size(); ++i)
-    {
-        shaders.setUniform3fv(std::format("shadowSamples[{}]", i), shadowKernel[i]);
-    }
-    for (unsigned int i = 0; i < skyboxKernel.size(); ++i)
-    {
-        shaders.setUniform3fv(std::format("skyboxSamples[{}]", i), skyboxKernel[i]);
-    }
     shaderSetting->setShaderUniforms(shaders);
     shaderSetting->renderUI();
     /*****************************************RayMarching设置************************************************* */
 
     Renderer::DrawQuad();
 }
+
+// 光源表(只上传变化的光源)与阴影贴图数组, 阴影与天空盒采样核. 采样核是 vec3 数组, location连续, 各一次上传
+void LightPass::uploadLightUniforms(Lights &lights)
+{
+    lightBuffer.bind(lights, shaders);
+    // 级联阴影仍为单组uniform, 与之前一样由最后一个方向光源设置
+    if (!lights.dirLights.empty())
+    {
+        lights.dirLights.back().CSMComponent->setToShader(shaders);
+    }
+
+    shaders.setUniform3fv("shadowSamples"_uniform, static_cast<GLsizei>(shadowKernel.size()), shadowKernel.data());
+    shaders.setUniform3fv("skyboxSamples"_uniform, static_cast<GLsizei>(skyboxKernel.size()), skyboxKernel.data());
+}
+
+// 对比同一组uniform的两种上传方式. 按名字的版本即改用 UniformId 之前的写法: 每个元素格式化一次名字再查字符串缓存
+// 光源参数已移入光源表, 这里只剩采样核与光源数目
+void LightPass::benchmarkUniformUpload(int iterations)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const auto idStart = Clock::now();
+    for (int n = 0; n < iterations; ++n)
+    {
+        shaders.setUniform("numPointLights"_uniform, 0);
+        shaders.setUniform("numDirLights"_uniform, 0);
+        shaders.setUniform3fv("shadowSamples"_uniform, static_cast<GLsizei>(shadowKernel.size()), shadowKernel.data());
+        shaders.setUniform3fv("skyboxSamples"_uniform, static_cast<GLsizei>(skyboxKernel.size()), skyboxKernel.data());
+    }
+    const auto stringStart = Clock::now();
+    for (int n = 0; n < iterations; ++n)
+    {
+        shaders.setInt("numPointLights", 0);
+        shaders.setInt("numDirLights", 0);
+        for (size_t i = 0; i < shadowKernel.size(); ++i)
+        {
+            shaders.setUniform3fv(std::format("shadowSamples[{}]", i), shadowKernel[i]);
+        }
+        for (size_t i = 0; i < skyboxKernel.size(); ++i)
+        {
+            shaders.setUniform3fv(std::format("skyboxSamples[{}]", i), skyboxKernel[i]);
+        }
+    }
+    const auto end = Clock::now();
+
+    uniformStats.benchmarkIterations = iterations;
+    uniformStats.idUs = std::chrono::duration<double, std::micro>(stringStart - idStart).count() / iterations;
+    uniformStats.stringUs = std::chrono::duration<double, std::micro>(end - stringStart).count() / iterations;
+    DebugOutput::AddLog("Light pass uniform upload x{}: UniformId {:.2f} us, std::format names {:.2f} us per upload\n",
+                        iterations, uniformStats.idUs, uniformStats.stringUs);
+}
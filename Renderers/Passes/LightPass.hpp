@@ -1,16 +1,35 @@
 #pragma once
 #include "Pass.hpp"
 #include "../Shading/Texture.hpp"
+#include "../../LightSource/LightBuffer.hpp"
 class LightShaderSetting;
 
 class LightPass : public Pass
 {
+public:
+    // 光源表与采样核的上传耗时(CPU)
+    struct UniformStats
+    {
+        double uploadMs = 0.0; // 上一帧
+        // 最近一次基准: 采样核等uniform分别按 UniformId 与按 std::format 名字上传, 每次上传的平均微秒数
+        int benchmarkIterations = 0;
+        double idUs = 0.0;
+        double stringUs = 0.0;
+    };
+
 private:
     Texture2D lightPassTex;
     Texture2D shadowNoiseTex;
 
     std::unique_ptr<LightShaderSetting> shaderSetting;
+    LightBuffer lightBuffer;
+    std::vector<glm::vec3> shadowKernel;
+    std::vector<glm::vec3> skyboxKernel;
+    UniformStats uniformStats;
+
     void initializeGLResources();
+    void uploadLightUniforms(Lights &lights);
+    void benchmarkUniformUpload(int iterations);
     void cleanUpGLResources() override;
 
 public:
@@ -31,4 +50,7 @@ public:
                 unsigned int skybox,
                 unsigned int transmittanceLUT,
                 unsigned int skyEnvmap);
+
+    const UniformStats &getUniformStats() const { return uniformStats; }
+    LightBuffer &getLightBuffer() { return lightBuffer; }
 };
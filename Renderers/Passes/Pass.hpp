@@ -16,6 +16,8 @@ protected:
     std::string gs_path;
     int vp_width;
     int vp_height;
+    // 本帧场景剔除统计, 渲染器在帧开始时清零
+    CullingStats cullingStats;
 
     // 管理GL资源
     //  初始化内部OpenGL资源,如获取FBO,Texture,绑定framebuffer等
@@ -42,6 +44,8 @@ public:
 
     virtual void resize(int _width, int _height) = 0;
     virtual ~Pass() = default;
+    const CullingStats &getCullingStats() const { return cullingStats; }
+    void resetCullingStats() { cullingStats = CullingStats(); }
     void setToggle(bool status, std::string toggle)
     {
         shaders.use();
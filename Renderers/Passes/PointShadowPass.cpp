@@ -1,12 +1,35 @@
 #include "PointShadowPass.hpp"
 #include "../../Shading/Cubemap.hpp"
+#include "../../Objects/Terrain.hpp"
+#include <algorithm>
+
+// 立方体6个面的投影视图矩阵, 一次上传整个数组
+static void SetShadowMatrices(Shader &shaders, const PointLight &light)
+{
+    glm::mat4 shadowMatrices[6];
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        shadowMatrices[i] = light.cubemapParam->projectionMartix * light.cubemapParam->viewMatrices[i];
+    }
+    shaders.setMat4("shadowMatrices"_uniform, 6, shadowMatrices);
+}
+
 PointShadowPass::PointShadowPass(std::string _vs_path, std::string _fs_path, std::string _gs_path)
-    : Pass(0, 0, _vs_path, _fs_path, _gs_path)
+    : Pass(0, 0, _vs_path, _fs_path, _gs_path),
+      instancedShaders(Shader("Shaders/ShadowDepthTexture/shadow_depthInstanced.vs", _fs_path.c_str(), _gs_path.c_str())),
+      terrainShaders(Shader("Shaders/Terrain/terrain_depth.vs", _fs_path.c_str(), _gs_path.c_str()))
 {
     initializeGLResources();
     contextSetup();
 }
 
+void PointShadowPass::reloadCurrentShaders()
+{
+    Pass::reloadCurrentShaders();
+    instancedShaders = Shader("Shaders/ShadowDepthTexture/shadow_depthInstanced.vs", fs_path.c_str(), gs_path.c_str());
+    terrainShaders = Shader("Shaders/Terrain/terrain_depth.vs", fs_path.c_str(), gs_path.c_str());
+}
+
 inline void PointShadowPass::initializeGLResources()
 {
     glGenFramebuffers(1, &FBO);
@@ -39,7 +62,6 @@ void PointShadowPass::attachDepthMap(const unsigned int _depthCubemap)
 void PointShadowPass::renderToTexture(
     const PointLight &light,
     Scene &scene,
-    glm::mat4 &model,
     int width,
     int height)
 {
@@ -55,18 +77,70 @@ void PointShadowPass::renderToTexture(
         shaders.use();
         if (!shaders.used)
             throw(std::exception("Shader failed to setup."));
-        for (unsigned int i = 0; i < 6; ++i)
+        SetShadowMatrices(shaders, light);
+        shaders.setFloat("farPlane"_uniform, light.getFarPlane());
+        shaders.setUniform3fv("lightPos"_uniform, light.getPosition());
+
+        // 6个面的视锥合起来是边长2*farPlane的立方体, 取其外接球
+        const BoundingSphere lightRange{light.getPosition(), light.getFarPlane() * 1.7320508f};
+        bool receiversInRange = true;
+        if (visibleReceivers)
         {
-            shaders.setMat4("shadowMatrices[" + std::to_string(i) + "]", light.cubemapParam->projectionMartix * light.cubemapParam->viewMatrices[i]);
+            receiversInRange = std::any_of(visibleReceivers->begin(), visibleReceivers->end(), [&](uint32_t i)
+                                           {
+                const BoundingVolume &bounds = scene.worldBoundsAt(i);
+                return !bounds.isValid() || bounds.sphere.intersects(lightRange); });
+        }
+        const Terrain &terrain = Terrain::Get();
+        if (visibleReceivers && !receiversInRange && terrain.isVisible())
+        {
+            const std::vector<AABB> &terrainReceivers = terrain.getReceiverBounds();
+            receiversInRange = std::any_of(terrainReceivers.begin(), terrainReceivers.end(), [&](const AABB &box)
+                                           {
+                const glm::vec3 d = glm::clamp(lightRange.center, box.min, box.max) - lightRange.center;
+                return glm::dot(d, d) <= lightRange.radius * lightRange.radius; });
+        }
+        if (!receiversInRange)
+            cullingStats.culled += scene.size();
+        else
+        {
+            cullingStats += Renderer::CollectVisible(scene, lightRange, visibleIndices);
+            // 立方体6个面共用一次提交, 按到光源的距离由近到远
+            renderQueue.setLodSelection(static_cast<float>(height), lodPixelError);
+            renderQueue.begin(scene, light.getPosition());
+            if (useInstancing)
+            {
+                instancedShaders.use();
+                SetShadowMatrices(instancedShaders, light);
+                instancedShaders.setFloat("farPlane"_uniform, light.getFarPlane());
+                instancedShaders.setUniform3fv("lightPos"_uniform, light.getPosition());
+                instancing.draw(scene, visibleIndices, instancedShaders, shaders, renderQueue);
+            }
+            else
+            {
+                renderQueue.add(visibleIndices);
+                renderQueue.submit(scene, shaders);
+            }
+            renderTerrain(light, lightRange);
         }
-        shaders.setFloat("farPlane", light.getFarPlane());
-        shaders.setUniform3fv("lightPos", light.getPosition());
-
-        Renderer::DrawScene(scene, model, shaders);
     }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+/// @brief 地形节点按光源范围选择, 顶点着色器输出世界坐标, 由几何着色器投影到6个面
+void PointShadowPass::renderTerrain(const PointLight &light, const BoundingSphere &lightRange)
+{
+    Terrain &terrain = Terrain::Get();
+    if (!terrain.isVisible())
+        return;
+    terrainShaders.use();
+    SetShadowMatrices(terrainShaders, light);
+    terrainShaders.setFloat("farPlane"_uniform, light.getFarPlane());
+    terrainShaders.setUniform3fv("lightPos"_uniform, light.getPosition());
+    terrainShaders.setMat4("viewProjection"_uniform, glm::mat4(1.0f));
+    terrain.draw(lightRange, terrainShaders);
+}
+
 inline void PointShadowVSMPass::initializeGLResources()
 {
     glGenFramebuffers(1, &FBO);
@@ -98,7 +172,7 @@ void PointShadowVSMPass::resize(int _width, int _height)
 void PointShadowVSMPass::renderToVSMTexture(const PointLight &light)
 {
     glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-    glViewport(0, 0, light.texResolution, light.texResolution);
+    glViewport(0, 0, light.shadowResolution, light.shadowResolution);
     shaders.use();
     if (!shaders.used)
         throw(std::exception("Shader failed to setup."));
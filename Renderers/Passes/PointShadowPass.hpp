@@ -12,10 +12,22 @@ Feature:
 class PointShadowPass : public Pass
 {
 private:
+    const std::vector<uint32_t> *visibleReceivers = nullptr;
+    // 实例化绘制, 世界矩阵从SSBO读取. 几何着色器与 shaders 相同
+    Shader instancedShaders;
+    // CDLOD地形, 几何着色器与 shaders 相同
+    Shader terrainShaders;
+    InstanceBatcher instancing;
+    bool useInstancing = false;
+    RenderQueue renderQueue;
+    float lodPixelError = 0.0f;
+    std::vector<uint32_t> visibleIndices;
+
     void initializeGLResources() override;
     void cleanUpGLResources() override;
 
     void attachDepthMap(const unsigned int _depthCubemap);
+    void renderTerrain(const PointLight &light, const BoundingSphere &lightRange);
 
 public:
     PointShadowPass(std::string _vs_path, std::string _fs_path, std::string _gs_path);
@@ -27,10 +39,26 @@ public:
 
     void resize(int _width, int _height) override;
 
+    void reloadCurrentShaders() override;
+
+    /// @brief 几何相同的投射体合并为实例化绘制
+    void setInstancing(bool enable) { useInstancing = enable; }
+    const InstanceBatcher::Stats &getInstancingStats() const { return instancing.getStats(); }
+    void resetInstancingStats() { instancing.resetStats(); }
+    void setRenderQueueSorting(bool enable) { renderQueue.setSorting(enable); }
+    const RenderQueue::Stats &getRenderQueueStats() const { return renderQueue.getStats(); }
+    void resetRenderQueueStats() { renderQueue.resetStats(); }
+    /// @brief 按立方体贴图上的投影尺寸选择LOD, 允许的屏幕误差(texel). <= 0 时总是绘制原网格
+    void setLodPixelError(float error) { lodPixelError = error; }
+    /// @brief 投射体只从紧密排列的位置流读取顶点(GeometryBuffer 的深度VAO)
+    void setPositionOnly(bool enable) { renderQueue.setPositionOnly(enable); }
+
+    /// @brief 设置相机可见对象. 光源范围内没有可见对象(及相机可见的地形节点)时不绘制投射体. nullptr 关闭
+    void setVisibleReceivers(const std::vector<uint32_t> *receivers) { visibleReceivers = receivers; }
+
     void renderToTexture(
         const PointLight &light,
         Scene &scene,
-        glm::mat4 &model,
         int width,
         int height);
 };
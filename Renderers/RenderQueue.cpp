@@ -0,0 +1,280 @@
+#include "RenderQueue.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+}
+
+void RenderQueue::beginCommon(Scene &scene)
+{
+    m_scene = &scene;
+    m_packets.clear();
+    if (m_ranges.update(scene))
+    {
+        m_materialIds.clear();
+        m_vaoIds.clear();
+    }
+}
+
+void RenderQueue::begin(Scene &scene, const glm::mat4 &viewProj)
+{
+    beginCommon(scene);
+    m_viewProj = viewProj;
+    // 正交投影的裁剪空间 w 恒为1
+    const bool orthographic = viewProj[0][3] == 0.0f && viewProj[1][3] == 0.0f && viewProj[2][3] == 0.0f;
+    m_depthMode = orthographic ? DepthMode::Orthographic : DepthMode::Perspective;
+    // 视图矩阵为刚体变换时, 投影矩阵 [1][1] 等于 viewProj 第二行前三项的长度
+    const float projectionScale = glm::length(glm::vec3(viewProj[0][1], viewProj[1][1], viewProj[2][1]));
+    m_lodPixelScale = m_lodMaxPixelError > 0.0f ? 0.5f * m_lodTargetHeight * projectionScale : 0.0f;
+}
+
+void RenderQueue::begin(Scene &scene, const glm::vec3 &origin)
+{
+    beginCommon(scene);
+    m_origin = origin;
+    m_depthMode = DepthMode::Distance;
+    // 立方体贴图每个面的视场为90度
+    m_lodPixelScale = m_lodMaxPixelError > 0.0f ? 0.5f * m_lodTargetHeight : 0.0f;
+}
+
+float RenderQueue::viewDepth(const BoundingVolume &bounds) const
+{
+    switch (m_depthMode)
+    {
+    case DepthMode::Perspective:
+        return (m_viewProj * glm::vec4(bounds.sphere.center, 1.0f)).w;
+    case DepthMode::Orthographic:
+        return (m_viewProj * glm::vec4(bounds.sphere.center, 1.0f)).z + 1.0f;
+    case DepthMode::Distance:
+        return glm::length(bounds.sphere.center - m_origin);
+    }
+    return 0.0f;
+}
+
+uint64_t RenderQueue::depthKey(uint32_t denseIndex) const
+{
+    const BoundingVolume &bounds = m_scene->worldBoundsAt(denseIndex);
+    if (!bounds.isValid())
+        return DepthMask;
+    // 非负浮点数的位模式与数值同序, 取符号位之后的高24位
+    const float depth = std::max(viewDepth(bounds), 0.0f);
+    return (std::bit_cast<uint32_t>(depth) >> 7) & DepthMask;
+}
+
+float RenderQueue::lodErrorBudget(uint32_t denseIndex) const
+{
+    if (m_lodPixelScale <= 0.0f)
+        return 0.0f;
+    const BoundingVolume &bounds = m_scene->worldBoundsAt(denseIndex);
+    if (!bounds.isValid())
+        return 0.0f;
+    // 取包围球最近处的深度, 包围球跨过观察点时使用原网格
+    const float depth = m_depthMode == DepthMode::Orthographic ? 1.0f : viewDepth(bounds) - bounds.sphere.radius;
+    if (depth <= 0.0f)
+        return 0.0f;
+    const glm::mat4 &model = m_scene->worldTransformAt(denseIndex);
+    const float scale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))});
+    if (scale <= 0.0f)
+        return 0.0f;
+    // 屏幕误差 = 模型空间误差 * 缩放 * pixelScale / 深度
+    return m_lodMaxPixelError * depth / (scale * m_lodPixelScale);
+}
+
+uint32_t RenderQueue::SelectLod(const DrawRange &range, float errorBudget)
+{
+    uint32_t lod = 0;
+    while (lod < range.lodCount && range.lods[lod].error <= errorBudget)
+        ++lod;
+    return lod;
+}
+
+DrawRange RenderQueue::LodRange(const DrawRange &range, uint32_t lod)
+{
+    DrawRange result = range;
+    if (lod > 0)
+    {
+        result.firstIndex = range.lods[lod - 1].firstIndex;
+        result.indexCount = range.lods[lod - 1].indexCount;
+    }
+    return result;
+}
+
+uint32_t RenderQueue::materialId(uint32_t material)
+{
+    auto [it, inserted] = m_materialIds.try_emplace(material, static_cast<uint32_t>(m_materialIds.size()));
+    // 编号用尽时共用最后一个, 提交时按实际材质比较, 只影响合并效果
+    return static_cast<uint32_t>(std::min<uint64_t>(it->second, MaterialMask - 1));
+}
+
+uint32_t RenderQueue::vaoId(GLuint vao)
+{
+    auto [it, inserted] = m_vaoIds.try_emplace(vao, static_cast<uint32_t>(m_vaoIds.size()));
+    return static_cast<uint32_t>(std::min<uint64_t>(it->second, VaoMask - 1));
+}
+
+void RenderQueue::add(uint32_t denseIndex, uint32_t program)
+{
+    const uint64_t programKey = uint64_t(program & 0xFF) << ProgramShift;
+    if (!m_sorting)
+    {
+        m_packets.push_back(Packet{programKey, denseIndex, NoRange, 0});
+        return;
+    }
+    const uint64_t depth = depthKey(denseIndex);
+    if (m_ranges.empty(denseIndex))
+    {
+        m_packets.push_back(Packet{programKey | (MaterialMask << MaterialShift) | (VaoMask << VaoShift) | depth, denseIndex, NoRange, 0});
+        return;
+    }
+    const float errorBudget = lodErrorBudget(denseIndex);
+    for (uint32_t r = m_ranges.begin(denseIndex); r < m_ranges.end(denseIndex); ++r)
+    {
+        const DrawRange &range = m_ranges.range(r);
+        const uint64_t key = programKey |
+                             (uint64_t(materialId(range.materialId)) << MaterialShift) |
+                             (uint64_t(vaoId(drawVao(range))) << VaoShift) |
+                             depth;
+        m_packets.push_back(Packet{key, denseIndex, r, SelectLod(range, errorBudget)});
+    }
+}
+
+void RenderQueue::add(const std::vector<uint32_t> &denseIndices, uint32_t program)
+{
+    m_packets.reserve(m_packets.size() + denseIndices.size());
+    for (uint32_t i : denseIndices)
+        add(i, program);
+}
+
+void RenderQueue::radixSort()
+{
+    const size_t count = m_packets.size();
+    m_sortScratch.resize(count);
+    Packet *source = m_packets.data();
+    Packet *destination = m_sortScratch.data();
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        size_t offsets[256] = {};
+        for (size_t i = 0; i < count; ++i)
+            offsets[(source[i].key >> shift) & 0xFF]++;
+        if (offsets[(source[0].key >> shift) & 0xFF] == count)
+            continue;
+        size_t sum = 0;
+        for (size_t &offset : offsets)
+        {
+            const size_t bucket = offset;
+            offset = sum;
+            sum += bucket;
+        }
+        for (size_t i = 0; i < count; ++i)
+            destination[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+        std::swap(source, destination);
+    }
+    if (source != m_packets.data())
+        m_packets.swap(m_sortScratch);
+}
+
+void RenderQueue::submit(Scene &scene, Shader *const *programs, size_t programCount)
+{
+    if (m_packets.empty())
+        return;
+    m_stats.packets += m_packets.size();
+    if (m_sorting)
+    {
+        const Clock::time_point start = Clock::now();
+        radixSort();
+        m_stats.sortMs += ElapsedMs(start);
+    }
+
+    constexpr uint32_t NoObject = ~uint32_t(0);
+    uint32_t currentProgram = ~uint32_t(0);
+    uint32_t currentObject = NoObject;
+    GLuint currentVao = ~GLuint(0);
+    uint32_t currentMaterial = MaterialLibrary::DefaultMaterial;
+    Shader *shaders = nullptr;
+    for (const Packet &packet : m_packets)
+    {
+        const uint32_t program = static_cast<uint32_t>(packet.key >> ProgramShift);
+        if (program != currentProgram)
+        {
+            if (shaders && currentMaterial != MaterialLibrary::DefaultMaterial)
+                shaders->setInt("materialId"_uniform, MaterialLibrary::DefaultMaterial);
+            if (shaders && m_objectIds)
+                shaders->setInt("objectId"_uniform, 0);
+            shaders = programs[std::min<size_t>(program, programCount - 1)];
+            shaders->use();
+            currentProgram = program;
+            currentObject = NoObject;
+            currentMaterial = MaterialLibrary::DefaultMaterial;
+            m_stats.programChanges++;
+        }
+
+        if (packet.range == NoRange)
+        {
+            Object &object = scene.objectAt(packet.object);
+            if (m_objectIds)
+                shaders->setInt("objectId"_uniform, static_cast<int>(packet.object + 1));
+            try
+            {
+                object.draw(scene.worldTransformAt(packet.object), *shaders);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Error rendering object '" << object.name << "': " << e.what() << std::endl;
+            }
+            // Object::draw 自行设置并复位了这些状态
+            currentObject = NoObject;
+            currentVao = ~GLuint(0);
+            currentMaterial = MaterialLibrary::DefaultMaterial;
+            m_stats.fallbackObjects++;
+            continue;
+        }
+
+        const DrawRange &range = m_ranges.range(packet.range);
+        const DrawRange drawn = LodRange(range, packet.lod);
+        const GLuint vao = drawVao(range);
+        if (vao != currentVao)
+        {
+            glBindVertexArray(vao);
+            currentVao = vao;
+            m_stats.vaoChanges++;
+        }
+        if (range.materialId != currentMaterial)
+        {
+            // 纹理数组已由 MaterialLibrary::bind 绑定, 切换材质只需一个整数
+            shaders->setInt("materialId"_uniform, static_cast<int>(range.materialId));
+            currentMaterial = range.materialId;
+            m_stats.materialChanges++;
+        }
+        if (packet.object != currentObject)
+        {
+            shaders->setMat4("model"_uniform, scene.worldTransformAt(packet.object));
+            if (m_objectIds)
+                shaders->setInt("objectId"_uniform, static_cast<int>(packet.object + 1));
+            currentObject = packet.object;
+            m_stats.transformChanges++;
+        }
+        glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(drawn.indexCount), drawn.indexType,
+                                 drawn.indexOffset(), drawn.baseVertex);
+        m_stats.drawCalls++;
+        m_stats.triangles += drawn.indexCount / 3;
+        if (packet.lod > 0)
+        {
+            m_stats.lodDrawCalls++;
+            m_stats.lodTrianglesSaved += (range.indexCount - drawn.indexCount) / 3;
+        }
+    }
+    if (currentMaterial != MaterialLibrary::DefaultMaterial)
+        shaders->setInt("materialId"_uniform, MaterialLibrary::DefaultMaterial);
+    if (m_objectIds)
+        shaders->setInt("objectId"_uniform, 0);
+    glBindVertexArray(0);
+    m_packets.clear();
+}
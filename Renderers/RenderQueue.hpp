@@ -0,0 +1,146 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../Shading/Shader.hpp"
+#include "../Shading/MaterialLibrary.hpp"
+#include "../Objects/Scene.hpp"
+#include "DrawRangeCache.hpp"
+
+/*
+排序渲染队列: pass 把可见对象展开为绘制包(每个 DrawRange 一个), 每个包带64位排序键
+    [63..56] 着色器程序  [55..36] 材质  [35..24] VAO  [23..0] 深度
+基数排序后按键序提交, 程序/材质/VAO/世界矩阵只在与上一个包不同时才重新设置
+同一状态内按深度由近到远, 不透明几何体可以更多地利用 early-Z
+没有 DrawRange 的对象作为回退包排在同一程序的最后, 仍由 Object::draw 绘制
+开启LOD选择时, 带简化层级的范围按投影后的几何误差选用屏幕误差不超过阈值的最粗层级
+只写深度的pass可开启仅位置模式, 改用范围的 depthVao, 顶点获取只读紧密排列的位置流
+写对象ID的pass开启后, 每个对象额外设置 objectId uniform(稠密下标 + 1)
+*/
+class RenderQueue
+{
+public:
+    struct Stats
+    {
+        size_t packets = 0;
+        size_t fallbackObjects = 0; // 经 Object::draw 绘制的对象数
+        size_t drawCalls = 0;
+        // 提交时实际发生的状态切换次数
+        size_t programChanges = 0;
+        size_t materialChanges = 0;
+        size_t vaoChanges = 0;
+        size_t transformChanges = 0;
+        size_t triangles = 0;
+        size_t lodDrawCalls = 0;      // 使用简化层级的绘制数
+        size_t lodTrianglesSaved = 0; // 相比原网格少绘制的三角形数
+        double sortMs = 0.0;
+    };
+
+    /// @brief 关闭时按加入顺序提交并逐对象调用 Object::draw, 用于对比
+    void setSorting(bool enable) { m_sorting = enable; }
+    bool isSorting() const { return m_sorting; }
+
+    /// @brief 开启时绘制使用 DrawRange::depthVao, 着色器只能读取位置属性
+    void setPositionOnly(bool enable) { m_positionOnly = enable; }
+    bool isPositionOnly() const { return m_positionOnly; }
+    /// @brief 开启时对象切换时设置 objectId, 着色器需声明 uniform int objectId
+    void setObjectIds(bool enable) { m_objectIds = enable; }
+
+    /// @brief 按当前模式绘制 range 时绑定的VAO
+    GLuint drawVao(const DrawRange &range) const { return m_positionOnly && range.depthVao ? range.depthVao : range.vao; }
+
+    /// @brief 之后的 begin 按投影尺寸选择LOD. targetHeight 为渲染目标高度(像素), maxPixelError <= 0 时关闭
+    ///        立方体阴影按90度视场计算
+    void setLodSelection(float targetHeight, float maxPixelError)
+    {
+        m_lodTargetHeight = targetHeight;
+        m_lodMaxPixelError = maxPixelError;
+    }
+
+    /// @brief 开始一次提交, 深度取包围球球心的视空间深度(正交投影时为裁剪空间z)
+    void begin(Scene &scene, const glm::mat4 &viewProj);
+    /// @brief 开始一次提交, 深度取到 origin 的距离. 用于点光源立方体阴影
+    void begin(Scene &scene, const glm::vec3 &origin);
+
+    void add(uint32_t denseIndex, uint32_t program = 0);
+    void add(const std::vector<uint32_t> &denseIndices, uint32_t program = 0);
+
+    /// @brief 排序并提交本次加入的所有包, 之后队列为空. 程序编号为 programs 的下标
+    void submit(Scene &scene, Shader *const *programs, size_t programCount);
+    void submit(Scene &scene, Shader &shaders)
+    {
+        Shader *programs[] = {&shaders};
+        submit(scene, programs, 1);
+    }
+
+    /// @brief begin 之后有效, InstanceBatcher 用它分组
+    const DrawRangeCache &getDrawRanges() const { return m_ranges; }
+
+    /// @brief begin 之后有效. 对象允许的模型空间几何误差, 0 表示使用原网格
+    float lodErrorBudget(uint32_t denseIndex) const;
+    /// @brief 误差不超过 errorBudget 的最粗层级, 0 为原范围, k 为 range.lods[k-1]
+    static uint32_t SelectLod(const DrawRange &range, float errorBudget);
+    /// @brief 第 lod 层级的索引范围, 其余字段同 range
+    static DrawRange LodRange(const DrawRange &range, uint32_t lod);
+
+    /// @brief 自上次 resetStats 以来的累计值
+    const Stats &getStats() const { return m_stats; }
+    void resetStats() { m_stats = Stats{}; }
+
+private:
+    static constexpr uint32_t NoRange = ~uint32_t(0);
+    static constexpr int ProgramShift = 56;
+    static constexpr int MaterialShift = 36;
+    static constexpr int VaoShift = 24;
+    static constexpr uint64_t MaterialMask = (uint64_t(1) << 20) - 1;
+    static constexpr uint64_t VaoMask = (uint64_t(1) << 12) - 1;
+    static constexpr uint64_t DepthMask = (uint64_t(1) << 24) - 1;
+
+    struct Packet
+    {
+        uint64_t key;
+        uint32_t object;
+        uint32_t range; // NoRange 表示回退包
+        uint32_t lod;
+    };
+
+    enum class DepthMode
+    {
+        Perspective,
+        Orthographic,
+        Distance
+    };
+
+    bool m_sorting = true;
+    bool m_positionOnly = false;
+    bool m_objectIds = false;
+    DrawRangeCache m_ranges;
+    // 材质编号与VAO名压缩为排序键中的短编号, 场景结构变化时重新编号
+    std::unordered_map<uint32_t, uint32_t> m_materialIds;
+    std::unordered_map<GLuint, uint32_t> m_vaoIds;
+
+    Scene *m_scene = nullptr; // begin 时设置
+    DepthMode m_depthMode = DepthMode::Distance;
+    glm::mat4 m_viewProj = glm::mat4(1.0f);
+    glm::vec3 m_origin = glm::vec3(0.0f);
+    float m_lodTargetHeight = 0.0f;
+    float m_lodMaxPixelError = 0.0f;
+    float m_lodPixelScale = 0.0f; // 深度1处(正交投影时任意深度)每单位长度的像素数, 0 表示不选择LOD
+
+    std::vector<Packet> m_packets;
+    std::vector<Packet> m_sortScratch;
+    Stats m_stats;
+
+    void beginCommon(Scene &scene);
+    // 包围球球心的深度, 与排序键一致
+    float viewDepth(const BoundingVolume &bounds) const;
+    uint64_t depthKey(uint32_t denseIndex) const;
+    uint32_t materialId(uint32_t material);
+    uint32_t vaoId(GLuint vao);
+    // 按 key 的LSD基数排序, 每次8位, 所有键在该位上相同时跳过
+    void radixSort();
+};
@@ -1,26 +1,124 @@
 
 #include "Renderer.hpp"
+#include <algorithm>
+#include <numeric>
 
 #include "../Objects/FrustumWireframe.hpp"
+#include "../Objects/PrimitiveRegistry.hpp"
 #include "Passes/DebugObjectPass.hpp"
+#include "HiZCulling.hpp"
+#include "ShadowReceiverMask.hpp"
 
 #define STATICIMPL
 
-// 绘制场景
-STATICIMPL void Renderer::DrawScene(Scene &scene, glm::mat4 &model, Shader &shaders)
+static void DrawObject(Scene &scene, Shader &shaders, size_t denseIndex)
 {
+    Object &object = scene.objectAt(denseIndex);
+    try
+    {
+        object.draw(scene.worldTransformAt(denseIndex), shaders);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error rendering object '" << object.name << "': " << e.what() << std::endl;
+    }
+}
 
-    for (auto &&[id, object] : scene)
+// BVH查询并依次执行各剔除阶段. 结果按稠密下标排序, 保持与不剔除时相同的绘制顺序
+template <typename Range>
+static CullingStats CollectSceneVisible(Scene &scene, const Range &range, const SceneCulling &culling, std::vector<uint32_t> &visibleIndices)
+{
+    visibleIndices.clear();
+    if (!Renderer::enableCulling)
     {
-        try
-        {
-            glm::mat4 obj_model = model * object->modelMatrix;
-            object->draw(obj_model, shaders);
-        }
-        catch (const std::exception &e)
+        visibleIndices.resize(scene.size());
+        std::iota(visibleIndices.begin(), visibleIndices.end(), 0u);
+        return CullingStats{scene.size(), 0};
+    }
+    scene.queryVisible(range, visibleIndices);
+    const size_t inRange = visibleIndices.size();
+    if (culling.receivers)
+    {
+        std::erase_if(visibleIndices, [&](uint32_t i)
+                      { return !culling.receivers->mayShadowReceivers(scene.worldBoundsAt(i).box); });
+    }
+    if (culling.hiZ)
+    {
+        std::erase_if(visibleIndices, [&](uint32_t i)
+                      { return !culling.hiZ->isVisible(scene.worldBoundsAt(i).box); });
+    }
+    if (MaskedOcclusionCulling *occlusion = culling.occlusion)
+    {
+        static std::vector<OccluderGeometry> geometry;
+        for (uint32_t i : visibleIndices)
         {
-            std::cerr << "Error rendering object '" << object->name << "': " << e.what() << std::endl;
+            if (!scene.isOccluderAt(i))
+                continue;
+            geometry.clear();
+            scene.objectAt(i).collectOccluderGeometry(geometry);
+            for (const auto &g : geometry)
+            {
+                occlusion->addOccluder(g.positions, g.stride, g.vertexCount, g.indices, g.indexCount, scene.worldTransformAt(i));
+            }
         }
+        occlusion->rasterize();
+        // 遮挡体自身不参与测试
+        static const AABB alwaysVisible;
+        occlusion->filterVisible(visibleIndices, [&](uint32_t i) -> const AABB &
+                                 { return scene.isOccluderAt(i) ? alwaysVisible : scene.worldBoundsAt(i).box; });
+    }
+    std::sort(visibleIndices.begin(), visibleIndices.end());
+    return CullingStats{visibleIndices.size(), scene.size() - inRange, inRange - visibleIndices.size()};
+}
+
+template <typename Range>
+static CullingStats DrawSceneVisible(Scene &scene, Shader &shaders, const Range &range, const SceneCulling &culling = {})
+{
+    static std::vector<uint32_t> visibleIndices;
+    const CullingStats stats = CollectSceneVisible(scene, range, culling, visibleIndices);
+    for (uint32_t i : visibleIndices)
+    {
+        DrawObject(scene, shaders, i);
+    }
+    return stats;
+}
+
+// 绘制场景
+STATICIMPL void Renderer::DrawScene(Scene &scene, Shader &shaders)
+{
+    for (size_t i = 0; i < scene.size(); ++i)
+    {
+        DrawObject(scene, shaders, i);
+    }
+}
+
+STATICIMPL CullingStats Renderer::DrawScene(Scene &scene, Shader &shaders, const FrustumPlanes &frustum,
+                                            const SceneCulling &culling)
+{
+    return DrawSceneVisible(scene, shaders, frustum, culling);
+}
+
+STATICIMPL CullingStats Renderer::DrawScene(Scene &scene, Shader &shaders, const BoundingSphere &range)
+{
+    return DrawSceneVisible(scene, shaders, range);
+}
+
+STATICIMPL CullingStats Renderer::CollectVisible(Scene &scene, const FrustumPlanes &frustum, const SceneCulling &culling,
+                                                 std::vector<uint32_t> &out)
+{
+    return CollectSceneVisible(scene, frustum, culling, out);
+}
+
+STATICIMPL CullingStats Renderer::CollectVisible(Scene &scene, const BoundingSphere &range, std::vector<uint32_t> &out)
+{
+    return CollectSceneVisible(scene, range, SceneCulling{}, out);
+}
+
+STATICIMPL void Renderer::DrawScene(Scene &scene, Shader &shaders, const std::vector<uint32_t> &denseIndices)
+{
+    for (uint32_t i : denseIndices)
+    {
+        DrawObject(scene, shaders, i);
     }
 }
 
@@ -79,90 +177,14 @@ STATICIMPL void Renderer::DrawQuad()
 }
 
 // 绘制公共球体. 用于生成cubemap或处理cubemap
-// 使用cubemapSphere.vs 作为顶点着色器
+// 使用cubemapSphere.vs 作为顶点着色器, 只读取位置属性
+// 球体网格来自 PrimitiveRegistry, 与场景中同参数的 Sphere 共用
 STATICIMPL void Renderer::DrawSphere()
 {
-    // 静态变量，用于存储球体的VAO和顶点数量，确保只生成一次
-    static unsigned int sphereVAO = 0;
-    static unsigned int indexCount;
-
-    // 如果球体VAO尚未生成，则进行初始化
-    if (sphereVAO == 0)
-    {
-        glGenVertexArrays(1, &sphereVAO);
-
-        unsigned int vbo, ebo;
-        glGenBuffers(1, &vbo);
-        glGenBuffers(1, &ebo);
-
-        std::vector<glm::vec3> positions;
-        std::vector<glm::vec2> uv;
-        std::vector<glm::vec3> normals;
-        std::vector<unsigned int> indices;
-
-        const unsigned int X_SEGMENTS = 64; // 经度分段数
-        const unsigned int Y_SEGMENTS = 64; // 纬度分段数
-        const float PI = 3.14159265359f;
-
-        // 生成顶点数据
-        for (unsigned int y = 0; y <= Y_SEGMENTS; ++y)
-        {
-            for (unsigned int x = 0; x <= X_SEGMENTS; ++x)
-            {
-                float xSegment = (float)x / (float)X_SEGMENTS;
-                float ySegment = (float)y / (float)Y_SEGMENTS;
-                float xPos = std::cos(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
-                float yPos = std::cos(ySegment * PI);
-                float zPos = std::sin(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
-
-                positions.push_back(glm::vec3(xPos, yPos, zPos));
-                uv.push_back(glm::vec2(xSegment, ySegment));
-                normals.push_back(glm::vec3(xPos, yPos, zPos)); // 球体的法线和位置向量相同
-            }
-        }
-
-        // 生成索引数据（用于绘制三角形）
-        for (unsigned int y = 0; y < Y_SEGMENTS; ++y)
-        {
-            for (unsigned int x = 0; x < X_SEGMENTS; ++x)
-            {
-                indices.push_back((y + 1) * (X_SEGMENTS + 1) + x);
-                indices.push_back(y * (X_SEGMENTS + 1) + x);
-                indices.push_back(y * (X_SEGMENTS + 1) + x + 1);
-
-                indices.push_back((y + 1) * (X_SEGMENTS + 1) + x);
-                indices.push_back(y * (X_SEGMENTS + 1) + x + 1);
-                indices.push_back((y + 1) * (X_SEGMENTS + 1) + x + 1);
-            }
-        }
-
-        indexCount = indices.size();
-
-        // 绑定VAO，然后绑定并填充VBO和EBO
-        glBindVertexArray(sphereVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3) + uv.size() * sizeof(glm::vec2) + normals.size() * sizeof(glm::vec3), NULL, GL_STATIC_DRAW);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, positions.size() * sizeof(glm::vec3), &positions[0]);
-        glBufferSubData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), uv.size() * sizeof(glm::vec2), &uv[0]);
-        glBufferSubData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3) + uv.size() * sizeof(glm::vec2), normals.size() * sizeof(glm::vec3), &normals[0]);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-        // 设置顶点属性指针
-        // 位置属性
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
-        // 纹理坐标属性
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void *)(positions.size() * sizeof(glm::vec3)));
-        // 法线属性
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)(positions.size() * sizeof(glm::vec3) + uv.size() * sizeof(glm::vec2)));
-    }
+    static PrimitiveHandle sphere = PrimitiveRegistry::Get().sphere(1.0f, 64, 64);
 
-    // 绘制球体
-    glBindVertexArray(sphereVAO);
-    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+    GeometryBuffer &buffer = GeometryBuffer::Standard();
+    buffer.bind();
+    buffer.draw(*sphere->geometry);
     glBindVertexArray(0);
 }
@@ -10,10 +10,14 @@
 #include "../LightSource/LightSource.hpp"
 
 #include "../Objects/Object.hpp"
+#include "../Objects/Scene.hpp"
 #include "../Objects/Grid.hpp"
 #include "../Objects/Cube.hpp"
 #include "../Objects/Sphere.hpp"
 #include "../Objects/Plane.hpp"
+#include "MaskedOcclusionCulling.hpp"
+#include "GPUDrivenCulling.hpp"
+#include "InstanceBatcher.hpp"
 
 class RenderParameters
 {
@@ -25,11 +29,53 @@ public:
     GLFWwindow *window;
 };
 
+// 单个pass一帧内的剔除统计
+struct CullingStats
+{
+    size_t visible = 0;
+    size_t culled = 0;   // 视锥/范围剔除
+    size_t occluded = 0; // 通过视锥但被软件遮挡剔除
+
+    CullingStats &operator+=(const CullingStats &other)
+    {
+        visible += other.visible;
+        culled += other.culled;
+        occluded += other.occluded;
+        return *this;
+    }
+};
+
+class HiZCulling;
+class ShadowReceiverMask;
+
+// 视锥剔除之后可选的剔除阶段, 由调用pass持有
+struct SceneCulling
+{
+    MaskedOcclusionCulling *occlusion = nullptr;   // CPU软件遮挡, 调用方负责 beginFrame
+    const HiZCulling *hiZ = nullptr;               // 上一帧GBuffer深度金字塔
+    const ShadowReceiverMask *receivers = nullptr; // 阴影: 只保留可能投影到可见接收体上的投射体
+};
+
 class Renderer
 {
 public:
-    // 绘制场景
-    static void DrawScene(Scene &scene, glm::mat4 &model, Shader &shaders);
+    // 关闭后所有pass提交全部对象, 便于对比剔除效果
+    inline static bool enableCulling = true;
+
+    // 绘制场景. 使用Scene缓存的世界矩阵,需先调用 Scene::updateTransforms
+    static void DrawScene(Scene &scene, Shader &shaders);
+    // 绘制场景, 通过Scene的BVH剔除与视锥不相交的对象. frustum 为调用pass所用的视锥
+    // culling 中的各阶段依次作用于视锥内的对象, 被剔除的计入 CullingStats::occluded
+    static CullingStats DrawScene(Scene &scene, Shader &shaders, const FrustumPlanes &frustum,
+                                  const SceneCulling &culling = {});
+    // 绘制场景, 剔除与球形范围不相交的对象. 用于点光源阴影(6个面共用一次提交)
+    static CullingStats DrawScene(Scene &scene, Shader &shaders, const BoundingSphere &range);
+    // 只绘制给定稠密下标的对象, 不做剔除. 用于GPU驱动路径中不支持间接绘制的对象
+    static void DrawScene(Scene &scene, Shader &shaders, const std::vector<uint32_t> &denseIndices);
+    // 与对应的 DrawScene 相同的剔除, 只输出按稠密下标排序的可见对象, 由调用方绘制
+    static CullingStats CollectVisible(Scene &scene, const FrustumPlanes &frustum, const SceneCulling &culling,
+                                       std::vector<uint32_t> &out);
+    static CullingStats CollectVisible(Scene &scene, const BoundingSphere &range, std::vector<uint32_t> &out);
 
     // 生成Quad并注册到OpenGL. [out]quadVAO,quadVBO
     static void GenerateQuad(unsigned int &quadVAO, unsigned int &quadVBO);
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "../Math/Bounds.hpp"
+#include "../Objects/Scene.hpp"
+
+/*
+阴影投射体剔除: 只有投影落在相机可见接收体上的投射体才需要画进阴影贴图
+在光源裁剪空间xy上建立 Resolution x Resolution 的网格, 每格记录可见接收体的最远深度.
+投射体覆盖的格子中, 只要有一格的接收体比投射体最近点更远, 就可能投下可见阴影
+*/
+class ShadowReceiverMask
+{
+public:
+    static constexpr int Resolution = 64;
+
+    /// @param lightSpaceMatrix 阴影贴图的投影*视图矩阵
+    /// @param receivers 相机可见对象的稠密下标
+    void build(const glm::mat4 &lightSpaceMatrix, const Scene &scene, const std::vector<uint32_t> &receivers)
+    {
+        m_lightSpace = lightSpaceMatrix;
+        m_maxDepth.assign(Resolution * Resolution, -std::numeric_limits<float>::infinity());
+        for (uint32_t i : receivers)
+            addReceiver(scene.worldBoundsAt(i).box);
+    }
+
+    /// @brief 在 build 之后追加不属于场景的接收体, 如地形节点
+    void addReceiver(const AABB &box)
+    {
+        Rect rect;
+        if (!box.isValid() || !project(box, rect))
+        {
+            // 无包围盒或跨过光源近平面: 视为覆盖整张阴影贴图
+            std::fill(m_maxDepth.begin(), m_maxDepth.end(), std::numeric_limits<float>::infinity());
+            return;
+        }
+        if (rect.empty)
+            return;
+        for (int y = rect.y0; y <= rect.y1; ++y)
+            for (int x = rect.x0; x <= rect.x1; ++x)
+            {
+                float &cell = m_maxDepth[y * Resolution + x];
+                cell = std::max(cell, rect.zMax);
+            }
+    }
+
+    /// @brief 投射体是否可能在可见接收体上投下阴影
+    bool mayShadowReceivers(const AABB &caster) const
+    {
+        if (!caster.isValid())
+            return true;
+        Rect rect;
+        if (!project(caster, rect))
+            return true;
+        if (rect.empty)
+            return false;
+        for (int y = rect.y0; y <= rect.y1; ++y)
+            for (int x = rect.x0; x <= rect.x1; ++x)
+            {
+                if (m_maxDepth[y * Resolution + x] >= rect.zMin)
+                    return true;
+            }
+        return false;
+    }
+
+private:
+    struct Rect
+    {
+        int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+        float zMin = 0.0f, zMax = 0.0f;
+        bool empty = true;
+    };
+
+    glm::mat4 m_lightSpace = glm::mat4(1.0f);
+    std::vector<float> m_maxDepth;
+
+    // 投影到网格. 顶点在光源后方(w<=0)时返回 false
+    bool project(const AABB &box, Rect &rect) const
+    {
+        glm::vec2 ndcMin(std::numeric_limits<float>::max());
+        glm::vec2 ndcMax(-std::numeric_limits<float>::max());
+        rect.zMin = std::numeric_limits<float>::max();
+        rect.zMax = -std::numeric_limits<float>::max();
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            const glm::vec3 p((corner & 1) ? box.max.x : box.min.x,
+                              (corner & 2) ? box.max.y : box.min.y,
+                              (corner & 4) ? box.max.z : box.min.z);
+            const glm::vec4 clip = m_lightSpace * glm::vec4(p, 1.0f);
+            if (clip.w <= 1e-5f)
+                return false;
+            const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            ndcMin = glm::min(ndcMin, glm::vec2(ndc));
+            ndcMax = glm::max(ndcMax, glm::vec2(ndc));
+            rect.zMin = std::min(rect.zMin, ndc.z);
+            rect.zMax = std::max(rect.zMax, ndc.z);
+        }
+        rect.empty = ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f;
+        if (rect.empty)
+            return true;
+        const auto toCell = [](float ndc)
+        {
+            return std::min(static_cast<int>((std::clamp(ndc, -1.0f, 1.0f) * 0.5f + 0.5f) * Resolution), Resolution - 1);
+        };
+        rect.x0 = toCell(ndcMin.x);
+        rect.y0 = toCell(ndcMin.y);
+        rect.x1 = toCell(ndcMax.x);
+        rect.y1 = toCell(ndcMax.y);
+        return true;
+    }
+};
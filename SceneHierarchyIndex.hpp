@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Objects/Scene.hpp"
+
+/*
+层次面板的行索引: 按名字排序的全部对象 + 当前过滤结果, 由 Scene::changeLog 增量维护, 不必每帧遍历场景
+过滤按不区分大小写的子串匹配. 新过滤串包含旧过滤串时只在已有结果中再筛选,
+否则从排序索引开头重新扫描, 每帧最多扫描 ScanBudget 项, 扫描期间面板显示已找到的部分
+面板只为可见行调用 ImGui(ImGuiListClipper), 开销与可见行数相关而与场景大小无关
+*/
+class SceneHierarchyIndex
+{
+public:
+    static constexpr size_t ScanBudget = 1 << 15;
+
+    struct Entry
+    {
+        std::string key; // 小写名字, 排序与匹配用
+        std::string name;
+        SceneHandle handle;
+
+        bool operator<(const Entry &other) const { return key != other.key ? key < other.key : name < other.name; }
+    };
+
+    /// @brief 每帧显示前调用, 应用场景的增删并推进过滤扫描
+    void update(Scene &scene)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const Scene::ChangeLog &log = scene.changeLog();
+        if (!m_built || log.overflow)
+        {
+            rebuild(scene);
+        }
+        else
+        {
+            for (SceneHandle handle : log.removed)
+                remove(handle);
+            for (SceneHandle handle : log.added)
+            {
+                if (scene.contains(handle))
+                    insert(handle, scene.getObject(handle).name);
+            }
+        }
+        scene.clearChangeLog();
+        scan();
+        m_lastUpdateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// @brief 设置过滤串, 空串显示全部
+    void setFilter(const std::string &filter)
+    {
+        const std::string key = ToLower(filter);
+        if (key == m_filter)
+            return;
+        const bool narrowing = !m_filter.empty() && key.find(m_filter) != std::string::npos;
+        m_filter = key;
+        if (m_filter.empty())
+        {
+            m_filtered.clear();
+            m_scanned = m_sorted.size();
+            return;
+        }
+        if (narrowing)
+        {
+            // 新结果是旧结果的子集, 已扫描部分只需在旧结果中筛选
+            std::erase_if(m_filtered, [&](const Entry &entry) { return !matches(entry); });
+            return;
+        }
+        m_filtered.clear();
+        m_scanned = 0;
+    }
+
+    /// @brief 当前显示的行, 按名字排序
+    const std::vector<Entry> &rows() const { return m_filter.empty() ? m_sorted : m_filtered; }
+    /// @brief handle 所在的行, 不在当前结果中时返回 rows().size()
+    size_t rowOf(SceneHandle handle) const
+    {
+        auto it = m_names.find(Key(handle));
+        if (it == m_names.end())
+            return rows().size();
+        const std::vector<Entry> &entries = rows();
+        const Entry probe{ToLower(it->second), it->second, handle};
+        auto row = std::lower_bound(entries.begin(), entries.end(), probe);
+        return row != entries.end() && row->handle == handle ? static_cast<size_t>(row - entries.begin()) : entries.size();
+    }
+
+    size_t objectCount() const { return m_sorted.size(); }
+    bool scanning() const { return !m_filter.empty() && m_scanned < m_sorted.size(); }
+    double lastUpdateMs() const { return m_lastUpdateMs; }
+
+private:
+    std::vector<Entry> m_sorted;
+    std::vector<Entry> m_filtered;
+    std::unordered_map<uint64_t, std::string> m_names; // 句柄 -> 名字, 删除时对象已不在场景中
+    std::string m_filter;
+    size_t m_scanned = 0; // m_sorted 中已按当前过滤串检查过的前缀长度
+    bool m_built = false;
+    double m_lastUpdateMs = 0.0;
+
+    static uint64_t Key(SceneHandle handle) { return (uint64_t(handle.index) << 32) | handle.generation; }
+
+    static std::string ToLower(const std::string &text)
+    {
+        std::string result = text;
+        for (char &c : result)
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return result;
+    }
+
+    bool matches(const Entry &entry) const { return entry.key.find(m_filter) != std::string::npos; }
+
+    void rebuild(Scene &scene)
+    {
+        m_sorted.clear();
+        m_names.clear();
+        m_sorted.reserve(scene.size());
+        for (size_t i = 0; i < scene.size(); ++i)
+        {
+            const std::string &name = scene.objectAt(i).name;
+            m_sorted.push_back(Entry{ToLower(name), name, scene.handleAt(i)});
+            m_names.emplace(Key(scene.handleAt(i)), name);
+        }
+        std::sort(m_sorted.begin(), m_sorted.end());
+        m_filtered.clear();
+        m_scanned = m_filter.empty() ? m_sorted.size() : 0;
+        m_built = true;
+    }
+
+    void insert(SceneHandle handle, const std::string &name)
+    {
+        Entry entry{ToLower(name), name, handle};
+        m_names[Key(handle)] = name;
+        auto position = std::upper_bound(m_sorted.begin(), m_sorted.end(), entry);
+        const size_t index = static_cast<size_t>(position - m_sorted.begin());
+        // 插入到已扫描的前缀内时立即判断, 否则之后的扫描会遇到它
+        if (index < m_scanned || m_filter.empty())
+        {
+            m_scanned++;
+            if (!m_filter.empty() && matches(entry))
+                m_filtered.insert(std::upper_bound(m_filtered.begin(), m_filtered.end(), entry), entry);
+        }
+        m_sorted.insert(position, std::move(entry));
+    }
+
+    void remove(SceneHandle handle)
+    {
+        auto it = m_names.find(Key(handle));
+        if (it == m_names.end())
+            return;
+        const Entry probe{ToLower(it->second), it->second, handle};
+        m_names.erase(it);
+        auto position = std::lower_bound(m_sorted.begin(), m_sorted.end(), probe);
+        if (position == m_sorted.end() || position->handle != handle)
+            return;
+        if (static_cast<size_t>(position - m_sorted.begin()) < m_scanned)
+            m_scanned--;
+        m_sorted.erase(position);
+        auto filtered = std::lower_bound(m_filtered.begin(), m_filtered.end(), probe);
+        if (filtered != m_filtered.end() && filtered->handle == handle)
+            m_filtered.erase(filtered);
+    }
+
+    void scan()
+    {
+        if (m_filter.empty())
+        {
+            m_scanned = m_sorted.size();
+            return;
+        }
+        const size_t end = std::min(m_sorted.size(), m_scanned + ScanBudget);
+        for (; m_scanned < end; ++m_scanned)
+        {
+            if (matches(m_sorted[m_scanned]))
+                m_filtered.push_back(m_sorted[m_scanned]);
+        }
+    }
+};
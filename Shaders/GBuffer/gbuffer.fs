@@ -1,21 +1,23 @@
-#version 330 core
+#version 460 core
 layout (location = 0) out vec3 gPosition;
 layout (location = 1) out vec3 gNormal;
 layout (location = 2) out vec4 gAlbedoSpec;
 layout (location = 3) out vec3 gViewPosition;
+// 对象ID附件未开启时没有对应的绘制缓冲, 写入被丢弃
+layout (location = 4) out uint gObjectId;
 
 in vec2 TexCoord;
 in vec3 FragPos;
 in vec3 Normal;
 in vec3 ViewFragPos;
+flat in int MaterialId;
+flat in uint ObjectId;
 
 /*****************视口大小******************************************************************/
 uniform int width = 1600;
 uniform int height = 900;
 
-uniform int enable_tex = 0;
-uniform sampler2D texture_diff;  //diff纹理单元句柄
-uniform sampler2D texture_spec;  //spec纹理单元句柄
+#include "material.glsl"
 // out vec4 FragColor;
 
 void main() {
@@ -26,10 +28,12 @@ void main() {
     gNormal = normalize(Normal);
     // gNormal = vec3(0.7f,0.7f,0.7f); // Placeholder value for demonstration
     // and the diffuse per-fragment color
-    gAlbedoSpec.rgb = (enable_tex==1)? vec3(texture(texture_diff, TexCoord).rgb) : vec3(1.f);
+    Material material = materials[MaterialId];
+    gAlbedoSpec.rgb = (material.diffuseArray >= 0)? texture(materialTextures[material.diffuseArray], vec3(TexCoord, material.diffuseLayer)).rgb : vec3(1.f);
     // store specular intensity in gAlbedoSpec's alpha component
-    gAlbedoSpec.a = (enable_tex==1)?texture(texture_spec, TexCoord).r: 1.f;
+    gAlbedoSpec.a = (material.specularArray >= 0)? texture(materialTextures[material.specularArray], vec3(TexCoord, material.specularLayer)).r : 1.f;
     gViewPosition = ViewFragPos;
+    gObjectId = ObjectId;
 
     // FragColor = vec4(gPosition, 1.0f); // For debugging purposes, output gPosition
     // FragColor = vec4(gNormal, 1.0f); // For debugging purposes, output gNormal
@@ -1,4 +1,4 @@
-#version 330 core
+#version 460 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoord;
@@ -6,11 +6,15 @@ layout(location = 2) in vec2 aTexCoord;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform int materialId = 0;
+uniform int objectId = 0; // 稠密下标 + 1, 0 表示不可拾取
 
 out vec3 Normal;
 out vec3 FragPos;
 out vec2 TexCoord;
 out vec3 ViewFragPos;
+flat out int MaterialId;
+flat out uint ObjectId;
 
 void main() {
     gl_Position = projection*view*model*vec4(aPos, 1.0);
@@ -18,4 +22,6 @@ void main() {
     Normal = mat3(transpose(inverse(model))) * aNormal;
     TexCoord = vec2(aTexCoord.x, aTexCoord.y);
     ViewFragPos = vec3((view*model * vec4(aPos, 1.0)).xyz);
+    MaterialId = materialId;
+    ObjectId = uint(objectId);
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+
+// GPU驱动/实例化绘制: 世界矩阵来自 baseInstance 起的第 gl_InstanceID 项
+#include "../GPUDriven/drawObject.glsl"
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// 间接绘制时材质编号由剔除着色器逐命令写出, 下标为 materialCommandBase + gl_DrawID
+// 实例化绘制时为 -1, 改用 materialId
+layout(std430, binding = 4) readonly buffer CommandMaterials
+{
+    uint commandMaterials[];
+};
+uniform int materialCommandBase = -1;
+uniform int materialId = 0;
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 TexCoord;
+out vec3 ViewFragPos;
+flat out int MaterialId;
+flat out uint ObjectId;
+
+void main() {
+    const DrawObject object = objects[gl_BaseInstance + gl_InstanceID];
+    mat4 model = object.model;
+    gl_Position = projection*view*model*vec4(aPos, 1.0);
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+    ViewFragPos = vec3((view*model * vec4(aPos, 1.0)).xyz);
+    MaterialId = (materialCommandBase >= 0)? int(commandMaterials[materialCommandBase + gl_DrawID]) : materialId;
+    ObjectId = uint(object.boundsMax.w) + 1u;
+}
@@ -0,0 +1,17 @@
+// 材质表, 与 MaterialLibrary::MaterialData 布局一致, 下标 -1 表示无纹理
+struct Material
+{
+    int diffuseArray;
+    int diffuseLayer;
+    int specularArray;
+    int specularLayer;
+};
+
+layout(std430, binding = 5) readonly buffer Materials
+{
+    Material materials[];
+};
+
+// 按尺寸分组的纹理数组, 数量与 MaterialLibrary::MaxTextureArrays 一致
+// 同一次绘制内数组下标必须一致, 由 MaterialLibrary::batchKey 保证
+uniform sampler2DArray materialTextures[8];
@@ -0,0 +1,12 @@
+// GPU驱动绘制的场景对象, 与 GPUDrivenCulling::DrawObject 布局一致, 按稠密下标排列
+struct DrawObject
+{
+    mat4 model;
+    vec4 boundsMin; // w=1 时包围盒有效
+    vec4 boundsMax; // w 为对象的稠密下标(GBuffer对象ID), 小于 2^24 时精确
+};
+
+layout(std430, binding = 0) readonly buffer DrawObjects
+{
+    DrawObject objects[];
+};
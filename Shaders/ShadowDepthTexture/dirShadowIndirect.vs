@@ -0,0 +1,11 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+
+// GPU驱动/实例化绘制: 世界矩阵来自 baseInstance 起的第 gl_InstanceID 项
+#include "../GPUDriven/drawObject.glsl"
+
+uniform mat4 lightSpaceMatrix;
+
+void main() {
+    gl_Position = lightSpaceMatrix * objects[gl_BaseInstance + gl_InstanceID].model * vec4(aPos, 1.0);
+}
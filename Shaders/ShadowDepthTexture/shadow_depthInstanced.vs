@@ -0,0 +1,10 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+
+// 实例化绘制: 世界矩阵来自 baseInstance 起的第 gl_InstanceID 项
+#include "../GPUDriven/drawObject.glsl"
+
+void main()
+{
+    gl_Position = objects[gl_BaseInstance + gl_InstanceID].model * vec4(aPos, 1.0); // only model transformation, VP transformation is for GS
+}
@@ -7,6 +7,14 @@ vec2 SATLookUp(in sampler2D SAT, in vec2 uvMin, in vec2 uvMax)
     vec2 D = uvMax;
     return texture(SAT, D).rg - texture(SAT, B).rg - texture(SAT, C).rg + texture(SAT, A).rg;
 }
+vec2 SATLookUp(in sampler2DArray SAT, int layer, in vec2 uvMin, in vec2 uvMax)
+{
+    vec2 A = uvMin;
+    vec2 B = vec2(uvMax.x, uvMin.y);
+    vec2 C = vec2(uvMin.x, uvMax.y);
+    vec2 D = uvMax;
+    return texture(SAT, vec3(D, layer)).rg - texture(SAT, vec3(B, layer)).rg - texture(SAT, vec3(C, layer)).rg + texture(SAT, vec3(A, layer)).rg;
+}
 // 还原深度偏移
 float reverseDepthBias(float moment)
 {
@@ -38,6 +46,31 @@ vec2 getVSSMMoments(sampler2D satTex, vec2 uv, float kernelSize)
     return moments.rg;
 }
 
+vec2 getVSSMMoments(sampler2DArray satTex, int layer, vec2 uv, float kernelSize)
+{
+    vec2 stride = 1.0 / vec2(textureSize(satTex, 0).xy);
+
+    float xmax = uv.x + kernelSize * stride.x;
+    float xmin = uv.x - kernelSize * stride.x;
+    float ymax = uv.y + kernelSize * stride.y;
+    float ymin = uv.y - kernelSize * stride.y;
+
+    vec4 A = texture(satTex, vec3(xmin, ymin, layer));
+    vec4 B = texture(satTex, vec3(xmax, ymin, layer));
+    vec4 C = texture(satTex, vec3(xmin, ymax, layer));
+    vec4 D = texture(satTex, vec3(xmax, ymax, layer));
+
+    float sPenumbra = 2.0 * kernelSize;
+
+    vec4 moments = (D + A - B - C) / float(sPenumbra * sPenumbra);
+    if (useBias == 1)
+    {
+        moments.x = reverseDepthBias(moments.x);
+        moments.y = reverseDepthBias(moments.y);
+    }
+    return moments.rg;
+}
+
 float chebyshev(vec2 moments, float currentDepth)
 {
     const float MIN_VAR = 1e-5;
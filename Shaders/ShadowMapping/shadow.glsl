@@ -2,7 +2,7 @@
 
 float computeDirLightShadowVSM(vec3 fragPos, vec3 fragNormal, in DirLight dirLight)
 {
-    if (DirShadow == 0)
+    if (DirShadow == 0 || dirLight.shadowArray < 0)
     {
         return 0.f;
     }
@@ -23,7 +23,7 @@ float computeDirLightShadowVSM(vec3 fragPos, vec3 fragNormal, in DirLight dirLig
     {
         return 0.0f;
     }
-    vec4 moments = texture(dirLight.VSMTexture, projCoords.xy);
+    vec4 moments = texture(dirVSMMaps[dirLight.shadowArray], vec3(projCoords.xy, dirLight.shadowLayer));
     float depthAvg = moments.r;
     float depthSquareAvg = moments.g;
 
@@ -43,7 +43,7 @@ float computeDirLightShadowVSM(vec3 fragPos, vec3 fragNormal, in DirLight dirLig
 
 float computeDirLightShadowVSMSAT(vec3 fragPos, vec3 fragNormal, in DirLight dirLight)
 {
-    if (DirShadow == 0)
+    if (DirShadow == 0 || dirLight.shadowArray < 0)
     {
         return 0.f;
     }
@@ -65,11 +65,11 @@ float computeDirLightShadowVSMSAT(vec3 fragPos, vec3 fragNormal, in DirLight dir
     {
         return 0.0f;
     }
-    // vec4 moments = texture(dirLight.VSMTexture, projCoords.xy);
+    // vec4 moments = texture(dirVSMMaps[dirLight.shadowArray], vec3(projCoords.xy, dirLight.shadowLayer));
     // float depthAvg = moments.r;
     // float depthSquareAvg = moments.g;
 
-    vec2 texSize = textureSize(dirLight.SATTexture, 0);
+    vec2 texSize = textureSize(dirSATMaps[dirLight.shadowArray], 0).xy;
     float kernelSize = VSSMKernelSize;
     vec2 halfKernel = vec2(kernelSize) * 0.5;
     // 计算搜索区域的 UV 坐标
@@ -80,11 +80,11 @@ float computeDirLightShadowVSMSAT(vec3 fragPos, vec3 fragNormal, in DirLight dir
     float kernelArea = (uvMax.x - uvMin.x) * (uvMax.y - uvMin.y) * texSize.x * texSize.y;
 
     // 获取深度总和，然后计算均值
-    float sumZ = SATLookUp(dirLight.SATTexture, uvMin, uvMax).r;
+    float sumZ = SATLookUp(dirSATMaps[dirLight.shadowArray], dirLight.shadowLayer, uvMin, uvMax).r;
     float depthAvg = sumZ / kernelArea;
 
     // 获取深度平方总和，然后计算均值
-    float sumZ2 = SATLookUp(dirLight.SATTexture, uvMin, uvMax).g;
+    float sumZ2 = SATLookUp(dirSATMaps[dirLight.shadowArray], dirLight.shadowLayer, uvMin, uvMax).g;
     float depthSquareAvg = sumZ2 / kernelArea;
 
     // 还原深度偏移
@@ -120,7 +120,7 @@ float computeDirLightShadowVSMSAT(vec3 fragPos, vec3 fragNormal, in DirLight dir
 // 返回阴影系数
 float computeDirLightShadowVSSM(vec3 fragPos, vec3 fragNormal, in DirLight dirLight)
 {
-    if (DirShadow == 0)
+    if (DirShadow == 0 || dirLight.shadowArray < 0)
     {
         return 0.f;
     }
@@ -135,14 +135,14 @@ float computeDirLightShadowVSSM(vec3 fragPos, vec3 fragNormal, in DirLight dirLi
     float lightSize = VSSMKernelSize * 5.f;
 
     float searchSize = lightSize;
-    vec2 moments = getVSSMMoments(dirLight.SATTexture, projCoords.xy, searchSize);
+    vec2 moments = getVSSMMoments(dirSATMaps[dirLight.shadowArray], dirLight.shadowLayer, projCoords.xy, searchSize);
 
     if (currentDepth >= 0.99f)
     {
         return 0.f;
     }
     // Blocker Searching
-    float border = searchSize / textureSize(dirLight.SATTexture, 0).x;
+    float border = searchSize / textureSize(dirSATMaps[dirLight.shadowArray], 0).x;
     // just cut out the no padding area according to the sarched area size
     if (projCoords.x <= border || projCoords.x >= 0.99f - border)
     {
@@ -168,7 +168,7 @@ float computeDirLightShadowVSSM(vec3 fragPos, vec3 fragNormal, in DirLight dirLi
     {
         return 0.0f;
     }
-    moments = getVSSMMoments(dirLight.SATTexture, projCoords.xy, wPenumbra);
+    moments = getVSSMMoments(dirSATMaps[dirLight.shadowArray], dirLight.shadowLayer, projCoords.xy, wPenumbra);
 
     if (currentDepth > 1.0) // 当前深度大于1 认为没有遮挡
     {
@@ -191,7 +191,7 @@ float computeDirLightShadowVSSM(vec3 fragPos, vec3 fragNormal, in DirLight dirLi
 float computeDirLightShadow(vec3 fragPos, vec3 fragNormal, in DirLight dirLight)
 {
     // perform perspective divide
-    if (DirShadow == 0)
+    if (DirShadow == 0 || dirLight.shadowArray < 0)
     {
         return 0.f;
     }
@@ -208,7 +208,7 @@ float computeDirLightShadow(vec3 fragPos, vec3 fragNormal, in DirLight dirLight)
     //     // transform to [0,1] range
     //     projCoords = projCoords * 0.5 + 0.5;
     //     // get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-    //     float closestDepth = texture(dirLight.depthMap, projCoords.xy).r;
+    //     float closestDepth = texture(dirShadowMaps[dirLight.shadowArray], vec3(projCoords.xy, dirLight.shadowLayer)).r;
     //     // get depth of current fragment from light's perspective
     //     float currentDepth = projCoords.z;
 
@@ -245,7 +245,7 @@ float computeDirLightShadow(vec3 fragPos, vec3 fragNormal, in DirLight dirLight)
             continue;
         }
         // get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-        float closestDepth = texture(dirLight.depthMap, projCoords.xy).r;
+        float closestDepth = texture(dirShadowMaps[dirLight.shadowArray], vec3(projCoords.xy, dirLight.shadowLayer)).r;
         // get depth of current fragment from light's perspective
         float currentDepth = projCoords.z;
 
@@ -265,7 +265,7 @@ float computeDirLightShadow(vec3 fragPos, vec3 fragNormal, in DirLight dirLight)
 float computeDirLightShadowPCSS(vec3 fragPos, vec3 fragNormal, in DirLight dirLight)
 {
     // perform perspective divide
-    if (DirShadow == 0)
+    if (DirShadow == 0 || dirLight.shadowArray < 0)
     {
         return 0.f;
     }
@@ -282,7 +282,7 @@ float computeDirLightShadowPCSS(vec3 fragPos, vec3 fragNormal, in DirLight dirLi
         // transform to [0,1] range
         projCoords = projCoords * 0.5 + 0.5;
         // get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-        float closestDepth = texture(dirLight.depthMap, projCoords.xy).r;
+        float closestDepth = texture(dirShadowMaps[dirLight.shadowArray], vec3(projCoords.xy, dirLight.shadowLayer)).r;
         // get depth of current fragment from light's perspective
         float currentDepth = projCoords.z;
 
@@ -313,7 +313,7 @@ float computeDirLightShadowPCSS(vec3 fragPos, vec3 fragNormal, in DirLight dirLi
             continue;
         }
         // get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-        float closestDepth = texture(dirLight.depthMap, projCoords.xy).r;
+        float closestDepth = texture(dirShadowMaps[dirLight.shadowArray], vec3(projCoords.xy, dirLight.shadowLayer)).r;
         // get depth of current fragment from light's perspective
         float currentDepth = projCoords.z;
 
@@ -332,7 +332,7 @@ float computeDirLightShadowPCSS(vec3 fragPos, vec3 fragNormal, in DirLight dirLi
 
 float computePointLightShadowVSM(vec3 fragPos, vec3 fragNorm, in PointLight pointLight)
 {
-    if (PointShadow == 0)
+    if (PointShadow == 0 || pointLight.shadowArray < 0)
     {
         return 0.f;
     }
@@ -346,7 +346,7 @@ float computePointLightShadowVSM(vec3 fragPos, vec3 fragNorm, in PointLight poin
     {
         return 0.0f;
     }
-    vec2 moments = texture(pointLight.VSMCubemap, dir).rg;
+    vec2 moments = texture(pointVSMMaps[pointLight.shadowArray], vec4(dir, pointLight.shadowLayer)).rg;
     float depthAvg = moments.r;
     float depthSquareAvg = moments.g;
 
@@ -366,7 +366,7 @@ float computePointLightShadowVSM(vec3 fragPos, vec3 fragNorm, in PointLight poin
 
 float computePointLightShadowPCSS(vec3 fragPos, vec3 fragNorm, in PointLight pointLight)
 {
-    if (PointShadow == 0)
+    if (PointShadow == 0 || pointLight.shadowArray < 0)
     {
         return 0.f;
     }
@@ -385,7 +385,7 @@ float computePointLightShadowPCSS(vec3 fragPos, vec3 fragNorm, in PointLight poi
         vec3 sampleOffset = TBN * shadowSamples[k] * 4.f;
         vec3 dir_sample = sampleOffset + fragPos - pointLight.pos;
         float curr_depth_sample = length(dir_sample);
-        float cloest_depth_sample = texture(pointLight.depthCubemap, dir_sample).r;
+        float cloest_depth_sample = texture(pointShadowMaps[pointLight.shadowArray], vec4(dir_sample, pointLight.shadowLayer)).r;
 
         cloest_depth_sample *= pointLight.farPlane;
         if (curr_depth_sample - cloest_depth_sample - bias > 0.01f)
@@ -401,7 +401,7 @@ float computePointLightShadowPCSS(vec3 fragPos, vec3 fragNorm, in PointLight poi
         vec3 sampleOffset = TBN * shadowSamples[j] * blurRadius * pow(curr_depth / 12, 2) * d / n_samples * 64;
         vec3 dir_sample = sampleOffset + fragPos - pointLight.pos;
         float curr_depth_sample = length(dir_sample);
-        float cloest_depth_sample = texture(pointLight.depthCubemap, dir_sample).r;
+        float cloest_depth_sample = texture(pointShadowMaps[pointLight.shadowArray], vec4(dir_sample, pointLight.shadowLayer)).r;
         cloest_depth_sample *= pointLight.farPlane;
         factor += (curr_depth_sample - cloest_depth_sample - bias > 0.f ? 1.0 : 0.0);
         // factor = curr_depth_sample;
@@ -411,7 +411,7 @@ float computePointLightShadowPCSS(vec3 fragPos, vec3 fragNorm, in PointLight poi
 
 float computePointLightShadowPCF(vec3 fragPos, vec3 fragNorm, in PointLight pointLight)
 {
-    if (PointShadow == 0)
+    if (PointShadow == 0 || pointLight.shadowArray < 0)
     {
         return 0.f;
     }
@@ -427,7 +427,7 @@ float computePointLightShadowPCF(vec3 fragPos, vec3 fragNorm, in PointLight poin
         vec3 sampleOffset = TBN * shadowSamples[j] / n_samples * 64;
         vec3 dir_sample = sampleOffset + fragPos - pointLight.pos;
         float curr_depth_sample = length(dir_sample);
-        float cloest_depth_sample = texture(pointLight.depthCubemap, dir_sample).r;
+        float cloest_depth_sample = texture(pointShadowMaps[pointLight.shadowArray], vec4(dir_sample, pointLight.shadowLayer)).r;
         cloest_depth_sample *= pointLight.farPlane;
         factor += (curr_depth_sample - cloest_depth_sample - bias > 0.f ? 1.0 : 0.0);
         // factor = curr_depth_sample;
@@ -0,0 +1,41 @@
+#version 460 core
+layout (location = 0) out vec3 gPosition;
+layout (location = 1) out vec3 gNormal;
+layout (location = 2) out vec4 gAlbedoSpec;
+layout (location = 3) out vec3 gViewPosition;
+layout (location = 4) out uint gObjectId; // 地形不是场景对象, 不可拾取
+
+in vec3 FragPos;
+in vec3 ViewFragPos;
+in float Morph;
+flat in vec4 Source;
+flat in int Level;
+
+#include "terrain.glsl"
+
+uniform int showLevels = 0;
+
+const vec3 levelColors[6] = vec3[](vec3(1.0, 0.3, 0.3), vec3(1.0, 0.7, 0.2), vec3(0.9, 1.0, 0.3),
+                                   vec3(0.3, 1.0, 0.4), vec3(0.3, 0.7, 1.0), vec3(0.7, 0.4, 1.0));
+
+void main() {
+    // 法线逐像素从高度纹理计算, 粗节点也保留高度图的细节
+    const vec3 normal = terrainNormal(Source, FragPos.xz);
+    const float slope = 1.0 - normal.y;
+    const float height = (FragPos.y - baseHeight) / max(heightScale, 1e-4);
+
+    // 按坡度与高度混合草地, 岩石与积雪
+    const vec3 grass = vec3(0.28, 0.42, 0.18);
+    const vec3 rock = vec3(0.42, 0.38, 0.34);
+    const vec3 snow = vec3(0.92, 0.93, 0.95);
+    vec3 albedo = mix(grass, rock, smoothstep(0.15, 0.35, slope));
+    albedo = mix(albedo, snow, smoothstep(0.7, 0.8, height) * (1.0 - smoothstep(0.3, 0.5, slope)));
+    if (showLevels != 0)
+        albedo = mix(levelColors[Level % 6], levelColors[(Level + 1) % 6], Morph);
+
+    gPosition = FragPos;
+    gNormal = normal;
+    gAlbedoSpec = vec4(albedo, 0.1);
+    gViewPosition = ViewFragPos;
+    gObjectId = 0u;
+}
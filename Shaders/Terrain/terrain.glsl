@@ -0,0 +1,52 @@
+// CDLOD地形的公共部分, 与 Terrain(Objects/Terrain.hpp) 对应
+
+// 与 Terrain::NodeInstance 布局一致
+struct TerrainNode
+{
+    vec4 node;   // 世界坐标xz起点, 边长, LOD级别
+    vec4 source; // 高度纹理坐标 uv = xz * source.z + source.xy, source.w 为瓦片层, < 0 为概览
+};
+
+// 绑定点与 Terrain::NodeBinding 一致, 下标为 gl_BaseInstance + gl_InstanceID
+layout(std430, binding = 6) readonly buffer TerrainNodes
+{
+    TerrainNode terrainNodes[];
+};
+
+uniform sampler2D terrainOverview;
+uniform sampler2DArray terrainTiles;
+uniform vec3 lodCamera;       // 主相机位置, 所有pass相同
+uniform vec4 morphRanges[16]; // 每级过渡的起点与 1 / 长度, 长度与 Terrain::MaxLevels 一致
+uniform float gridQuads;
+uniform float heightScale;
+uniform float baseHeight;
+
+float terrainHeight(vec4 source, vec2 xz)
+{
+    const vec2 uv = xz * source.z + source.xy;
+    const float h = source.w < 0.0 ? textureLod(terrainOverview, uv, 0.0).r : textureLod(terrainTiles, vec3(uv, source.w), 0.0).r;
+    return baseHeight + h * heightScale;
+}
+
+// 中心差分, 步长为高度纹理的一个采样
+vec3 terrainNormal(vec4 source, vec2 xz)
+{
+    const float size = source.w < 0.0 ? float(textureSize(terrainOverview, 0).x) : float(textureSize(terrainTiles, 0).x);
+    const float texel = 1.0 / (source.z * size);
+    const float dx = terrainHeight(source, xz + vec2(texel, 0.0)) - terrainHeight(source, xz - vec2(texel, 0.0));
+    const float dz = terrainHeight(source, xz + vec2(0.0, texel)) - terrainHeight(source, xz - vec2(0.0, texel));
+    return normalize(vec3(-dx, 2.0 * texel, -dz));
+}
+
+// 网格坐标 (0~1) 对应的世界坐标. 过渡系数按未吸附位置到主相机的距离计算, 奇数顶点按系数移向上一级网格的顶点
+vec3 terrainPosition(TerrainNode terrain, vec2 grid, out float morph)
+{
+    const vec2 xz = terrain.node.xy + grid * terrain.node.z;
+    const vec4 range = morphRanges[int(terrain.node.w)];
+    const float cameraDistance = length(vec3(xz.x, terrainHeight(terrain.source, xz), xz.y) - lodCamera);
+    morph = clamp((cameraDistance - range.x) * range.y, 0.0, 1.0);
+
+    const vec2 fraction = fract(grid * gridQuads * 0.5) * 2.0 / gridQuads;
+    const vec2 morphed = terrain.node.xy + (grid - fraction * morph) * terrain.node.z;
+    return vec3(morphed.x, terrainHeight(terrain.source, morphed), morphed.y);
+}
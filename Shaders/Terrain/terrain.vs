@@ -0,0 +1,25 @@
+#version 460 core
+layout (location = 0) in vec2 aGrid;
+
+#include "terrain.glsl"
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 FragPos;
+out vec3 ViewFragPos;
+out float Morph;
+flat out vec4 Source;
+flat out int Level;
+
+void main() {
+    const TerrainNode terrain = terrainNodes[gl_BaseInstance + gl_InstanceID];
+    float morph;
+    const vec3 position = terrainPosition(terrain, aGrid, morph);
+    gl_Position = projection * view * vec4(position, 1.0);
+    FragPos = position;
+    ViewFragPos = vec3(view * vec4(position, 1.0));
+    Morph = morph;
+    Source = terrain.source;
+    Level = int(terrain.node.w);
+}
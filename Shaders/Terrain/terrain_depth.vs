@@ -0,0 +1,13 @@
+#version 460 core
+layout (location = 0) in vec2 aGrid;
+
+#include "terrain.glsl"
+
+// 平行光阴影为光源的投影*视图矩阵; 点光源阴影为单位矩阵, 由几何着色器投影到6个面
+uniform mat4 viewProjection;
+
+void main() {
+    float morph;
+    const vec3 position = terrainPosition(terrainNodes[gl_BaseInstance + gl_InstanceID], aGrid, morph);
+    gl_Position = viewProjection * vec4(position, 1.0);
+}
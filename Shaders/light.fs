@@ -1,5 +1,5 @@
 
-#version 330 core
+#version 460 core
 out vec4 LightResult;
 in vec2 TexCoord;
 
@@ -19,14 +19,10 @@ uniform samplerCube depthMap; // debug
 uniform sampler2D ssaoTex;
 
 /*****************点光源设置******************************************************************/
-const int MAX_POINT_LIGHTS = 10; // Maximum number of lights supported
-uniform int numPointLights;      // actual number of lights used
-uniform PointLight pointLightArray[MAX_POINT_LIGHTS];
+uniform int numPointLights; // 光源表 pointLights 中的光源数
 uniform int usePCSS;
 /*****************定向光源设置******************************************************************/
-const int MAX_DIR_LIGHTS = 5; // Maximum number of lights supported
-uniform int numDirLights;     // actual number of lights used
-uniform DirLight dirLightArray[MAX_DIR_LIGHTS];
+uniform int numDirLights; // 光源表 dirLights 中的光源数
 vec3 sunlightDecay;
 uniform int useBias; // 是否使用深度偏移
 uniform int useVSSM;
@@ -142,30 +138,30 @@ vec3 dirLightDiffuse(vec3 fragPos, vec3 n)
     for (int i = 0; i < numDirLights; ++i)
     {
 
-        vec3 l = normalize(dirLightArray[i].pos);
+        vec3 l = normalize(dirLights[i].pos);
         float rr = dot(l, l);
         float litFactor = 0.0f;
-        // if (dirLightArray[i].useVSM == 0)
+        // if (dirLights[i].useVSM == 0)
         // {
 
         //     if (usePCSS == 1)
         //     {
-        //         litFactor = 1 - computeDirLightShadowPCSS(fragPos, n, dirLightArray[i]);
+        //         litFactor = 1 - computeDirLightShadowPCSS(fragPos, n, dirLights[i]);
         //     }
         //     else
         //     {
-        //         litFactor = 1 - computeDirLightShadow(fragPos, n, dirLightArray[i]);
+        //         litFactor = 1 - computeDirLightShadow(fragPos, n, dirLights[i]);
         //     }
         // }
         // else
         // {
         //     if (useVSSM == 1)
         //     {
-        //         litFactor = 1 - computeDirLightShadowVSSM(fragPos, n, dirLightArray[i]);
+        //         litFactor = 1 - computeDirLightShadowVSSM(fragPos, n, dirLights[i]);
         //     }
         //     else
         //     {
-        //         litFactor = 1 - computeDirLightShadowVSM(fragPos, n, dirLightArray[i]);
+        //         litFactor = 1 - computeDirLightShadowVSM(fragPos, n, dirLights[i]);
         //     }
         // }
         
@@ -173,12 +169,12 @@ vec3 dirLightDiffuse(vec3 fragPos, vec3 n)
         
         if (i == 0) // 太阳光处理
         {
-            diffuse += (litFactor)*dirLightArray[i].intensity / rr * max(0.f, dot(n, l)) * sunlightDecay;
+            diffuse += (litFactor)*dirLights[i].intensity / rr * max(0.f, dot(n, l)) * sunlightDecay;
         }
         else
         {
             diffuse +=
-                litFactor * dirLightArray[i].intensity / rr * max(0.f, dot(n, l));
+                litFactor * dirLights[i].intensity / rr * max(0.f, dot(n, l));
         }
     }
     return diffuse;
@@ -191,35 +187,35 @@ vec3 dirLightSpec(vec3 fragPos, vec3 n)
     {
         // 太阳光处理
 
-        vec3 l = normalize(dirLightArray[i].pos);
+        vec3 l = normalize(dirLights[i].pos);
         float specularStrength = 0.01f;
         vec3 viewDir = normalize(eyePos - fragPos);
         vec3 reflectDir = reflect(-l, n);
         float litFactor = 0.0f;
-        if (dirLightArray[i].useVSM == 0)
+        if (dirLights[i].useVSM == 0)
         {
-            litFactor = 1 - computeDirLightShadow(fragPos, n, dirLightArray[i]);
+            litFactor = 1 - computeDirLightShadow(fragPos, n, dirLights[i]);
         }
         else
         {
             if (useVSSM == 1)
             {
-                litFactor = 1 - computeDirLightShadowVSSM(fragPos, n, dirLightArray[i]);
+                litFactor = 1 - computeDirLightShadowVSSM(fragPos, n, dirLights[i]);
             }
             else
             {
-                litFactor = 1 - computeDirLightShadowVSM(fragPos, n, dirLightArray[i]);
+                litFactor = 1 - computeDirLightShadowVSM(fragPos, n, dirLights[i]);
             }
         }
         float spec = pow(max(dot(viewDir, reflectDir), 0.0), 128);
 
         if (i == 0) // 太阳光处理
         {
-            specular += litFactor * specularStrength * spec * dirLightArray[i].intensity * sunlightDecay * 160;
+            specular += litFactor * specularStrength * spec * dirLights[i].intensity * sunlightDecay * 160;
         }
         else
         {
-            specular += litFactor * specularStrength * spec * dirLightArray[i].intensity * 160;
+            specular += litFactor * specularStrength * spec * dirLights[i].intensity * 160;
         }
     }
     return specular;
@@ -231,27 +227,27 @@ vec3 pointLightDiffuse(vec3 fragPos, vec3 n)
 
     for (int i = 0; i < numPointLights; ++i)
     {
-        vec3 l = pointLightArray[i].pos - fragPos;
+        vec3 l = pointLights[i].pos - fragPos;
         float rr = pow(dot(l, l), 0.6) * 10;
         l = normalize(l);
 
         float litfactor = 0.0f;
-        if (pointLightArray[i].useVSM == 0)
+        if (pointLights[i].useVSM == 0)
         {
             if (usePCSS == 1)
             {
-                litfactor = 1 - computePointLightShadowPCSS(fragPos, n, pointLightArray[i]);
+                litfactor = 1 - computePointLightShadowPCSS(fragPos, n, pointLights[i]);
             }
             else
             {
-                litfactor = 1 - computePointLightShadowPCF(fragPos, n, pointLightArray[i]);
+                litfactor = 1 - computePointLightShadowPCF(fragPos, n, pointLights[i]);
             }
         }
         else
         {
-            litfactor = 1 - computePointLightShadowVSM(fragPos, n, pointLightArray[i]);
+            litfactor = 1 - computePointLightShadowVSM(fragPos, n, pointLights[i]);
         }
-        diffuse += pointLightArray[i].intensity / rr * max(0.f, dot(n, l)) * (litfactor);
+        diffuse += pointLights[i].intensity / rr * max(0.f, dot(n, l)) * (litfactor);
     }
     return diffuse;
 }
@@ -262,45 +258,53 @@ vec3 pointLightSpec(vec3 fragPos, vec3 n)
 
     for (int i = 0; i < numPointLights; ++i)
     {
-        vec3 l = pointLightArray[i].pos - fragPos;
+        vec3 l = pointLights[i].pos - fragPos;
         float rr = pow(dot(l, l), 0.6) * 10;
         l = normalize(l);
         float spec = 0.f;
         float specularStrength = 0.005f;
 
         float litfactor = 0.0f;
-        if (pointLightArray[i].useVSM == 0)
+        if (pointLights[i].useVSM == 0)
         {
             if (usePCSS == 1)
             {
-                litfactor = 1 - computePointLightShadowPCSS(fragPos, n, pointLightArray[i]);
+                litfactor = 1 - computePointLightShadowPCSS(fragPos, n, pointLights[i]);
             }
             else
             {
-                litfactor = 1 - computePointLightShadowPCF(fragPos, n, pointLightArray[i]);
+                litfactor = 1 - computePointLightShadowPCF(fragPos, n, pointLights[i]);
             }
         }
         else
         {
-            litfactor = 1 - computePointLightShadowVSM(fragPos, n, pointLightArray[i]);
+            litfactor = 1 - computePointLightShadowVSM(fragPos, n, pointLights[i]);
         }
 
         vec3 viewDir = normalize(eyePos - fragPos);
         vec3 reflectDir = reflect(-l, n);
         spec = pow(max(dot(viewDir, reflectDir), 0.0), 64);
-        specular += specularStrength * spec * pointLightArray[i].intensity * litfactor;
+        specular += specularStrength * spec * pointLights[i].intensity * litfactor;
     }
     return specular;
 }
 
+// 第一个方向光源作为太阳. 光源表中没有方向光源时使用默认太阳(与 DirectionLight 的默认参数一致), 不越界读取
+vec3 sunIntensity = vec3(0.1f);
+
 void initializeAtmosphereParameters()
 {
 
     camDir = fragViewSpaceDir(TexCoord);
     camPos = eyePos;
     earthCenter = vec3(0.0f, -earthRadius, 0.0f); // 地球球心，位于地面原点正下方
-    sunDir = dirLightArray[0].pos;
-    sunlightDecay = computeSunlightDecay(camPos, camDir, dirLightArray[0].pos);
+    sunDir = vec3(50.f, 20.f, 60.f);
+    if (numDirLights > 0)
+    {
+        sunDir = dirLights[0].pos;
+        sunIntensity = dirLights[0].intensity;
+    }
+    sunlightDecay = computeSunlightDecay(camPos, camDir, sunDir);
 }
 
 void computeSkyAtmosphere(in out vec4 LightResult, in vec3 ambient, in vec3 n)
@@ -316,14 +320,14 @@ void computeSkyAtmosphere(in out vec4 LightResult, in vec3 ambient, in vec3 n)
         }
         else
         {
-            LightResult.rgb += computeSkyColor(dirLightArray[0].intensity).rgb;
+            LightResult.rgb += computeSkyColor(sunIntensity).rgb;
         }
-        LightResult.rgb += generateSunDisk(camPos, camDir, sunDir, dirLightArray[0].intensity, 2.0f);
+        LightResult.rgb += generateSunDisk(camPos, camDir, sunDir, sunIntensity, 2.0f);
     }
     else
     {
         // 击中地球,渲染大气透视
-        LightResult.rgb += computeAerialPerspective(camEarthIntersection, dirLightArray[0].intensity).rgb;
+        LightResult.rgb += computeAerialPerspective(camEarthIntersection, sunIntensity).rgb;
 
         vec4 t1 = transmittance(camPos, camEarthIntersection, 1.0f);
         // vec4 t1 = getTransmittanceFromLUT(transmittanceLUT, earthRadius, earthRadius + skyHeight, camPos, camEarthIntersection);
@@ -341,7 +345,7 @@ void computeSceneAtmosphere(in vec3 FragPos, in out vec4 SceneColor)
 {
     vec4 t1 = getTransmittanceFromLUT(transmittanceLUT, earthRadius, earthRadius + skyHeight, camPos, FragPos);
     SceneColor *= t1;
-    SceneColor.rgb += computeAerialPerspective(FragPos, dirLightArray[0].intensity).rgb;
+    SceneColor.rgb += computeAerialPerspective(FragPos, sunIntensity).rgb;
 }
 void main()
 {
@@ -402,8 +406,8 @@ void main()
             eyePos.xyz,
             dir,
             FragPos,
-            LightVolueBoxMin + pointLightArray[i].pos,
-            LightVolueBoxMax + pointLightArray[i].pos,
-            vec4(pow(pointLightArray[i].intensity / 8.f, vec3(1.2f)), 1.0f));
+            LightVolueBoxMin + pointLights[i].pos,
+            LightVolueBoxMax + pointLights[i].pos,
+            vec4(pow(pointLights[i].intensity / 8.f, vec3(1.2f)), 1.0f));
     }
 }
@@ -1,24 +1,44 @@
 #include "ShadowMapping/shadowUnit.glsl"
 
+// 光源表, 与 LightBuffer 中的 PointLightData / DirLightData 布局一致
+// shadowArray 为所在阴影贴图数组(分辨率组)的下标, shadowLayer 为数组中的层(点光源为立方体下标)
 struct DirLight
 {
-    vec3 pos;
-    vec3 intensity;
     mat4 spaceMatrix;
-    sampler2D depthMap;
+    vec3 pos;
     float farPlane;
+    vec3 intensity;
     float orthoScale;
-    sampler2D VSMTexture;
     int useVSM;
-    sampler2D SATTexture;
+    int shadowArray;
+    int shadowLayer;
 };
 
 struct PointLight
 {
     vec3 pos;
-    vec3 intensity;
-    samplerCube depthCubemap;
     float farPlane;
-    samplerCube VSMCubemap;
+    vec3 intensity;
     int useVSM;
-};
\ No newline at end of file
+    int shadowArray;
+    int shadowLayer;
+};
+
+layout(std430, binding = 7) readonly buffer PointLights
+{
+    PointLight pointLights[];
+};
+
+layout(std430, binding = 8) readonly buffer DirLights
+{
+    DirLight dirLights[];
+};
+
+// 按分辨率分组的阴影贴图数组, 数量与 LightBuffer::MaxShadowArrays 一致
+// 光源循环内下标对所有片元一致, 可以直接索引 sampler 数组
+const int MAX_SHADOW_ARRAYS = 2;
+uniform samplerCubeArray pointShadowMaps[MAX_SHADOW_ARRAYS];
+uniform samplerCubeArray pointVSMMaps[MAX_SHADOW_ARRAYS];
+uniform sampler2DArray dirShadowMaps[MAX_SHADOW_ARRAYS];
+uniform sampler2DArray dirVSMMaps[MAX_SHADOW_ARRAYS];
+uniform sampler2DArray dirSATMaps[MAX_SHADOW_ARRAYS];
@@ -111,14 +111,14 @@ public:
     void setViewMatrix(Shader &shaders)
     {
         auto view = camFrustum.getViewMatrix();
-        shaders.setMat4("view", view);
-        shaders.setUniform3fv("eyePos", camFrustum.m_position);
+        shaders.setMat4("view"_uniform, view);
+        shaders.setUniform3fv("eyePos"_uniform, camFrustum.m_position);
     }
 
     void setPerspectiveMatrix(Shader &shaders)
     {
         auto projection = camFrustum.getProjectionMatrix();
-        shaders.setMat4("projection", projection);
+        shaders.setMat4("projection"_uniform, projection);
     }
 
     void setToShader(Shader &shaders)
@@ -126,12 +126,12 @@ public:
         shaders.toggleIgnoreNotFoundWarning();
         setViewMatrix(shaders);
         setPerspectiveMatrix(shaders);
-        shaders.setUniform3fv("eyePos", camFrustum.m_position);
-        shaders.setUniform3fv("eyeFront", camFrustum.m_front);
-        shaders.setUniform3fv("eyeUp", camFrustum.m_up);
-        shaders.setFloat("farPlane", camFrustum.m_farPlane);
-        shaders.setFloat("nearPlane", camFrustum.m_nearPlane);
-        shaders.setFloat("fov", camFrustum.m_fov);
+        shaders.setUniform3fv("eyePos"_uniform, camFrustum.m_position);
+        shaders.setUniform3fv("eyeFront"_uniform, camFrustum.m_front);
+        shaders.setUniform3fv("eyeUp"_uniform, camFrustum.m_up);
+        shaders.setFloat("farPlane"_uniform, camFrustum.m_farPlane);
+        shaders.setFloat("nearPlane"_uniform, camFrustum.m_nearPlane);
+        shaders.setFloat("fov"_uniform, camFrustum.m_fov);
         shaders.toggleIgnoreNotFoundWarning();
     }
 
@@ -0,0 +1,259 @@
+#include "ClusterPagePool.hpp"
+#include "../Objects/ClusteredMesh.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    constexpr size_t SlotVertexBytes = size_t(ClusterHierarchy::PageVertices) * sizeof(ClusterHierarchy::ClusterVertex);
+    constexpr size_t SlotIndexBytes = size_t(ClusterHierarchy::PageIndices) * sizeof(uint16_t);
+
+    bool IsReady(const std::future<std::vector<char>> &future)
+    {
+        return future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready;
+    }
+
+    std::vector<char> ReadPage(const std::filesystem::path &path, uint64_t offset, size_t bytes)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("cannot open " + path.string());
+        std::vector<char> data(bytes);
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(data.data(), static_cast<std::streamsize>(bytes));
+        if (!file)
+            throw std::runtime_error("truncated page in " + path.string());
+        return data;
+    }
+}
+
+ClusterPagePool &ClusterPagePool::Get()
+{
+    static ClusterPagePool pool;
+    return pool;
+}
+
+ClusterPagePool::~ClusterPagePool()
+{
+    for (PendingPage &pending : m_pending)
+    {
+        if (pending.data.valid())
+            pending.data.wait();
+    }
+    for (auto &future : m_abandoned)
+    {
+        if (future.valid())
+            future.wait();
+    }
+    // GL上下文在静态对象析构时可能已销毁, 缓冲随上下文释放
+}
+
+void ClusterPagePool::createBuffers()
+{
+    const uint32_t slotCount = std::max<uint32_t>(m_settings.slotCount, 16);
+    m_slots.assign(slotCount, Slot{});
+    m_freeSlots.clear();
+    for (uint32_t i = slotCount; i-- > 0;)
+        m_freeSlots.push_back(i);
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_vbo);
+    glGenBuffers(1, &m_ebo);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, slotCount * SlotVertexBytes, nullptr, GL_DYNAMIC_DRAW);
+    constexpr GLsizei stride = sizeof(ClusterHierarchy::ClusterVertex);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void *)0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void *)(3 * sizeof(float)));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void *)(6 * sizeof(float)));
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, slotCount * SlotIndexBytes, nullptr, GL_DYNAMIC_DRAW);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_stats.slots = slotCount;
+    m_stats.poolBytes = slotCount * (SlotVertexBytes + SlotIndexBytes);
+}
+
+void ClusterPagePool::beginFrame(const glm::vec3 &cameraPosition, float pixelScale)
+{
+    if (!m_vao)
+        createBuffers();
+    // 上一帧的cut统计
+    m_stats.drawnClusters = m_frameCut.drawnClusters;
+    m_stats.drawnTriangles = m_frameCut.drawnTriangles;
+    m_stats.refinedGroups = m_frameCut.refinedGroups;
+    m_stats.selectMs = m_frameCut.selectMs;
+    m_frameCut = Stats{};
+    m_stats.requests = m_requests.size();
+
+    m_frame++;
+    m_cameraPosition = cameraPosition;
+    m_pixelScale = pixelScale;
+
+    for (auto it = m_abandoned.begin(); it != m_abandoned.end();)
+    {
+        if (IsReady(*it))
+            it = m_abandoned.erase(it);
+        else
+            ++it;
+    }
+    uploadReadyPages();
+    startReads();
+
+    m_stats.usedSlots = m_slots.size() - m_freeSlots.size();
+    m_stats.inFlightReads = 0;
+    m_stats.readyPages = 0;
+    for (const PendingPage &pending : m_pending)
+    {
+        if (IsReady(pending.data))
+            m_stats.readyPages++;
+        else
+            m_stats.inFlightReads++;
+    }
+}
+
+void ClusterPagePool::request(ClusteredMesh &owner, uint32_t page, float priority)
+{
+    m_requests.push_back(Request{&owner, page, priority});
+}
+
+void ClusterPagePool::release(ClusteredMesh &owner)
+{
+    for (uint32_t i = 0; i < m_slots.size(); ++i)
+    {
+        Slot &slot = m_slots[i];
+        if (slot.owner != &owner)
+            continue;
+        if (slot.pinned)
+            m_stats.pinnedSlots--;
+        slot = Slot{};
+        m_freeSlots.push_back(i);
+    }
+    m_requests.erase(std::remove_if(m_requests.begin(), m_requests.end(), [&](const Request &r) { return r.owner == &owner; }),
+                     m_requests.end());
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        if (it->owner == &owner)
+        {
+            m_abandoned.push_back(std::move(it->data));
+            it = m_pending.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void ClusterPagePool::addCutStats(size_t clusters, size_t triangles, size_t refinedGroups, double selectMs)
+{
+    m_frameCut.drawnClusters += clusters;
+    m_frameCut.drawnTriangles += triangles;
+    m_frameCut.refinedGroups += refinedGroups;
+    m_frameCut.selectMs += selectMs;
+}
+
+void ClusterPagePool::startReads()
+{
+    // 误差大的先读. 同一页可能被多次请求, 由 owner 的页状态去重
+    std::stable_sort(m_requests.begin(), m_requests.end(), [](const Request &a, const Request &b) { return a.priority > b.priority; });
+    for (const Request &request : m_requests)
+    {
+        if (m_pending.size() >= m_settings.maxInFlightReads)
+            break;
+        if (!request.owner->needsPage(request.page))
+            continue;
+        const ClusterHierarchy::PageRecord &record = request.owner->pageRecord(request.page);
+        request.owner->onPageLoading(request.page);
+        m_pending.push_back(PendingPage{request.owner, request.page,
+                                        std::async(std::launch::async, ReadPage, request.owner->getPath(), record.offset, record.byteSize())});
+        m_stats.bytesRead += record.byteSize();
+    }
+    m_requests.clear();
+}
+
+void ClusterPagePool::uploadReadyPages()
+{
+    m_stats.uploads = 0;
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        if (m_stats.uploads >= m_settings.maxUploadsPerFrame)
+            break;
+        if (!IsReady(it->data))
+        {
+            ++it;
+            continue;
+        }
+        ClusteredMesh &owner = *it->owner;
+        const uint32_t page = it->page;
+        const ClusterHierarchy::PageRecord &record = owner.pageRecord(page);
+        const uint32_t slot = acquireSlot();
+        if (slot == NoSlot)
+        {
+            // 池中没有可替换的页, 数据留到之后的帧
+            ++it;
+            continue;
+        }
+
+        std::vector<char> data;
+        try
+        {
+            data = it->data.get();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "ClusterPagePool: " << e.what() << std::endl;
+            m_freeSlots.push_back(slot);
+            owner.onPageDropped(page);
+            it = m_pending.erase(it);
+            continue;
+        }
+        const size_t vertexBytes = size_t(record.vertexCount) * sizeof(ClusterHierarchy::ClusterVertex);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_vbo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, slot * SlotVertexBytes, vertexBytes, data.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, slot * SlotIndexBytes, data.size() - vertexBytes, data.data() + vertexBytes);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        m_slots[slot] = Slot{&owner, page, m_frame, record.pinned != 0};
+        if (record.pinned)
+            m_stats.pinnedSlots++;
+        owner.onPageResident(page, slot);
+        m_stats.uploads++;
+        it = m_pending.erase(it);
+    }
+}
+
+uint32_t ClusterPagePool::acquireSlot()
+{
+    if (!m_freeSlots.empty())
+    {
+        const uint32_t slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+    // 上一帧仍在使用的页不替换, 否则刚替换的页可能马上又被请求
+    uint32_t oldest = NoSlot;
+    uint64_t oldestFrame = m_frame - 1;
+    for (uint32_t i = 0; i < m_slots.size(); ++i)
+    {
+        const Slot &slot = m_slots[i];
+        if (!slot.pinned && slot.lastUsed < oldestFrame)
+        {
+            oldest = i;
+            oldestFrame = slot.lastUsed;
+        }
+    }
+    if (oldest == NoSlot)
+        return NoSlot;
+    m_slots[oldest].owner->onPageEvicted(m_slots[oldest].page);
+    m_slots[oldest] = Slot{};
+    m_stats.evictions++;
+    return oldest;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <vector>
+
+#include "../Math/ClusterHierarchy.hpp"
+
+class ClusteredMesh;
+
+/*
+簇层级页的GPU页池: 一个VBO/EBO按固定大小划分为槽位, 每个槽位放一页(ClusterHierarchy::PageVertices 顶点, PageIndices 个16位索引)
+槽位数在首次使用时固定, 显存占用不随网格大小增长
+ClusteredMesh 在选择cut时提交缺失页的请求(按投影误差排优先级), 下一帧开始时按优先级启动工作线程读取文件
+读取完成的页在帧开始时上传到空闲槽位. 没有空闲槽位时替换上一帧之前未使用过的最久未用的页, 含根簇的页常驻不替换
+*/
+class ClusterPagePool
+{
+public:
+    struct Settings
+    {
+        uint32_t slotCount = 2048;      // 首次使用时生效
+        size_t maxInFlightReads = 16;
+        size_t maxUploadsPerFrame = 64;
+        float pixelError = 1.0f;        // cut选择的屏幕误差阈值(像素)
+    };
+
+    struct Stats
+    {
+        size_t slots = 0;
+        size_t usedSlots = 0;
+        size_t pinnedSlots = 0;
+        size_t poolBytes = 0;
+        size_t inFlightReads = 0;
+        size_t readyPages = 0;      // 已读取但还没有可用槽位的页
+        size_t requests = 0;        // 上一帧提交的缺页请求
+        size_t uploads = 0;         // 本帧上传的页
+        size_t evictions = 0;       // 累计替换次数
+        size_t bytesRead = 0;       // 累计读取字节数
+        // 上一帧所有 ClusteredMesh 的cut
+        size_t drawnClusters = 0;
+        size_t drawnTriangles = 0;
+        size_t refinedGroups = 0;
+        double selectMs = 0.0;
+    };
+
+    static ClusterPagePool &Get();
+
+    ClusterPagePool(const ClusterPagePool &) = delete;
+    ClusterPagePool &operator=(const ClusterPagePool &) = delete;
+    ~ClusterPagePool();
+
+    /// @brief 每帧渲染前调用一次: 启动读取, 上传已读取的页, 记录本帧cut选择使用的相机
+    /// @param pixelScale 视口高度的一半 / tan(fovy / 2), 即投影矩阵 [1][1] * 视口高度 / 2
+    void beginFrame(const glm::vec3 &cameraPosition, float pixelScale);
+
+    /// @brief 请求读取一页. 每帧的请求在下一帧开始时按 priority 从大到小处理, 未处理的请求丢弃, 需要时由下一次选择重新提交
+    void request(ClusteredMesh &owner, uint32_t page, float priority);
+    /// @brief 标记槽位在本帧被使用
+    void touch(uint32_t slot) { m_slots[slot].lastUsed = m_frame; }
+    /// @brief 释放 owner 的所有槽位与请求, ClusteredMesh 析构时调用
+    void release(ClusteredMesh &owner);
+
+    /// @brief 累计本帧的cut统计
+    void addCutStats(size_t clusters, size_t triangles, size_t refinedGroups, double selectMs);
+
+    GLuint getVAO() const { return m_vao; }
+    uint64_t frame() const { return m_frame; }
+    const glm::vec3 &cameraPosition() const { return m_cameraPosition; }
+    float pixelScale() const { return m_pixelScale; }
+
+    Settings &getSettings() { return m_settings; }
+    const Stats &getStats() const { return m_stats; }
+
+private:
+    static constexpr uint32_t NoSlot = ClusterHierarchy::None;
+
+    struct Slot
+    {
+        ClusteredMesh *owner = nullptr;
+        uint32_t page = 0;
+        uint64_t lastUsed = 0;
+        bool pinned = false;
+    };
+
+    struct Request
+    {
+        ClusteredMesh *owner;
+        uint32_t page;
+        float priority;
+    };
+
+    struct PendingPage
+    {
+        ClusteredMesh *owner;
+        uint32_t page;
+        std::future<std::vector<char>> data;
+    };
+
+    Settings m_settings;
+    Stats m_stats;
+    GLuint m_vao = 0;
+    GLuint m_vbo = 0;
+    GLuint m_ebo = 0;
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<Request> m_requests;
+    std::vector<PendingPage> m_pending;
+    // owner 已释放但仍在读取的页, 完成后丢弃. future 析构会等待读取结束, 不能直接销毁
+    std::vector<std::future<std::vector<char>>> m_abandoned;
+    uint64_t m_frame = 1;
+    glm::vec3 m_cameraPosition = glm::vec3(0.0f);
+    float m_pixelScale = 0.0f;
+    Stats m_frameCut;
+
+    ClusterPagePool() = default;
+
+    void createBuffers();
+    void startReads();
+    void uploadReadyPages();
+    // 空闲槽位, 没有时替换最久未用的页. 无可替换时返回 NoSlot
+    uint32_t acquireSlot();
+};
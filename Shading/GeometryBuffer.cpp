@@ -0,0 +1,353 @@
+#include "GeometryBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+    constexpr size_t InitialVertexCapacity = size_t(1) << 16;
+    constexpr size_t InitialIndexCapacity = size_t(1) << 18;
+
+    // FNV-1a
+    uint64_t HashBytes(uint64_t hash, const void *data, size_t bytes)
+    {
+        const unsigned char *p = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            hash ^= p[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool SameBytes(const void *a, const void *b, size_t bytes)
+    {
+        return bytes == 0 || std::memcmp(a, b, bytes) == 0;
+    }
+}
+
+bool GeometryBuffer::RangeAllocator::allocate(size_t count, size_t &offset)
+{
+    offset = 0;
+    if (count == 0)
+        return true;
+    for (auto it = m_free.begin(); it != m_free.end(); ++it)
+    {
+        if (it->second < count)
+            continue;
+        offset = it->first;
+        const size_t remaining = it->second - count;
+        m_free.erase(it);
+        if (remaining > 0)
+            m_free.emplace(offset + count, remaining);
+        return true;
+    }
+    return false;
+}
+
+void GeometryBuffer::RangeAllocator::free(size_t offset, size_t count)
+{
+    if (count == 0)
+        return;
+    auto next = m_free.lower_bound(offset);
+    // 与前后相邻的空块合并
+    if (next != m_free.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            count += prev->second;
+            m_free.erase(prev);
+        }
+    }
+    if (next != m_free.end() && offset + count == next->first)
+    {
+        count += next->second;
+        m_free.erase(next);
+    }
+    m_free.emplace(offset, count);
+}
+
+void GeometryBuffer::RangeAllocator::grow(size_t newCapacity)
+{
+    if (newCapacity <= m_capacity)
+        return;
+    const size_t added = newCapacity - m_capacity;
+    const size_t offset = m_capacity;
+    m_capacity = newCapacity;
+    free(offset, added);
+}
+
+std::map<std::pair<GeometryBuffer::VertexFormat, GLenum>, std::unique_ptr<GeometryBuffer>> &GeometryBuffer::SharedBuffers()
+{
+    static std::map<std::pair<VertexFormat, GLenum>, std::unique_ptr<GeometryBuffer>> buffers;
+    return buffers;
+}
+
+GeometryBuffer &GeometryBuffer::Shared(VertexFormat format, GLenum indexType)
+{
+    std::unique_ptr<GeometryBuffer> &buffer = SharedBuffers()[{format, indexType}];
+    if (!buffer)
+        buffer = std::make_unique<GeometryBuffer>(format, indexType);
+    return *buffer;
+}
+
+GeometryBuffer::Stats GeometryBuffer::SharedStats()
+{
+    Stats total;
+    for (const auto &[key, buffer] : SharedBuffers())
+    {
+        const Stats &stats = buffer->getStats();
+        total.allocations += stats.allocations;
+        total.sharedAllocations += stats.sharedAllocations;
+        total.vertexCount += stats.vertexCount;
+        total.vertexCapacity += stats.vertexCapacity;
+        total.indexCount += stats.indexCount;
+        total.indexCapacity += stats.indexCapacity;
+        total.vertexBytes += stats.vertexBytes;
+        total.indexBytes += stats.indexBytes;
+        total.positionBytes += stats.positionBytes;
+        total.contentBytes += stats.contentBytes;
+        total.drawCalls += stats.drawCalls;
+        total.vaoBinds += stats.vaoBinds;
+    }
+    return total;
+}
+
+void GeometryBuffer::ResetSharedFrameStats()
+{
+    for (const auto &[key, buffer] : SharedBuffers())
+        buffer->resetFrameStats();
+}
+
+GeometryBuffer::GeometryBuffer(VertexFormat format, GLenum indexType)
+    : m_format(format),
+      m_stride(format == VertexFormat::Compact ? CompactStride : StandardStride),
+      m_indexType(indexType),
+      m_indexSize(indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint)),
+      m_positionStride(format == VertexFormat::Compact ? CompactPositionStride : StandardPositionStride)
+{
+    if (indexType != GL_UNSIGNED_SHORT && indexType != GL_UNSIGNED_INT)
+        throw std::runtime_error("GeometryBuffer: unsupported index type");
+    glGenVertexArrays(1, &m_vao);
+    glGenVertexArrays(1, &m_depthVao);
+    m_vbo = Reallocate(0, 0, InitialVertexCapacity * m_stride);
+    m_positionVbo = Reallocate(0, 0, InitialVertexCapacity * m_positionStride);
+    m_ebo = Reallocate(0, 0, InitialIndexCapacity * m_indexSize);
+    m_vertices.grow(InitialVertexCapacity);
+    m_indices.grow(InitialIndexCapacity);
+    attachBuffers();
+}
+
+GeometryBuffer::~GeometryBuffer()
+{
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteVertexArrays(1, &m_depthVao);
+    glDeleteBuffers(1, &m_vbo);
+    glDeleteBuffers(1, &m_positionVbo);
+    glDeleteBuffers(1, &m_ebo);
+}
+
+GeometryHandle GeometryBuffer::allocate(const void *vertices, size_t vertexCount, const GLuint *indices, size_t indexCount, bool shareable)
+{
+    const void *indexData = indices;
+    if (m_indexType == GL_UNSIGNED_SHORT)
+    {
+        m_shortIndices.resize(indexCount);
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            if (indices[i] > 0xFFFF)
+                throw std::runtime_error("GeometryBuffer: index does not fit in 16 bits");
+            m_shortIndices[i] = static_cast<GLushort>(indices[i]);
+        }
+        indexData = m_shortIndices.data();
+    }
+    const size_t vertexBytes = vertexCount * m_stride;
+    const size_t indexBytes = indexCount * m_indexSize;
+
+    uint64_t contentHash = 0;
+    if (shareable)
+    {
+        contentHash = HashBytes(14695981039346656037ull, &vertexCount, sizeof(vertexCount));
+        contentHash = HashBytes(contentHash, &indexCount, sizeof(indexCount));
+        contentHash = HashBytes(contentHash, vertices, vertexBytes);
+        contentHash = HashBytes(contentHash, indexData, indexBytes);
+        auto [first, last] = m_contents.equal_range(contentHash);
+        for (auto it = first; it != last; ++it)
+        {
+            const std::vector<unsigned char> &content = it->second.bytes;
+            if (content.size() != vertexBytes + indexBytes || !SameBytes(content.data(), vertices, vertexBytes) ||
+                !SameBytes(content.data() + vertexBytes, indexData, indexBytes))
+                continue;
+            if (GeometryHandle existing = it->second.handle.lock())
+            {
+                m_stats.sharedAllocations++;
+                return existing;
+            }
+        }
+    }
+
+    size_t vertexOffset = 0;
+    if (!m_vertices.allocate(vertexCount, vertexOffset))
+    {
+        const size_t oldCapacity = m_vertices.capacity();
+        const size_t newCapacity = std::max(oldCapacity * 2, oldCapacity + vertexCount);
+        m_vbo = Reallocate(m_vbo, oldCapacity * m_stride, newCapacity * m_stride);
+        m_positionVbo = Reallocate(m_positionVbo, oldCapacity * m_positionStride, newCapacity * m_positionStride);
+        m_vertices.grow(newCapacity);
+        m_vertices.allocate(vertexCount, vertexOffset);
+        attachBuffers();
+    }
+    size_t indexOffset = 0;
+    if (!m_indices.allocate(indexCount, indexOffset))
+    {
+        const size_t oldCapacity = m_indices.capacity();
+        const size_t newCapacity = std::max(oldCapacity * 2, oldCapacity + indexCount);
+        m_ebo = Reallocate(m_ebo, oldCapacity * m_indexSize, newCapacity * m_indexSize);
+        m_indices.grow(newCapacity);
+        m_indices.allocate(indexCount, indexOffset);
+        attachBuffers();
+    }
+    Upload(m_vbo, vertexOffset * m_stride, vertexBytes, vertices);
+    m_positions.resize(vertexCount * m_positionStride);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        std::copy_n(static_cast<const unsigned char *>(vertices) + v * m_stride, m_positionStride,
+                    m_positions.data() + v * m_positionStride);
+    }
+    Upload(m_positionVbo, vertexOffset * m_positionStride, m_positions.size(), m_positions.data());
+    Upload(m_ebo, indexOffset * m_indexSize, indexBytes, indexData);
+
+    m_stats.allocations++;
+    m_stats.vertexCount += vertexCount;
+    m_stats.indexCount += indexCount;
+    m_stats.vertexBytes += vertexBytes;
+    m_stats.indexBytes += indexBytes;
+    m_stats.positionBytes += vertexCount * m_positionStride;
+    m_stats.vertexCapacity = m_vertices.capacity();
+    m_stats.indexCapacity = m_indices.capacity();
+
+    GeometryRange range;
+    range.firstVertex = static_cast<GLuint>(vertexOffset);
+    range.vertexCount = static_cast<GLuint>(vertexCount);
+    range.firstIndex = static_cast<GLuint>(indexOffset);
+    range.indexCount = static_cast<GLuint>(indexCount);
+    GeometryHandle handle(new GeometryRange(range), [this, contentHash, shareable](const GeometryRange *r)
+                          {
+                              release(*r, contentHash, shareable);
+                              delete r; });
+    if (shareable)
+    {
+        SharedContent content;
+        content.range = handle.get();
+        content.handle = handle;
+        content.bytes.resize(vertexBytes + indexBytes);
+        std::copy_n(static_cast<const unsigned char *>(vertices), vertexBytes, content.bytes.data());
+        std::copy_n(static_cast<const unsigned char *>(indexData), indexBytes, content.bytes.data() + vertexBytes);
+        m_stats.contentBytes += content.bytes.size();
+        m_contents.emplace(contentHash, std::move(content));
+    }
+    return handle;
+}
+
+void GeometryBuffer::release(const GeometryRange &range, uint64_t contentHash, bool shareable)
+{
+    if (shareable)
+    {
+        auto [first, last] = m_contents.equal_range(contentHash);
+        for (auto it = first; it != last; ++it)
+        {
+            if (it->second.range != &range)
+                continue;
+            m_stats.contentBytes -= it->second.bytes.size();
+            m_contents.erase(it);
+            break;
+        }
+    }
+    m_vertices.free(range.firstVertex, range.vertexCount);
+    m_indices.free(range.firstIndex, range.indexCount);
+    m_stats.allocations--;
+    m_stats.vertexCount -= range.vertexCount;
+    m_stats.indexCount -= range.indexCount;
+    m_stats.vertexBytes -= size_t(range.vertexCount) * m_stride;
+    m_stats.indexBytes -= size_t(range.indexCount) * m_indexSize;
+    m_stats.positionBytes -= size_t(range.vertexCount) * m_positionStride;
+}
+
+void GeometryBuffer::bind()
+{
+    glBindVertexArray(m_vao);
+    m_stats.vaoBinds++;
+}
+
+void GeometryBuffer::draw(const GeometryRange &range, GLuint first, GLuint count)
+{
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(count), m_indexType,
+                             reinterpret_cast<const void *>(size_t(range.firstIndex + first) * m_indexSize),
+                             static_cast<GLint>(range.firstVertex));
+    m_stats.drawCalls++;
+}
+
+GLuint GeometryBuffer::Reallocate(GLuint buffer, size_t oldBytes, size_t newBytes)
+{
+    GLuint newBuffer = 0;
+    glGenBuffers(1, &newBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, newBytes, nullptr, GL_STATIC_DRAW);
+    if (oldBytes > 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldBytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    if (buffer)
+        glDeleteBuffers(1, &buffer);
+    return newBuffer;
+}
+
+void GeometryBuffer::Upload(GLuint buffer, size_t offset, size_t bytes, const void *data)
+{
+    if (bytes == 0)
+        return;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset, bytes, data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+// 缓冲重新分配后需要重新挂到VAO上
+void GeometryBuffer::attachBuffers()
+{
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    if (m_format == VertexFormat::Compact)
+    {
+        // 由顶点获取阶段解码, 着色器输入仍为 vec3/vec3/vec2
+        glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, m_stride, (void *)0);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, m_stride, (void *)(4 * sizeof(GLushort)));
+        glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, m_stride, (void *)(4 * sizeof(GLushort) + sizeof(GLuint)));
+    }
+    else
+    {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, m_stride, (void *)0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, m_stride, (void *)(3 * sizeof(float)));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, m_stride, (void *)(6 * sizeof(float)));
+    }
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+
+    glBindVertexArray(m_depthVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_positionVbo);
+    if (m_format == VertexFormat::Compact)
+        glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, m_positionStride, (void *)0);
+    else
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, m_positionStride, (void *)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
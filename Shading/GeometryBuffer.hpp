@@ -0,0 +1,151 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/// @brief 几何缓冲中的一段子分配. 索引相对 firstVertex, 绘制时作为 baseVertex
+struct GeometryRange
+{
+    GLuint firstVertex = 0;
+    GLuint vertexCount = 0;
+    GLuint firstIndex = 0;
+    GLuint indexCount = 0;
+};
+// 最后一个持有者释放时归还空间, 对象可按值拷贝
+using GeometryHandle = std::shared_ptr<const GeometryRange>;
+
+/*
+共享顶点/索引缓冲: 同一顶点格式的几何体在一个VBO/EBO中子分配, 共用一个VAO.
+逐对象绘制时不再切换顶点状态, 间接绘制时同材质的对象可以合并为一次 glMultiDrawElementsIndirect
+空间不足时按2倍扩容并拷贝旧数据, 已分配的偏移不变. 释放的空间按首次适应复用, 相邻空块合并
+内容完全相同的几何体(如多个同参数的 Sphere)共用一次分配, 使实例化绘制能识别它们
+    哈希只用于查找, 复用前与保留的CPU端内容副本逐字节比较, 哈希碰撞的不同内容各自分配
+每种顶点格式与索引类型的组合对应一个共享缓冲(Shared), 导入的网格可使用紧凑格式与16位索引
+另存一份紧密排列的位置流, 深度VAO只从中读取位置, 供只写深度的阴影pass使用. 两个VAO共用索引缓冲, 范围通用
+*/
+class GeometryBuffer
+{
+public:
+    enum class VertexFormat
+    {
+        Standard, // position(3 float) + normal(3 float) + texCoord(2 float), 与 Mesh::Vertex 等布局一致
+        Compact   // position(3 half + 填充) + normal(snorm 10-10-10-2) + texCoord(2 unorm16), 与 MeshOptimizer::CompactVertex 一致
+    };
+    static constexpr GLsizei StandardStride = 8 * sizeof(float);
+    static constexpr GLsizei CompactStride = 16;
+    // 位置流每顶点字节数: 3 float / 4 half. 两种格式的位置都位于顶点开头
+    static constexpr GLsizei StandardPositionStride = 3 * sizeof(float);
+    static constexpr GLsizei CompactPositionStride = 4 * sizeof(uint16_t);
+
+    struct Stats
+    {
+        size_t allocations = 0;
+        size_t sharedAllocations = 0; // 命中已有相同内容而未新分配的次数
+        size_t vertexCount = 0;
+        size_t vertexCapacity = 0;
+        size_t indexCount = 0;
+        size_t indexCapacity = 0;
+        size_t vertexBytes = 0; // 已分配顶点与索引占用的字节数
+        size_t indexBytes = 0;
+        size_t positionBytes = 0; // 位置流占用的字节数
+        size_t contentBytes = 0;  // 可共享分配为比较内容保留的CPU端副本
+        // 本帧经 bind/draw 提交的次数, 由 resetFrameStats 清零
+        size_t drawCalls = 0;
+        size_t vaoBinds = 0;
+    };
+
+    /// @brief 标准顶点格式(位置, 法线, 纹理坐标)与32位索引的共享缓冲. 首次使用时创建, 需要GL上下文
+    static GeometryBuffer &Standard() { return Shared(VertexFormat::Standard, GL_UNSIGNED_INT); }
+    /// @param indexType GL_UNSIGNED_SHORT 或 GL_UNSIGNED_INT
+    static GeometryBuffer &Shared(VertexFormat format, GLenum indexType);
+    /// @brief 所有已创建共享缓冲的统计之和
+    static Stats SharedStats();
+    static void ResetSharedFrameStats();
+
+    GeometryBuffer(VertexFormat format, GLenum indexType);
+    ~GeometryBuffer();
+    GeometryBuffer(const GeometryBuffer &) = delete;
+    GeometryBuffer &operator=(const GeometryBuffer &) = delete;
+
+    /// @param vertices vertexCount 个 stride 字节的顶点
+    /// @param indices 相对本次分配首顶点的索引, 16位索引缓冲要求均小于65536
+    /// @param shareable false 时总是新分配且不参与合并, 用于之后会被改写的顶点(如蒙皮结果)
+    /// @return 已有内容相同且仍在使用的分配时返回同一句柄
+    GeometryHandle allocate(const void *vertices, size_t vertexCount, const GLuint *indices, size_t indexCount, bool shareable = true);
+
+    GLuint getVAO() const { return m_vao; }
+    // 只有位置属性(location 0)的VAO
+    GLuint getDepthVAO() const { return m_depthVao; }
+    // 扩容时缓冲会被替换, 不要跨帧保存
+    GLuint getVertexBuffer() const { return m_vbo; }
+    GLuint getPositionBuffer() const { return m_positionVbo; }
+    GLsizei getStride() const { return m_stride; }
+    GLsizei getPositionStride() const { return m_positionStride; }
+    GLenum getIndexType() const { return m_indexType; }
+    GLsizei getIndexSize() const { return m_indexSize; }
+    void bind();
+    /// @brief 绘制一段子分配中的 [first, first+count) 个索引, 调用前需 bind
+    void draw(const GeometryRange &range, GLuint first, GLuint count);
+    void draw(const GeometryRange &range) { draw(range, 0, range.indexCount); }
+
+    const Stats &getStats() const { return m_stats; }
+    void resetFrameStats()
+    {
+        m_stats.drawCalls = 0;
+        m_stats.vaoBinds = 0;
+    }
+
+private:
+    // 按元素计数的首次适应分配器, key 为空块起点
+    class RangeAllocator
+    {
+    public:
+        size_t capacity() const { return m_capacity; }
+        bool allocate(size_t count, size_t &offset);
+        void free(size_t offset, size_t count);
+        // 扩容后末尾新增空块
+        void grow(size_t newCapacity);
+
+    private:
+        std::map<size_t, size_t> m_free;
+        size_t m_capacity = 0;
+    };
+
+    VertexFormat m_format;
+    GLsizei m_stride;
+    GLenum m_indexType;
+    GLsizei m_indexSize;
+    GLsizei m_positionStride;
+    GLuint m_vao = 0;
+    GLuint m_depthVao = 0;
+    GLuint m_vbo = 0;
+    GLuint m_positionVbo = 0;
+    GLuint m_ebo = 0;
+    RangeAllocator m_vertices; // 以顶点计
+    RangeAllocator m_indices;  // 以索引计
+    Stats m_stats;
+    struct SharedContent
+    {
+        const GeometryRange *range = nullptr; // 释放时据此找到本条目
+        std::weak_ptr<const GeometryRange> handle;
+        std::vector<unsigned char> bytes; // 顶点后接索引, 索引为本缓冲的索引类型
+    };
+    // 内容哈希 -> 分配, 用于合并相同几何体. 哈希相同的不同内容并存
+    std::unordered_multimap<uint64_t, SharedContent> m_contents;
+    std::vector<GLushort> m_shortIndices; // 转换为16位索引的临时数据
+    std::vector<unsigned char> m_positions; // 从交错顶点中抽出的位置流临时数据
+
+    static std::map<std::pair<VertexFormat, GLenum>, std::unique_ptr<GeometryBuffer>> &SharedBuffers();
+
+    void release(const GeometryRange &range, uint64_t contentHash, bool shareable);
+    // 新建 newBytes 大小的缓冲, 拷入旧缓冲的前 oldBytes 字节并删除旧缓冲
+    static GLuint Reallocate(GLuint buffer, size_t oldBytes, size_t newBytes);
+    static void Upload(GLuint buffer, size_t offset, size_t bytes, const void *data);
+    void attachBuffers();
+};
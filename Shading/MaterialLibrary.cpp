@@ -0,0 +1,216 @@
+#include "MaterialLibrary.hpp"
+#include <algorithm>
+#include <iostream>
+
+#include "../includes/stb_image.h"
+
+namespace
+{
+    constexpr unsigned int InitialLayers = 4;
+}
+
+MaterialLibrary &MaterialLibrary::Get()
+{
+    static MaterialLibrary library;
+    return library;
+}
+
+MaterialLibrary::MaterialLibrary()
+{
+    glGenBuffers(1, &m_buffer);
+    m_materials.push_back(MaterialData{-1, -1, -1, -1});
+    m_records.emplace_back();
+    m_stats.materials = m_materials.size();
+}
+
+MaterialLibrary::~MaterialLibrary()
+{
+    glDeleteBuffers(1, &m_buffer);
+}
+
+uint32_t MaterialLibrary::addMaterial(const std::string &diffusePath, const std::string &specularPath)
+{
+    if (diffusePath.empty() && specularPath.empty())
+        return DefaultMaterial;
+    auto [it, inserted] = m_materialOfPaths.try_emplace({diffusePath, specularPath}, static_cast<uint32_t>(m_materials.size()));
+    if (inserted)
+    {
+        m_materials.push_back(MaterialData{-1, -1, -1, -1});
+        m_records.push_back(MaterialRecord{diffusePath, specularPath, 0});
+        m_stats.materials = m_materials.size();
+    }
+    MaterialRecord &record = m_records[it->second];
+    if (record.refs++ > 0)
+        return it->second;
+
+    // 首次引用, 或引用全部释放后再次注册
+    const TextureSlot diffuse = diffusePath.empty() ? TextureSlot{} : loadTexture(diffusePath);
+    const TextureSlot specular = specularPath.empty() ? TextureSlot{} : loadTexture(specularPath);
+    m_materials[it->second] = MaterialData{diffuse.array, diffuse.layer, specular.array, specular.layer};
+    m_tableDirty = true;
+    return it->second;
+}
+
+void MaterialLibrary::release(uint32_t material)
+{
+    if (material == DefaultMaterial || material >= m_records.size())
+        return;
+    MaterialRecord &record = m_records[material];
+    if (record.refs == 0 || --record.refs > 0)
+        return;
+    if (!record.diffusePath.empty())
+        releaseTexture(record.diffusePath);
+    if (!record.specularPath.empty())
+        releaseTexture(record.specularPath);
+    m_materials[material] = MaterialData{-1, -1, -1, -1};
+    m_tableDirty = true;
+}
+
+size_t MaterialLibrary::textureBytes(uint32_t material) const
+{
+    if (material >= m_records.size() || m_records[material].refs == 0)
+        return 0;
+    size_t bytes = 0;
+    for (const std::string *path : {&m_records[material].diffusePath, &m_records[material].specularPath})
+    {
+        auto it = path->empty() ? m_textures.end() : m_textures.find(*path);
+        if (it == m_textures.end() || it->second.slot.array < 0)
+            continue;
+        const TextureArray &array = m_arrays[it->second.slot.array];
+        // 完整mipmap链约为第0级的4/3
+        bytes += size_t(array.width) * array.height * 4 * 4 / 3;
+    }
+    return bytes;
+}
+
+uint64_t MaterialLibrary::batchKey(uint32_t material) const
+{
+    const MaterialData &data = m_materials[std::min<size_t>(material, m_materials.size() - 1)];
+    return (uint64_t(uint32_t(data.diffuseArray + 1)) << 32) | uint32_t(data.specularArray + 1);
+}
+
+MaterialLibrary::TextureSlot MaterialLibrary::loadTexture(const std::string &path)
+{
+    auto [it, inserted] = m_textures.try_emplace(path);
+    it->second.refs++;
+    if (!inserted)
+        return it->second.slot;
+
+    TextureSlot &slot = it->second.slot;
+    int width = 0, height = 0, channels = 0;
+    // 统一展开为RGBA, 同尺寸的纹理才能放进同一个数组
+    unsigned char *data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    const int arrayIndex = data ? arrayFor(width, height) : -1;
+    if (arrayIndex >= 0)
+    {
+        TextureArray &array = m_arrays[arrayIndex];
+        slot.array = arrayIndex;
+        if (!array.freeLayers.empty())
+        {
+            slot.layer = array.freeLayers.back();
+            array.freeLayers.pop_back();
+            m_stats.freeLayers--;
+        }
+        else
+        {
+            reserveLayer(array);
+            slot.layer = static_cast<GLint>(array.layers++);
+        }
+        array.texture->setData(data, slot.layer);
+        array.mipmapsDirty = true;
+        m_stats.textures++;
+    }
+    else
+    {
+        std::cout << "Failed to load texture into material library: " << path << std::endl;
+        m_stats.rejected++;
+    }
+    stbi_image_free(data);
+    return slot;
+}
+
+void MaterialLibrary::releaseTexture(const std::string &path)
+{
+    auto it = m_textures.find(path);
+    if (it == m_textures.end() || --it->second.refs > 0)
+        return;
+    const TextureSlot slot = it->second.slot;
+    m_textures.erase(it);
+    if (slot.array < 0)
+        return;
+    // 层的内容留到被覆盖为止, 容量不收缩
+    m_arrays[slot.array].freeLayers.push_back(slot.layer);
+    m_stats.freeLayers++;
+    m_stats.textures--;
+}
+
+int MaterialLibrary::arrayFor(unsigned int width, unsigned int height)
+{
+    for (size_t i = 0; i < m_arrays.size(); ++i)
+    {
+        if (m_arrays[i].width == width && m_arrays[i].height == height)
+            return static_cast<int>(i);
+    }
+    if (m_arrays.size() >= MaxTextureArrays)
+        return -1;
+    TextureArray array;
+    array.width = width;
+    array.height = height;
+    m_arrays.push_back(std::move(array));
+    m_stats.arrays = m_arrays.size();
+    return static_cast<int>(m_arrays.size() - 1);
+}
+
+void MaterialLibrary::reserveLayer(TextureArray &array)
+{
+    const unsigned int capacity = array.texture ? array.texture->Depth : 0;
+    if (array.layers < capacity)
+        return;
+    const unsigned int newCapacity = std::max(InitialLayers, capacity * 2);
+    auto texture = std::make_unique<Texture2DArray>();
+    texture->generate(array.width, array.height, newCapacity, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, nullptr, true);
+    texture->setWrapMode(GL_REPEAT);
+    if (array.texture && array.layers > 0)
+    {
+        glCopyImageSubData(array.texture->ID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+                           texture->ID, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+                           array.width, array.height, array.layers);
+    }
+    array.texture = std::move(texture);
+
+    m_stats.layerCapacity += newCapacity - capacity;
+    m_stats.textureBytes += size_t(newCapacity - capacity) * array.width * array.height * 4;
+}
+
+void MaterialLibrary::bind(Shader &shaders)
+{
+    if (m_tableDirty)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, m_materials.size() * sizeof(MaterialData), m_materials.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        m_tableDirty = false;
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MaterialBinding, m_buffer);
+
+    GLint units[MaxTextureArrays];
+    for (int i = 0; i < MaxTextureArrays; ++i)
+    {
+        units[i] = FirstTextureUnit + i;
+        glActiveTexture(GL_TEXTURE0 + FirstTextureUnit + i);
+        if (i >= static_cast<int>(m_arrays.size()) || !m_arrays[i].texture)
+        {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+            continue;
+        }
+        TextureArray &array = m_arrays[i];
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array.texture->ID);
+        if (array.mipmapsDirty)
+        {
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+            array.mipmapsDirty = false;
+        }
+    }
+    glActiveTexture(GL_TEXTURE0);
+    shaders.setUniform1iv("materialTextures", MaxTextureArrays, units);
+}
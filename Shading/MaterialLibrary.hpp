@@ -0,0 +1,125 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Shader.hpp"
+#include "Texture.hpp"
+
+/*
+材质表: 所有材质存放在一个SSBO中, 绘制只需传递材质编号
+模型纹理按尺寸分组打包进 Texture2DArray 的各层, 每个尺寸一个数组, 全部数组在pass开始时绑定一次.
+不同材质的绘制之间不再切换纹理, 只有引用的纹理数组组合不同时才需要分开批次
+(片元着色器用材质中的数组下标索引 sampler 数组, 同一次绘制内该下标必须一致)
+材质与纹理按引用计数: 材质的引用全部释放后其纹理引用随之释放, 纹理不再被引用时归还所占的层, 供之后加载的同尺寸纹理复用
+*/
+class MaterialLibrary
+{
+public:
+    // 与 Shaders/GBuffer/material.glsl 一致
+    static constexpr int MaxTextureArrays = 8;
+    static constexpr GLint FirstTextureUnit = 8;
+    static constexpr GLuint MaterialBinding = 5;
+    // 编号0为无纹理的默认材质
+    static constexpr uint32_t DefaultMaterial = 0;
+
+    struct Stats
+    {
+        size_t materials = 0;
+        size_t textures = 0;      // 已加载的纹理文件数
+        size_t arrays = 0;        // 纹理数组(尺寸组)数
+        size_t layerCapacity = 0; // 所有数组已分配的层数
+        size_t freeLayers = 0;    // 已释放, 等待复用的层数
+        size_t textureBytes = 0;  // 已分配的第0级纹理字节数
+        size_t rejected = 0;      // 尺寸组用尽或加载失败而未使用的纹理数
+    };
+
+    /// @brief 全局材质表, 首次使用时创建, 需要GL上下文
+    static MaterialLibrary &Get();
+
+    MaterialLibrary(const MaterialLibrary &) = delete;
+    MaterialLibrary &operator=(const MaterialLibrary &) = delete;
+    ~MaterialLibrary();
+
+    /// @brief 注册由漫反射与高光纹理组成的材质, 路径为空表示没有该纹理. 相同组合返回同一编号
+    ///        每次调用增加一次引用. 编号在释放后仍然保留, 再次注册时重新加载纹理
+    uint32_t addMaterial(const std::string &diffusePath, const std::string &specularPath);
+    /// @brief 释放 addMaterial 的一次引用, 默认材质忽略. 引用全部释放后材质不再有纹理, 需在引用它的对象不再绘制后调用
+    void release(uint32_t material);
+
+    /// @brief 材质的纹理在纹理数组中占用的字节数(含mipmap), 未加载的纹理不计
+    size_t textureBytes(uint32_t material) const;
+
+    /// @brief 引用的纹理数组组合, 相同时可以合并进同一次绘制
+    uint64_t batchKey(uint32_t material) const;
+
+    /// @brief 上传改动, 绑定材质SSBO与全部纹理数组, 并设置 shaders 的 sampler 数组. 需在 use() 之后调用
+    void bind(Shader &shaders);
+
+    const Stats &getStats() const { return m_stats; }
+
+private:
+    // 与 material.glsl 中的 Material 布局一致, 下标 -1 表示无纹理
+    struct MaterialData
+    {
+        GLint diffuseArray;
+        GLint diffuseLayer;
+        GLint specularArray;
+        GLint specularLayer;
+    };
+    static_assert(sizeof(MaterialData) == 16, "MaterialData must match std430 layout");
+
+    struct TextureSlot
+    {
+        GLint array = -1;
+        GLint layer = -1;
+    };
+
+    struct TextureRecord
+    {
+        TextureSlot slot; // 加载失败时 array 为 -1, 同样计数, 引用全部释放后才会重试
+        size_t refs = 0;
+    };
+
+    // 与 m_materials 一一对应
+    struct MaterialRecord
+    {
+        std::string diffusePath;
+        std::string specularPath;
+        size_t refs = 0;
+    };
+
+    struct TextureArray
+    {
+        std::unique_ptr<Texture2DArray> texture;
+        unsigned int width = 0;
+        unsigned int height = 0;
+        unsigned int layers = 0; // 使用过的最高层数, 容量为 texture->Depth
+        std::vector<GLint> freeLayers; // layers 以下已释放的层
+        bool mipmapsDirty = false;
+    };
+
+    GLuint m_buffer = 0;
+    bool m_tableDirty = true;
+    std::vector<MaterialData> m_materials;
+    std::vector<MaterialRecord> m_records;
+    std::map<std::pair<std::string, std::string>, uint32_t> m_materialOfPaths;
+    std::unordered_map<std::string, TextureRecord> m_textures;
+    std::vector<TextureArray> m_arrays;
+    Stats m_stats;
+
+    MaterialLibrary();
+    // 增加一次纹理引用, 首次引用时加载到纹理数组
+    TextureSlot loadTexture(const std::string &path);
+    void releaseTexture(const std::string &path);
+    // 返回能放入该尺寸纹理的数组, 尺寸组用尽时返回 -1
+    int arrayFor(unsigned int width, unsigned int height);
+    // 容量不足时按2倍扩容并拷贝已有层
+    void reserveLayer(TextureArray &array);
+};
@@ -55,6 +55,13 @@ public:
         }
     }
 
+    void detachColorAttachment(GLenum attachment)
+    {
+        bind();
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, 0, 0);
+        std::erase(attachments, attachment);
+    }
+
     void attachDepthTexture2D(TextureID textureID)
     {
         bind();
@@ -83,6 +83,23 @@ STATICIMPL GLint ShaderBase::GetTextureUnitsLimits()
     return location;
 }
 
+GLint ShaderBase::getUniformLocation(UniformId id)
+{
+    if (!used)
+    {
+        throw std::runtime_error("Attempted to set uniform '" + id.fullName() + "' while shader is not active (glUseProgram was not called).");
+    }
+    const auto it = uniformIdLocationMap.find(id.key());
+    if (it != uniformIdLocationMap.end())
+    {
+        return it->second;
+    }
+    // һβѯ: ƴ, ַӿȡlocation(仺δҵ)
+    GLint location = getUniformLocationSafe(id.fullName());
+    uniformIdLocationMap.insert({id.key(), location});
+    return location;
+}
+
 void ShaderBase::setUniform4fv(const std::string &name, GLsizei count, const float *value)
 {
     GLint location = getUniformLocationSafe(name);
@@ -92,6 +109,15 @@ void ShaderBase::setUniform4fv(const std::string &name, GLsizei count, const flo
     }
 }
 
+void ShaderBase::setUniform1iv(const std::string &name, GLsizei count, const int *value)
+{
+    GLint location = getUniformLocationSafe(name);
+    if (location != -1)
+    {
+        glUniform1iv(location, count, value);
+    }
+}
+
 void ShaderBase::setUniform4fv(const std::string &name, const glm::vec4 &vec4)
 {
     GLint location = getUniformLocationSafe(name);
@@ -195,6 +221,95 @@ void ShaderBase::setUniform(const std::string &name, int i)
         glUniform1i(location, i);
     }
 }
+
+void ShaderBase::setUniform4fv(UniformId id, GLsizei count, const float *value)
+{
+    GLint location = getUniformLocation(id);
+    if (location != -1)
+    {
+        glUniform4fv(location, count, value);
+    }
+}
+
+void ShaderBase::setUniform3fv(UniformId id, GLsizei count, const glm::vec3 *value)
+{
+    GLint location = getUniformLocation(id);
+    if (location != -1)
+    {
+        glUniform3fv(location, count, glm::value_ptr(*value));
+    }
+}
+
+void ShaderBase::setUniform3fv(UniformId id, const glm::vec3 &vec3)
+{
+    setUniform3fv(id, 1, &vec3);
+}
+
+void ShaderBase::setMat4(UniformId id, GLsizei count, const glm::mat4 *mat)
+{
+    GLint location = getUniformLocation(id);
+    if (location != -1)
+    {
+        glUniformMatrix4fv(location, count, GL_FALSE, glm::value_ptr(*mat));
+    }
+}
+
+void ShaderBase::setMat4(UniformId id, const glm::mat4 &mat)
+{
+    setMat4(id, 1, &mat);
+}
+
+void ShaderBase::setFloat(UniformId id, float f)
+{
+    GLint location = getUniformLocation(id);
+    if (location != -1)
+    {
+        glUniform1f(location, f);
+    }
+}
+
+void ShaderBase::setInt(UniformId id, int i)
+{
+    GLint location = getUniformLocation(id);
+    if (location != -1)
+    {
+        glUniform1i(location, i);
+    }
+}
+
+void ShaderBase::setUniform(UniformId id, const glm::vec4 &vec4)
+{
+    setUniform4fv(id, 1, glm::value_ptr(vec4));
+}
+
+void ShaderBase::setUniform(UniformId id, const glm::vec3 &vec3)
+{
+    setUniform3fv(id, 1, &vec3);
+}
+
+void ShaderBase::setUniform(UniformId id, const glm::vec2 &vec2)
+{
+    GLint location = getUniformLocation(id);
+    if (location != -1)
+    {
+        glUniform2fv(location, 1, glm::value_ptr(vec2));
+    }
+}
+
+void ShaderBase::setUniform(UniformId id, const glm::mat4 &mat)
+{
+    setMat4(id, 1, &mat);
+}
+
+void ShaderBase::setUniform(UniformId id, float f)
+{
+    setFloat(id, f);
+}
+
+void ShaderBase::setUniform(UniformId id, int i)
+{
+    setInt(id, i);
+}
 /////////////////////////////////////////////////////////////////////////////////////////
 // Shader ʵ
 
@@ -278,6 +393,8 @@ Shader &Shader::operator=(Shader &&other) noexcept
         this->gs_path = std::move(other.gs_path);
         this->textureLocationMap = std::move(other.textureLocationMap);
         this->uniformLocationMap = std::move(other.uniformLocationMap);
+        this->uniformIdLocationMap = std::move(other.uniformIdLocationMap);
+        this->textureIdLocationMap = std::move(other.textureIdLocationMap);
         this->warningMsgSet = std::move(other.warningMsgSet);
         this->texLocationID = other.texLocationID;
         other.programID = 0; // ͷԴԴ
@@ -329,6 +446,31 @@ void Shader::setTextureAuto(GLuint textureID, GLenum textureTarget, int shaderTe
     }
 }
 
+void Shader::setTextureAuto(GLuint textureID, GLenum textureTarget, int shaderTextureLocation, UniformId sampler)
+{
+    auto it = textureIdLocationMap.find(sampler.key());
+    if (it == textureIdLocationMap.end())
+    {
+        // һΰ: ַԪ, ַ汾 textureLocationMap, ͬһֻռһԪ
+        auto [named, inserted] = textureLocationMap.try_emplace(sampler.fullName(), texLocationID);
+        if (inserted)
+        {
+            texLocationID++;
+        }
+        it = textureIdLocationMap.insert({sampler.key(), named->second}).first;
+    }
+    int location = it->second;
+
+    glActiveTexture(GetTextureUnitEnum(location));
+    glBindTexture(textureTarget, textureID);
+
+    GLint samplerLoc = getUniformLocation(sampler);
+    if (samplerLoc != -1)
+    {
+        glUniform1i(samplerLoc, location);
+    }
+}
+
 unsigned int Shader::linkShader(unsigned int vertexShader, unsigned int fragmentShader, unsigned int geometryShader, bool hasGS)
 {
     // Cofig Shader Program
@@ -437,6 +579,7 @@ ComputeShader &ComputeShader::operator=(ComputeShader &&other) noexcept
         this->programID = other.programID;
         this->used = other.used;
         this->uniformLocationMap = std::move(other.uniformLocationMap);
+        this->uniformIdLocationMap = std::move(other.uniformIdLocationMap);
         this->warningMsgSet = std::move(other.warningMsgSet);
 
         // Invalidate the other object
@@ -17,6 +17,7 @@
 
 #include "../Utils/DebugOutput.hpp"
 #include "GLResource.hpp"
+#include "UniformId.hpp"
 
 class ShaderBase : public GLResource
 {
@@ -24,6 +25,8 @@ public:
     unsigned int &programID = GLResource::ID;
     bool used = false;
     std::unordered_map<std::string, int> uniformLocationMap;
+    // UniformId::key() -> location, 热路径的查找不涉及字符串
+    std::unordered_map<uint64_t, int> uniformIdLocationMap;
     std::unordered_set<std::string> warningMsgSet;
     bool ignoreNotFoundWarning = false;
 
@@ -52,6 +55,9 @@ public:
     virtual GLint getUniformLocationSafe(const std::string &name) = 0;                                                                              // 接口方法
     GLint getUniformLocationSafe(const std::string &name, const std::function<void(const std::string &uniformName, GLuint programID)> &onNotFound); // 通用方法
 
+    /// @brief 未命中时经字符串接口查询一次, 之后只查整数键
+    GLint getUniformLocation(UniformId id);
+
     bool hasUniform(const std::string &name)
     {
         return glGetUniformLocation(programID, name.c_str()) != -1;
@@ -69,6 +75,7 @@ public:
     }
 
     void setUniform4fv(const std::string &name, GLsizei count, const float *value);
+    void setUniform1iv(const std::string &name, GLsizei count, const int *value);
     void setUniform4fv(const std::string &name, const glm::vec4 &vec4);
     void setUniform3fv(const std::string &name, const glm::vec3 &vec3);
     void setMat4(const std::string &name, const glm::mat4 &mat);
@@ -80,6 +87,21 @@ public:
     void setUniform(const std::string &name, const glm::mat4 &mat);
     void setUniform(const std::string &name, float f);
     void setUniform(const std::string &name, int i);
+
+    // 以 UniformId 为键的设置, 不分配内存. 数组版本从 id 对应的元素开始连续上传 count 个
+    void setUniform4fv(UniformId id, GLsizei count, const float *value);
+    void setUniform3fv(UniformId id, GLsizei count, const glm::vec3 *value);
+    void setUniform3fv(UniformId id, const glm::vec3 &vec3);
+    void setMat4(UniformId id, GLsizei count, const glm::mat4 *mat);
+    void setMat4(UniformId id, const glm::mat4 &mat);
+    void setFloat(UniformId id, float f);
+    void setInt(UniformId id, int i);
+    void setUniform(UniformId id, const glm::vec4 &vec4);
+    void setUniform(UniformId id, const glm::vec3 &vec3);
+    void setUniform(UniformId id, const glm::vec2 &vec2);
+    void setUniform(UniformId id, const glm::mat4 &mat);
+    void setUniform(UniformId id, float f);
+    void setUniform(UniformId id, int i);
 };
 
 class Shader : public ShaderBase
@@ -90,6 +112,7 @@ public:
     std::string fs_path;
     std::string gs_path;
     std::unordered_map<std::string, int> textureLocationMap;
+    std::unordered_map<uint64_t, int> textureIdLocationMap; // UniformId::key() -> 纹理单元
     int texLocationID;
 
 private:
@@ -104,6 +127,8 @@ public:
     Shader(Shader &&other) noexcept;
     Shader &operator=(Shader &&other) noexcept;
     void setTextureAuto(GLuint textureID, GLenum textureTarget, int shaderTextureLocation, const std::string &samplerUniformName);
+    /// @brief 同上, 纹理单元与 samplerUniformName 为同名字符串时共用
+    void setTextureAuto(GLuint textureID, GLenum textureTarget, int shaderTextureLocation, UniformId sampler);
 };
 
 class ComputeShader : public ShaderBase
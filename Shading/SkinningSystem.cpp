@@ -0,0 +1,176 @@
+#include "SkinningSystem.hpp"
+#include "Shader.hpp"
+#include "../Objects/SkinnedModel.hpp"
+#include "../Renderers/GPUTimer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // 实例较少时不值得分线程
+    constexpr size_t MinInstancesPerWorker = 8;
+}
+
+SkinningSystem &SkinningSystem::Get()
+{
+    static SkinningSystem system;
+    return system;
+}
+
+SkinningSystem::~SkinningSystem()
+{
+    // GL上下文在静态对象析构时可能已销毁, 程序与查询对象随上下文释放
+    m_shader.release();
+    m_timer.release();
+}
+
+void SkinningSystem::add(SkinnedModel &model)
+{
+    m_models.push_back(&model);
+}
+
+void SkinningSystem::remove(SkinnedModel &model)
+{
+    std::erase(m_models, &model);
+    std::erase(m_dirty, &model);
+}
+
+void SkinningSystem::reloadShaders()
+{
+    m_shader = std::make_unique<ComputeShader>("Shaders/Skinning/skin.comp");
+}
+
+void SkinningSystem::update(float deltaSeconds)
+{
+    m_stats.instances = m_models.size();
+    m_stats.skinnedInstances = 0;
+    m_stats.bones = 0;
+    m_stats.vertices = 0;
+    m_stats.dispatches = 0;
+    m_stats.poseMs = 0.0;
+    m_stats.uploadMs = 0.0;
+    if (m_timer)
+        m_stats.gpuMs = m_timer->getAverageMs();
+    if (m_models.empty())
+        return;
+    if (!m_shader)
+        reloadShaders();
+    if (!m_timer)
+        m_timer = std::make_unique<GPUTimer>();
+
+    const float delta = m_settings.paused ? 0.0f : deltaSeconds * m_settings.timeScale;
+    m_dirty.clear();
+    m_paletteFirst.clear();
+    size_t rows = 0;
+    for (SkinnedModel *model : m_models)
+    {
+        if (!model->advance(delta))
+            continue;
+        m_dirty.push_back(model);
+        m_paletteFirst.push_back(rows);
+        rows += model->getAsset().skeleton.boneCount() * Animation::PaletteRowsPerBone;
+    }
+    if (m_dirty.empty())
+        return;
+    m_palette.resize(rows);
+    m_stats.skinnedInstances = m_dirty.size();
+    m_stats.bones = rows / Animation::PaletteRowsPerBone;
+
+    const auto poseStart = Clock::now();
+    evaluatePoses();
+    m_stats.poseMs = ElapsedMs(poseStart);
+
+    const auto uploadStart = Clock::now();
+    dispatch();
+    m_stats.uploadMs = ElapsedMs(uploadStart);
+}
+
+void SkinningSystem::evaluatePoses()
+{
+    unsigned workerCount = m_settings.workerCount;
+    if (workerCount == 0)
+    {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        workerCount = hardware > 1 ? hardware - 1 : 1;
+    }
+    const size_t workers = std::max<size_t>(1, std::min<size_t>(workerCount, m_dirty.size() / MinInstancesPerWorker));
+    const size_t chunk = (m_dirty.size() + workers - 1) / workers;
+    m_poses.resize(std::max(m_poses.size(), workers));
+    m_stats.workers = workers;
+
+    // 各线程写入调色板中互不重叠的区间
+    const auto evaluateRange = [this](size_t worker, size_t begin, size_t end)
+    {
+        SkeletonPose &pose = m_poses[worker];
+        for (size_t i = begin; i < end; ++i)
+        {
+            const SkinnedModel &model = *m_dirty[i];
+            const Skeleton &skeleton = model.getAsset().skeleton;
+            Animation::Sample(skeleton, model.currentClip(), model.getTime(), pose);
+            Animation::BuildPalette(skeleton, pose, m_palette.data() + m_paletteFirst[i]);
+        }
+    };
+    if (workers == 1)
+    {
+        evaluateRange(0, 0, m_dirty.size());
+        return;
+    }
+    std::vector<std::future<void>> jobs;
+    for (size_t worker = 0, begin = 0; begin < m_dirty.size(); ++worker, begin += chunk)
+        jobs.emplace_back(std::async(std::launch::async, evaluateRange, worker, begin, std::min(m_dirty.size(), begin + chunk)));
+    for (auto &job : jobs)
+        job.get();
+}
+
+void SkinningSystem::dispatch()
+{
+    const size_t bytes = m_palette.size() * sizeof(glm::vec4);
+    if (m_paletteBuffer == 0)
+        glGenBuffers(1, &m_paletteBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_paletteBuffer);
+    if (bytes > m_paletteCapacity)
+        m_paletteCapacity = std::max(bytes, m_paletteCapacity * 2);
+    // 每帧重新指定存储, 不等待上一帧仍在读取旧内容的派发
+    glBufferData(GL_SHADER_STORAGE_BUFFER, m_paletteCapacity, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, bytes, m_palette.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    m_stats.paletteBytes = bytes;
+
+    m_timer->begin();
+    m_shader->use();
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_paletteBuffer);
+    for (size_t i = 0; i < m_dirty.size(); ++i)
+    {
+        SkinnedModel &model = *m_dirty[i];
+        const SkinnedAsset &asset = model.getAsset();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, model.sourceBuffer());
+        m_shader->setInt("paletteFirst"_uniform, static_cast<int>(m_paletteFirst[i]));
+        for (size_t p = 0; p < asset.parts.size(); ++p)
+        {
+            const SkinnedAsset::Part &source = asset.parts[p];
+            const SkinnedModel::Part &target = model.getParts()[p];
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, target.buffer->getVertexBuffer());
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, target.buffer->getPositionBuffer());
+            m_shader->setInt("sourceFirst"_uniform, static_cast<int>(source.firstSource));
+            m_shader->setInt("vertexCount"_uniform, static_cast<int>(source.vertexCount));
+            m_shader->setInt("targetFirst"_uniform, static_cast<int>(target.geometry->firstVertex));
+            glDispatchCompute((source.vertexCount + GroupSize - 1) / GroupSize, 1, 1);
+            m_stats.vertices += source.vertexCount;
+            m_stats.dispatches++;
+        }
+    }
+    for (GLuint binding = 0; binding < 4; ++binding)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+    // 之后作为顶点属性读取, 几何缓冲扩容时还会被拷贝
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    m_timer->end();
+}
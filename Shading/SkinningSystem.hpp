@@ -0,0 +1,80 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "../Math/Skeleton.hpp"
+
+class SkinnedModel;
+class ComputeShader;
+class GPUTimer;
+
+/*
+骨骼动画的每帧更新: 推进所有 SkinnedModel 的播放时间, 在工作线程中求值姿态, 把调色板写入一个连续数组后一次上传
+再为每个网格派发一次计算着色器, 把蒙皮后的顶点(含仅位置流)写入共享几何缓冲中该实例独占的范围
+之后本帧所有pass都按静态几何绘制这份结果, 蒙皮次数与pass数无关. 姿态没有变化的实例不参与求值与蒙皮
+*/
+class SkinningSystem
+{
+public:
+    static constexpr int GroupSize = 64; // 与 skin.comp 的 local_size_x 一致
+
+    struct Settings
+    {
+        bool paused = false;
+        float timeScale = 1.0f;
+        unsigned workerCount = 0; // 0 表示按硬件线程数
+    };
+
+    struct Stats
+    {
+        size_t instances = 0;
+        size_t skinnedInstances = 0; // 本帧重新蒙皮的实例
+        size_t bones = 0;            // 本帧求值的骨骼数
+        size_t vertices = 0;         // 本帧蒙皮的顶点数
+        size_t dispatches = 0;
+        size_t workers = 0;
+        size_t paletteBytes = 0;
+        double poseMs = 0.0;   // 姿态求值(CPU, 含等待工作线程)
+        double uploadMs = 0.0; // 调色板上传与派发的CPU耗时
+        double gpuMs = 0.0;    // 蒙皮计算着色器的GPU耗时
+    };
+
+    static SkinningSystem &Get();
+
+    SkinningSystem(const SkinningSystem &) = delete;
+    SkinningSystem &operator=(const SkinningSystem &) = delete;
+    ~SkinningSystem();
+
+    // SkinnedModel 构造与析构时调用
+    void add(SkinnedModel &model);
+    void remove(SkinnedModel &model);
+
+    /// @brief 每帧渲染前调用一次
+    void update(float deltaSeconds);
+    void reloadShaders();
+
+    Settings &getSettings() { return m_settings; }
+    const Stats &getStats() const { return m_stats; }
+
+private:
+    Settings m_settings;
+    Stats m_stats;
+    std::vector<SkinnedModel *> m_models;
+    std::vector<SkinnedModel *> m_dirty;  // 本帧需要蒙皮的实例
+    std::vector<size_t> m_paletteFirst;   // m_dirty 中各实例调色板在 m_palette 中的起始行
+    std::vector<glm::vec4> m_palette;     // 每个骨骼3行, 按 m_dirty 顺序连续存放
+    std::vector<SkeletonPose> m_poses;    // 每个工作线程一份临时姿态
+    GLuint m_paletteBuffer = 0;
+    size_t m_paletteCapacity = 0; // 以字节计
+    std::unique_ptr<ComputeShader> m_shader;
+    std::unique_ptr<GPUTimer> m_timer;
+
+    SkinningSystem() = default;
+
+    void evaluatePoses();
+    void dispatch();
+};
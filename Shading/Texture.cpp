@@ -56,7 +56,7 @@ void Texture2D::generate(unsigned int width, unsigned int height, GLenum interna
     glBindTexture(Target, 0);
 }
 
-void Texture2D::generateComputeStorage(unsigned int width, unsigned int height, GLenum internalFormat)
+void Texture2D::generateComputeStorage(unsigned int width, unsigned int height, GLenum internalFormat, GLsizei levels)
 {
     if (ID != 0)
     {
@@ -71,7 +71,7 @@ void Texture2D::generateComputeStorage(unsigned int width, unsigned int height,
     assert(Target == GL_TEXTURE_2D);
     glBindTexture(Target, ID);
     {
-        glTexStorage2D(Target, 1, internalFormat, Width, Height);
+        glTexStorage2D(Target, levels, internalFormat, Width, Height);
         glTexParameteri(Target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         glTexParameteri(Target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         glTexParameteri(Target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -80,6 +80,37 @@ void Texture2D::generateComputeStorage(unsigned int width, unsigned int height,
     glBindTexture(Target, 0);
 }
 
+///@brief 生成数组纹理某一层的2D视图, 渲染与采样视图即读写该层
+///@param origTexture 不可变存储的 GL_TEXTURE_2D_ARRAY
+///@param layer 视图对应的层
+/// Filter 与 Wrap 使用调用前设置的成员值
+void Texture2D::generateView(GLuint origTexture, GLenum internalFormat, unsigned int width, unsigned int height, GLuint layer)
+{
+    if (ID != 0)
+    {
+        glDeleteTextures(1, &ID);
+    }
+    // 视图须使用从未绑定过的名字
+    glGenTextures(1, &ID);
+
+    Width = width;
+    Height = height;
+    InternalFormat = internalFormat;
+    Mipmapping = false;
+
+    assert(Target == GL_TEXTURE_2D);
+    assert(FilterMin != GL_LINEAR_MIPMAP_LINEAR);
+    glTextureView(ID, Target, origTexture, internalFormat, 0, 1, layer, 1);
+    glBindTexture(Target, ID);
+    {
+        glTexParameteri(Target, GL_TEXTURE_MIN_FILTER, FilterMin);
+        glTexParameteri(Target, GL_TEXTURE_MAG_FILTER, FilterMax);
+        glTexParameteri(Target, GL_TEXTURE_WRAP_S, WrapS);
+        glTexParameteri(Target, GL_TEXTURE_WRAP_T, WrapT);
+    }
+    glBindTexture(Target, 0);
+}
+
 /// @brief 设置纹理数据 在Generate()之后调用 通常是逐帧调用
 /// @param data 纹理数据指针 注意与纹理格式一致
 void Texture2D::setData(void *data)
@@ -239,6 +270,35 @@ void TextureCube::generate(unsigned int width, unsigned int height, GLenum inter
         glGenerateMipmap(Target);
 }
 
+///@brief 生成立方体贴图数组中一个立方体(6层)的视图
+///@param origTexture 不可变存储的 GL_TEXTURE_CUBE_MAP_ARRAY
+///@param layer 立方体下标, 视图覆盖第 layer * 6 起的6层
+void TextureCube::generateView(GLuint origTexture, GLenum internalFormat, unsigned int size, GLuint layer, GLenum filterMax, GLenum filterMin)
+{
+    Target = GL_TEXTURE_CUBE_MAP;
+    Width = size;
+    Height = size;
+    InternalFormat = internalFormat;
+    FilterMin = filterMin;
+    FilterMax = filterMax;
+    Mipmapping = false;
+
+    if (ID != 0)
+    {
+        glDeleteTextures(1, &ID);
+    }
+    glGenTextures(1, &ID);
+
+    glTextureView(ID, Target, origTexture, internalFormat, 0, 1, layer * 6, 6);
+    glBindTexture(Target, ID);
+    glTexParameteri(Target, GL_TEXTURE_MAG_FILTER, filterMax);
+    glTexParameteri(Target, GL_TEXTURE_MIN_FILTER, filterMin);
+    glTexParameteri(Target, GL_TEXTURE_WRAP_S, WrapS);
+    glTexParameteri(Target, GL_TEXTURE_WRAP_T, WrapT);
+    glTexParameteri(Target, GL_TEXTURE_WRAP_R, WrapR);
+    glBindTexture(Target, 0);
+}
+
 void TextureCube::setFaceData(FaceEnum faceTarget, void *data)
 {
     glBindTexture(Target, ID);
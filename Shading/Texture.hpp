@@ -36,7 +36,9 @@ public:
     Texture2D(Texture2D &&) noexcept = default;
     Texture2D &operator=(Texture2D &&) noexcept = default;
     void generate(unsigned int width, unsigned int height, GLenum internalFormat, GLenum format, GLenum type, void *data, bool mipMapping = true);
-    void generateComputeStorage(unsigned int width, unsigned int height, GLenum internalFormat);
+    void generateComputeStorage(unsigned int width, unsigned int height, GLenum internalFormat, GLsizei levels = 1);
+    /// @brief  origTexture  layer ͼ, 乲ô洢. origTexture Ϊɱ洢(glTexStorage*)
+    void generateView(GLuint origTexture, GLenum internalFormat, unsigned int width, unsigned int height, GLuint layer);
 
     void setData(void *data);
 
@@ -114,6 +116,8 @@ public:
     TextureCube &operator=(TextureCube &&) noexcept = default;
 
     void generate(unsigned int width, unsigned int height, GLenum internalFormat, GLenum format, GLenum type, GLenum filterMax, GLenum filterMin, bool mipmap);
+    /// @brief ͼ origTexture  layer ͼ, 乲ô洢. origTexture Ϊɱ洢
+    void generateView(GLuint origTexture, GLenum internalFormat, unsigned int size, GLuint layer, GLenum filterMax, GLenum filterMin);
 
     void setFaceData(FaceEnum faceTarget, void *data);
 
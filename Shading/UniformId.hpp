@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/*
+编译期哈希的uniform名, 用于每帧或每次绘制都要设置的uniform
+    ShaderBase 以64位键缓存location, 设置时不构造字符串, 也不在运行时哈希字符串
+    名字中的 "[]" 表示数组下标, 设置时用 operator[] 给出: "pointLightArray[].pos"_uniform[3] 对应 pointLightArray[3].pos
+    只在第一次查询某个(名字, 下标)时拼出完整名字, 经字符串接口取得location并写入缓存
+基本类型数组(如 shadowSamples[128])的location连续, 应一次上传整个数组, 不必逐项设置
+*/
+struct UniformId
+{
+    uint64_t hash = 0;
+    std::string_view name;
+    int index = -1; // 替换名字中的 "[]", < 0 表示没有下标
+
+    // FNV-1a
+    static constexpr uint64_t Hash(std::string_view text)
+    {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (char c : text)
+        {
+            h ^= static_cast<uint8_t>(c);
+            h *= 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    consteval explicit UniformId(std::string_view _name) : hash(Hash(_name)), name(_name) {}
+
+    constexpr UniformId operator[](size_t i) const
+    {
+        UniformId indexed = *this;
+        indexed.index = static_cast<int>(i);
+        return indexed;
+    }
+
+    /// @brief 缓存键, 同一名字的不同下标互不相同
+    constexpr uint64_t key() const
+    {
+        return index < 0 ? hash : hash ^ ((static_cast<uint64_t>(index) + 1) * 0x9E3779B97F4A7C15ull);
+    }
+
+    /// @brief 完整的uniform名, 只在缓存未命中时调用
+    std::string fullName() const
+    {
+        std::string result(name);
+        const size_t brackets = result.find("[]");
+        if (index >= 0 && brackets != std::string::npos)
+            result.insert(brackets + 1, std::to_string(index));
+        return result;
+    }
+};
+
+consteval UniformId operator""_uniform(const char *name, size_t length)
+{
+    return UniformId(std::string_view(name, length));
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+
+/*
+无GL上下文的测试程序共用的检查宏. 失败时打印位置并计数, main 以失败数作为返回值供 ctest 判断
+*/
+namespace Check
+{
+    inline int &Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline bool Report(bool passed, const char *expression, const char *file, int line)
+    {
+        if (!passed)
+        {
+            std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+            Failures()++;
+        }
+        return passed;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    inline double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+}
+
+#define CHECK(expression) ::Check::Report(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
@@ -0,0 +1,202 @@
+#include "../Renderers/MaskedOcclusionCulling.hpp"
+#include "Check.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/*
+MaskedOcclusionCulling 的无GL测试与基准
+相机位于 (0, 0, 5) 看向 -Z, 墙为 z = 0 处 4x4 的正方形, 地面为 y = -1 处穿过近平面的长条
+*/
+namespace
+{
+    constexpr int Width = 320;
+    constexpr int Height = 192;
+
+    glm::mat4 ViewProjection()
+    {
+        const glm::mat4 projection = glm::perspective(glm::radians(60.0f), float(Width) / float(Height), 0.1f, 100.0f);
+        const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        return projection * view;
+    }
+
+    AABB Box(const glm::vec3 &min, const glm::vec3 &max)
+    {
+        AABB box;
+        box.min = min;
+        box.max = max;
+        return box;
+    }
+
+    // XY平面上 [-1, 1]^2 划分为 n x n 个四边形
+    struct Grid
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+
+        explicit Grid(int n)
+        {
+            for (int y = 0; y <= n; ++y)
+                for (int x = 0; x <= n; ++x)
+                    positions.emplace_back(2.0f * x / n - 1.0f, 2.0f * y / n - 1.0f, 0.0f);
+            for (int y = 0; y < n; ++y)
+            {
+                for (int x = 0; x < n; ++x)
+                {
+                    const uint32_t a = uint32_t(y * (n + 1) + x), b = a + 1, c = a + uint32_t(n + 1), d = c + 1;
+                    indices.insert(indices.end(), {a, b, d, a, d, c});
+                }
+            }
+        }
+
+        void addTo(MaskedOcclusionCulling &occlusion, const glm::mat4 &model) const
+        {
+            occlusion.addOccluder(&positions[0].x, sizeof(glm::vec3), positions.size(), indices.data(), indices.size(), model);
+        }
+    };
+
+    glm::mat4 WallModel()
+    {
+        return glm::scale(glm::mat4(1.0f), glm::vec3(2.0f, 2.0f, 1.0f));
+    }
+
+    // y = -1 的水平长条, z 从 -20 到 20, 穿过相机所在的近平面
+    glm::mat4 FloorModel()
+    {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+        model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        return glm::scale(model, glm::vec3(20.0f, 20.0f, 1.0f));
+    }
+
+    void TestVisibility()
+    {
+        MaskedOcclusionCulling occlusion(Width, Height);
+        const Grid quad(1);
+        occlusion.beginFrame(ViewProjection());
+        occlusion.rasterize();
+        // 没有遮挡体时都可见
+        CHECK(occlusion.isVisible(Box(glm::vec3(-0.5f, -0.5f, -3.0f), glm::vec3(0.5f, 0.5f, -2.0f))));
+
+        occlusion.beginFrame(ViewProjection());
+        quad.addTo(occlusion, WallModel());
+        quad.addTo(occlusion, FloorModel());
+        occlusion.rasterize();
+        CHECK(occlusion.getStats().occluderTriangles >= 4);
+
+        // 墙后的盒子被遮挡, 墙前的可见
+        CHECK(!occlusion.isVisible(Box(glm::vec3(-0.5f, -0.5f, -3.0f), glm::vec3(0.5f, 0.5f, -2.0f))));
+        CHECK(occlusion.isVisible(Box(glm::vec3(-0.5f, -0.5f, 1.0f), glm::vec3(0.5f, 0.5f, 2.0f))));
+        // 部分露出墙边
+        CHECK(occlusion.isVisible(Box(glm::vec3(1.5f, -0.5f, -3.0f), glm::vec3(3.5f, 0.5f, -2.0f))));
+        // 跨过近平面的盒子保守认为可见, 即使其余部分在墙后
+        CHECK(occlusion.isVisible(Box(glm::vec3(-0.5f, -0.5f, -3.0f), glm::vec3(0.5f, 0.5f, 6.0f))));
+        CHECK(occlusion.isVisible(Box(glm::vec3(-0.2f, -0.2f, 4.95f), glm::vec3(0.2f, 0.2f, 5.05f))));
+        // 相机背后
+        CHECK(occlusion.isVisible(Box(glm::vec3(-0.5f, -0.5f, 7.0f), glm::vec3(0.5f, 0.5f, 8.0f))));
+
+        // 穿过近平面的地面经裁剪后仍能遮挡其下方, 不误遮挡上方
+        CHECK(!occlusion.isVisible(Box(glm::vec3(-0.5f, -3.0f, 1.0f), glm::vec3(0.5f, -2.0f, 2.0f))));
+        CHECK(occlusion.isVisible(Box(glm::vec3(-0.5f, -0.9f, 1.0f), glm::vec3(0.5f, -0.5f, 2.0f))));
+    }
+
+    // 多线程光栅化与测试的结果与单线程一致, 常驻工作线程可跨帧重复使用
+    void TestWorkersMatchSingleThread()
+    {
+        MaskedOcclusionCulling single(Width, Height, 1);
+        MaskedOcclusionCulling threaded(Width, Height, 4);
+        const Grid wall(16);
+        const Grid floor(4);
+
+        std::vector<uint32_t> all;
+        std::vector<AABB> boxes;
+        for (int z = 0; z < 20; ++z)
+        {
+            for (int x = -20; x < 20; ++x)
+            {
+                const glm::vec3 min(x * 0.25f, -1.5f + (x & 3) * 0.5f, 3.0f - z * 0.5f);
+                boxes.push_back(Box(min, min + glm::vec3(0.2f)));
+                all.push_back(uint32_t(all.size()));
+            }
+        }
+        const auto boxOf = [&](uint32_t i) -> const AABB & { return boxes[i]; };
+
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            const glm::mat4 viewProj = ViewProjection() * glm::rotate(glm::mat4(1.0f), glm::radians(5.0f * frame), glm::vec3(0.0f, 1.0f, 0.0f));
+            for (MaskedOcclusionCulling *occlusion : {&single, &threaded})
+            {
+                occlusion->beginFrame(viewProj);
+                wall.addTo(*occlusion, WallModel());
+                floor.addTo(*occlusion, FloorModel());
+                occlusion->rasterize();
+            }
+            std::vector<float> singleDepth, threadedDepth;
+            single.exportDepth(singleDepth);
+            threaded.exportDepth(threadedDepth);
+            CHECK(singleDepth == threadedDepth);
+
+            std::vector<uint32_t> singleVisible = all, threadedVisible = all;
+            const size_t singleOccluded = single.filterVisible(singleVisible, boxOf);
+            const size_t threadedOccluded = threaded.filterVisible(threadedVisible, boxOf);
+            CHECK(singleOccluded > 0);
+            CHECK(singleOccluded == threadedOccluded);
+            CHECK(singleVisible == threadedVisible);
+        }
+    }
+
+    void Benchmark()
+    {
+        constexpr int Frames = 20;
+        constexpr size_t BoxCount = 100000;
+        MaskedOcclusionCulling occlusion(Width, Height);
+        const Grid wall(64); // 8192 个三角形
+
+        std::vector<AABB> boxes;
+        boxes.reserve(BoxCount);
+        for (size_t i = 0; i < BoxCount; ++i)
+        {
+            const glm::vec3 min(float(i % 100) * 0.1f - 5.0f, float(i / 100 % 100) * 0.1f - 5.0f, -1.0f - float(i / 10000));
+            boxes.push_back(Box(min, min + glm::vec3(0.08f)));
+        }
+        const auto boxOf = [&](uint32_t i) -> const AABB & { return boxes[i]; };
+
+        double addMs = 0.0, rasterizeMs = 0.0, testMs = 0.0;
+        size_t triangles = 0, occluded = 0;
+        std::vector<uint32_t> visible;
+        for (int frame = 0; frame < Frames; ++frame)
+        {
+            const auto start = Check::Clock::now();
+            occlusion.beginFrame(ViewProjection());
+            for (int i = 0; i < 4; ++i)
+                wall.addTo(occlusion, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -0.25f * i)) * WallModel());
+            addMs += Check::ElapsedMs(start);
+            occlusion.rasterize();
+
+            visible.resize(BoxCount);
+            for (size_t i = 0; i < BoxCount; ++i)
+                visible[i] = uint32_t(i);
+            occluded = occlusion.filterVisible(visible, boxOf);
+            rasterizeMs += occlusion.getStats().rasterizeMs;
+            testMs += occlusion.getStats().testMs;
+            triangles = occlusion.getStats().occluderTriangles;
+        }
+        CHECK(occluded > 0);
+        std::printf("%d x %d, %zu occluder triangles: add %.3f ms, rasterize %.3f ms; %zu boxes tested in %.3f ms (%zu occluded)\n",
+                    occlusion.getWidth(), occlusion.getHeight(), triangles, addMs / Frames, rasterizeMs / Frames,
+                    BoxCount, testMs / Frames, occluded);
+    }
+}
+
+int main()
+{
+    TestVisibility();
+    TestWorkersMatchSingleThread();
+    Benchmark();
+
+    if (Check::Failures() > 0)
+        std::printf("%d check(s) failed\n", Check::Failures());
+    return Check::Failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+#include "../Math/MeshSimplifier.hpp"
+#include "Check.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*
+MeshSimplifier 的无GL测试与基准: 简化带UV接缝的球面
+检查 LOD 链的误差单调递增, 不出现原网格没有的开放边, 接缝上的位置在每一级都保留
+*/
+namespace
+{
+    struct Vertex
+    {
+        glm::vec3 position;
+        glm::vec2 texCoord;
+    };
+
+    struct TestMesh
+    {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+    };
+
+    /// @brief 经纬球. 经度 0 与 2pi 处各有一列位置相同, 纹理坐标不同的顶点(接缝), 两极每个分段各一个顶点
+    /// @param hemisphere 只生成北半球, 赤道为开放边界
+    TestMesh UVSphere(unsigned int segments, unsigned int rings, bool hemisphere = false)
+    {
+        TestMesh mesh;
+        const unsigned int lastRing = hemisphere ? rings / 2 : rings;
+        for (unsigned int r = 0; r <= lastRing; ++r)
+        {
+            const float theta = glm::pi<float>() * r / rings;
+            for (unsigned int s = 0; s <= segments; ++s)
+            {
+                // 接缝两侧按同一角度计算, 保证位置逐位相等
+                const float phi = glm::two_pi<float>() * (s % segments) / segments;
+                glm::vec3 position(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+                if (r == 0 || r == rings)
+                    position = glm::vec3(0.0f, r == 0 ? 1.0f : -1.0f, 0.0f);
+                mesh.vertices.push_back(Vertex{position, glm::vec2(float(s) / segments, float(r) / rings)});
+            }
+        }
+        const unsigned int row = segments + 1;
+        for (unsigned int r = 0; r < lastRing; ++r)
+        {
+            for (unsigned int s = 0; s < segments; ++s)
+            {
+                const unsigned int a = r * row + s, b = a + 1, c = a + row, d = c + 1;
+                if (r != 0)
+                    mesh.indices.insert(mesh.indices.end(), {a, b, c});
+                if (r + 1 != rings)
+                    mesh.indices.insert(mesh.indices.end(), {b, d, c});
+            }
+        }
+        return mesh;
+    }
+
+    using PositionKey = std::tuple<float, float, float>;
+
+    PositionKey KeyOf(const glm::vec3 &p)
+    {
+        return {p.x + 0.0f, p.y + 0.0f, p.z + 0.0f};
+    }
+
+    // 与简化器相同, 位置相同的顶点视为同一拓扑顶点
+    std::vector<unsigned int> WeldPositions(const TestMesh &mesh, std::vector<size_t> &copies)
+    {
+        std::map<PositionKey, unsigned int> ids;
+        std::vector<unsigned int> weld(mesh.vertices.size());
+        for (size_t v = 0; v < mesh.vertices.size(); ++v)
+        {
+            auto [it, inserted] = ids.try_emplace(KeyOf(mesh.vertices[v].position), static_cast<unsigned int>(ids.size()));
+            weld[v] = it->second;
+        }
+        copies.assign(ids.size(), 0);
+        std::vector<uint8_t> referenced(mesh.vertices.size(), 0);
+        for (unsigned int v : mesh.indices)
+        {
+            if (!referenced[v])
+                copies[weld[v]]++;
+            referenced[v] = 1;
+        }
+        return weld;
+    }
+
+    // 只被一个三角形使用的拓扑边
+    std::set<std::pair<unsigned int, unsigned int>> OpenEdges(const std::vector<unsigned int> &indices, const std::vector<unsigned int> &weld)
+    {
+        std::map<std::pair<unsigned int, unsigned int>, int> uses;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int a = weld[indices[i + k]], b = weld[indices[i + (k + 1) % 3]];
+                if (a == b)
+                    continue;
+                uses[{std::min(a, b), std::max(a, b)}]++;
+            }
+        }
+        std::set<std::pair<unsigned int, unsigned int>> open;
+        for (const auto &[edge, count] : uses)
+        {
+            if (count == 1)
+                open.insert(edge);
+        }
+        return open;
+    }
+
+    std::vector<MeshLod> BuildLods(const TestMesh &mesh)
+    {
+        return MeshSimplifier::BuildLodChain(&mesh.vertices[0].position.x, sizeof(Vertex), mesh.vertices.size(), mesh.indices);
+    }
+
+    void TestLodChain(const char *name, const TestMesh &mesh)
+    {
+        std::vector<size_t> copies;
+        const std::vector<unsigned int> weld = WeldPositions(mesh, copies);
+        const auto originalOpen = OpenEdges(mesh.indices, weld);
+        const std::vector<MeshLod> lods = BuildLods(mesh);
+        std::printf("%s: %zu triangles, %zu lods\n", name, mesh.indices.size() / 3, lods.size());
+        CHECK(!lods.empty());
+
+        size_t previousIndices = mesh.indices.size();
+        float previousError = 0.0f;
+        for (size_t level = 0; level < lods.size(); ++level)
+        {
+            const MeshLod &lod = lods[level];
+            std::printf("  lod %zu: %zu triangles, error %g\n", level + 1, lod.indices.size() / 3, lod.error);
+            CHECK(lod.indices.size() % 3 == 0);
+            CHECK(lod.indices.size() < previousIndices);
+            CHECK(lod.error >= previousError);
+            previousIndices = lod.indices.size();
+            previousError = lod.error;
+
+            // 不产生新顶点, 索引都指向原顶点
+            CHECK(std::all_of(lod.indices.begin(), lod.indices.end(), [&](unsigned int v) { return v < mesh.vertices.size(); }));
+
+            for (const auto &edge : OpenEdges(lod.indices, weld))
+            {
+                if (!CHECK(originalOpen.count(edge) != 0))
+                    break;
+            }
+
+            // 接缝与开放边界上的位置只能作为塌缩目标, 每一级仍被引用
+            std::vector<uint8_t> present(copies.size(), 0);
+            for (unsigned int v : lod.indices)
+                present[weld[v]] = 1;
+            for (size_t p = 0; p < copies.size(); ++p)
+            {
+                if (copies[p] > 1 && !CHECK(present[p]))
+                    break;
+            }
+            for (const auto &edge : originalOpen)
+            {
+                if (!CHECK(present[edge.first] && present[edge.second]))
+                    break;
+            }
+        }
+    }
+
+    void BenchmarkLargeSphere()
+    {
+        // 512 x 257: 2 * 512 * 256 = 262144 个三角形
+        const TestMesh mesh = UVSphere(512, 257);
+        CHECK(mesh.indices.size() / 3 == 262144);
+
+        auto start = Check::Clock::now();
+        float error = 0.0f;
+        const std::vector<unsigned int> half = MeshSimplifier::Simplify(&mesh.vertices[0].position.x, sizeof(Vertex), mesh.vertices.size(),
+                                                                        mesh.indices, mesh.indices.size() / 2, error);
+        const double simplifyMs = Check::ElapsedMs(start);
+        CHECK(half.size() <= mesh.indices.size() / 2);
+
+        start = Check::Clock::now();
+        const std::vector<MeshLod> lods = BuildLods(mesh);
+        const double chainMs = Check::ElapsedMs(start);
+        CHECK(!lods.empty());
+        std::printf("262144 triangles: simplify to half %.1f ms (error %g), lod chain (%zu lods) %.1f ms\n",
+                    simplifyMs, error, lods.size(), chainMs);
+    }
+}
+
+int main()
+{
+    TestLodChain("sphere 32x16", UVSphere(32, 16));
+    TestLodChain("sphere 96x48", UVSphere(96, 48));
+    TestLodChain("hemisphere 64x32", UVSphere(64, 32, true));
+    BenchmarkLargeSphere();
+
+    if (Check::Failures() > 0)
+        std::printf("%d check(s) failed\n", Check::Failures());
+    return Check::Failures() == 0 ? 0 : 1;
+}
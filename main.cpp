@@ -9,11 +9,17 @@
 #include "Objects/Cube.hpp"
 #include "Objects/Grid.hpp"
 #include "Objects/Object.hpp"
+#include "Objects/Scene.hpp"
+#include "Objects/SceneGenerator.hpp"
 #include "Objects/Plane.hpp"
 #include "Objects/Sphere.hpp"
 #include "Objects/Arrow.hpp"
 #include "Objects/FrustumWireframe.hpp"
+#include "Objects/Terrain.hpp"
+#include "Objects/WorldPartition.hpp"
 #include "Renderers/RendererManager.hpp"
+#include "Shading/ClusterPagePool.hpp"
+#include "Shading/SkinningSystem.hpp"
 #include "Shader.hpp"
 #include "Utils/DebugOutput.hpp"
 
@@ -27,7 +33,7 @@
 const int InitWidth = 1600;
 const int InitHeight = 900;
 
-int main()
+int main(int argc, char **argv)
 {
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -81,37 +87,51 @@ int main()
     Camera cam(InitWidth, InitHeight, 14.f, 0.05f);
 
     Scene scene;
-    glm::mat4 plane_model = glm::translate(model, glm::vec3(0.f, 1.f, 0.f));
-    glm::mat4 box_model = glm::translate(model, glm::vec3(3.f, 2.f, -4.f));
-    glm::mat4 sphere_model = glm::translate(model, glm::vec3(6.f, 2.f, 2.f));
-    glm::mat4 backPack_model = glm::translate(model, glm::vec3(0.f, 3.f, 4.f));
-    glm::mat4 bass_model = glm::translate(model, glm::vec3(0.f, 4.f, 4.f));
-
-    auto currentID = scene.addObject(std::make_unique<Cube>(glm::vec3(1.f, 1.f, 1.f)));
-    scene.getObject(currentID).setModelTransform(box_model);
-
-    currentID = scene.addObject(std::make_unique<Sphere>(1.f));
-    scene.getObject(currentID).setModelTransform(sphere_model);
-
-    currentID = scene.addObject(std::make_unique<Plane>(20.f, 20.f));
-    scene.getObject(currentID).setModelTransform(plane_model);
-
     Lights allLights;
     auto &[pointLights, dirLights] = allLights;
-    pointLights.emplace_back(glm::vec3(0.1f, 0.1f, 0.1f),
-                             glm::vec3(8.f, 10.f, 4.f), 1024, 250.f);
-
-    pointLights.emplace_back(glm::vec3(10.f, 30.f, 20.f),
-                             glm::vec3(2.f, 10.f, 14.f), 1024, 250.f);
-    pointLights.emplace_back(glm::vec3(30.f, 20.f, 40.f),
-                             glm::vec3(16.f, 4.f, 8.f), 1024, 250.f);
 
-    dirLights.emplace_back(
-        DirectionLight(glm::vec3(1.0f), glm::vec3(50.f, 20.f, 10.f), 1024));
+    // 命令行带 --stress 参数时生成压力测试场景, 否则使用默认场景
+    SceneGenerator::Settings stressSettings;
+    bool stressScene = false;
+    try
+    {
+        stressScene = SceneGenerator::ParseArguments(argc, argv, stressSettings);
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Invalid stress arguments: " << e.what() << std::endl;
+    }
 
-    // temporary light source variable
-    PointLight &light = pointLights[0]; // Assuming the first light is the one we
-                                        // want to use for shadow
+    if (stressScene)
+    {
+        const SceneGenerator::Result result = SceneGenerator::Generate(scene, allLights, stressSettings);
+        DebugOutput::AddLog("Stress scene (seed {}): {} primitives, {} model instances, {} point lights, {} dir lights in {:.2f} ms\n",
+                            stressSettings.seed, result.primitives, result.modelInstances, result.pointLights, result.dirLights, result.generateMs);
+    }
+    else
+    {
+        glm::mat4 plane_model = glm::translate(model, glm::vec3(0.f, 1.f, 0.f));
+        glm::mat4 box_model = glm::translate(model, glm::vec3(3.f, 2.f, -4.f));
+        glm::mat4 sphere_model = glm::translate(model, glm::vec3(6.f, 2.f, 2.f));
+        glm::mat4 backPack_model = glm::translate(model, glm::vec3(0.f, 3.f, 4.f));
+        glm::mat4 bass_model = glm::translate(model, glm::vec3(0.f, 4.f, 4.f));
+
+        scene.addObject(std::make_unique<Cube>(glm::vec3(1.f, 1.f, 1.f)), box_model);
+        scene.addObject(std::make_unique<Sphere>(1.f), sphere_model);
+        SceneHandle plane = scene.addObject(std::make_unique<Plane>(20.f, 20.f), plane_model);
+        scene.setOccluder(plane, true);
+
+        pointLights.emplace_back(glm::vec3(0.1f, 0.1f, 0.1f),
+                                 glm::vec3(8.f, 10.f, 4.f), 1024, 250.f);
+
+        pointLights.emplace_back(glm::vec3(10.f, 30.f, 20.f),
+                                 glm::vec3(2.f, 10.f, 14.f), 1024, 250.f);
+        pointLights.emplace_back(glm::vec3(30.f, 20.f, 40.f),
+                                 glm::vec3(16.f, 4.f, 8.f), 1024, 250.f);
+
+        dirLights.emplace_back(
+            DirectionLight(glm::vec3(1.0f), glm::vec3(50.f, 20.f, 10.f), 1024));
+    }
 
     // 应用初始化
     auto ptrRenderParameters = std::make_shared<RenderParameters>(
@@ -162,7 +182,21 @@ int main()
             GUI::ModelLoadView();
         }
         ModelLoader::run(scene);
+        WorldPartition::Get().update(scene, cam.getPosition());
+        {
+            // 簇层级网格的页在渲染前上传, 本帧的cut按主相机选择
+            int framebufferWidth = 0, framebufferHeight = 0;
+            glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+            ClusterPagePool::Get().beginFrame(cam.getPosition(), 0.5f * framebufferHeight * cam.getPerspectiveMatrix()[1][1]);
+        }
+
+        // 地形瓦片的上传与请求, 各pass的LOD按主相机距离选择
+        Terrain::Get().update(cam.getPosition(), cam.getFrustum().getPlanes());
+
+        // 骨骼动画每帧只蒙皮一次, 之后各pass读取同一份结果
+        SkinningSystem::Get().update(io.DeltaTime);
 
+        scene.updateTransforms(model);
         ptrRenderManager->render(ptrRenderParameters);
 
         scene.update();